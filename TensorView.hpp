@@ -4,17 +4,43 @@
 #include "TensorView/tensorview_config.hpp"
 #include "TensorView/errors.hpp"
 #include "TensorView/span.hpp"
+#include "TensorView/layout.hpp"
+#include "TensorView/float16.hpp"
 #include "TensorView/DynamicTensorShape.hpp"
 #include "TensorView/FixedTensorShape.hpp"
 #include "TensorView/StridedShape.hpp"
+#include "TensorView/StridedIterator.hpp"
+#include "TensorView/ContiguousIterator.hpp"
+#include "TensorView/multi_index.hpp"
 #include "TensorView/ViewContainer.hpp"
 #include "TensorView/BaseTensor.hpp"
 #include "TensorView/DynamicTensorView.hpp"
 #include "TensorView/FixedTensorView.hpp"
 #include "TensorView/SubView.hpp"
+#include "TensorView/StridedView.hpp"
 #include "TensorView/FixedTensor.hpp"
 #include "TensorView/Tensor.hpp"
+#include "TensorView/SmallTensor.hpp"
 #include "TensorView/reshape.hpp"
 #include "TensorView/named_tensors.hpp"
+#include "TensorView/expressions.hpp"
+#include "TensorView/simd.hpp"
+#include "TensorView/reductions.hpp"
+#include "TensorView/copy.hpp"
+#include "TensorView/aligned_allocator.hpp"
+#include "TensorView/arena.hpp"
+#include "TensorView/parallel.hpp"
+#include "TensorView/matmul.hpp"
+#include "TensorView/stencil.hpp"
+#include "TensorView/sparse.hpp"
+#include "TensorView/DeviceTensor.hpp"
+#include "TensorView/cuda_kernels.hpp"
+#include "TensorView/distributed.hpp"
+#include "TensorView/mapped_file.hpp"
+#include "TensorView/npy.hpp"
+#include "TensorView/stream.hpp"
+#include "TensorView/chunked.hpp"
+#include "TensorView/fixed_linalg.hpp"
+#include "TensorView/contract.hpp"
 
 #endif
@@ -4,6 +4,13 @@
 #include "tensorview_config.hpp"
 #include "errors.hpp"
 #include "span.hpp"
+#include "StridedShape.hpp"
+#include "DynamicTensorShape.hpp"
+#include "StridedIterator.hpp"
+#include "ContiguousIterator.hpp"
+#include "multi_index.hpp"
+#include "layout.hpp"
+#include "profile.hpp"
 
 namespace tensor
 {
@@ -13,10 +20,53 @@ namespace tensor
 
 namespace tensor::details
 {
+  /// @brief tag base class of lazily evaluated elementwise expressions.
+  struct expression_base
+  {
+  };
+
+  template <typename T>
+  inline constexpr bool is_expression_v = std::is_base_of_v<expression_base, std::decay_t<T>>;
+
+  // selects the iterator of a tensor from its shape. Contiguous shapes are
+  // iterated with a pointer, shapes with non-trivial multidimensional strides
+  // use the odometer iterator.
+  template <typename Shape, typename ViewType, typename LinearIterator, bool Contiguous = Shape::is_contiguous()>
+  struct select_iterator
+  {
+    using type = LinearIterator;
+  };
+
+  template <typename Shape, typename ViewType, typename LinearIterator>
+  struct select_iterator<Shape, ViewType, LinearIterator, true>
+  {
+    using type = ContiguousIterator<typename ViewType::value_type>;
+  };
+
+  template <size_t Rank, typename ViewType, typename LinearIterator>
+  struct select_iterator<StridedShape<Rank>, ViewType, LinearIterator, false>
+  {
+    using type = StridedIterator<ViewType, Rank>;
+  };
+
+  template <size_t Rank, typename Layout, typename ViewType, typename LinearIterator>
+  struct select_iterator<DynamicTensorShape<Rank, Layout>, ViewType, LinearIterator, false>
+  {
+    using type = StridedIterator<ViewType, Rank>;
+  };
+
+  template <typename ViewType, typename LinearIterator>
+  struct select_iterator<StridedShape<1>, ViewType, LinearIterator, false>
+  {
+    using type = LinearIterator;
+  };
+
   template <typename Shape, typename Container>
   class BaseTensor
   {
   public:
+    using shape_type = Shape;
+    using container_type = Container;
     using value_type = typename Container::value_type;
     using reference = typename Container::reference;
     using const_reference = typename Container::const_reference;
@@ -33,56 +83,34 @@ namespace tensor::details
       using pointer = value_type *;
       using reference = value_type &;
 
-      // sentinel
-      TENSOR_FUNC Iterator()
-        : initialized(false), _pos(0) {}
+      TENSOR_FUNC Iterator() : _pos(0) {}
 
-      TENSOR_FUNC Iterator(Shape shape_, ViewType &&view_, index_t pos)
-          : initialized(true), _pos(pos), _shape(shape_), _view(view_) {}
+      TENSOR_FUNC Iterator(Shape shape_, ViewType view_, index_t pos)
+          : _pos(pos), _shape(shape_), _view(view_) {}
 
       TENSOR_FUNC reference operator*()
       {
-#ifdef TENSOR_DEBUG
-        if (!initialized)
-          tensor_bad_memory_access();
-#endif
-        return _view[_shape[_pos]];
+        return _view[_shape.linear_offset(_pos)];
       }
 
       TENSOR_FUNC pointer operator->()
       {
-#ifdef TENSOR_DEBUG
-        if (!initialized)
-          tensor_bad_memory_access();
-#endif
-        return &_view[_shape[_pos]];
+        return &_view[_shape.linear_offset(_pos)];
       }
 
       TENSOR_FUNC reference operator[](difference_type n)
       {
-#ifdef TENSOR_DEBUG
-        if (!initialized)
-          tensor_bad_memory_access();
-#endif
-        return _view[_shape[_pos + n]];
+        return _view[_shape.linear_offset(_pos + n)];
       }
 
       TENSOR_FUNC Iterator &operator++()
       {
-#ifdef TENSOR_DEBUG
-        if (!initialized)
-          tensor_bad_memory_access();
-#endif
         ++_pos;
         return *this;
       }
 
       TENSOR_FUNC Iterator operator++(int)
       {
-#ifdef TENSOR_DEBUG
-        if (!initialized)
-          tensor_bad_memory_access();
-#endif
         Iterator tmp = *this;
         ++_pos;
         return tmp;
@@ -90,20 +118,12 @@ namespace tensor::details
 
       TENSOR_FUNC Iterator &operator--()
       {
-#ifdef TENSOR_DEBUG
-        if (!initialized)
-          tensor_bad_memory_access();
-#endif
         --_pos;
         return *this;
       }
 
       TENSOR_FUNC Iterator operator--(int)
       {
-#ifdef TENSOR_DEBUG
-        if (!initialized)
-          tensor_bad_memory_access();
-#endif
         Iterator tmp = *this;
         --_pos;
         return tmp;
@@ -111,97 +131,76 @@ namespace tensor::details
 
       TENSOR_FUNC Iterator operator+(difference_type n) const
       {
-#ifdef TENSOR_DEBUG
-        if (!initialized)
-          tensor_bad_memory_access();
-#endif
         return Iterator(_shape, _view, _pos + n);
       }
 
       TENSOR_FUNC Iterator operator-(difference_type n) const
       {
-#ifdef TENSOR_DEBUG
-        if (!initialized)
-          tensor_bad_memory_access();
-#endif
         return Iterator(_shape, _view, _pos - n);
       }
 
       TENSOR_FUNC Iterator &operator+=(difference_type n)
       {
-#ifdef TENSOR_DEBUG
-        if (!initialized)
-          tensor_bad_memory_access();
-#endif
         _pos += n;
         return *this;
       }
 
       TENSOR_FUNC Iterator &operator-=(difference_type n)
       {
-#ifdef TENSOR_DEBUG
-        if (!initialized)
-          tensor_bad_memory_access();
-#endif
         _pos -= n;
         return *this;
       }
 
       TENSOR_FUNC difference_type operator-(const Iterator &other) const
       {
-#ifdef TENSOR_DEBUG
-        if (!initialized || !other.initialized)
-          tensor_bad_memory_access();
-#endif
-        return _pos - other._pos;
+        return (difference_type)_pos - (difference_type)other._pos;
       }
 
       TENSOR_FUNC bool operator==(const Iterator &other) const
       {
-        return initialized && other.initialized && (_pos == other._pos);
+        return _pos == other._pos;
       }
 
       TENSOR_FUNC bool operator!=(const Iterator &other) const
       {
-        return (not initialized) or (not other.initialized) or (_pos != other._pos);
+        return _pos != other._pos;
       }
 
       TENSOR_FUNC bool operator<(const Iterator &other) const
       {
-        return (!initialized || (other.initialized && _pos < other._pos));
+        return _pos < other._pos;
       }
 
       TENSOR_FUNC bool operator>(const Iterator &other) const
       {
-        return !other.initialized || (initialized && _pos > other._pos);
+        return _pos > other._pos;
       }
 
       TENSOR_FUNC bool operator<=(const Iterator &other) const
       {
-        return (!initialized || (other.initialized && _pos <= other._pos));
+        return _pos <= other._pos;
       }
 
       TENSOR_FUNC bool operator>=(const Iterator &other) const
       {
-        return !other.initialized || (initialized && _pos >= other._pos);
+        return _pos >= other._pos;
       }
 
     private:
-      bool initialized;
       index_t _pos;
       Shape _shape;
       ViewType _view;
     };
 
-    using iterator = Iterator<decltype(make_view(std::declval<Container &>()))>;
-    using const_iterator = Iterator<decltype(make_view(std::declval<const Container &>()))>;
+    using iterator = typename select_iterator<Shape, decltype(make_view(std::declval<Container &>())), Iterator<decltype(make_view(std::declval<Container &>()))>>::type;
+    using const_iterator = typename select_iterator<Shape, decltype(make_view(std::declval<const Container &>())), Iterator<decltype(make_view(std::declval<const Container &>()))>>::type;
     using reverse_iterator = std::reverse_iterator<iterator>;
     using const_reverse_iterator = std::reverse_iterator<const_iterator>;
 
     BaseTensor() = default;
     ~BaseTensor() = default;
 
-    explicit TENSOR_FUNC BaseTensor(Shape shape_, Container container_) : _shape(shape_), container(container_) {}
+    explicit TENSOR_FUNC BaseTensor(Shape shape_, Container container_) : _shape(shape_), container(std::move(container_)) {}
 
     /// @brief shallow copy.
     BaseTensor(const BaseTensor &) = default;
@@ -211,6 +210,47 @@ namespace tensor::details
     BaseTensor(BaseTensor &&) = default;
     BaseTensor &operator=(BaseTensor &&) = default;
 
+    /**
+     * @brief evaluates an elementwise expression into the tensor.
+     *
+     * @details The expression is evaluated in a single pass without
+     * allocating temporaries. When the tensor and every operand of the
+     * expression are contiguous with the same layout, the elements are
+     * visited by linear index, otherwise by multi-index.
+     *
+     * @param expr expression, e.g. `a * x + b * y`, with the same shape as
+     * the tensor.
+     */
+    template <typename Expr, typename = std::enable_if_t<is_expression_v<Expr>>>
+    TENSOR_FUNC BaseTensor &operator=(const Expr &expr)
+    {
+      static_assert(Expr::order() == Shape::order(), "expression has the wrong number of dimensions.");
+#ifdef TENSOR_CHECK_BOUNDS
+      for (index_t d = 0; d < Shape::order(); ++d)
+        if (expr.shape(d) != _shape.shape(d))
+          tensor_shape_mismatch();
+#endif
+
+      const index_t n = size();
+      if constexpr (Shape::is_contiguous() && Expr::is_contiguous() && same_layout_v<typename Shape::layout_type, typename Expr::layout_type>)
+      {
+        auto *out = container.data();
+        for (index_t i = 0; i < n; ++i)
+          out[i] = expr[i];
+      }
+      else
+      {
+        std::array<index_t, Shape::order()> idx{};
+        for (index_t i = 0; i < n; ++i)
+        {
+          container[apply_index(_shape, idx)] = expr(idx);
+          next_index(idx, _shape);
+        }
+      }
+
+      return *this;
+    }
+
     /// @brief returns the order of the tensor, i.e. the number of dimensions
     /// of the tensor.
     static constexpr index_t order()
@@ -281,37 +321,55 @@ namespace tensor::details
     /// @brief linear index access.
     TENSOR_FUNC reference operator[](index_t index)
     {
+      TENSOR_PROFILE_ACCESS(linear, container.data(), _shape, sizeof(value_type));
       return container[_shape[index]];
     }
 
     /// @brief linear index access.
     TENSOR_FUNC const_reference operator[](index_t index) const
     {
+      TENSOR_PROFILE_ACCESS(linear, container.data(), _shape, sizeof(value_type));
       return container[_shape[index]];
     }
 
     /// @brief returns pointer to start of tensor.
     TENSOR_FUNC iterator begin()
     {
-      return iterator(_shape, make_view<Container>(container), 0);
+      check_range();
+      if constexpr (Shape::is_contiguous())
+        return iterator(container.data());
+      else
+        return iterator(_shape, make_view<Container>(container), 0);
     }
 
     /// @brief returns pointer to start of tensor.
     TENSOR_FUNC const_iterator begin() const
     {
-      return const_iterator(_shape, make_view<const Container>(container), 0);
+      check_range();
+      if constexpr (Shape::is_contiguous())
+        return const_iterator(container.data());
+      else
+        return const_iterator(_shape, make_view<const Container>(container), 0);
     }
 
     /// @brief returns pointer to the element following the last element of tensor.
     TENSOR_FUNC iterator end()
     {
-      return iterator(_shape, make_view<Container>(container), size());
+      check_range();
+      if constexpr (Shape::is_contiguous())
+        return iterator(container.data() + size());
+      else
+        return iterator(_shape, make_view<Container>(container), size());
     }
 
     /// @brief returns pointer to the element following the last element of tensor.
     TENSOR_FUNC const_iterator end() const
     {
-      return const_iterator(_shape, make_view<const Container>(container), size());
+      check_range();
+      if constexpr (Shape::is_contiguous())
+        return const_iterator(container.data() + size());
+      else
+        return const_iterator(_shape, make_view<const Container>(container), size());
     }
 
     /// @brief returns reverse iterator to the end of the tensor.
@@ -350,39 +408,68 @@ namespace tensor::details
       return _shape.shape(d);
     }
 
+    /// @brief returns the distance (in elements) between consecutive entries
+    /// of the tensor along dimension d.
+    TENSOR_FUNC stride_t stride(index_t d) const
+    {
+      return _shape.stride(d);
+    }
+
+    /// @brief returns the shape object of the tensor.
+    TENSOR_FUNC const Shape &shape() const
+    {
+      return _shape;
+    }
+
   protected:
     Shape _shape;
     Container container;
 
+    // iterators do not check their accesses, so the range they cover is
+    // validated once when they are created.
+    TENSOR_FUNC void check_range() const
+    {
+#ifdef TENSOR_CHECK_BOUNDS
+      if (size() > 0 && container.data() == nullptr)
+        tensor_bad_memory_access();
+#endif
+    }
+
     TENSOR_FUNC reference subview(index_t index)
     {
+      TENSOR_PROFILE_ACCESS(element, container.data(), _shape, sizeof(value_type));
       return container[index];
     }
 
     TENSOR_FUNC const_reference subview(index_t index) const
     {
+      TENSOR_PROFILE_ACCESS(element, container.data(), _shape, sizeof(value_type));
       return container[index];
     }
 
     template <size_t N>
     TENSOR_FUNC auto subview(const std::array<span, N> &spans)
     {
+      TENSOR_PROFILE_ACCESS(subview, container.data(), _shape, 0);
       return SubView<value_type, N>(make_view(container), spans);
     }
 
     template <size_t N>
     TENSOR_FUNC auto subview(const std::array<span, N> &spans) const
     {
+      TENSOR_PROFILE_ACCESS(subview, container.data(), _shape, 0);
       return SubView<const value_type, N>(make_view(container), spans);
     }
 
     TENSOR_FUNC auto subview(const span &s)
     {
+      TENSOR_PROFILE_ACCESS(subview, container.data(), _shape, 0);
       return SubView<value_type, 1>(make_view(container), s);
     }
 
     TENSOR_FUNC auto subview(const span &s) const
     {
+      TENSOR_PROFILE_ACCESS(subview, container.data(), _shape, 0);
       return SubView<const value_type, 1>(make_view(container), s);
     }
   };
@@ -0,0 +1,150 @@
+#ifndef __TENSOR_VIEW_CONTIGUOUS_ITERATOR_HPP__
+#define __TENSOR_VIEW_CONTIGUOUS_ITERATOR_HPP__
+
+#include "tensorview_config.hpp"
+#include "profile.hpp"
+
+namespace tensor::details
+{
+  /// @brief iterator over tensors whose elements are stored contiguously.
+  ///
+  /// @details The iterator is a thin wrapper around a pointer so that loops
+  /// and standard algorithms over the iterator compile to the same code as
+  /// loops over the raw array. In C++20 the iterator models
+  /// `std::contiguous_iterator`.
+  ///
+  /// @tparam T the (possibly const qualified) type of the elements
+  template <typename T>
+  class ContiguousIterator
+  {
+  public:
+#if __cplusplus >= 202002L
+    using iterator_concept = std::contiguous_iterator_tag;
+#endif
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = std::remove_cv_t<T>;
+    using element_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = T *;
+    using reference = T &;
+
+    TENSOR_FUNC ContiguousIterator() : ptr{nullptr} {}
+
+    TENSOR_FUNC explicit ContiguousIterator(pointer data) : ptr{data} {}
+
+    /// @brief a mutable iterator is convertible to a const iterator.
+    template <typename U, typename = std::enable_if_t<std::is_same_v<const U, T> && !std::is_const_v<U>>>
+    TENSOR_FUNC ContiguousIterator(const ContiguousIterator<U> &other) : ptr{other.operator->()} {}
+
+    TENSOR_FUNC reference operator*() const
+    {
+      TENSOR_PROFILE_ITERATOR(sizeof(T));
+      return *ptr;
+    }
+
+    TENSOR_FUNC pointer operator->() const
+    {
+      return ptr;
+    }
+
+    TENSOR_FUNC reference operator[](difference_type n) const
+    {
+      TENSOR_PROFILE_ITERATOR(sizeof(T));
+      return ptr[n];
+    }
+
+    TENSOR_FUNC ContiguousIterator &operator++()
+    {
+      ++ptr;
+      return *this;
+    }
+
+    TENSOR_FUNC ContiguousIterator operator++(int)
+    {
+      ContiguousIterator tmp = *this;
+      ++ptr;
+      return tmp;
+    }
+
+    TENSOR_FUNC ContiguousIterator &operator--()
+    {
+      --ptr;
+      return *this;
+    }
+
+    TENSOR_FUNC ContiguousIterator operator--(int)
+    {
+      ContiguousIterator tmp = *this;
+      --ptr;
+      return tmp;
+    }
+
+    TENSOR_FUNC ContiguousIterator operator+(difference_type n) const
+    {
+      return ContiguousIterator(ptr + n);
+    }
+
+    TENSOR_FUNC friend ContiguousIterator operator+(difference_type n, const ContiguousIterator &it)
+    {
+      return ContiguousIterator(it.ptr + n);
+    }
+
+    TENSOR_FUNC ContiguousIterator operator-(difference_type n) const
+    {
+      return ContiguousIterator(ptr - n);
+    }
+
+    TENSOR_FUNC ContiguousIterator &operator+=(difference_type n)
+    {
+      ptr += n;
+      return *this;
+    }
+
+    TENSOR_FUNC ContiguousIterator &operator-=(difference_type n)
+    {
+      ptr -= n;
+      return *this;
+    }
+
+    TENSOR_FUNC difference_type operator-(const ContiguousIterator &other) const
+    {
+      return ptr - other.ptr;
+    }
+
+    TENSOR_FUNC bool operator==(const ContiguousIterator &other) const
+    {
+      return ptr == other.ptr;
+    }
+
+    TENSOR_FUNC bool operator!=(const ContiguousIterator &other) const
+    {
+      return ptr != other.ptr;
+    }
+
+    TENSOR_FUNC bool operator<(const ContiguousIterator &other) const
+    {
+      return ptr < other.ptr;
+    }
+
+    TENSOR_FUNC bool operator>(const ContiguousIterator &other) const
+    {
+      return ptr > other.ptr;
+    }
+
+    TENSOR_FUNC bool operator<=(const ContiguousIterator &other) const
+    {
+      return ptr <= other.ptr;
+    }
+
+    TENSOR_FUNC bool operator>=(const ContiguousIterator &other) const
+    {
+      return ptr >= other.ptr;
+    }
+
+  private:
+    pointer ptr;
+  };
+
+} // namespace tensor::details
+
+#endif
@@ -0,0 +1,421 @@
+#ifndef __TENSOR_VIEW_DEVICE_TENSOR_HPP__
+#define __TENSOR_VIEW_DEVICE_TENSOR_HPP__
+
+#include "tensorview_config.hpp"
+
+#ifdef TENSOR_USE_CUDA
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <utility>
+
+#include <cuda_runtime.h>
+
+#include "errors.hpp"
+#include "layout.hpp"
+#include "DynamicTensorShape.hpp"
+#include "DynamicTensorView.hpp"
+#include "Tensor.hpp"
+#include "expressions.hpp"
+
+namespace tensor
+{
+  /// @brief throws an exception with the description of a failed CUDA runtime call.
+  inline void tensor_cuda_error(cudaError_t err)
+  {
+    throw std::runtime_error(std::string("TensorView: CUDA error: ") + cudaGetErrorString(err));
+  }
+
+  namespace details
+  {
+    inline void cuda_check(cudaError_t err)
+    {
+      if (err != cudaSuccess)
+        tensor_cuda_error(err);
+    }
+
+    // keeps the memory freed by cudaFreeAsync in the memory pool of the
+    // current device instead of returning it to the driver at every
+    // synchronization, so that repeated allocations of the same sizes are
+    // served from the pool.
+    inline void configure_device_pool()
+    {
+      thread_local int configured_device = -1;
+      int device;
+      cuda_check(cudaGetDevice(&device));
+      if (device == configured_device)
+        return;
+
+      cudaMemPool_t pool;
+      cuda_check(cudaDeviceGetDefaultMemPool(&pool, device));
+      uint64_t threshold = UINT64_MAX;
+      cuda_check(cudaMemPoolSetAttribute(pool, cudaMemPoolAttrReleaseThreshold, &threshold));
+      configured_device = device;
+    }
+
+    /**
+     * @brief page-locked host buffer used to stage transfers of pageable
+     * host memory, one per host thread.
+     *
+     * @details Copies from pageable memory with `cudaMemcpyAsync` are
+     * synchronous, so `copy_async` copies pageable tensors through this
+     * buffer instead. An event recorded after each transfer guards the
+     * buffer against reuse while a transfer is pending.
+     */
+    class staging_buffer
+    {
+    public:
+      staging_buffer() = default;
+
+      ~staging_buffer()
+      {
+        if (event)
+        {
+          cudaEventSynchronize(event);
+          cudaEventDestroy(event);
+        }
+        if (data)
+          cudaFreeHost(data);
+      }
+
+      staging_buffer(const staging_buffer &) = delete;
+      staging_buffer &operator=(const staging_buffer &) = delete;
+
+      /// @brief waits until the previous transfer is complete and returns a
+      /// buffer of at least `bytes` bytes.
+      void *acquire(size_t bytes)
+      {
+        if (!event)
+          cuda_check(cudaEventCreateWithFlags(&event, cudaEventDisableTiming));
+        cuda_check(cudaEventSynchronize(event));
+
+        if (bytes > capacity)
+        {
+          if (data)
+            cuda_check(cudaFreeHost(data));
+          data = nullptr;
+          cuda_check(cudaMallocHost(&data, bytes));
+          capacity = bytes;
+        }
+        return data;
+      }
+
+      /// @brief marks the buffer as in use until the work queued on stream so far is complete.
+      void release(cudaStream_t stream)
+      {
+        cuda_check(cudaEventRecord(event, stream));
+      }
+
+      static staging_buffer &thread_local_buffer()
+      {
+        thread_local staging_buffer buffer;
+        return buffer;
+      }
+
+    private:
+      void *data = nullptr;
+      size_t capacity = 0;
+      cudaEvent_t event = nullptr;
+    };
+
+    // arguments of the host callback which finishes a staged device to host copy.
+    struct staged_copy
+    {
+      void *dst;
+      const void *src;
+      size_t bytes;
+
+      static void CUDART_CB run(void *arg)
+      {
+        staged_copy *c = static_cast<staged_copy *>(arg);
+        std::memcpy(c->dst, c->src, c->bytes);
+        delete c;
+      }
+    };
+
+    // true if ptr is page-locked host memory (or managed memory), which can
+    // be copied to and from the device asynchronously.
+    inline bool is_pinned(const void *ptr)
+    {
+      cudaPointerAttributes attr;
+      if (cudaPointerGetAttributes(&attr, ptr) != cudaSuccess)
+      {
+        cudaGetLastError(); // clear the error of an unregistered pointer
+        return false;
+      }
+      return attr.type == cudaMemoryTypeHost || attr.type == cudaMemoryTypeManaged;
+    }
+  } // namespace details
+
+  /**
+   * @brief allocator of page-locked (pinned) host memory. A `Tensor` which
+   * uses it, e.g. `PinnedTensor`, can be copied to and from the device
+   * asynchronously without staging.
+   */
+  template <typename T>
+  class pinned_allocator
+  {
+  public:
+    using value_type = T;
+    using is_always_equal = std::true_type;
+
+    pinned_allocator() noexcept = default;
+
+    template <typename U>
+    pinned_allocator(const pinned_allocator<U> &) noexcept {}
+
+    [[nodiscard]] T *allocate(size_t n)
+    {
+      void *ptr = nullptr;
+      details::cuda_check(cudaMallocHost(&ptr, n * sizeof(T)));
+      return static_cast<T *>(ptr);
+    }
+
+    void deallocate(T *ptr, size_t) noexcept
+    {
+      cudaFreeHost(ptr);
+    }
+
+    template <typename U>
+    bool operator==(const pinned_allocator<U> &) const noexcept
+    {
+      return true;
+    }
+
+    template <typename U>
+    bool operator!=(const pinned_allocator<U> &) const noexcept
+    {
+      return false;
+    }
+  };
+
+  /// @brief host `Tensor` in page-locked memory.
+  template <typename scalar, size_t Rank, typename Layout = layout::left>
+  using PinnedTensor = Tensor<scalar, Rank, pinned_allocator<scalar>, Layout>;
+
+  /**
+   * @brief tensor which owns an array in device memory.
+   *
+   * @details The memory is allocated with the stream-ordered
+   * `cudaMallocAsync` from the memory pool of the current device, and is
+   * freed with `cudaFreeAsync` on the same stream when the tensor is
+   * destroyed, so allocating temporaries does not synchronize the device.
+   * The elements cannot be accessed on the host; pass `view()` to a kernel
+   * instead, and use `copy_async` to transfer data.
+   *
+   * @tparam scalar the type of the elements
+   * @tparam Rank the tensor dimension
+   * @tparam Layout `layout::left` (column-major) or `layout::right` (row-major)
+   */
+  template <typename scalar, size_t Rank, typename Layout = layout::left>
+  class DeviceTensor
+  {
+  public:
+    using value_type = scalar;
+    using shape_type = details::DynamicTensorShape<Rank, Layout>;
+    using view_type = TensorView<scalar, Rank, Layout>;
+    using const_view_type = TensorView<const scalar, Rank, Layout>;
+
+    DeviceTensor() = default;
+
+    /// @brief allocates an uninitialized tensor, ordered on the default stream.
+    template <TENSOR_INT_LIKE... Sizes>
+    explicit DeviceTensor(Sizes... shape) : DeviceTensor(cudaStream_t(0), shape...) {}
+
+    /// @brief allocates an uninitialized tensor, ordered on stream.
+    template <TENSOR_INT_LIKE... Sizes>
+    explicit DeviceTensor(cudaStream_t stream, Sizes... shape) : _shape(shape...), _stream(stream)
+    {
+      details::configure_device_pool();
+      const size_t bytes = _shape.required_size() * sizeof(scalar);
+      if (bytes > 0)
+        details::cuda_check(cudaMallocAsync(reinterpret_cast<void **>(&ptr), bytes, _stream));
+    }
+
+    ~DeviceTensor()
+    {
+      if (ptr)
+        cudaFreeAsync(ptr, _stream);
+    }
+
+    DeviceTensor(const DeviceTensor &) = delete;
+    DeviceTensor &operator=(const DeviceTensor &) = delete;
+
+    DeviceTensor(DeviceTensor &&other) noexcept : _shape(other._shape), _stream(other._stream), ptr(std::exchange(other.ptr, nullptr)) {}
+
+    DeviceTensor &operator=(DeviceTensor &&other) noexcept
+    {
+      if (this != &other)
+      {
+        if (ptr)
+          cudaFreeAsync(ptr, _stream);
+        _shape = other._shape;
+        _stream = other._stream;
+        ptr = std::exchange(other.ptr, nullptr);
+      }
+      return *this;
+    }
+
+    /// @brief returns a view of the device memory, which can be passed by
+    /// value to a `__global__` function.
+    view_type view()
+    {
+      return make_view<view_type>(std::make_index_sequence<Rank>{});
+    }
+
+    /// @brief returns a read only view of the device memory.
+    const_view_type view() const
+    {
+      return make_view<const_view_type>(std::make_index_sequence<Rank>{});
+    }
+
+    /// @brief returns the pointer to the device memory.
+    scalar *data()
+    {
+      return ptr;
+    }
+
+    /// @brief returns the pointer to the device memory.
+    const scalar *data() const
+    {
+      return ptr;
+    }
+
+    /// @brief returns the stream on which the memory was allocated and will be freed.
+    cudaStream_t stream() const
+    {
+      return _stream;
+    }
+
+    /// @brief returns the shape object of the tensor.
+    const shape_type &shape() const
+    {
+      return _shape;
+    }
+
+    /// @brief returns the size of the tensor along dimension d.
+    index_t shape(index_t d) const
+    {
+      return _shape.shape(d);
+    }
+
+    /// @brief returns the total number of elements in the tensor.
+    index_t size() const
+    {
+      return _shape.size();
+    }
+
+    static constexpr size_t order()
+    {
+      return Rank;
+    }
+
+  private:
+    shape_type _shape;
+    cudaStream_t _stream = 0;
+    scalar *ptr = nullptr;
+
+    template <typename View, size_t... I>
+    View make_view(std::index_sequence<I...>) const
+    {
+      return View(ptr, _shape.shape(I)...);
+    }
+  };
+
+  namespace details
+  {
+    template <typename Host, typename Device>
+    inline size_t transfer_bytes(const Host &host, const Device &device)
+    {
+      using host_shape = typename Host::shape_type;
+      static_assert(host_shape::order() == Device::order(), "copy_async requires tensors with the same number of dimensions.");
+      static_assert(std::is_same_v<typename host_shape::layout_type, typename Device::shape_type::layout_type>, "copy_async requires tensors with the same layout, which excludes subviews.");
+      static_assert(std::is_same_v<std::remove_cv_t<typename Host::value_type>, typename Device::value_type>, "copy_async requires tensors with the same element type.");
+
+#ifdef TENSOR_CHECK_BOUNDS
+      for (index_t d = 0; d < Device::order(); ++d)
+        if (host.shape(d) != device.shape(d))
+          tensor_shape_mismatch();
+#endif
+
+      return device.shape().required_size() * sizeof(typename Device::value_type);
+    }
+  } // namespace details
+
+  /**
+   * @brief queues a copy of a host tensor to the device on stream.
+   *
+   * @details Pinned host memory (e.g. `PinnedTensor`) is transferred
+   * directly. Pageable memory is first copied into a page-locked staging
+   * buffer, after which the call returns and the transfer runs
+   * asynchronously; the host tensor may be modified as soon as the call
+   * returns.
+   *
+   * @param src `Tensor` or `TensorView` in host memory with the same shape
+   * and layout as dst.
+   * @param dst the destination on the device.
+   * @param stream the stream to order the transfer on.
+   */
+  template <typename Host, typename scalar, size_t Rank, typename Layout, typename = std::enable_if_t<details::is_tensor_v<Host>>>
+  inline void copy_async(const Host &src, DeviceTensor<scalar, Rank, Layout> &dst, cudaStream_t stream)
+  {
+    const size_t bytes = details::transfer_bytes(src, dst);
+    if (bytes == 0)
+      return;
+
+    if (details::is_pinned(src.data()))
+    {
+      details::cuda_check(cudaMemcpyAsync(dst.data(), src.data(), bytes, cudaMemcpyHostToDevice, stream));
+    }
+    else
+    {
+      auto &staging = details::staging_buffer::thread_local_buffer();
+      void *buf = staging.acquire(bytes);
+      std::memcpy(buf, src.data(), bytes);
+      details::cuda_check(cudaMemcpyAsync(dst.data(), buf, bytes, cudaMemcpyHostToDevice, stream));
+      staging.release(stream);
+    }
+  }
+
+  /**
+   * @brief queues a copy of a device tensor to the host on stream.
+   *
+   * @details The host tensor holds the result once the stream is
+   * synchronized. Pageable host memory is filled from the staging buffer by
+   * a host callback on the stream, so the call does not block.
+   */
+  template <typename Host, typename scalar, size_t Rank, typename Layout, typename = std::enable_if_t<details::is_tensor_v<Host>>>
+  inline void copy_async(const DeviceTensor<scalar, Rank, Layout> &src, Host &&dst, cudaStream_t stream)
+  {
+    const size_t bytes = details::transfer_bytes(dst, src);
+    if (bytes == 0)
+      return;
+
+    if (details::is_pinned(dst.data()))
+    {
+      details::cuda_check(cudaMemcpyAsync(dst.data(), src.data(), bytes, cudaMemcpyDeviceToHost, stream));
+    }
+    else
+    {
+      auto &staging = details::staging_buffer::thread_local_buffer();
+      void *buf = staging.acquire(bytes);
+      details::cuda_check(cudaMemcpyAsync(buf, src.data(), bytes, cudaMemcpyDeviceToHost, stream));
+      details::cuda_check(cudaLaunchHostFunc(stream, details::staged_copy::run, new details::staged_copy{dst.data(), buf, bytes}));
+      staging.release(stream);
+    }
+  }
+
+  /// @brief queues a copy between two device tensors on stream.
+  template <typename scalar, size_t Rank, typename Layout>
+  inline void copy_async(const DeviceTensor<scalar, Rank, Layout> &src, DeviceTensor<scalar, Rank, Layout> &dst, cudaStream_t stream)
+  {
+    const size_t bytes = details::transfer_bytes(src, dst);
+    if (bytes > 0)
+      details::cuda_check(cudaMemcpyAsync(dst.data(), src.data(), bytes, cudaMemcpyDeviceToDevice, stream));
+  }
+} // namespace tensor
+
+#endif // TENSOR_USE_CUDA
+
+#endif
@@ -4,31 +4,53 @@
 #include "tensorview_config.hpp"
 #include "errors.hpp"
 #include "span.hpp"
+#include "layout.hpp"
 
 namespace tensor::details
 {
-  template <size_t Rank>
+  /// @brief shape of a tensor with dimensions known at run time.
+  ///
+  /// @details The strides of every dimension are computed when the shape is
+  /// constructed (or reshaped), so that an offset is the dot product of the
+  /// indices with the strides rather than a chain of dependent multiply-adds.
+  ///
+  /// @tparam Rank the order of the tensor
+  /// @tparam Layout `layout::left` (first index fastest), `layout::right`
+  /// (last index fastest), or their padded variants `layout::left_padded<P>`
+  /// and `layout::right_padded<P>` where the stride of the second fastest
+  /// dimension is rounded up to a multiple of P.
+  template <size_t Rank, typename Layout = layout::left>
   class DynamicTensorShape
   {
   public:
+    using layout_type = Layout;
+
     template <TENSOR_INT_LIKE... Shape>
     TENSOR_FUNC DynamicTensorShape(Shape... shape_) : len((1 * ... * shape_)), _shape{(index_t)shape_...}
     {
       static_assert(Rank > 0, "DynamicTensorShape must have a non-zero rank");
       static_assert(sizeof...(shape_) == Rank, "wrong number of dimensions specified for DynamicTensorShape.");
-#ifdef TENSOR_DEBUG
+#ifdef TENSOR_CHECK_BOUNDS
       if (((shape_ <= 0) || ... || false))
         tensor_bad_shape();
 #endif
+      compute_strides();
     }
 
-    TENSOR_FUNC DynamicTensorShape() : len{0}, _shape{} {}
+    TENSOR_FUNC DynamicTensorShape() : len{0}, storage{0}, _shape{}, strides{} {}
 
     static constexpr index_t order()
     {
       return Rank;
     }
 
+    /// @brief the elements are stored contiguously in memory unless the
+    /// layout is padded.
+    static constexpr bool is_contiguous()
+    {
+      return !is_padded_layout_v<Layout> || Rank == 1;
+    }
+
     template <typename... Indices>
     TENSOR_FUNC auto operator()(Indices... indices) const
     {
@@ -36,17 +58,41 @@ namespace tensor::details
       return compute_index(std::forward<Indices>(indices)...);
     }
 
+    /// @brief returns the offset of the element with linear index `index`.
+    /// Contiguous tensors are linearized in memory order, padded tensors in
+    /// first index fastest order.
     TENSOR_FUNC index_t operator[](index_t index) const
     {
-#ifdef TENSOR_DEBUG
+#ifdef TENSOR_CHECK_BOUNDS
       if (index < 0 || index >= len)
+        tensor_linear_index_out_of_range(index, len);
+#endif
+      return linear_offset(index);
+    }
+
+    /// @brief returns the offset of the element with linear index `index`
+    /// without bounds checking.
+    TENSOR_FUNC index_t linear_offset(index_t index) const
+    {
+      if constexpr (is_contiguous())
+        return index;
+      else
       {
-        char msg[100];
-        snprintf(msg, sizeof(msg), "linear index = %ld is out of range for tensor with size %ld.", index, len);
-        tensor_out_of_range(msg);
+        index_t offset = 0;
+        for (index_t d = 0; d < Rank; ++d)
+        {
+          offset += strides[d] * (index % _shape[d]);
+          index /= _shape[d];
+        }
+        return offset;
       }
-#endif
-      return index;
+    }
+
+    /// @brief returns the offset of the multi-index idx without bounds
+    /// checking. Used by bulk operations whose ranges are validated on entry.
+    TENSOR_FUNC index_t offset(const std::array<index_t, Rank> &idx) const
+    {
+      return offset(idx, std::make_index_sequence<Rank>{});
     }
 
     TENSOR_FUNC index_t size() const
@@ -54,68 +100,113 @@ namespace tensor::details
       return len;
     }
 
+    /// @brief returns the number of elements of the array holding the
+    /// tensor, including padding.
+    TENSOR_FUNC index_t required_size() const
+    {
+      return storage;
+    }
+
     TENSOR_FUNC index_t shape(index_t d) const
     {
       return _shape[d];
     }
 
+    /// @brief returns the distance (in elements) between consecutive entries along dimension d.
+    TENSOR_FUNC stride_t stride(index_t d) const
+    {
+      return (stride_t)strides[d];
+    }
+
     template <TENSOR_INT_LIKE... Sizes>
     TENSOR_FUNC void reshape(Sizes... new_shape)
     {
       static_assert(sizeof...(Sizes) == Rank, "wrong number of dimensions.");
-#ifdef TENSOR_DEBUG
+#ifdef TENSOR_CHECK_BOUNDS
       if (((new_shape <= 0) || ... || false))
         tensor_bad_shape();
 #endif
       _shape = {(index_t)new_shape...};
       len = (1 * ... * new_shape);
+      compute_strides();
     }
 
   private:
+    using traits = layout_traits<Layout>;
+
+    template <size_t... I>
+    TENSOR_FUNC index_t offset(const std::array<index_t, Rank> &idx, std::index_sequence<I...>) const
+    {
+      return (scaled<I>(idx[I]) + ...);
+    }
+
+    // the fastest dimension, which has unit stride.
+    static constexpr index_t fast_dim = traits::is_right ? Rank - 1 : 0;
+
     index_t len;
+    index_t storage;
     std::array<index_t, Rank> _shape;
+    std::array<index_t, Rank> strides;
 
-    template <index_t Dim = 0, typename... Indices>
-    TENSOR_FUNC auto compute_index(index_t index, Indices... indices) const
+    TENSOR_FUNC void compute_strides()
     {
-#ifdef TENSOR_DEBUG
-      if (index < 0 || index >= _shape[Dim])
+      index_t s = 1;
+      for (index_t k = 0; k < Rank; ++k)
       {
-        char msg[100];
-        snprintf(msg, sizeof(msg), "Index %ld is out of range for dimension %ld with size %ld.", index, Dim, _shape[Dim]);
-        tensor_out_of_range(msg);
+        const index_t d = traits::is_right ? Rank - 1 - k : k;
+        strides[d] = s;
+        if (d == fast_dim && Rank > 1)
+          s *= traits::padding * ((_shape[d] + traits::padding - 1) / traits::padding);
+        else
+          s *= _shape[d];
       }
-#endif
+      storage = s;
+    }
+
+    template <index_t Dim = 0, typename Index, typename... Indices>
+    TENSOR_FUNC auto compute_index(Index x, Indices... indices) const
+    {
       if constexpr (Dim + 1 < Rank)
-        return index + _shape[Dim] * compute_index<Dim + 1>(std::forward<Indices>(indices)...);
+        return scaled<Dim>(term<Dim>(x)) + compute_index<Dim + 1>(std::forward<Indices>(indices)...);
       else
-        return index;
+        return scaled<Dim>(term<Dim>(x));
     }
 
-    template <index_t Dim = 0, typename... Indices>
-    TENSOR_FUNC auto compute_index(span x, Indices... indices) const
+    // multiplies an index or span by the stride of dimension Dim. The unit
+    // stride of the fastest dimension is known at compile time.
+    template <index_t Dim, typename Index>
+    TENSOR_FUNC auto scaled(Index x) const
     {
-#ifdef TENSOR_DEBUG
+      if constexpr (Dim == fast_dim)
+        return x;
+      else
+        return strides[Dim] * x;
+    }
+
+    template <index_t Dim>
+    TENSOR_FUNC index_t term(index_t index) const
+    {
+#ifdef TENSOR_CHECK_BOUNDS
+      if (index < 0 || index >= _shape[Dim])
+        tensor_index_out_of_range(index, Dim, _shape[Dim]);
+#endif
+      return index;
+    }
+
+    template <index_t Dim>
+    TENSOR_FUNC span term(span x) const
+    {
+#ifdef TENSOR_CHECK_BOUNDS
       if (x.begin < 0 || x.end > _shape[Dim])
-      {
-        char msg[100];
-        snprintf(msg, sizeof(msg), "span( %ld, %ld ) is out of range for dimension %ld with size %ld.", x.begin, x.end, Dim, _shape[Dim]);
-        tensor_out_of_range(msg);
-      }
+        tensor_span_out_of_range(x.begin, x.end, Dim, _shape[Dim]);
 #endif
-      if constexpr (Dim + 1 < Rank)
-        return x + _shape[Dim] * compute_index<Dim + 1>(std::forward<Indices>(indices)...);
-      else
-        return x;
+      return x;
     }
 
-    template <index_t Dim = 0, typename... Indices>
-    TENSOR_FUNC auto compute_index(all, Indices... indices) const
+    template <index_t Dim>
+    TENSOR_FUNC span term(all) const
     {
-      if constexpr (Dim + 1 < Rank)
-        return span(0, _shape[Dim]) + _shape[Dim] * compute_index<Dim + 1>(std::forward<Indices>(indices)...);
-      else
-        return span(0, _shape[Dim]);
+      return span(0, _shape[Dim]);
     }
   };
 
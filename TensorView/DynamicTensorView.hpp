@@ -12,12 +12,13 @@ namespace tensor
   /// high dimensional indexing.
   /// @tparam scalar the type of array, e.g. double, int, etc.
   /// @tparam Rank the tensor dimension, e.g. 2 for a matrix
-  template <typename scalar, size_t Rank>
-  class TensorView : public details::BaseTensor<details::DynamicTensorShape<Rank>, details::ViewContainer<scalar>>
+  /// @tparam Layout `layout::left` (column-major) or `layout::right` (row-major)
+  template <typename scalar, size_t Rank, typename Layout = layout::left>
+  class TensorView : public details::BaseTensor<details::DynamicTensorShape<Rank, Layout>, details::ViewContainer<scalar>>
   {
   public:
-    using base_tensor = details::BaseTensor<details::DynamicTensorShape<Rank>, details::ViewContainer<scalar>>;
-    using shape_type = details::DynamicTensorShape<Rank>;
+    using base_tensor = details::BaseTensor<details::DynamicTensorShape<Rank, Layout>, details::ViewContainer<scalar>>;
+    using shape_type = details::DynamicTensorShape<Rank, Layout>;
     using container_type = details::ViewContainer<scalar>;
     using pointer = typename base_tensor::pointer;
     using const_pointer = typename base_tensor::const_pointer;
@@ -27,6 +28,8 @@ namespace tensor
 
     TENSOR_FUNC TensorView() : base_tensor(shape_type(), container_type(nullptr)) {}
 
+    using base_tensor::operator=;
+
     template <TENSOR_INT_LIKE... Sizes>
     TENSOR_FUNC TensorView &reshape(Sizes... new_shape)
     {
@@ -13,17 +13,22 @@ namespace tensor
   /// __device__ code and passed as arguments to __global__ kernel.
   ///
   /// @tparam scalar type of tensor elements
+  /// @tparam Layout `layout::left` (column-major) or `layout::right` (row-major)
   /// @tparam ...Shape shape of the tensor
-  template <typename scalar, size_t... Shape>
-  class FixedTensor : public details::BaseTensor<details::FixedTensorShape<Shape...>, std::array<scalar, (1 * ... * Shape)>>
+  template <typename scalar, typename Layout, size_t... Shape>
+  class BasicFixedTensor : public details::BaseTensor<details::BasicFixedTensorShape<Layout, Shape...>, std::array<scalar, (1 * ... * Shape)>>
   {
   public:
-    using base_tensor = details::BaseTensor<details::FixedTensorShape<Shape...>, std::array<scalar, (1 * ... * Shape)>>;
+    using base_tensor = details::BaseTensor<details::BasicFixedTensorShape<Layout, Shape...>, std::array<scalar, (1 * ... * Shape)>>;
+    using shape_type = details::BasicFixedTensorShape<Layout, Shape...>;
+    using container_type = std::array<scalar, (1 * ... * Shape)>;
     using pointer = typename base_tensor::pointer;
     using const_pointer = typename base_tensor::const_pointer;
 
-    TENSOR_FUNC FixedTensor()
-        : base_tensor(details::FixedTensorShape<Shape...>(), std::array<scalar, (1 * ... * Shape)>{scalar()}) {}
+    TENSOR_FUNC BasicFixedTensor()
+        : base_tensor(shape_type(), container_type{scalar()}) {}
+
+    using base_tensor::operator=;
 
     /// @brief implicit conversion to scalar*
     TENSOR_FUNC operator pointer()
@@ -50,6 +55,10 @@ namespace tensor
     }
   };
 
+  /// @brief column-major tensor with dimensions known at compile time.
+  template <typename scalar, size_t... Shape>
+  using FixedTensor = BasicFixedTensor<scalar, layout::left, Shape...>;
+
 } // namespace tensor
 
 #endif
@@ -4,40 +4,76 @@
 #include "tensorview_config.hpp"
 #include "errors.hpp"
 #include "span.hpp"
+#include "layout.hpp"
 
 namespace tensor::details
 {
-  template <size_t... Shape>
-  class FixedTensorShape
+  /// @brief shape of a contiguous tensor with dimensions known at compile time.
+  /// @tparam Layout `layout::left` (first index fastest) or `layout::right`
+  /// (last index fastest)
+  /// @tparam ...Shape the size of each dimension
+  template <typename Layout, size_t... Shape>
+  class BasicFixedTensorShape
   {
   public:
-    FixedTensorShape() = default;
+    using layout_type = Layout;
+
+    static_assert(std::is_same_v<Layout, layout::left> || std::is_same_v<Layout, layout::right>, "fixed size tensors are either column-major or row-major.");
+
+    BasicFixedTensorShape() = default;
 
     template <typename... Indices>
     TENSOR_FUNC auto operator()(Indices... indices) const
     {
       static_assert(sizeof...(Indices) == rank, "wrong number of indices.");
-      return compute_index<Shape...>(std::forward<Indices>(indices)...);
+      return compute_index(std::forward<Indices>(indices)...);
     }
 
     TENSOR_FUNC index_t operator[](index_t index) const
     {
-#ifdef TENSOR_DEBUG
+#ifdef TENSOR_CHECK_BOUNDS
       if (index < 0 || index >= len)
-      {
-        char msg[100];
-        snprintf(msg, sizeof(msg), "linear index = %ld is out of range for tensor with size %ld.", index, len);
-        tensor_out_of_range(msg);
-      }
+        tensor_linear_index_out_of_range(index, len);
 #endif
       return index;
     }
 
+    /// @brief returns the offset of the element with linear index `index`
+    /// without bounds checking.
+    static TENSOR_FUNC index_t linear_offset(index_t index)
+    {
+      return index;
+    }
+
+    /// @brief returns the offset of the multi-index idx without bounds
+    /// checking. Used by bulk operations whose ranges are validated on entry.
+    static TENSOR_FUNC index_t offset(const std::array<index_t, sizeof...(Shape)> &idx)
+    {
+      index_t offset = 0;
+      if constexpr (std::is_same_v<Layout, layout::right>)
+      {
+        for (index_t d = 0; d < rank; ++d)
+          offset = offset * extent(d) + idx[d];
+      }
+      else
+      {
+        for (index_t d = rank; d > 0; --d)
+          offset = offset * extent(d - 1) + idx[d - 1];
+      }
+      return offset;
+    }
+
     static constexpr index_t order()
     {
       return rank;
     }
 
+    /// @brief the elements are stored contiguously in memory.
+    static constexpr bool is_contiguous()
+    {
+      return true;
+    }
+
     static TENSOR_FUNC index_t size()
     {
       return len;
@@ -45,66 +81,100 @@ namespace tensor::details
 
     static TENSOR_FUNC index_t shape(index_t d)
     {
-#ifdef TENSOR_DEBUG
+#ifdef TENSOR_CHECK_BOUNDS
       if (d < 0 || d >= rank)
-      {
-        char msg[100];
-        snprintf(msg, sizeof(msg), "shape index = %ld is out of range for tensor of rank %ld.", d, rank);
-        tensor_out_of_range(msg);
-      }
+        tensor_dimension_out_of_range(d, rank);
 #endif
       constexpr index_t _shape[] = {Shape...};
       return _shape[d];
     }
 
+    /// @brief returns the distance (in elements) between consecutive entries along dimension d.
+    static TENSOR_FUNC stride_t stride(index_t d)
+    {
+      index_t s = 1;
+      if constexpr (std::is_same_v<Layout, layout::right>)
+      {
+        for (index_t k = d + 1; k < rank; ++k)
+          s *= extent(k);
+      }
+      else
+      {
+        for (index_t k = 0; k < d; ++k)
+          s *= extent(k);
+      }
+      return (stride_t)s;
+    }
+
   private:
     static constexpr index_t len = (1 * ... * Shape);
     static constexpr index_t rank = sizeof...(Shape);
 
-    template <index_t N, index_t... Ns, typename... Indices>
-    static TENSOR_FUNC auto compute_index(index_t index, Indices... indices)
+    static constexpr index_t extent(index_t d)
     {
-#ifdef TENSOR_DEBUG
-      if (index < 0 || index >= N)
-      {
-        char msg[100];
-        snprintf(msg, sizeof(msg), "Index %ld is out of range for dimension with size %ld.", index, N);
-        tensor_out_of_range(msg);
-      }
-#endif
-      if constexpr (sizeof...(Indices) == 0)
-        return index;
-      else
-        return index + N * compute_index<Ns...>(std::forward<Indices>(indices)...);
+      constexpr index_t _shape[] = {Shape...};
+      return _shape[d];
     }
 
-    template <index_t N, index_t... Ns, typename... Indices>
-    static TENSOR_FUNC auto compute_index(span x, Indices... indices)
+    template <index_t Dim = 0, typename Index, typename... Indices>
+    static TENSOR_FUNC auto compute_index(Index x, Indices... indices)
     {
-#ifdef TENSOR_DEBUG
-      if (x.begin < 0 || x.end > N)
+      if constexpr (std::is_same_v<Layout, layout::right>)
       {
-        char msg[100];
-        snprintf(msg, sizeof(msg), "span( %ld, %ld ) is out of range for dimension with size %ld.", x.begin, x.end, N);
-        tensor_out_of_range(msg);
+        if constexpr (sizeof...(Indices) == 0)
+          return term<0>(x);
+        else
+          return compute_index_right<1>(term<0>(x), std::forward<Indices>(indices)...);
       }
-#endif
-      if constexpr (sizeof...(Indices) == 0)
-        return x;
+      else if constexpr (sizeof...(Indices) == 0)
+        return term<Dim>(x);
       else
-        return x + N * compute_index<Ns...>(std::forward<Indices>(indices)...);
+        return term<Dim>(x) + extent(Dim) * compute_index<Dim + 1>(std::forward<Indices>(indices)...);
     }
 
-    template <index_t N, index_t... Ns, typename... Indices>
-    static TENSOR_FUNC auto compute_index(all, Indices... indices)
+    // row-major offset by Horner's rule from the first index:
+    // ((x0 * n1 + x1) * n2 + x2) ...
+    template <index_t Dim, typename Acc, typename Index, typename... Indices>
+    static TENSOR_FUNC auto compute_index_right(Acc acc, Index x, Indices... indices)
     {
+      auto next = extent(Dim) * acc + term<Dim>(x);
       if constexpr (sizeof...(Indices) == 0)
-        return span(0, N);
+        return next;
       else
-        return span(0, N) + N * compute_index<Ns...>(std::forward<Indices>(indices)...);
+        return compute_index_right<Dim + 1>(next, std::forward<Indices>(indices)...);
+    }
+
+    template <index_t Dim>
+    static TENSOR_FUNC index_t term(index_t index)
+    {
+#ifdef TENSOR_CHECK_BOUNDS
+      if (index < 0 || index >= extent(Dim))
+        tensor_index_out_of_range(index, Dim, extent(Dim));
+#endif
+      return index;
+    }
+
+    template <index_t Dim>
+    static TENSOR_FUNC span term(span x)
+    {
+#ifdef TENSOR_CHECK_BOUNDS
+      if (x.begin < 0 || x.end > extent(Dim))
+        tensor_span_out_of_range(x.begin, x.end, Dim, extent(Dim));
+#endif
+      return x;
+    }
+
+    template <index_t Dim>
+    static TENSOR_FUNC span term(all)
+    {
+      return span(0, extent(Dim));
     }
   };
 
+  /// @brief column-major shape with dimensions known at compile time.
+  template <size_t... Shape>
+  using FixedTensorShape = BasicFixedTensorShape<layout::left, Shape...>;
+
 } // namespace tensor
 
 #endif
@@ -10,18 +10,21 @@ namespace tensor
 {
   /// @brief high dimensional view for tensors with dimensions known at compile time.
   /// @tparam scalar type of tensor elements
+  /// @tparam Layout `layout::left` (column-major) or `layout::right` (row-major)
   /// @tparam ...Shape shape of the tensor
-  template <typename scalar, size_t... Shape>
-  class FixedTensorView : public details::BaseTensor<details::FixedTensorShape<Shape...>, details::ViewContainer<scalar>>
+  template <typename scalar, typename Layout, size_t... Shape>
+  class BasicFixedTensorView : public details::BaseTensor<details::BasicFixedTensorShape<Layout, Shape...>, details::ViewContainer<scalar>>
   {
   public:
-    using base_tensor = details::BaseTensor<details::FixedTensorShape<Shape...>, details::ViewContainer<scalar>>;
-    using shape_type = details::FixedTensorShape<Shape...>;
+    using base_tensor = details::BaseTensor<details::BasicFixedTensorShape<Layout, Shape...>, details::ViewContainer<scalar>>;
+    using shape_type = details::BasicFixedTensorShape<Layout, Shape...>;
     using container_type = details::ViewContainer<scalar>;
     using pointer = typename base_tensor::pointer;
     using const_pointer = typename base_tensor::const_pointer;
 
-    TENSOR_FUNC explicit FixedTensorView(scalar *data) : base_tensor(shape_type{}, container_type(data)) {}
+    TENSOR_FUNC explicit BasicFixedTensorView(scalar *data) : base_tensor(shape_type{}, container_type(data)) {}
+
+    using base_tensor::operator=;
 
     /// @brief implicit conversion to scalar*
     TENSOR_FUNC operator pointer()
@@ -47,6 +50,10 @@ namespace tensor
       return this->container.data();
     }
   };
+
+  /// @brief column-major view for tensors with dimensions known at compile time.
+  template <typename scalar, size_t... Shape>
+  using FixedTensorView = BasicFixedTensorView<scalar, layout::left, Shape...>;
 } // namespace tensor
 
 #endif
@@ -0,0 +1,334 @@
+#ifndef __TENSOR_VIEW_SMALL_TENSOR_HPP__
+#define __TENSOR_VIEW_SMALL_TENSOR_HPP__
+
+#include <memory>
+
+#include "tensorview_config.hpp"
+#include "DynamicTensorShape.hpp"
+#include "BaseTensor.hpp"
+#include "Tensor.hpp"
+
+namespace tensor
+{
+  namespace details
+  {
+    /// @brief array which stores up to `Capacity` elements inside the object
+    /// and allocates larger arrays with `Allocator`.
+    ///
+    /// @details The inline elements are addressed through the object rather
+    /// than a stored pointer, so a buffer within its capacity holds no
+    /// pointers at all. Memory is reused when the buffer shrinks, like
+    /// `std::vector`.
+    template <typename scalar, size_t Capacity, typename Allocator>
+    class small_buffer
+    {
+      static_assert(Capacity > 0, "the inline capacity must be positive.");
+      static_assert(std::is_trivially_copyable_v<scalar> && std::is_trivially_destructible_v<scalar>, "small_buffer elements are copied without constructors and never destroyed.");
+
+    public:
+      using value_type = scalar;
+      using reference = scalar &;
+      using const_reference = const scalar &;
+      using pointer = scalar *;
+      using const_pointer = const scalar *;
+      using allocator_type = typename std::allocator_traits<Allocator>::template rebind_alloc<scalar>;
+
+      TENSOR_HOST_DEVICE inline small_buffer() : n{0}, heap_capacity{0}, heap{nullptr} {}
+
+      /// @brief buffer of `m` uninitialized elements.
+      TENSOR_HOST_DEVICE inline explicit small_buffer(index_t m) : small_buffer()
+      {
+        grow(m, false);
+        n = m;
+      }
+
+      /// @brief buffer of `m` copies of `value`.
+      TENSOR_HOST_DEVICE inline small_buffer(index_t m, const scalar &value) : small_buffer()
+      {
+        resize(m, value);
+      }
+
+      TENSOR_HOST_DEVICE inline small_buffer(const small_buffer &other) : small_buffer()
+      {
+        grow(other.n, false);
+        copy_from(other.data(), other.n);
+        n = other.n;
+      }
+
+      TENSOR_HOST_DEVICE inline small_buffer(small_buffer &&other) noexcept : small_buffer()
+      {
+        take(other);
+      }
+
+      TENSOR_HOST_DEVICE inline small_buffer &operator=(const small_buffer &other)
+      {
+        if (this != &other)
+        {
+          if (other.n > capacity())
+          {
+            release();
+            grow(other.n, false);
+          }
+          copy_from(other.data(), other.n);
+          n = other.n;
+        }
+        return *this;
+      }
+
+      TENSOR_HOST_DEVICE inline small_buffer &operator=(small_buffer &&other) noexcept
+      {
+        if (this != &other)
+        {
+          release();
+          take(other);
+        }
+        return *this;
+      }
+
+      TENSOR_HOST_DEVICE inline ~small_buffer()
+      {
+        release();
+      }
+
+      TENSOR_HOST_DEVICE inline pointer data()
+      {
+        return heap ? heap : storage;
+      }
+
+      TENSOR_HOST_DEVICE inline const_pointer data() const
+      {
+        return heap ? heap : storage;
+      }
+
+      TENSOR_HOST_DEVICE inline reference operator[](index_t i)
+      {
+        return data()[i];
+      }
+
+      TENSOR_HOST_DEVICE inline const_reference operator[](index_t i) const
+      {
+        return data()[i];
+      }
+
+      TENSOR_HOST_DEVICE inline index_t size() const
+      {
+        return n;
+      }
+
+      /// @brief the number of elements which fit in the current memory.
+      TENSOR_HOST_DEVICE inline index_t capacity() const
+      {
+        return heap ? heap_capacity : Capacity;
+      }
+
+      /// @brief true if the elements are stored inside the object.
+      TENSOR_HOST_DEVICE inline bool is_inline() const
+      {
+        return heap == nullptr;
+      }
+
+      /// @brief resizes the buffer, preserving the first `min(size(), m)`
+      /// elements. New elements are set to `value`.
+      TENSOR_HOST_DEVICE inline void resize(index_t m, const scalar &value)
+      {
+        grow(m, true);
+        for (index_t i = n; i < m; ++i)
+          data()[i] = value;
+        n = m;
+      }
+
+      /// @brief resizes the buffer without preserving or initializing its
+      /// elements.
+      TENSOR_HOST_DEVICE inline void resize_discard(index_t m)
+      {
+        if (m > capacity())
+        {
+          release();
+          grow(m, false);
+        }
+        n = m;
+      }
+
+    private:
+      index_t n;
+      index_t heap_capacity;
+      scalar *heap;
+      scalar storage[Capacity];
+
+      // ensures the buffer holds at least `m` elements, copying the current
+      // elements to the new memory if `preserve`.
+      TENSOR_HOST_DEVICE inline void grow(index_t m, bool preserve)
+      {
+        if (m <= capacity())
+          return;
+
+#ifdef __CUDA_ARCH__
+        printf("TensorView: SmallTensor of size %d exceeds its inline capacity in device code.\n", (int)m);
+        assert(false);
+#else
+        allocator_type alloc;
+        scalar *p = std::allocator_traits<allocator_type>::allocate(alloc, m);
+        if (preserve)
+        {
+          const scalar *old = data();
+          for (index_t i = 0; i < n; ++i)
+            p[i] = old[i];
+        }
+        release();
+        heap = p;
+        heap_capacity = m;
+#endif
+      }
+
+      TENSOR_HOST_DEVICE inline void release()
+      {
+        if (heap)
+        {
+#ifndef __CUDA_ARCH__
+          allocator_type alloc;
+          std::allocator_traits<allocator_type>::deallocate(alloc, heap, heap_capacity);
+#endif
+          heap = nullptr;
+          heap_capacity = 0;
+        }
+      }
+
+      // steals the heap array of `other`, or copies its inline elements.
+      TENSOR_HOST_DEVICE inline void take(small_buffer &other)
+      {
+        if (other.heap)
+        {
+          heap = other.heap;
+          heap_capacity = other.heap_capacity;
+          other.heap = nullptr;
+          other.heap_capacity = 0;
+        }
+        else
+        {
+          copy_from(other.storage, other.n);
+        }
+        n = other.n;
+        other.n = 0;
+      }
+
+      TENSOR_HOST_DEVICE inline void copy_from(const scalar *src, index_t m)
+      {
+        scalar *dst = data();
+        for (index_t i = 0; i < m; ++i)
+          dst[i] = src[i];
+      }
+    };
+  } // namespace details
+
+  /// @brief runtime-shaped tensor which stores up to `InlineCapacity`
+  /// elements inside the object.
+  ///
+  /// @details Creating a `SmallTensor` within its capacity never allocates,
+  /// so it suits the many small temporaries of e.g. particle codes where the
+  /// extents are only known at runtime. Larger shapes spill to memory from
+  /// `Allocator`. Within its capacity a `SmallTensor` may be constructed,
+  /// reshaped and copied in cuda __device__ code; exceeding the capacity on
+  /// the device is an error. Copies are deep and the size of the object is
+  /// at least `InlineCapacity * sizeof(scalar)`, so prefer passing views.
+  ///
+  /// @tparam scalar the type of elements in the tensor, trivially copyable
+  /// @tparam Rank the order of the tensor, e.g. 2 for a matrix
+  /// @tparam InlineCapacity the number of elements stored inline
+  /// @tparam Allocator an allocator for tensors larger than `InlineCapacity`
+  /// @tparam Layout `layout::left` (column-major) or `layout::right` (row-major)
+  template <typename scalar, size_t Rank, size_t InlineCapacity, typename Allocator = std::allocator<scalar>, typename Layout = layout::left>
+  class SmallTensor : public details::BaseTensor<details::DynamicTensorShape<Rank, Layout>, details::small_buffer<scalar, InlineCapacity, Allocator>>
+  {
+  public:
+    using base_tensor = details::BaseTensor<details::DynamicTensorShape<Rank, Layout>, details::small_buffer<scalar, InlineCapacity, Allocator>>;
+    using shape_type = details::DynamicTensorShape<Rank, Layout>;
+    using container_type = details::small_buffer<scalar, InlineCapacity, Allocator>;
+
+    using pointer = typename base_tensor::pointer;
+    using const_pointer = typename base_tensor::const_pointer;
+
+    /// @brief creates a tensor of the given shape with every element
+    /// value-initialized (i.e. zero for arithmetic types).
+    template <TENSOR_INT_LIKE... Sizes>
+    TENSOR_HOST_DEVICE inline explicit SmallTensor(Sizes... shape) : base_tensor(shape_type(shape...), container_type(shape_type(shape...).required_size(), scalar())) {}
+
+    /// @brief creates a tensor of the given shape without initializing its
+    /// elements.
+    template <TENSOR_INT_LIKE... Sizes>
+    TENSOR_HOST_DEVICE inline SmallTensor(uninitialized_t, Sizes... shape) : base_tensor(shape_type(shape...), container_type(shape_type(shape...).required_size())) {}
+
+    TENSOR_HOST_DEVICE inline SmallTensor() : base_tensor(shape_type(), container_type()) {}
+
+    using base_tensor::operator=;
+
+    /// @brief the number of elements stored without allocating.
+    static constexpr index_t inline_capacity()
+    {
+      return InlineCapacity;
+    }
+
+    /// @brief true if the elements are stored inside the object.
+    TENSOR_HOST_DEVICE inline bool is_inline() const
+    {
+      return this->container.is_inline();
+    }
+
+    /// @brief changes the shape of the tensor. The elements are preserved in
+    /// memory order, new elements are value-initialized.
+    template <TENSOR_INT_LIKE... Sizes>
+    TENSOR_HOST_DEVICE inline SmallTensor &reshape(Sizes... new_shape)
+    {
+      this->_shape.reshape(std::forward<Sizes>(new_shape)...);
+      this->container.resize(this->_shape.required_size(), scalar());
+
+      return *this;
+    }
+
+    /// @brief changes the shape of the tensor without preserving its
+    /// contents. The memory is reused if it is large enough.
+    template <TENSOR_INT_LIKE... Sizes>
+    TENSOR_HOST_DEVICE inline SmallTensor &reshape_discard(Sizes... new_shape)
+    {
+      this->_shape.reshape(std::forward<Sizes>(new_shape)...);
+      this->container.resize_discard(this->_shape.required_size());
+
+      return *this;
+    }
+
+    /// @brief implicit conversion to scalar*
+    TENSOR_HOST_DEVICE inline operator pointer()
+    {
+      return this->container.data();
+    }
+
+    /// @brief implicit conversion to scalar*
+    TENSOR_HOST_DEVICE inline operator const_pointer() const
+    {
+      return this->container.data();
+    }
+
+    /// @brief returns the array of elements
+    TENSOR_HOST_DEVICE inline pointer data()
+    {
+      return this->container.data();
+    }
+
+    /// @brief returns the array of elements
+    TENSOR_HOST_DEVICE inline const_pointer data() const
+    {
+      return this->container.data();
+    }
+  };
+
+  /// @brief runtime-shaped matrix storing up to `InlineCapacity` elements
+  /// inline.
+  template <typename scalar, size_t InlineCapacity, typename Allocator = std::allocator<scalar>>
+  using SmallMatrix = SmallTensor<scalar, 2, InlineCapacity, Allocator>;
+
+  /// @brief runtime-sized vector storing up to `InlineCapacity` elements
+  /// inline.
+  template <typename scalar, size_t InlineCapacity, typename Allocator = std::allocator<scalar>>
+  using SmallVector = SmallTensor<scalar, 1, InlineCapacity, Allocator>;
+} // namespace tensor
+
+#endif
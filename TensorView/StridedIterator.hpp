@@ -0,0 +1,245 @@
+#ifndef __TENSOR_VIEW_STRIDED_ITERATOR_HPP__
+#define __TENSOR_VIEW_STRIDED_ITERATOR_HPP__
+
+#include "tensorview_config.hpp"
+#include "profile.hpp"
+#include "errors.hpp"
+#include "StridedShape.hpp"
+
+namespace tensor::details
+{
+  /// @brief odometer style iterator over the elements of a tensor with
+  /// arbitrary strides (`StridedShape` or a padded `DynamicTensorShape`).
+  ///
+  /// @details The iterator keeps a counter per dimension and the running
+  /// offset into the underlying array, so incrementing costs a single add
+  /// except when a dimension wraps around. Consecutive dimensions that are
+  /// contiguous with respect to each other (e.g. the leading dimensions of
+  /// `x.at(all(), all(), k)`) and singleton dimensions are collapsed when
+  /// the iterator is constructed so that the innermost run is as long as
+  /// possible.
+  ///
+  /// @tparam ViewType the `ViewContainer` of the tensor
+  /// @tparam Rank the order of the tensor
+  template <typename ViewType, size_t Rank>
+  class StridedIterator
+  {
+  public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = typename ViewType::value_type;
+    using difference_type = std::ptrdiff_t;
+    using pointer = value_type *;
+    using reference = value_type &;
+
+    TENSOR_FUNC StridedIterator() : _ndim(1), _pos(0), _offset(0), _extents{}, _strides{}, _count{} {}
+
+    template <typename Shape>
+    TENSOR_FUNC StridedIterator(const Shape &shape_, ViewType view_, index_t pos)
+        : _ndim(0), _pos(0), _offset(0), _extents{}, _strides{}, _count{}, _view(view_)
+    {
+      for (index_t d = 0; d < Rank; ++d)
+      {
+        const index_t n = shape_.shape(d);
+        const index_t s = (index_t)shape_.stride(d);
+
+        if (n == 1)
+          continue;
+
+        if (_ndim > 0 && s == _strides[_ndim - 1] * _extents[_ndim - 1])
+        {
+          _extents[_ndim - 1] *= n;
+        }
+        else
+        {
+          _extents[_ndim] = n;
+          _strides[_ndim] = s;
+          ++_ndim;
+        }
+      }
+
+      if (_ndim == 0)
+      {
+        _ndim = 1;
+        _extents[0] = 1;
+        _strides[0] = 0;
+      }
+
+      seek(pos);
+    }
+
+    TENSOR_FUNC reference operator*()
+    {
+      TENSOR_PROFILE_ITERATOR(sizeof(value_type));
+      return _view[_offset];
+    }
+
+    TENSOR_FUNC pointer operator->()
+    {
+      return &_view[_offset];
+    }
+
+    TENSOR_FUNC reference operator[](difference_type n)
+    {
+      StridedIterator tmp = *this;
+      tmp += n;
+      return *tmp;
+    }
+
+    TENSOR_FUNC StridedIterator &operator++()
+    {
+      ++_pos;
+      _offset += _strides[0];
+      if (++_count[0] == _extents[0])
+        carry();
+      return *this;
+    }
+
+    TENSOR_FUNC StridedIterator operator++(int)
+    {
+      StridedIterator tmp = *this;
+      ++(*this);
+      return tmp;
+    }
+
+    TENSOR_FUNC StridedIterator &operator--()
+    {
+      --_pos;
+      if (_count[0] > 0)
+      {
+        --_count[0];
+        _offset -= _strides[0];
+      }
+      else
+      {
+        borrow();
+      }
+      return *this;
+    }
+
+    TENSOR_FUNC StridedIterator operator--(int)
+    {
+      StridedIterator tmp = *this;
+      --(*this);
+      return tmp;
+    }
+
+    TENSOR_FUNC StridedIterator operator+(difference_type n) const
+    {
+      StridedIterator tmp = *this;
+      tmp += n;
+      return tmp;
+    }
+
+    TENSOR_FUNC StridedIterator operator-(difference_type n) const
+    {
+      StridedIterator tmp = *this;
+      tmp -= n;
+      return tmp;
+    }
+
+    TENSOR_FUNC StridedIterator &operator+=(difference_type n)
+    {
+      seek(_pos + n);
+      return *this;
+    }
+
+    TENSOR_FUNC StridedIterator &operator-=(difference_type n)
+    {
+      seek(_pos - n);
+      return *this;
+    }
+
+    TENSOR_FUNC difference_type operator-(const StridedIterator &other) const
+    {
+      return (difference_type)_pos - (difference_type)other._pos;
+    }
+
+    TENSOR_FUNC bool operator==(const StridedIterator &other) const
+    {
+      return _pos == other._pos;
+    }
+
+    TENSOR_FUNC bool operator!=(const StridedIterator &other) const
+    {
+      return _pos != other._pos;
+    }
+
+    TENSOR_FUNC bool operator<(const StridedIterator &other) const
+    {
+      return _pos < other._pos;
+    }
+
+    TENSOR_FUNC bool operator>(const StridedIterator &other) const
+    {
+      return _pos > other._pos;
+    }
+
+    TENSOR_FUNC bool operator<=(const StridedIterator &other) const
+    {
+      return _pos <= other._pos;
+    }
+
+    TENSOR_FUNC bool operator>=(const StridedIterator &other) const
+    {
+      return _pos >= other._pos;
+    }
+
+  private:
+    index_t _ndim;
+    index_t _pos;
+    index_t _offset;
+    std::array<index_t, Rank> _extents;
+    std::array<index_t, Rank> _strides;
+    std::array<index_t, Rank> _count;
+    ViewType _view;
+
+    // sets the counters and offset from the linear position. The last
+    // counter is not wrapped so that the one-past-the-end state agrees with
+    // the state reached by incrementing.
+    TENSOR_FUNC void seek(index_t pos)
+    {
+      _pos = pos;
+      _offset = 0;
+      for (index_t d = 0; d + 1 < _ndim; ++d)
+      {
+        _count[d] = pos % _extents[d];
+        pos /= _extents[d];
+        _offset += _count[d] * _strides[d];
+      }
+      _count[_ndim - 1] = pos;
+      _offset += pos * _strides[_ndim - 1];
+    }
+
+    // propagates an overflow of the innermost counter.
+    TENSOR_FUNC void carry()
+    {
+      for (index_t d = 0; d + 1 < _ndim && _count[d] == _extents[d]; ++d)
+      {
+        _offset -= _count[d] * _strides[d];
+        _count[d] = 0;
+        _offset += _strides[d + 1];
+        ++_count[d + 1];
+      }
+    }
+
+    // propagates an underflow of the innermost counter.
+    TENSOR_FUNC void borrow()
+    {
+      index_t d = 0;
+      while (d + 1 < _ndim && _count[d] == 0)
+        ++d;
+
+      --_count[d];
+      _offset -= _strides[d];
+
+      for (index_t k = 0; k < d; ++k)
+      {
+        _count[k] = _extents[k] - 1;
+        _offset += _count[k] * _strides[k];
+      }
+    }
+  };
+
+} // namespace tensor::details
+
+#endif
@@ -4,6 +4,7 @@
 #include "tensorview_config.hpp"
 #include "errors.hpp"
 #include "span.hpp"
+#include "layout.hpp"
 
 namespace tensor::details
 {
@@ -11,6 +12,8 @@ namespace tensor::details
   struct StridedShape
   {
   public:
+    using layout_type = layout::stride;
+
     TENSOR_FUNC StridedShape(const std::array<span, Rank> &spans)
     {
       len = 1;
@@ -22,11 +25,31 @@ namespace tensor::details
       }
     }
 
+    /// @brief shape with the given extents and (possibly negative or zero) strides.
+    TENSOR_FUNC StridedShape(const std::array<index_t, Rank> &shape_, const std::array<stride_t, Rank> &strides_)
+    {
+      len = 1;
+      for (index_t d = 0; d < Rank; ++d)
+      {
+        _shape[d] = shape_[d];
+        strides[d] = (index_t)strides_[d];
+        len *= _shape[d];
+      }
+    }
+
+    TENSOR_FUNC StridedShape() : len{0}, _shape{}, strides{} {}
+
     static constexpr index_t order()
     {
       return Rank;
     }
 
+    /// @brief the elements are not stored contiguously in memory in general.
+    static constexpr bool is_contiguous()
+    {
+      return false;
+    }
+
     template <typename... Indices>
     TENSOR_FUNC auto operator()(Indices... indices) const
     {
@@ -35,15 +58,34 @@ namespace tensor::details
 
     TENSOR_FUNC index_t operator[](index_t index) const
     {
-#ifdef TENSOR_DEBUG
+#ifdef TENSOR_CHECK_BOUNDS
       if (index < 0 || index >= len)
+        tensor_linear_index_out_of_range(index, len);
+#endif
+      return linear_offset(index);
+    }
+
+    /// @brief returns the offset of the element with linear index `index`
+    /// without bounds checking.
+    TENSOR_FUNC index_t linear_offset(index_t index) const
+    {
+      index_t offset = 0;
+      for (index_t d = 0; d < Rank; ++d)
       {
-        char msg[100];
-        snprintf(msg, sizeof(msg), "linear index = %ld is out of range for tensor with size %ld.", index, len);
-        tensor_out_of_range(msg);
+        offset += strides[d] * (index % _shape[d]);
+        index /= _shape[d];
       }
-#endif
-      return index * strides[0];
+      return offset;
+    }
+
+    /// @brief returns the offset of the multi-index idx without bounds
+    /// checking. Used by bulk operations whose ranges are validated on entry.
+    TENSOR_FUNC index_t offset(const std::array<index_t, Rank> &idx) const
+    {
+      index_t offset = 0;
+      for (index_t d = 0; d < Rank; ++d)
+        offset += strides[d] * idx[d];
+      return offset;
     }
 
     TENSOR_FUNC index_t size() const
@@ -56,6 +98,12 @@ namespace tensor::details
       return _shape[d];
     }
 
+    /// @brief returns the distance (in elements) between consecutive entries along dimension d.
+    TENSOR_FUNC stride_t stride(index_t d) const
+    {
+      return (stride_t)strides[d];
+    }
+
   private:
     index_t len;
     std::array<index_t, Rank> _shape;
@@ -64,13 +112,9 @@ namespace tensor::details
     template <index_t Dim = 0, typename... Indices>
     TENSOR_FUNC auto compute_index(index_t index, Indices... indices) const
     {
-#ifdef TENSOR_DEBUG
+#ifdef TENSOR_CHECK_BOUNDS
       if (index < 0 || index >= _shape[Dim])
-      {
-        char msg[100];
-        snprintf(msg, sizeof(msg), "Index %ld is out of range for dimension %ld with size %ld.", index, Dim, _shape[Dim]);
-        tensor_out_of_range(msg);
-      }
+        tensor_index_out_of_range(index, Dim, _shape[Dim]);
 #endif
       if constexpr (Dim + 1 < Rank)
         return strides[Dim] * index + compute_index<Dim + 1>(std::forward<Indices>(indices)...);
@@ -81,13 +125,9 @@ namespace tensor::details
     template <index_t Dim = 0, typename... Indices>
     TENSOR_FUNC auto compute_index(span x, Indices... indices) const
     {
-#ifdef TENSOR_DEBUG
+#ifdef TENSOR_CHECK_BOUNDS
       if (x.begin < 0 || x.end > _shape[Dim])
-      {
-        char msg[100];
-        snprintf(msg, sizeof(msg), "span( %ld, %ld ) is out of range for dimension %ld with size %ld.", x.begin, x.end, Dim, _shape[Dim]);
-        tensor_out_of_range(msg);
-      }
+        tensor_span_out_of_range(x.begin, x.end, Dim, _shape[Dim]);
 #endif
       if constexpr (Dim + 1 < Rank)
         return strides[Dim] * x + compute_index<Dim + 1>(std::forward<Indices>(indices)...);
@@ -109,55 +149,70 @@ namespace tensor::details
   struct StridedShape<1>
   {
   public:
-    TENSOR_FUNC StridedShape(const span &x) : len{x.size()}, stride{x.stride} {}
+    using layout_type = layout::stride;
+
+    TENSOR_FUNC StridedShape(const span &x) : len{x.size()}, _stride{x.stride} {}
+
+    /// @brief shape with the given extent and (possibly negative or zero) stride.
+    TENSOR_FUNC StridedShape(const std::array<index_t, 1> &shape_, const std::array<stride_t, 1> &stride_) : len{shape_[0]}, _stride{(index_t)stride_[0]} {}
+
+    TENSOR_FUNC StridedShape() : len{0}, _stride{0} {}
 
     static constexpr index_t order()
     {
       return 1;
     }
 
+    /// @brief the elements are not stored contiguously in memory in general.
+    static constexpr bool is_contiguous()
+    {
+      return false;
+    }
+
     TENSOR_FUNC index_t operator()(index_t i) const
     {
-#ifdef TENSOR_DEBUG
+#ifdef TENSOR_CHECK_BOUNDS
       if (i < 0 || i >= len)
-      {
-        char msg[100];
-        snprintf(msg, sizeof(msg), "Index = %ld is out of range for 1D tensor with size %ld.", i, len);
-        tensor_out_of_range(msg);
-      }
+        tensor_index_out_of_range(i, 0, len);
 #endif
-      return stride * i;
+      return _stride * i;
     }
 
     TENSOR_FUNC span operator()(span x) const
     {
-#ifdef TENSOR_DEBUG
-      if (x.begin < 0 || x.end >= len)
-      {
-        char msg[100];
-        snprintf(msg, sizeof(msg), "span( %ld, %ld ) is out of range for 1D tensor with size %ld.", x.begin, x.end, len);
-        tensor_out_of_range(msg);
-      }
+#ifdef TENSOR_CHECK_BOUNDS
+      if (x.begin < 0 || x.end > len)
+        tensor_span_out_of_range(x.begin, x.end, 0, len);
 #endif
-      return stride * x;
+      return _stride * x;
     }
 
     TENSOR_FUNC span operator()(all) const
     {
-      return stride * span(0, len);
+      return _stride * span(0, len);
     }
 
     TENSOR_FUNC index_t operator[](index_t index) const
     {
-#ifdef TENSOR_DEBUG
+#ifdef TENSOR_CHECK_BOUNDS
       if (index < 0 || index >= len)
-      {
-        char msg[100];
-        snprintf(msg, sizeof(msg), "linear index = %ld is out of range for tensor with size %ld.", index, len);
-        tensor_out_of_range(msg);
-      }
+        tensor_linear_index_out_of_range(index, len);
 #endif
-      return index * stride;
+      return linear_offset(index);
+    }
+
+    /// @brief returns the offset of the element with linear index `index`
+    /// without bounds checking.
+    TENSOR_FUNC index_t linear_offset(index_t index) const
+    {
+      return index * _stride;
+    }
+
+    /// @brief returns the offset of the multi-index idx without bounds
+    /// checking. Used by bulk operations whose ranges are validated on entry.
+    TENSOR_FUNC index_t offset(const std::array<index_t, 1> &idx) const
+    {
+      return idx[0] * _stride;
     }
 
     TENSOR_FUNC index_t size() const
@@ -170,9 +225,15 @@ namespace tensor::details
       return len;
     }
 
+    /// @brief returns the distance (in elements) between consecutive entries.
+    TENSOR_FUNC stride_t stride(index_t) const
+    {
+      return (stride_t)_stride;
+    }
+
   private:
     index_t len;
-    index_t stride;
+    index_t _stride;
   };
 
 } // namespace tensor
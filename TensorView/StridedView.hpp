@@ -0,0 +1,148 @@
+#ifndef __TENSOR_VIEW_STRIDED_VIEW_HPP__
+#define __TENSOR_VIEW_STRIDED_VIEW_HPP__
+
+#include "tensorview_config.hpp"
+#include "errors.hpp"
+#include "ViewContainer.hpp"
+#include "FixedTensorShape.hpp"
+#include "StridedShape.hpp"
+#include "BaseTensor.hpp"
+
+namespace tensor
+{
+  /// @brief provides read/write access to an externally managed array whose
+  /// dimensions have arbitrary strides. A stride may be negative (the
+  /// dimension runs backwards through memory) or zero (every index of the
+  /// dimension refers to the same element, i.e. a broadcast).
+  /// @tparam scalar type of tensor elements
+  /// @tparam Rank the tensor dimension
+  template <typename scalar, size_t Rank>
+  class StridedView : public details::BaseTensor<details::StridedShape<Rank>, details::ViewContainer<scalar>>
+  {
+  public:
+    using base_tensor = details::BaseTensor<details::StridedShape<Rank>, details::ViewContainer<scalar>>;
+    using shape_type = details::StridedShape<Rank>;
+    using container_type = details::ViewContainer<scalar>;
+
+    StridedView() = default;
+
+    /**
+     * @brief wraps an array with the given extents and strides.
+     *
+     * @param data pointer to the element with multi-index (0, ..., 0)
+     * @param shape the size of each dimension
+     * @param strides the distance (in elements) between consecutive entries
+     * of each dimension
+     */
+    TENSOR_FUNC explicit StridedView(scalar *data, const std::array<index_t, Rank> &shape, const std::array<stride_t, Rank> &strides) : base_tensor(shape_type(shape, strides), container_type(data))
+    {
+#ifdef TENSOR_CHECK_BOUNDS
+      for (index_t d = 0; d < Rank; ++d)
+        if (shape[d] <= 0)
+          tensor_bad_shape();
+#endif
+    }
+
+    using base_tensor::operator=;
+
+    /// @brief returns pointer to the element with multi-index (0, ..., 0).
+    TENSOR_FUNC scalar *data()
+    {
+      return this->container.data();
+    }
+
+    /// @brief returns pointer to the element with multi-index (0, ..., 0).
+    TENSOR_FUNC TENSOR_CONST_QUAL(scalar) *data() const
+    {
+      return this->container.data();
+    }
+  };
+
+  namespace details
+  {
+    template <typename Shape>
+    struct is_fixed_shape : std::false_type
+    {
+    };
+
+    template <size_t... S>
+    struct is_fixed_shape<FixedTensorShape<S...>> : std::true_type
+    {
+    };
+
+    // the element type of a view into T, const if T is.
+    template <typename T>
+    using view_scalar_t = std::remove_pointer_t<decltype(std::declval<T &>().data())>;
+
+    template <size_t... P>
+    constexpr bool is_permutation()
+    {
+      constexpr size_t p[] = {P...};
+      constexpr size_t n = sizeof...(P);
+      for (size_t i = 0; i < n; ++i)
+      {
+        if (p[i] >= n)
+          return false;
+        for (size_t j = 0; j < i; ++j)
+          if (p[i] == p[j])
+            return false;
+      }
+      return true;
+    }
+  } // namespace details
+
+  /**
+   * @brief returns a view of x with its dimensions reordered, e.g.
+   * `permute<1, 0, 2>(x)(i, j, k) == x(j, i, k)`. No data is copied.
+   *
+   * @tparam P dimension d of the result is dimension `P[d]` of x
+   * @param x tensor, view, or subview
+   */
+  template <size_t... P, typename T>
+  TENSOR_FUNC auto permute(T &&x)
+  {
+    using shape_type = typename std::decay_t<T>::shape_type;
+    static_assert(sizeof...(P) == shape_type::order(), "permute requires one index per dimension.");
+    static_assert(details::is_permutation<P...>(), "permute requires a permutation of the dimensions.");
+
+    using scalar = details::view_scalar_t<T>;
+    return StridedView<scalar, sizeof...(P)>(x.data(), {x.shape(P)...}, {x.stride(P)...});
+  }
+
+  /// @brief returns a transposed view of the matrix A. No data is copied.
+  /// Fixed size matrices are transposed into a new `FixedTensor` instead
+  /// (see fixed_linalg.hpp); use `permute<1, 0>` for a view.
+  template <typename T, typename = std::enable_if_t<!details::is_fixed_shape<typename std::decay_t<T>::shape_type>::value>>
+  TENSOR_FUNC auto transpose(T &&A)
+  {
+    static_assert(std::decay_t<T>::order() == 2, "transpose requires a matrix.");
+    return permute<1, 0>(std::forward<T>(A));
+  }
+
+  /// @brief returns a view of x with the order of the entries along
+  /// dimension `dim` reversed. No data is copied.
+  template <typename T>
+  TENSOR_FUNC auto flip(T &&x, index_t dim)
+  {
+    constexpr size_t Rank = std::decay_t<T>::order();
+#ifdef TENSOR_CHECK_BOUNDS
+    if (dim < 0 || dim >= Rank)
+      tensor_dimension_out_of_range(dim, Rank);
+#endif
+
+    std::array<index_t, Rank> shape;
+    std::array<stride_t, Rank> strides;
+    for (index_t d = 0; d < Rank; ++d)
+    {
+      shape[d] = x.shape(d);
+      strides[d] = x.stride(d);
+    }
+
+    using scalar = details::view_scalar_t<T>;
+    scalar *first = x.data() + (stride_t)(shape[dim] - 1) * strides[dim];
+    strides[dim] = -strides[dim];
+    return StridedView<scalar, Rank>(first, shape, strides);
+  }
+} // namespace tensor
+
+#endif
@@ -16,24 +16,50 @@ namespace tensor
   class SubView : public details::BaseTensor<details::StridedShape<Rank>, details::ViewContainer<scalar>>
   {
   public:
-    TENSOR_FUNC explicit SubView(details::ViewContainer<scalar> view, const std::array<span, Rank> &spans) : base_tensor(shape_type(spans), container_type(view.data() + details::offset(spans))) {}
-
-  private:
     using base_tensor = details::BaseTensor<details::StridedShape<Rank>, details::ViewContainer<scalar>>;
     using shape_type = details::StridedShape<Rank>;
     using container_type = details::ViewContainer<scalar>;
+
+    TENSOR_FUNC explicit SubView(details::ViewContainer<scalar> view, const std::array<span, Rank> &spans) : base_tensor(shape_type(spans), container_type(view.data() + (stride_t)details::offset(spans))) {}
+
+    using base_tensor::operator=;
+
+    /// @brief returns pointer to the first element of the subview.
+    TENSOR_FUNC scalar *data()
+    {
+      return this->container.data();
+    }
+
+    /// @brief returns pointer to the first element of the subview.
+    TENSOR_FUNC TENSOR_CONST_QUAL(scalar) *data() const
+    {
+      return this->container.data();
+    }
   };
 
   template <typename scalar>
   class SubView<scalar, 1> : public details::BaseTensor<details::StridedShape<1>, details::ViewContainer<scalar>>
   {
   public:
-    TENSOR_FUNC explicit SubView(details::ViewContainer<scalar> view, const span &s) : base_tensor(shape_type(s), container_type(view.data() + s.begin)) {}
-
-  private:
     using base_tensor = details::BaseTensor<details::StridedShape<1>, details::ViewContainer<scalar>>;
     using shape_type = details::StridedShape<1>;
     using container_type = details::ViewContainer<scalar>;
+
+    TENSOR_FUNC explicit SubView(details::ViewContainer<scalar> view, const span &s) : base_tensor(shape_type(s), container_type(view.data() + (stride_t)s.begin)) {}
+
+    using base_tensor::operator=;
+
+    /// @brief returns pointer to the first element of the subview.
+    TENSOR_FUNC scalar *data()
+    {
+      return this->container.data();
+    }
+
+    /// @brief returns pointer to the first element of the subview.
+    TENSOR_FUNC TENSOR_CONST_QUAL(scalar) *data() const
+    {
+      return this->container.data();
+    }
   };
 } // namespace tensor
 
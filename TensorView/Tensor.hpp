@@ -3,9 +3,20 @@
 
 #include "tensorview_config.hpp"
 #include "DynamicTensorShape.hpp"
+#include "default_init_allocator.hpp"
 
 namespace tensor
 {
+  /// @brief tag type selecting the constructors which leave the elements of
+  /// a tensor uninitialized.
+  struct uninitialized_t
+  {
+    explicit uninitialized_t() = default;
+  };
+
+  /// @brief tag passed to `Tensor(uninitialized, shape...)`.
+  inline constexpr uninitialized_t uninitialized{};
+
   /// @brief tensor type which manages its own memory (dynamically)
   ///
   /// @details Unlike the view type, this type dynamically allocates memory. For
@@ -16,27 +27,59 @@ namespace tensor
   /// @tparam scalar the type of elements in the tensor e.g. float
   /// @tparam Allocator an allocator for managing memory
   /// @tparam Rank the order of the tensor, e.g. 2 for a matrix
-  template <typename scalar, size_t Rank, typename Allocator = std::allocator<scalar>>
-  class Tensor : public details::BaseTensor<details::DynamicTensorShape<Rank>, std::vector<scalar, Allocator>>
+  /// @tparam Layout `layout::left` (column-major) or `layout::right` (row-major)
+  template <typename scalar, size_t Rank, typename Allocator = std::allocator<scalar>, typename Layout = layout::left>
+  class Tensor : public details::BaseTensor<details::DynamicTensorShape<Rank, Layout>, std::vector<scalar, details::default_init_allocator<Allocator>>>
   {
   public:
-    using base_tensor = details::BaseTensor<details::DynamicTensorShape<Rank>, std::vector<scalar, Allocator>>;
-    using shape_type = details::DynamicTensorShape<Rank>;
-    using container_type = std::vector<scalar, Allocator>;
+    using base_tensor = details::BaseTensor<details::DynamicTensorShape<Rank, Layout>, std::vector<scalar, details::default_init_allocator<Allocator>>>;
+    using shape_type = details::DynamicTensorShape<Rank, Layout>;
+    using container_type = std::vector<scalar, details::default_init_allocator<Allocator>>;
 
     using pointer = typename base_tensor::pointer;
     using const_pointer = typename base_tensor::const_pointer;
 
+    /// @brief allocates a tensor of the given shape with every element
+    /// value-initialized (i.e. zero for arithmetic types).
     template <TENSOR_INT_LIKE... Sizes>
-    inline explicit Tensor(Sizes... shape) : base_tensor(shape_type(shape...), container_type((1 * ... * shape))) {}
+    inline explicit Tensor(Sizes... shape) : base_tensor(shape_type(shape...), container_type(shape_type(shape...).required_size(), scalar())) {}
+
+    /// @brief allocates a tensor of the given shape without initializing
+    /// trivial element types. No page of the array is touched until it is
+    /// first written.
+    template <TENSOR_INT_LIKE... Sizes>
+    inline Tensor(uninitialized_t, Sizes... shape) : base_tensor(shape_type(shape...), container_type(shape_type(shape...).required_size())) {}
 
     inline Tensor() : base_tensor(shape_type(), container_type(0)) {}
 
+    using base_tensor::operator=;
+
+    /// @brief changes the shape of the tensor. The elements are preserved in
+    /// memory order, new elements are value-initialized.
     template <TENSOR_INT_LIKE... Sizes>
     TENSOR_FUNC Tensor &reshape(Sizes... new_shape)
     {
       this->_shape.reshape(std::forward<Sizes>(new_shape)...);
-      this->container.resize(this->_shape.size());
+      this->container.resize(this->_shape.required_size(), scalar());
+
+      return *this;
+    }
+
+    /// @brief changes the shape of the tensor without preserving its
+    /// contents. The memory is reused if it is large enough, otherwise it is
+    /// reallocated without copying, and trivial element types are left
+    /// uninitialized.
+    template <TENSOR_INT_LIKE... Sizes>
+    inline Tensor &reshape_discard(Sizes... new_shape)
+    {
+      this->_shape.reshape(std::forward<Sizes>(new_shape)...);
+
+      const index_t n = this->_shape.required_size();
+      if (n > this->container.capacity())
+        container_type().swap(this->container); // free the old array before allocating the new one
+
+      this->container.clear();
+      this->container.resize(n);
 
       return *this;
     }
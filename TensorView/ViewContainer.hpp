@@ -35,7 +35,7 @@ namespace tensor::details
       if (ptr == nullptr)
         tensor_bad_memory_access();
 #endif
-      return ptr[index];
+      return ptr[(stride_t)index];
     }
 
     TENSOR_FUNC const_reference operator[](index_t index) const
@@ -44,7 +44,7 @@ namespace tensor::details
       if (ptr == nullptr)
         tensor_bad_memory_access();
 #endif
-      return ptr[index];
+      return ptr[(stride_t)index];
     }
 
   private:
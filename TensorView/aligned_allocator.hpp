@@ -0,0 +1,119 @@
+#ifndef __TENSOR_VIEW_ALIGNED_ALLOCATOR_HPP__
+#define __TENSOR_VIEW_ALIGNED_ALLOCATOR_HPP__
+
+#include <new>
+#include <limits>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+#include "tensorview_config.hpp"
+#include "layout.hpp"
+#include "Tensor.hpp"
+
+namespace tensor
+{
+  /// @brief alignment of a cache line, and of a full AVX-512 register.
+  inline constexpr size_t cache_line_alignment = 64;
+
+  /// @brief alignment of a (transparent) huge page on x86-64 and aarch64.
+  inline constexpr size_t huge_page_alignment = size_t(2) << 20;
+
+  /**
+   * @brief allocator which aligns every allocation to `Align` bytes.
+   *
+   * @details The default alignment of 64 bytes matches both the cache line
+   * and the widest vector registers, so vector loads from the start of the
+   * array are aligned and tensors split between threads at multiples of 64
+   * bytes do not share cache lines. With `Align = huge_page_alignment` the
+   * allocations are aligned to 2 MB pages, and on Linux the kernel is asked
+   * to back them with transparent huge pages, which reduces TLB misses for
+   * very large tensors.
+   *
+   * @tparam T the type of the elements
+   * @tparam Align the alignment in bytes, a power of two
+   */
+  template <typename T, size_t Align = cache_line_alignment>
+  class aligned_allocator
+  {
+  public:
+    static_assert((Align & (Align - 1)) == 0, "the alignment must be a power of two.");
+    static_assert(Align >= alignof(T), "the alignment must be at least the alignment of the type.");
+
+    using value_type = T;
+    using size_type = size_t;
+    using difference_type = std::ptrdiff_t;
+    using is_always_equal = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+
+    static constexpr size_t alignment = Align;
+
+    template <typename U>
+    struct rebind
+    {
+      using other = aligned_allocator<U, Align>;
+    };
+
+    aligned_allocator() noexcept = default;
+
+    template <typename U>
+    aligned_allocator(const aligned_allocator<U, Align> &) noexcept {}
+
+    [[nodiscard]] T *allocate(size_t n)
+    {
+      if (n > std::numeric_limits<size_t>::max() / sizeof(T))
+        throw std::bad_array_new_length();
+
+      const size_t bytes = n * sizeof(T);
+      void *ptr = ::operator new(bytes, std::align_val_t(Align));
+
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+      if constexpr (Align >= huge_page_alignment)
+        if (bytes >= huge_page_alignment)
+          madvise(ptr, bytes, MADV_HUGEPAGE); // only a hint, failure is harmless
+#endif
+
+      return static_cast<T *>(ptr);
+    }
+
+    void deallocate(T *ptr, size_t) noexcept
+    {
+      ::operator delete(ptr, std::align_val_t(Align));
+    }
+
+    template <typename U>
+    bool operator==(const aligned_allocator<U, Align> &) const noexcept
+    {
+      return true;
+    }
+
+    template <typename U>
+    bool operator!=(const aligned_allocator<U, Align> &) const noexcept
+    {
+      return false;
+    }
+  };
+
+  namespace layout
+  {
+    /// @brief column-major layout where every column of a tensor of T starts
+    /// at a multiple of `Align` bytes from the first one.
+    template <typename T, size_t Align = cache_line_alignment>
+    using left_aligned = left_padded<(Align >= sizeof(T)) ? Align / sizeof(T) : 1>;
+
+    /// @brief row-major layout where every row of a tensor of T starts at a
+    /// multiple of `Align` bytes from the first one.
+    template <typename T, size_t Align = cache_line_alignment>
+    using right_aligned = right_padded<(Align >= sizeof(T)) ? Align / sizeof(T) : 1>;
+  } // namespace layout
+
+  /// @brief column-major `Tensor` whose storage is aligned to `Align` bytes
+  /// and whose columns are padded to a multiple of a cache line. The padding
+  /// is exposed by the shape as `stride(1)` and
+  /// `shape_type::layout_type::padding`.
+  template <typename scalar, size_t Rank, size_t Align = cache_line_alignment>
+  using AlignedTensor = Tensor<scalar, Rank, aligned_allocator<scalar, Align>, layout::left_aligned<scalar>>;
+} // namespace tensor
+
+#endif
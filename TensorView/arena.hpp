@@ -0,0 +1,338 @@
+#ifndef __TENSOR_VIEW_ARENA_HPP__
+#define __TENSOR_VIEW_ARENA_HPP__
+
+#include <new>
+#include <memory>
+#include <vector>
+#include <cstddef>
+
+#include "tensorview_config.hpp"
+#include "aligned_allocator.hpp"
+#include "DynamicTensorView.hpp"
+
+namespace tensor
+{
+  /**
+   * @brief bump allocator for short lived temporaries.
+   *
+   * @details Memory is handed out from large blocks by advancing an offset,
+   * so an allocation costs a few instructions and never takes a lock.
+   * Individual deallocations are no-ops; instead the whole arena is rewound
+   * with `reset()` or at the end of a `scope()`. The blocks are kept and
+   * reused after rewinding. Destructors of objects placed in the arena are
+   * never run.
+   *
+   * An arena is not thread safe. Use `Arena::thread_local_arena()` to get an
+   * arena per thread.
+   */
+  class Arena
+  {
+  public:
+    /// @brief position in the arena which it can be rewound to.
+    struct Marker
+    {
+      size_t block;
+      size_t offset;
+    };
+
+    /// @brief rewinds the arena to its state at construction on destruction.
+    class Scope
+    {
+    public:
+      explicit Scope(Arena &arena_) : arena(arena_), marker(arena_.mark()) {}
+      ~Scope() { arena.rewind(marker); }
+
+      Scope(const Scope &) = delete;
+      Scope &operator=(const Scope &) = delete;
+
+    private:
+      Arena &arena;
+      Marker marker;
+    };
+
+    /// @param block_size the size in bytes of the blocks requested from the
+    /// system. Larger allocations get a block of their own.
+    explicit Arena(size_t block_size = size_t(1) << 20) : _block_size(block_size), current{0, 0} {}
+
+    ~Arena()
+    {
+      for (auto &b : blocks)
+        ::operator delete(b.data, std::align_val_t(cache_line_alignment));
+    }
+
+    Arena(const Arena &) = delete;
+    Arena &operator=(const Arena &) = delete;
+
+    /// @brief returns `bytes` bytes aligned to `align` (a power of two, at
+    /// most 64).
+    inline void *allocate(size_t bytes, size_t align = alignof(std::max_align_t))
+    {
+      if (bytes == 0)
+        bytes = 1;
+
+      while (current.block < blocks.size())
+      {
+        const Block &b = blocks[current.block];
+        const size_t offset = (current.offset + align - 1) & ~(align - 1);
+        if (offset + bytes <= b.size)
+        {
+          current.offset = offset + bytes;
+          return b.data + offset;
+        }
+        ++current.block;
+        current.offset = 0;
+      }
+
+      const size_t size = (bytes > _block_size) ? bytes : _block_size;
+      char *data = static_cast<char *>(::operator new(size, std::align_val_t(cache_line_alignment)));
+      blocks.push_back({data, size});
+      current = {blocks.size() - 1, bytes};
+      return data;
+    }
+
+    /// @brief no-op, memory is released by `reset()` or `rewind()`.
+    void deallocate(void *, size_t) noexcept {}
+
+    /// @brief returns the current position of the arena.
+    Marker mark() const
+    {
+      return current;
+    }
+
+    /// @brief releases every allocation made since `marker` was taken.
+    void rewind(Marker marker)
+    {
+      current = marker;
+    }
+
+    /// @brief releases every allocation. The memory is kept for reuse.
+    void reset()
+    {
+      current = {0, 0};
+    }
+
+    /// @brief returns an object which rewinds the arena when it goes out of scope.
+    Scope scope()
+    {
+      return Scope(*this);
+    }
+
+    /// @brief returns the total number of bytes requested from the system.
+    size_t capacity() const
+    {
+      size_t n = 0;
+      for (auto &b : blocks)
+        n += b.size;
+      return n;
+    }
+
+    /**
+     * @brief allocates an uninitialized tensor in the arena.
+     *
+     * @tparam scalar a trivially destructible element type
+     * @param shape the size of each dimension
+     * @return a `TensorView` of the memory. It is valid until the arena is
+     * rewound past it.
+     */
+    template <typename scalar, TENSOR_INT_LIKE... Sizes>
+    TensorView<scalar, sizeof...(Sizes)> make_tensor(Sizes... shape)
+    {
+      static_assert(std::is_trivially_destructible_v<scalar>, "the arena never runs destructors.");
+      const size_t n = (size_t(1) * ... * (size_t)shape);
+      scalar *data = static_cast<scalar *>(allocate(n * sizeof(scalar), alignof(scalar) > 16 ? alignof(scalar) : 16));
+      return TensorView<scalar, sizeof...(Sizes)>(data, shape...);
+    }
+
+    /// @brief returns the arena of the calling thread.
+    static Arena &thread_local_arena()
+    {
+      thread_local Arena arena;
+      return arena;
+    }
+
+  private:
+    struct Block
+    {
+      char *data;
+      size_t size;
+    };
+
+    size_t _block_size;
+    Marker current;
+    std::vector<Block> blocks;
+  };
+
+  /**
+   * @brief pool of blocks in power of two size classes.
+   *
+   * @details Deallocated blocks are kept on a free list of their size class
+   * and handed out again by the next allocation of that class, so a loop
+   * which repeatedly creates and destroys temporaries of the same shapes
+   * stops calling `malloc` after the first iteration. Every block is 64
+   * byte aligned.
+   *
+   * A pool is not thread safe. Use `Pool::thread_local_pool()` to get a pool
+   * per thread. Blocks may be returned to a different pool than the one which
+   * allocated them.
+   */
+  class Pool
+  {
+  public:
+    Pool() = default;
+
+    ~Pool()
+    {
+      release();
+    }
+
+    Pool(const Pool &) = delete;
+    Pool &operator=(const Pool &) = delete;
+
+    /// @brief returns a 64 byte aligned block of at least `bytes` bytes.
+    inline void *allocate(size_t bytes)
+    {
+      auto &list = free_lists[size_class(bytes)];
+      if (!list.empty())
+      {
+        void *ptr = list.back();
+        list.pop_back();
+        return ptr;
+      }
+      return ::operator new(class_size(size_class(bytes)), std::align_val_t(cache_line_alignment));
+    }
+
+    /// @brief returns a block of `bytes` bytes to its free list.
+    inline void deallocate(void *ptr, size_t bytes)
+    {
+      free_lists[size_class(bytes)].push_back(ptr);
+    }
+
+    /// @brief returns the blocks on the free lists to the system.
+    inline void release()
+    {
+      for (auto &list : free_lists)
+      {
+        for (void *ptr : list)
+          ::operator delete(ptr, std::align_val_t(cache_line_alignment));
+        list.clear();
+      }
+    }
+
+    /// @brief returns the pool of the calling thread.
+    static Pool &thread_local_pool()
+    {
+      thread_local Pool pool;
+      return pool;
+    }
+
+  private:
+    static constexpr size_t min_class = 6; // 64 bytes
+    static constexpr size_t num_classes = 8 * sizeof(size_t) - min_class;
+
+    std::vector<void *> free_lists[num_classes];
+
+    static size_t size_class(size_t bytes)
+    {
+      size_t c = 0;
+      while ((size_t(1) << (c + min_class)) < bytes)
+        ++c;
+      return c;
+    }
+
+    static size_t class_size(size_t c)
+    {
+      return size_t(1) << (c + min_class);
+    }
+  };
+
+  /// @brief allocator which places the elements of a container in an
+  /// `Arena`, by default the arena of the constructing thread. Can be used
+  /// as the `Allocator` of `Tensor`.
+  template <typename T>
+  class ArenaAllocator
+  {
+  public:
+    using value_type = T;
+
+    ArenaAllocator() noexcept : arena(&Arena::thread_local_arena()) {}
+
+    explicit ArenaAllocator(Arena &arena_) noexcept : arena(&arena_) {}
+
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U> &other) noexcept : arena(other.arena) {}
+
+    T *allocate(size_t n)
+    {
+      return static_cast<T *>(arena->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T *ptr, size_t n) noexcept
+    {
+      arena->deallocate(ptr, n * sizeof(T));
+    }
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U> &other) const noexcept
+    {
+      return arena == other.arena;
+    }
+
+    template <typename U>
+    bool operator!=(const ArenaAllocator<U> &other) const noexcept
+    {
+      return arena != other.arena;
+    }
+
+  private:
+    template <typename U>
+    friend class ArenaAllocator;
+
+    Arena *arena;
+  };
+
+  /// @brief allocator which takes blocks from a `Pool`, by default the pool
+  /// of the constructing thread. Can be used as the `Allocator` of `Tensor`.
+  template <typename T>
+  class PoolAllocator
+  {
+  public:
+    using value_type = T;
+
+    PoolAllocator() noexcept : pool(&Pool::thread_local_pool()) {}
+
+    explicit PoolAllocator(Pool &pool_) noexcept : pool(&pool_) {}
+
+    template <typename U>
+    PoolAllocator(const PoolAllocator<U> &other) noexcept : pool(other.pool) {}
+
+    T *allocate(size_t n)
+    {
+      return static_cast<T *>(pool->allocate(n * sizeof(T)));
+    }
+
+    void deallocate(T *ptr, size_t n) noexcept
+    {
+      pool->deallocate(ptr, n * sizeof(T));
+    }
+
+    template <typename U>
+    bool operator==(const PoolAllocator<U> &other) const noexcept
+    {
+      return pool == other.pool;
+    }
+
+    template <typename U>
+    bool operator!=(const PoolAllocator<U> &other) const noexcept
+    {
+      return pool != other.pool;
+    }
+
+  private:
+    template <typename U>
+    friend class PoolAllocator;
+
+    Pool *pool;
+  };
+} // namespace tensor
+
+#endif
@@ -0,0 +1,571 @@
+#ifndef __TENSOR_VIEW_CHUNKED_HPP__
+#define __TENSOR_VIEW_CHUNKED_HPP__
+
+#include "tensorview_config.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <future>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include "errors.hpp"
+#include "span.hpp"
+#include "Tensor.hpp"
+#include "mapped_file.hpp"
+
+namespace tensor
+{
+  namespace details
+  {
+    inline constexpr char chunked_file_magic[8] = {'T', 'E', 'N', 'S', 'O', 'R', 'C', 'K'};
+
+    // tiles start at a page boundary so that each read is page aligned.
+    inline constexpr uint32_t chunked_file_alignment = 4096;
+
+    template <typename scalar, size_t Rank, size_t... I>
+    inline Tensor<scalar, Rank> make_tile(const std::array<index_t, Rank> &tile, std::index_sequence<I...>)
+    {
+      return Tensor<scalar, Rank>(uninitialized, tile[I]...);
+    }
+  } // namespace details
+
+  /**
+   * @brief tensor stored on disk as a grid of fixed-shape tiles, of which
+   * at most `cache_tiles` are held in memory at once.
+   *
+   * @details Tiles are column-major `Tensor`s of shape `tile_shape()`; tiles
+   * on the upper edges of the tensor are stored at full size and only their
+   * leading part is visible. Accesses load tiles on demand and evict the
+   * least recently used tile when the cache is full, writing it back if it
+   * was accessed for writing. Accesses through a const `ChunkedTensor` only
+   * read, so read only passes over a mutable tensor (e.g. through
+   * `std::as_const(x)`) write nothing back. After every access the next tiles
+   * along the traversal order (see `traversal`) are read asynchronously.
+   *
+   * Views returned by `at`, `tile` and `for_each_tile` are `SubView`s of
+   * the cached tiles, so kernels written for tensors work on them
+   * unchanged. A view stays valid until its tile is evicted, i.e. until
+   * `cache_tiles` other tiles have been accessed or prefetched.
+   *
+   * Use `create_chunked` and `open_chunked` to construct a `ChunkedTensor`.
+   *
+   * @tparam scalar the element type. A const type opens the file read only.
+   */
+  template <typename scalar, size_t Rank>
+  class ChunkedTensor
+  {
+  public:
+    using value_type = scalar;
+    using tile_type = Tensor<std::remove_const_t<scalar>, Rank>;
+
+    ChunkedTensor(int fd, const std::string &path, const std::array<index_t, Rank> &extents, const std::array<index_t, Rank> &tile, uint64_t data_offset, index_t cache_tiles)
+        : _file{fd}, _path(path), _extents(extents), _tile(tile), _data_offset(data_offset), _capacity(cache_tiles)
+    {
+      if (_capacity == 0)
+        tensor_out_of_range("a ChunkedTensor must cache at least one tile.");
+
+      _tile_size = 1;
+      _num_tiles = 1;
+      for (index_t d = 0; d < Rank; ++d)
+      {
+        _grid[d] = (_extents[d] + _tile[d] - 1) / _tile[d];
+        _tile_size *= _tile[d];
+        _num_tiles *= _grid[d];
+        _order[d] = d;
+      }
+    }
+
+    ChunkedTensor(const ChunkedTensor &) = delete;
+    ChunkedTensor &operator=(const ChunkedTensor &) = delete;
+
+    /// @brief writes back modified tiles. Call `flush()` beforehand to
+    /// observe write errors, which are ignored here.
+    ~ChunkedTensor()
+    {
+      try
+      {
+        flush();
+      }
+      catch (...)
+      {
+      }
+      for (auto &entry : _lru)
+        if (entry.pending.valid())
+          entry.pending.wait();
+    }
+
+    /// @brief returns the shape of the tensor.
+    const std::array<index_t, Rank> &shape() const
+    {
+      return _extents;
+    }
+
+    /// @brief returns the extent of dimension d.
+    index_t shape(index_t d) const
+    {
+      return _extents[d];
+    }
+
+    /// @brief returns the shape of a tile.
+    const std::array<index_t, Rank> &tile_shape() const
+    {
+      return _tile;
+    }
+
+    /// @brief returns the number of tiles along each dimension.
+    const std::array<index_t, Rank> &grid() const
+    {
+      return _grid;
+    }
+
+    /// @brief returns the total number of elements.
+    index_t size() const
+    {
+      index_t n = 1;
+      for (index_t e : _extents)
+        n *= e;
+      return n;
+    }
+
+    /// @brief returns the number of tiles.
+    index_t num_tiles() const
+    {
+      return _num_tiles;
+    }
+
+    /// @brief returns the maximum number of tiles held in memory.
+    index_t cache_capacity() const
+    {
+      return _capacity;
+    }
+
+    /// @brief returns the number of tiles currently held in memory.
+    index_t resident_tiles() const
+    {
+      return _lru.size();
+    }
+
+    /**
+     * @brief declares the order in which the tiles will be traversed.
+     *
+     * @param order the dimensions of the tile grid from the fastest to the
+     * slowest varying, e.g. {0, 1, ...} (the default) for column-major.
+     * @param prefetch the number of tiles read ahead after every access. It
+     * is limited to `cache_capacity() - 1`.
+     */
+    void traversal(const std::array<index_t, Rank> &order, index_t prefetch = 1)
+    {
+      std::array<bool, Rank> seen{};
+      for (index_t d : order)
+      {
+        if (d >= Rank || seen[d])
+          tensor_out_of_range("the traversal order must be a permutation of the dimensions.");
+        seen[d] = true;
+      }
+      _order = order;
+      _prefetch = prefetch;
+    }
+
+    /**
+     * @brief high dimensional access within a single tile.
+     *
+     * @tparam Indices `span`, `all`, or convertible to `index_t`. The indices
+     * are global; all of them must fall within the same tile.
+     * @return a reference to the element if all indices are integers,
+     * otherwise a `SubView` of the cached tile.
+     */
+    template <typename... Indices>
+    decltype(auto) at(Indices... indices)
+    {
+      static_assert(sizeof...(Indices) == Rank, "the number of indices must match the rank of the tensor.");
+      return at_tile<!std::is_const_v<scalar>>(std::make_index_sequence<Rank>{}, indices...);
+    }
+
+    /// @brief read only access within a single tile, see `at`. The tile is
+    /// not written back on eviction unless it is modified elsewhere.
+    template <typename... Indices>
+    decltype(auto) at(Indices... indices) const
+    {
+      static_assert(sizeof...(Indices) == Rank, "the number of indices must match the rank of the tensor.");
+      return at_tile<false>(std::make_index_sequence<Rank>{}, indices...);
+    }
+
+    /// @brief returns the visible part of the tile at tile coordinates t.
+    auto tile(const std::array<index_t, Rank> &t)
+    {
+      return tile_view<!std::is_const_v<scalar>>(t);
+    }
+
+    /// @brief returns a read only view of the visible part of the tile at
+    /// tile coordinates t.
+    auto tile(const std::array<index_t, Rank> &t) const
+    {
+      return tile_view<false>(t);
+    }
+
+    /**
+     * @brief calls f(view, offset) for every tile in the traversal order,
+     * where view is the visible part of the tile and offset is the global
+     * index of its first element.
+     */
+    template <typename Func>
+    void for_each_tile(Func &&f)
+    {
+      visit_tiles<!std::is_const_v<scalar>>(f);
+    }
+
+    /// @brief calls f(view, offset) for every tile with read only views.
+    template <typename Func>
+    void for_each_tile(Func &&f) const
+    {
+      visit_tiles<false>(f);
+    }
+
+    /// @brief starts reading the tile at tile coordinates t if it is not resident.
+    void prefetch(const std::array<index_t, Rank> &t) const
+    {
+      const index_t id = tile_id(t);
+      if (_index.count(id))
+        return;
+      insert(id);
+    }
+
+    /// @brief writes all modified tiles back to the file.
+    void flush()
+    {
+      for (auto &entry : _lru)
+        write_back(entry);
+    }
+
+  private:
+    struct tile_entry
+    {
+      index_t id;
+      tile_type data;
+      std::future<void> pending;
+      bool dirty = false;
+    };
+
+    details::file_descriptor _file;
+    std::string _path;
+    std::array<index_t, Rank> _extents;
+    std::array<index_t, Rank> _tile;
+    std::array<index_t, Rank> _grid;
+    std::array<index_t, Rank> _order;
+    uint64_t _data_offset;
+    index_t _tile_size;
+    index_t _num_tiles;
+    index_t _capacity;
+    index_t _prefetch = 1;
+
+    // most recently used first. The cache is mutable so that const
+    // accesses can load tiles.
+    mutable std::list<tile_entry> _lru;
+    mutable std::unordered_map<index_t, typename std::list<tile_entry>::iterator> _index;
+
+    template <bool Write, size_t... I, typename... Indices>
+    decltype(auto) at_tile(std::index_sequence<I...>, Indices... indices) const
+    {
+      const std::array<index_t, Rank> t = {tile_of(indices, I)...};
+      tile_type &x = fetch(t, Write);
+      if constexpr (Write)
+        return x.at(local(indices, t, I)...);
+      else
+        return std::as_const(x).at(local(indices, t, I)...);
+    }
+
+    template <bool Write>
+    auto tile_view(const std::array<index_t, Rank> &t) const
+    {
+      for (index_t d = 0; d < Rank; ++d)
+        if (t[d] >= _grid[d])
+          tensor_out_of_range("tile index exceeds the tile grid.");
+
+      tile_type &x = fetch(t, Write);
+      std::array<index_t, Rank> visible;
+      for (index_t d = 0; d < Rank; ++d)
+        visible[d] = std::min(_tile[d], _extents[d] - t[d] * _tile[d]);
+
+      if constexpr (Write)
+        return visible_part(x, visible, std::make_index_sequence<Rank>{});
+      else
+        return visible_part(std::as_const(x), visible, std::make_index_sequence<Rank>{});
+    }
+
+    template <bool Write, typename Func>
+    void visit_tiles(Func &f) const
+    {
+      std::array<index_t, Rank> t{};
+      do
+      {
+        std::array<index_t, Rank> offset;
+        for (index_t d = 0; d < Rank; ++d)
+          offset[d] = t[d] * _tile[d];
+        f(tile_view<Write>(t), offset);
+      } while (next_tile(t));
+    }
+
+    template <typename T, size_t... I>
+    static auto visible_part(T &x, const std::array<index_t, Rank> &visible, std::index_sequence<I...>)
+    {
+      return x.at(span(0, visible[I])...);
+    }
+
+    index_t tile_id(const std::array<index_t, Rank> &t) const
+    {
+      index_t id = 0;
+      for (index_t d = Rank; d > 0; --d)
+        id = id * _grid[d - 1] + t[d - 1];
+      return id;
+    }
+
+    uint64_t tile_offset(index_t id) const
+    {
+      return _data_offset + uint64_t(id) * _tile_size * sizeof(scalar);
+    }
+
+    // advances t to the next tile in the traversal order.
+    bool next_tile(std::array<index_t, Rank> &t) const
+    {
+      for (index_t k = 0; k < Rank; ++k)
+      {
+        const index_t d = _order[k];
+        if (++t[d] < _grid[d])
+          return true;
+        t[d] = 0;
+      }
+      return false;
+    }
+
+    index_t tile_of(index_t i, index_t d) const
+    {
+      if (i >= _extents[d])
+        tensor_out_of_range("index exceeds the shape of the ChunkedTensor.");
+      return i / _tile[d];
+    }
+
+    index_t tile_of(const span &s, index_t d) const
+    {
+      if (s.size() == 0)
+        return 0;
+      const index_t first = s.begin;
+      const index_t last = s.begin + (s.size() - 1) * s.stride;
+      const index_t lo = std::min(first, last), hi = std::max(first, last);
+      if (hi >= _extents[d])
+        tensor_out_of_range("span exceeds the shape of the ChunkedTensor.");
+      if (lo / _tile[d] != hi / _tile[d])
+        tensor_out_of_range("span crosses a tile boundary of the ChunkedTensor.");
+      return lo / _tile[d];
+    }
+
+    index_t tile_of(all, index_t d) const
+    {
+      if (_grid[d] != 1)
+        tensor_out_of_range("all{} spans more than one tile of the ChunkedTensor.");
+      return 0;
+    }
+
+    index_t local(index_t i, const std::array<index_t, Rank> &t, index_t d) const
+    {
+      return i - t[d] * _tile[d];
+    }
+
+    span local(const span &s, const std::array<index_t, Rank> &t, index_t d) const
+    {
+      const index_t o = t[d] * _tile[d];
+      return span(s.begin - o, s.end - o, s.stride);
+    }
+
+    span local(all, const std::array<index_t, Rank> &, index_t d) const
+    {
+      return span(0, _extents[d]);
+    }
+
+    void write_back(tile_entry &entry) const
+    {
+      if (!entry.dirty)
+        return;
+      if (entry.pending.valid())
+        entry.pending.get();
+      details::pwrite_all(_file.fd, entry.data.data(), _tile_size * sizeof(scalar), tile_offset(entry.id), _path);
+      entry.dirty = false;
+    }
+
+    void evict() const
+    {
+      auto &entry = _lru.back();
+      if (entry.pending.valid())
+        entry.pending.wait();
+      write_back(entry);
+      _index.erase(entry.id);
+      _lru.pop_back();
+    }
+
+    // starts reading tile id into a new cache entry.
+    tile_entry &insert(index_t id) const
+    {
+      if (_lru.size() >= _capacity)
+        evict();
+
+      auto &entry = _lru.emplace_front(tile_entry{id, details::make_tile<std::remove_const_t<scalar>, Rank>(_tile, std::make_index_sequence<Rank>{}), {}});
+      _index[id] = _lru.begin();
+
+      auto *buf = entry.data.data();
+      const int fd = _file.fd;
+      const size_t bytes = _tile_size * sizeof(scalar);
+      const uint64_t offset = tile_offset(id);
+      const std::string &path = _path;
+      entry.pending = std::async(std::launch::async, [=]()
+                                 { details::read_all(fd, buf, bytes, offset, path); });
+      return entry;
+    }
+
+    // returns the resident tile t, loading it if necessary, and prefetches
+    // the tiles which follow it. The tile is written back on eviction if
+    // `write`. A tile whose read failed is dropped from the cache, so that
+    // the next access reads it again.
+    tile_type &fetch(std::array<index_t, Rank> t, bool write) const
+    {
+      const index_t id = tile_id(t);
+      auto it = _index.find(id);
+      if (it == _index.end())
+        insert(id);
+      else
+        _lru.splice(_lru.begin(), _lru, it->second);
+
+      tile_entry &entry = _lru.front();
+      if (entry.pending.valid())
+      {
+        try
+        {
+          entry.pending.get();
+        }
+        catch (...)
+        {
+          _index.erase(id);
+          _lru.pop_front();
+          throw;
+        }
+      }
+      entry.dirty = entry.dirty || write;
+
+      const index_t ahead = std::min(_prefetch, _capacity - 1);
+      for (index_t k = 0; k < ahead && next_tile(t); ++k)
+        prefetch(t);
+
+      return entry.data;
+    }
+  };
+
+  /**
+   * @brief creates a zero filled chunked tensor file of the given shape,
+   * stored as tiles of shape `tile`, and opens it for reading and writing.
+   *
+   * @param cache_tiles the number of tiles held in memory.
+   */
+  template <typename scalar, size_t Rank>
+  inline ChunkedTensor<scalar, Rank> create_chunked(const std::string &path, const std::array<index_t, Rank> &extents, const std::array<index_t, Rank> &tile, index_t cache_tiles)
+  {
+    static_assert(!std::is_const_v<scalar>, "create_chunked requires a mutable element type.");
+
+    uint64_t num_tiles = 1, tile_size = 1;
+    std::array<uint64_t, 2 * Rank> dims;
+    for (index_t d = 0; d < Rank; ++d)
+    {
+      if (extents[d] == 0 || tile[d] == 0)
+        tensor_bad_shape();
+      num_tiles *= (extents[d] + tile[d] - 1) / tile[d];
+      tile_size *= tile[d];
+      dims[d] = extents[d];
+      dims[Rank + d] = tile[d];
+    }
+
+    const int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+      tensor_file_error(path, std::strerror(errno));
+    details::file_descriptor file{fd};
+
+    // the header of a tensor file with the tile shape appended to the shape.
+    details::tensor_file_header h;
+    std::memcpy(h.magic, details::chunked_file_magic, sizeof(h.magic));
+    h.version = details::tensor_file_version;
+    h.dtype = details::dtype_code<scalar>::value;
+    h.element_size = sizeof(scalar);
+    h.rank = Rank;
+    h.layout = 0;
+    h.alignment = details::chunked_file_alignment;
+    const uint64_t header_size = sizeof(h) + dims.size() * sizeof(uint64_t);
+    h.data_offset = (header_size + h.alignment - 1) / h.alignment * h.alignment;
+
+    std::vector<char> buf(h.data_offset, 0);
+    std::memcpy(buf.data(), &h, sizeof(h));
+    std::memcpy(buf.data() + sizeof(h), dims.data(), dims.size() * sizeof(uint64_t));
+    details::write_all(fd, buf.data(), buf.size(), path);
+
+    if (::ftruncate(fd, h.data_offset + num_tiles * tile_size * sizeof(scalar)) != 0)
+      tensor_file_error(path, std::strerror(errno));
+
+    file.fd = -1;
+    return ChunkedTensor<scalar, Rank>(fd, path, extents, tile, h.data_offset, cache_tiles);
+  }
+
+  /**
+   * @brief opens a chunked tensor file created by `create_chunked`.
+   *
+   * @tparam scalar the element type. Use a const type to open the file read only.
+   * @param cache_tiles the number of tiles held in memory.
+   */
+  template <typename scalar, size_t Rank>
+  inline ChunkedTensor<scalar, Rank> open_chunked(const std::string &path, index_t cache_tiles)
+  {
+    using T = std::remove_const_t<scalar>;
+    const int fd = ::open(path.c_str(), std::is_const_v<scalar> ? O_RDONLY : O_RDWR);
+    if (fd < 0)
+      tensor_file_error(path, std::strerror(errno));
+    details::file_descriptor file{fd};
+
+    details::tensor_file_header h;
+    std::array<uint64_t, 2 * Rank> dims;
+    details::read_all(fd, &h, sizeof(h), 0, path);
+    if (std::memcmp(h.magic, details::chunked_file_magic, sizeof(h.magic)) != 0)
+      tensor_file_error(path, "not a chunked tensor file.");
+    if (h.version != details::tensor_file_version)
+      tensor_file_error(path, "unsupported tensor file version " + std::to_string(h.version) + ".");
+    if (h.dtype != details::dtype_code<T>::value || h.element_size != sizeof(T))
+      tensor_file_error(path, "the file stores a different element type.");
+    if (h.rank != Rank)
+      tensor_file_error(path, "the file stores a tensor of rank " + std::to_string(h.rank) + ".");
+    details::read_all(fd, dims.data(), dims.size() * sizeof(uint64_t), sizeof(h), path);
+
+    std::array<index_t, Rank> extents, tile;
+    uint64_t num_tiles = 1, tile_size = 1;
+    for (index_t d = 0; d < Rank; ++d)
+    {
+      extents[d] = dims[d];
+      tile[d] = dims[Rank + d];
+      if (extents[d] == 0 || tile[d] == 0)
+        tensor_file_error(path, "malformed chunked tensor header.");
+      num_tiles *= (extents[d] + tile[d] - 1) / tile[d];
+      tile_size *= tile[d];
+    }
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0)
+      tensor_file_error(path, std::strerror(errno));
+    if ((uint64_t)st.st_size < h.data_offset + num_tiles * tile_size * sizeof(T))
+      tensor_file_error(path, "the file is truncated.");
+
+    file.fd = -1;
+    return ChunkedTensor<scalar, Rank>(fd, path, extents, tile, h.data_offset, cache_tiles);
+  }
+} // namespace tensor
+
+#endif // unix
+
+#endif
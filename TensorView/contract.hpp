@@ -0,0 +1,584 @@
+#ifndef __TENSOR_VIEW_CONTRACT_HPP__
+#define __TENSOR_VIEW_CONTRACT_HPP__
+
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <utility>
+
+#include "tensorview_config.hpp"
+#include "errors.hpp"
+#include "profile.hpp"
+#include "Tensor.hpp"
+#include "parallel.hpp"
+#include "matmul.hpp"
+#include "fixed_linalg.hpp"
+
+namespace tensor::details
+{
+  /// @brief the most distinct indices a contraction may have.
+  inline constexpr size_t contract_max_labels = 16;
+
+  /// @brief a contraction `"ikl,kjl->ij"` parsed at compile time. Each
+  /// distinct index letter is numbered in order of first appearance, and
+  /// `label[op][d]` is the number of the index of dimension d of operand op
+  /// (0 = A, 1 = B, 2 = the result).
+  struct contraction_spec
+  {
+    bool valid;
+    size_t n_labels;
+    char labels[contract_max_labels];
+    size_t rank[3];
+    size_t label[3][contract_max_labels];
+
+    constexpr bool has(size_t op, size_t u) const
+    {
+      for (size_t d = 0; d < rank[op]; ++d)
+        if (label[op][d] == u)
+          return true;
+      return false;
+    }
+  };
+
+  constexpr bool is_contraction_label(char c)
+  {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+  }
+
+  /// @brief parses `"A,B->C"` where A, B and C are strings of index letters.
+  /// Without `->`, the result has the indices which appear once in A and B,
+  /// in alphabetical order, as in `numpy.einsum`.
+  constexpr contraction_spec parse_contraction(const char *s)
+  {
+    contraction_spec spec{};
+    spec.valid = true;
+    size_t op = 0;
+    bool arrow = false;
+    for (const char *p = s; *p != '\0' && spec.valid; ++p)
+    {
+      const char c = *p;
+      if (c == ' ')
+        continue;
+      if (c == ',')
+      {
+        spec.valid = (op == 0);
+        op = 1;
+        continue;
+      }
+      if (c == '-' && p[1] == '>')
+      {
+        spec.valid = (op == 1);
+        arrow = true;
+        op = 2;
+        ++p;
+        continue;
+      }
+      if (!is_contraction_label(c) || spec.rank[op] == contract_max_labels)
+      {
+        spec.valid = false;
+        break;
+      }
+
+      size_t u = 0;
+      while (u < spec.n_labels && spec.labels[u] != c)
+        ++u;
+      if (u == spec.n_labels)
+      {
+        // every index of the result must be an index of A or B
+        if (op == 2 || spec.n_labels == contract_max_labels)
+        {
+          spec.valid = false;
+          break;
+        }
+        spec.labels[spec.n_labels++] = c;
+      }
+
+      // an index may appear once per operand (no diagonals)
+      if (spec.has(op, u))
+        spec.valid = false;
+      spec.label[op][spec.rank[op]++] = u;
+    }
+
+    if (op == 0)
+      spec.valid = false;
+
+    if (spec.valid && !arrow)
+    {
+      for (char c = 'A'; c <= 'z'; ++c)
+      {
+        for (size_t u = 0; u < spec.n_labels; ++u)
+          if (spec.labels[u] == c && spec.has(0, u) != spec.has(1, u))
+            spec.label[2][spec.rank[2]++] = u;
+      }
+    }
+    return spec;
+  }
+
+#if __cplusplus >= 202002L
+  /// @brief a string literal as a template argument, e.g. `contract<"ij,jk->ik">`.
+  template <size_t N>
+  struct fixed_string
+  {
+    char chars[N];
+
+    constexpr fixed_string(const char (&s)[N])
+    {
+      for (size_t i = 0; i < N; ++i)
+        chars[i] = s[i];
+    }
+  };
+
+  template <fixed_string Spec>
+  struct contraction_of
+  {
+    static constexpr contraction_spec value = parse_contraction(Spec.chars);
+  };
+#else
+  template <const char *Spec>
+  struct contraction_of
+  {
+    static constexpr contraction_spec value = parse_contraction(Spec);
+  };
+#endif
+
+  /// @brief the size and the stride in A, B and C of every index of a
+  /// contraction. The stride of an index in an operand without it is zero.
+  template <size_t L>
+  struct contraction_dims
+  {
+    std::array<index_t, L> size;
+    std::array<stride_t, L> stride[3];
+    std::array<bool, L> in[3];
+  };
+
+  /// @brief contractions whose matrix product part has at most this many
+  /// multiplications are computed by loops, not by `matmul` kernels.
+  inline constexpr index_t contract_gemm_size = gemm_small_size;
+
+  // one index of a matrix product, made of one or more indices of the
+  // contraction which are contiguous with each other in every operand.
+  struct contraction_group
+  {
+    index_t size = 1;
+    stride_t stride[3] = {0, 0, 0};
+  };
+
+  // merges the indices for which in[op0] && in[op1] && !in[other] into one
+  // index of a matrix product if their strides allow it. Otherwise the
+  // largest of them is used and the others are appended to loops.
+  template <size_t L>
+  inline contraction_group group_indices(const contraction_dims<L> &dims, size_t op0, size_t op1, std::array<size_t, L> &loops, size_t &n_loops)
+  {
+    const size_t other = 3 - op0 - op1;
+    std::array<size_t, L> g{};
+    size_t n = 0;
+    for (size_t u = 0; u < L; ++u)
+      if (dims.in[op0][u] && dims.in[op1][u] && !dims.in[other][u] && dims.size[u] > 1)
+        g[n++] = u;
+
+    contraction_group group;
+    if (n == 0)
+      return group;
+
+    std::sort(g.begin(), g.begin() + n, [&](size_t a, size_t b)
+              { return std::abs(dims.stride[op0][a]) < std::abs(dims.stride[op0][b]); });
+
+    bool mergeable = true;
+    for (size_t i = 1; i < n; ++i)
+      for (size_t op : {op0, op1})
+        mergeable = mergeable && dims.stride[op][g[i]] == dims.stride[op][g[i - 1]] * (stride_t)dims.size[g[i - 1]];
+
+    if (mergeable)
+    {
+      for (size_t i = 0; i < n; ++i)
+        group.size *= dims.size[g[i]];
+      for (size_t op : {op0, op1})
+        group.stride[op] = dims.stride[op][g[0]];
+      return group;
+    }
+
+    size_t largest = 0;
+    for (size_t i = 1; i < n; ++i)
+      if (dims.size[g[i]] > dims.size[g[largest]])
+        largest = i;
+    for (size_t i = 0; i < n; ++i)
+      if (i != largest)
+        loops[n_loops++] = g[i];
+
+    group.size = dims.size[g[largest]];
+    for (size_t op : {op0, op1})
+      group.stride[op] = dims.stride[op][g[largest]];
+    return group;
+  }
+
+  // the offsets into A, B and C of the t-th combination of the indices
+  // loops[0, n), the first varying fastest.
+  template <size_t L>
+  inline void contraction_offsets(const contraction_dims<L> &dims, const std::array<size_t, L> &loops, size_t n, index_t t, stride_t (&offset)[3])
+  {
+    offset[0] = offset[1] = offset[2] = 0;
+    for (size_t i = 0; i < n; ++i)
+    {
+      const size_t u = loops[i];
+      const index_t k = t % dims.size[u];
+      t /= dims.size[u];
+      for (size_t op = 0; op < 3; ++op)
+        offset[op] += (stride_t)k * dims.stride[op][u];
+    }
+  }
+
+  // calls f(offset) for every combination of the indices order[0, n - 1),
+  // the last varying fastest. order[n - 1] is the innermost loop, which f
+  // runs itself.
+  template <size_t L, typename F>
+  inline void contraction_loops(const contraction_dims<L> &dims, const std::array<size_t, L> &order, size_t n, F &&f)
+  {
+    std::array<index_t, L> idx{};
+    stride_t offset[3] = {0, 0, 0};
+    for (;;)
+    {
+      f(offset);
+      for (size_t d = (n > 0) ? n - 1 : 0;;)
+      {
+        if (d == 0)
+          return;
+        --d;
+        const size_t u = order[d];
+        for (size_t op = 0; op < 3; ++op)
+          offset[op] += dims.stride[op][u];
+        if (++idx[d] < dims.size[u])
+          break;
+        for (size_t op = 0; op < 3; ++op)
+          offset[op] -= (stride_t)dims.size[u] * dims.stride[op][u];
+        idx[d] = 0;
+      }
+    }
+  }
+
+  // zeros C, looping over the indices of C among order[0, n) in that order.
+  template <size_t L, typename T>
+  inline void contract_zero(const contraction_dims<L> &dims, const std::array<size_t, L> &order, size_t n, T *c)
+  {
+    std::array<size_t, L> out{};
+    size_t n_out = 0;
+    for (size_t i = 0; i < n; ++i)
+      if (dims.in[2][order[i]])
+        out[n_out++] = order[i];
+    const index_t len_c = (n_out > 0) ? dims.size[out[n_out - 1]] : 1;
+    const stride_t sc_c = (n_out > 0) ? dims.stride[2][out[n_out - 1]] : 0;
+    contraction_loops(dims, out, n_out, [&](const stride_t(&o)[3])
+                      {
+                        for (index_t k = 0; k < len_c; ++k)
+                          c[o[2] + (stride_t)k * sc_c] = T(0); });
+  }
+
+  // C = A * B by nested loops, ordered so that the index with the smallest
+  // strides is innermost.
+  template <size_t L, typename T, typename TA, typename TB>
+  inline void contract_loops(const contraction_dims<L> &dims, T *c, const TA *a, const TB *b)
+  {
+    std::array<size_t, L> order{};
+    size_t n = 0;
+    for (size_t u = 0; u < L; ++u)
+      if (dims.size[u] > 1)
+        order[n++] = u;
+
+    auto cost = [&](size_t u)
+    { return std::abs(dims.stride[0][u]) + std::abs(dims.stride[1][u]) + std::abs(dims.stride[2][u]); };
+    std::sort(order.begin(), order.begin() + n, [&](size_t x, size_t y)
+              { return cost(x) > cost(y); });
+
+    // zero C, then accumulate
+    contract_zero(dims, order, n, c);
+
+    const size_t inner = (n > 0) ? order[n - 1] : 0;
+    const index_t len = (n > 0) ? dims.size[inner] : 1;
+    const stride_t sa = (n > 0) ? dims.stride[0][inner] : 0;
+    const stride_t sb = (n > 0) ? dims.stride[1][inner] : 0;
+    const stride_t sc = (n > 0) ? dims.stride[2][inner] : 0;
+    const int kind = (sc == 0) ? 0 : (sc == 1 && sa == 1 && sb == 0) ? 1 : (sc == 1 && sa == 0 && sb == 1) ? 2 : (sc == 1 && sa == 1 && sb == 1) ? 3 : 4;
+    contraction_loops(dims, order, n, [&](const stride_t(&o)[3])
+                      {
+                        const TA *pa = a + o[0];
+                        const TB *pb = b + o[1];
+                        T *pc = c + o[2];
+                        // the unit stride cases are written out so that they vectorize
+                        switch (kind)
+                        {
+                        case 0:
+                        {
+                          T acc = 0;
+                          for (index_t k = 0; k < len; ++k)
+                            acc += pa[(stride_t)k * sa] * pb[(stride_t)k * sb];
+                          *pc += acc;
+                          break;
+                        }
+                        case 1:
+                          for (index_t k = 0; k < len; ++k)
+                            pc[k] += pa[k] * pb[0];
+                          break;
+                        case 2:
+                          for (index_t k = 0; k < len; ++k)
+                            pc[k] += pa[0] * pb[k];
+                          break;
+                        case 3:
+                          for (index_t k = 0; k < len; ++k)
+                            pc[k] += pa[k] * pb[k];
+                          break;
+                        default:
+                          for (index_t k = 0; k < len; ++k)
+                            pc[(stride_t)k * sc] += pa[(stride_t)k * sa] * pb[(stride_t)k * sb];
+                        } });
+  }
+
+  // C = A * B. The indices are sorted into the rows (in A and C), columns
+  // (in B and C) and inner dimension (in A and B) of a matrix product, which
+  // is computed by the `matmul` kernels for every combination of the
+  // remaining indices: batches, which select a slice of C, and sums, which
+  // accumulate into it.
+  template <size_t L, typename T, typename TA, typename TB>
+  inline void contract_gemm(const contraction_dims<L> &dims, T *c, const TA *a, const TB *b)
+  {
+    // an empty index leaves C empty, or zero if it is only summed over
+    bool empty = false, c_empty = false;
+    for (size_t u = 0; u < L; ++u)
+    {
+      empty |= dims.size[u] == 0;
+      c_empty |= dims.size[u] == 0 && dims.in[2][u];
+    }
+    if (empty)
+    {
+      if (!c_empty)
+      {
+        std::array<size_t, L> order{};
+        size_t n = 0;
+        for (size_t u = 0; u < L; ++u)
+          if (dims.in[2][u] && dims.size[u] > 1)
+            order[n++] = u;
+        contract_zero(dims, order, n, c);
+      }
+      return;
+    }
+
+    std::array<size_t, L> loops{};
+    size_t n_loops = 0;
+    const contraction_group m = group_indices(dims, 0, 2, loops, n_loops);
+    const contraction_group n = group_indices(dims, 1, 2, loops, n_loops);
+    const contraction_group k = group_indices(dims, 0, 1, loops, n_loops);
+
+    if (m.size * n.size * k.size <= contract_gemm_size)
+    {
+      contract_loops(dims, c, a, b);
+      return;
+    }
+
+    // the remaining indices: present in all three operands, or in only one
+    // of A and B
+    for (size_t u = 0; u < L; ++u)
+      if (dims.size[u] > 1 && ((dims.in[0][u] && dims.in[1][u] && dims.in[2][u]) || (!dims.in[2][u] && dims.in[0][u] != dims.in[1][u])))
+        loops[n_loops++] = u;
+
+    // batches first, then sums
+    std::stable_partition(loops.begin(), loops.begin() + n_loops, [&](size_t u)
+                          { return dims.in[2][u]; });
+    size_t n_batch_loops = 0;
+    index_t n_batch = 1, n_sum = 1;
+    for (size_t i = 0; i < n_loops; ++i)
+    {
+      if (dims.in[2][loops[i]])
+      {
+        n_batch *= dims.size[loops[i]];
+        ++n_batch_loops;
+      }
+      else
+        n_sum *= dims.size[loops[i]];
+    }
+    std::array<size_t, L> sums{};
+    for (size_t i = n_batch_loops; i < n_loops; ++i)
+      sums[i - n_batch_loops] = loops[i];
+    const size_t n_sum_loops = n_loops - n_batch_loops;
+
+    auto batch = [&](index_t t, bool parallel)
+    {
+      stride_t ob[3], os[3];
+      contraction_offsets(dims, loops, n_batch_loops, t, ob);
+      const strided_matrix<T> C{c + ob[2], m.size, n.size, m.stride[2], n.stride[2]};
+      for (index_t s = 0; s < n_sum; ++s)
+      {
+        contraction_offsets(dims, sums, n_sum_loops, s, os);
+        const strided_matrix<const TA> A{a + ob[0] + os[0], m.size, k.size, m.stride[0], k.stride[0]};
+        const strided_matrix<const TB> B{b + ob[1] + os[1], k.size, n.size, k.stride[1], n.stride[1]};
+        gemm(C, A, B, T(1), (s == 0) ? T(0) : T(1), parallel);
+      }
+    };
+
+    const index_t work = m.size * n.size * k.size * n_sum;
+    auto &exec = default_executor();
+    if (n_batch > 1 && work * n_batch >= gemm_parallel_size && exec.concurrency() > 1)
+    {
+      const index_t n_tasks = std::min<index_t>(n_batch, slabs_per_thread * exec.concurrency());
+      exec.bulk(n_tasks, [&](index_t t)
+                {
+                  for (index_t i = (n_batch * t) / n_tasks; i < (n_batch * (t + 1)) / n_tasks; ++i)
+                    batch(i, false); });
+    }
+    else
+    {
+      for (index_t i = 0; i < n_batch; ++i)
+        batch(i, n_batch == 1);
+    }
+  }
+
+  // the sizes and strides of the indices of A and B.
+  template <typename Spec, typename TA, typename TB>
+  inline auto contraction_operands(const TA &A, const TB &B)
+  {
+    constexpr contraction_spec spec = Spec::value;
+    static_assert(spec.valid, "invalid contraction: expected \"A,B->C\" with one letter per dimension, e.g. \"ikl,kjl->ij\".");
+    static_assert(spec.rank[0] == TA::order(), "the contraction has the wrong number of indices for A.");
+    static_assert(spec.rank[1] == TB::order(), "the contraction has the wrong number of indices for B.");
+
+    contraction_dims<spec.n_labels> dims{};
+    for (size_t d = 0; d < spec.rank[0]; ++d)
+    {
+      const size_t u = spec.label[0][d];
+      dims.size[u] = A.shape(d);
+      dims.stride[0][u] = A.stride(d);
+      dims.in[0][u] = true;
+    }
+    for (size_t d = 0; d < spec.rank[1]; ++d)
+    {
+      const size_t u = spec.label[1][d];
+#ifdef TENSOR_CHECK_BOUNDS
+      if (dims.in[0][u] && dims.size[u] != B.shape(d))
+        tensor_shape_mismatch();
+#endif
+      dims.size[u] = B.shape(d);
+      dims.stride[1][u] = B.stride(d);
+      dims.in[1][u] = true;
+    }
+    return dims;
+  }
+
+  template <typename Spec, typename TC, typename TA, typename TB>
+  inline void contract_into(TC &&C, const TA &A, const TB &B)
+  {
+    TENSOR_PROFILE_RANGE("tensor::contract");
+    constexpr contraction_spec spec = Spec::value;
+    auto dims = contraction_operands<Spec>(A, B);
+    static_assert(spec.rank[2] == std::decay_t<TC>::order(), "the contraction has the wrong number of indices for the result.");
+    for (size_t d = 0; d < spec.rank[2]; ++d)
+    {
+      const size_t u = spec.label[2][d];
+#ifdef TENSOR_CHECK_BOUNDS
+      if (dims.size[u] != C.shape(d))
+        tensor_shape_mismatch();
+#endif
+      dims.stride[2][u] = C.stride(d);
+      dims.in[2][u] = true;
+    }
+
+    contract_gemm(dims, C.data(), A.data(), B.data());
+  }
+
+  template <typename Spec, typename TA, typename TB, size_t... I>
+  inline auto contract_new(const TA &A, const TB &B, std::index_sequence<I...>)
+  {
+    constexpr contraction_spec spec = Spec::value;
+    using T = product_t<typename TA::value_type, typename TB::value_type>;
+
+    if constexpr (sizeof...(I) == 0)
+    {
+      // a full contraction returns a scalar
+      TENSOR_PROFILE_RANGE("tensor::contract");
+      T c;
+      contract_gemm(contraction_operands<Spec>(A, B), &c, A.data(), B.data());
+      return c;
+    }
+    else
+    {
+      // the size of the dimension of A or B with the index of dimension d of the result
+      auto size = [&](size_t d)
+      {
+        const size_t u = spec.label[2][d];
+        for (size_t e = 0; e < spec.rank[0]; ++e)
+          if (spec.label[0][e] == u)
+            return A.shape(e);
+        for (size_t e = 0; e < spec.rank[1]; ++e)
+          if (spec.label[1][e] == u)
+            return B.shape(e);
+        return index_t(0);
+      };
+
+      Tensor<T, sizeof...(I)> C(uninitialized, size(I)...);
+      contract_into<Spec>(C, A, B);
+      return C;
+    }
+  }
+} // namespace tensor::details
+
+namespace tensor
+{
+#if __cplusplus >= 202002L
+  /**
+   * @brief contracts A and B as specified by an einsum string, e.g.
+   * `C = contract<"ikl,kjl->ij">(A, B)` is `C(i, j) = sum_k,l A(i, k, l) *
+   * B(k, j, l)`.
+   *
+   * @details The specification is parsed at compile time: one letter per
+   * dimension of A, then B, then the result. Indices of both A and B which
+   * are not in the result are summed; without `->` the result has the
+   * indices which appear once, in alphabetical order. The indices are sorted
+   * into the rows, columns and inner dimension of a matrix product using the
+   * strides of the operands, which is computed by the `matmul` kernels and
+   * batched over the remaining indices. Small contractions are computed by
+   * loops ordered by stride. A, B may be any tensors with strides (`Tensor`,
+   * `TensorView`, `SubView`, `StridedView`).
+   *
+   * @return a `Tensor` with the indices of the result, or a scalar for a
+   * full contraction such as `"ij,ij->"`.
+   */
+  template <details::fixed_string Spec, typename TA, typename TB, typename = std::enable_if_t<details::is_tensor_v<TA> && details::is_tensor_v<TB>>>
+  inline auto contract(const TA &A, const TB &B)
+  {
+    using spec = details::contraction_of<Spec>;
+    return details::contract_new<spec>(A, B, std::make_index_sequence<spec::value.rank[2]>{});
+  }
+
+  /// @brief C = the contraction of A and B specified by Spec, into an
+  /// existing tensor. C must not overlap A or B.
+  template <details::fixed_string Spec, typename TC, typename TA, typename TB, typename = std::enable_if_t<details::is_tensor_v<TC> && details::is_tensor_v<TA> && details::is_tensor_v<TB>>>
+  inline void contract(TC &&C, const TA &A, const TB &B)
+  {
+    details::contract_into<details::contraction_of<Spec>>(std::forward<TC>(C), A, B);
+  }
+#else
+  /**
+   * @brief contracts A and B as specified by an einsum string with static
+   * storage duration, e.g.
+   *
+   *     static constexpr char ikl_kjl[] = "ikl,kjl->ij";
+   *     auto C = contract<ikl_kjl>(A, B);
+   *
+   * @details C++17 does not accept string literals as template arguments;
+   * with C++20 the string may be written in place, `contract<"ikl,kjl->ij">`.
+   * See the C++20 overload for the details.
+   */
+  template <const char *Spec, typename TA, typename TB, typename = std::enable_if_t<details::is_tensor_v<TA> && details::is_tensor_v<TB>>>
+  inline auto contract(const TA &A, const TB &B)
+  {
+    using spec = details::contraction_of<Spec>;
+    return details::contract_new<spec>(A, B, std::make_index_sequence<spec::value.rank[2]>{});
+  }
+
+  /// @brief C = the contraction of A and B specified by Spec, into an
+  /// existing tensor. C must not overlap A or B.
+  template <const char *Spec, typename TC, typename TA, typename TB, typename = std::enable_if_t<details::is_tensor_v<TC> && details::is_tensor_v<TA> && details::is_tensor_v<TB>>>
+  inline void contract(TC &&C, const TA &A, const TB &B)
+  {
+    details::contract_into<details::contraction_of<Spec>>(std::forward<TC>(C), A, B);
+  }
+#endif
+} // namespace tensor
+
+#endif
@@ -0,0 +1,303 @@
+#ifndef __TENSOR_VIEW_COPY_HPP__
+#define __TENSOR_VIEW_COPY_HPP__
+
+#include <algorithm>
+#include <cstring>
+
+#include "tensorview_config.hpp"
+#include "errors.hpp"
+#include "profile.hpp"
+#include "simd.hpp"
+#include "expressions.hpp"
+
+namespace tensor::details
+{
+  /// @brief edge length of the square tiles of the blocked transpose. A pair
+  /// of 32 x 32 tiles of doubles fits in a 16 KB L1 cache.
+  inline constexpr index_t copy_tile_size = 32;
+
+  // returns false so that the caller copies the block element by element.
+  template <typename T>
+  inline bool transpose_4x4(T *, stride_t, const T *, stride_t)
+  {
+    return false;
+  }
+
+#if defined(TENSOR_SIMD_AVX) || defined(TENSOR_SIMD_AVX512)
+  // copies a 4 x 4 block of doubles which is contiguous along the first
+  // index of dst and along the second index of src by transposing in
+  // registers.
+  inline bool transpose_4x4(double *dst, stride_t ld_dst, const double *src, stride_t ld_src)
+  {
+    const __m256d r0 = _mm256_loadu_pd(src);
+    const __m256d r1 = _mm256_loadu_pd(src + ld_src);
+    const __m256d r2 = _mm256_loadu_pd(src + 2 * ld_src);
+    const __m256d r3 = _mm256_loadu_pd(src + 3 * ld_src);
+
+    const __m256d t0 = _mm256_unpacklo_pd(r0, r1);
+    const __m256d t1 = _mm256_unpackhi_pd(r0, r1);
+    const __m256d t2 = _mm256_unpacklo_pd(r2, r3);
+    const __m256d t3 = _mm256_unpackhi_pd(r2, r3);
+
+    _mm256_storeu_pd(dst, _mm256_permute2f128_pd(t0, t2, 0x20));
+    _mm256_storeu_pd(dst + ld_dst, _mm256_permute2f128_pd(t1, t3, 0x20));
+    _mm256_storeu_pd(dst + 2 * ld_dst, _mm256_permute2f128_pd(t0, t2, 0x31));
+    _mm256_storeu_pd(dst + 3 * ld_dst, _mm256_permute2f128_pd(t1, t3, 0x31));
+    return true;
+  }
+#endif
+
+  /**
+   * @brief copies an na x nb block between arrays whose fast dimensions
+   * differ. dst has unit stride along a and src has unit stride along b.
+   * The block is visited in square tiles so that both the rows read from
+   * src and the rows written to dst stay in cache.
+   */
+  template <typename T>
+  inline void copy_transpose(T *dst, stride_t ldst, const T *src, stride_t lsrc, index_t na, index_t nb)
+  {
+    constexpr index_t B = copy_tile_size;
+    for (index_t jb = 0; jb < nb; jb += B)
+    {
+      const index_t je = std::min(nb, jb + B);
+      for (index_t ib = 0; ib < na; ib += B)
+      {
+        const index_t ie = std::min(na, ib + B);
+
+        index_t j = jb;
+        for (; j + 4 <= je; j += 4)
+        {
+          index_t i = ib;
+          for (; i + 4 <= ie; i += 4)
+            if (!transpose_4x4(dst + i + (stride_t)j * ldst, ldst, src + j + (stride_t)i * lsrc, lsrc))
+              break;
+          for (; i < ie; ++i)
+            for (index_t jj = j; jj < j + 4; ++jj)
+              dst[i + (stride_t)jj * ldst] = src[jj + (stride_t)i * lsrc];
+        }
+        for (; j < je; ++j)
+          for (index_t i = ib; i < ie; ++i)
+            dst[i + (stride_t)j * ldst] = src[j + (stride_t)i * lsrc];
+      }
+    }
+  }
+
+  // index of the dimension with the smallest non-trivial stride.
+  template <size_t Rank>
+  inline index_t fastest_dim(const std::array<index_t, Rank> &extents, const std::array<stride_t, Rank> &strides)
+  {
+    index_t fast = 0;
+    stride_t best = 0;
+    for (index_t d = 0; d < Rank; ++d)
+    {
+      const stride_t s = (strides[d] < 0) ? -strides[d] : strides[d];
+      if (extents[d] > 1 && (best == 0 || (s != 0 && s < best)))
+      {
+        fast = d;
+        best = s;
+      }
+    }
+    return fast;
+  }
+
+  /**
+   * @brief converts n contiguous elements of src to the element type of dst.
+   *
+   * @details Conversions between `float` and the 16 bit storage types load
+   * and store a vector register at a time (with F16C or AVX-512 for
+   * `float16`), other conversions are elementwise.
+   */
+  template <typename T, typename S>
+  inline void convert_contiguous(T *dst, const S *src, index_t n)
+  {
+    index_t i = 0;
+    if constexpr ((std::is_same_v<T, float> && is_storage_type_v<S>) || (is_storage_type_v<T> && std::is_same_v<S, float>))
+    {
+      using V = simd<float>;
+      for (; i + V::width <= n; i += V::width)
+        V::store(dst + i, V::load(src + i));
+    }
+    for (; i < n; ++i)
+      dst[i] = static_cast<T>(src[i]);
+  }
+
+  /**
+   * @brief copies between two arrays with the same extents and arbitrary
+   * strides.
+   *
+   * @details The dimension a with the smallest stride in dst is the inner
+   * loop. If src is fastest along a different dimension b, the (a, b) planes
+   * are copied with the blocked transpose. The remaining dimensions are
+   * visited in the outer loop. If the element types differ (see `convert`)
+   * contiguous runs are converted by `convert_contiguous` and there is no
+   * transpose.
+   */
+  template <typename T, size_t Rank, typename S = T>
+  inline void copy_strided(T *dst, const std::array<stride_t, Rank> &dst_strides, const S *src, const std::array<stride_t, Rank> &src_strides, const std::array<index_t, Rank> &extents)
+  {
+    const index_t a = fastest_dim(extents, dst_strides);
+    const index_t b = fastest_dim(extents, src_strides);
+    const bool transpose = std::is_same_v<T, S> && a != b && dst_strides[a] == 1 && src_strides[b] == 1;
+
+    index_t outer = 1;
+    for (index_t d = 0; d < Rank; ++d)
+      if (d != a && (!transpose || d != b))
+        outer *= extents[d];
+
+    const index_t na = extents[a];
+    const stride_t da = dst_strides[a], sa = src_strides[a];
+
+    std::array<index_t, Rank> idx{};
+    for (index_t o = 0; o < outer; ++o)
+    {
+      stride_t doff = 0, soff = 0;
+      for (index_t d = 0; d < Rank; ++d)
+      {
+        doff += (stride_t)idx[d] * dst_strides[d];
+        soff += (stride_t)idx[d] * src_strides[d];
+      }
+
+      T *pd = dst + doff;
+      const S *ps = src + soff;
+      if constexpr (std::is_same_v<T, S>)
+      {
+        if (transpose)
+          copy_transpose(pd, dst_strides[b], ps, src_strides[a], na, extents[b]);
+        else if (da == 1 && sa == 1)
+          std::copy_n(ps, na, pd);
+        else
+          for (index_t i = 0; i < na; ++i)
+            pd[(stride_t)i * da] = ps[(stride_t)i * sa];
+      }
+      else if (da == 1 && sa == 1)
+        convert_contiguous(pd, ps, na);
+      else
+        for (index_t i = 0; i < na; ++i)
+          pd[(stride_t)i * da] = ps[(stride_t)i * sa];
+
+      // advance the multi-index of the outer dimensions
+      for (index_t d = 0; d < Rank; ++d)
+      {
+        if (d == a || (transpose && d == b))
+          continue;
+        if (++idx[d] < extents[d])
+          break;
+        idx[d] = 0;
+      }
+    }
+  }
+} // namespace tensor::details
+
+namespace tensor
+{
+  /**
+   * @brief copies the elements of src into dst.
+   *
+   * @details When both tensors are contiguous with the same layout the data
+   * is copied with `memcpy`. Otherwise the strides of both tensors are
+   * compared: if their fastest dimensions differ (e.g. `src` is a `permute`
+   * or `transpose` view, or the tensors have different layouts) the copy is
+   * a cache-blocked transpose, otherwise each run along the common fastest
+   * dimension is copied in turn.
+   *
+   * @param dst `Tensor`, `TensorView`, `SubView`, `StridedView`, etc. with
+   * the same shape as src. May be a temporary view, e.g. `x.at(all(), 0)`.
+   * @param src the tensor to copy from. Must not overlap with dst.
+   */
+  template <typename Dst, typename Src, typename = std::enable_if_t<details::is_tensor_v<Dst> && details::is_tensor_v<Src>>>
+  inline void copy(Dst &&dst, const Src &src)
+  {
+    TENSOR_PROFILE_RANGE("tensor::copy");
+    using dst_type = std::decay_t<Dst>;
+    using scalar = std::remove_cv_t<typename dst_type::value_type>;
+    using dst_shape = typename dst_type::shape_type;
+    using src_shape = typename Src::shape_type;
+    constexpr size_t Rank = dst_shape::order();
+    static_assert(std::is_same_v<scalar, std::remove_cv_t<typename Src::value_type>>, "copy requires tensors with the same element type.");
+    static_assert(Rank == src_shape::order(), "copy requires tensors with the same number of dimensions.");
+
+#ifdef TENSOR_CHECK_BOUNDS
+    for (index_t d = 0; d < Rank; ++d)
+      if (dst.shape(d) != src.shape(d))
+        tensor_shape_mismatch();
+#endif
+
+    if constexpr (dst_shape::is_contiguous() && src_shape::is_contiguous() && std::is_same_v<typename dst_shape::layout_type, typename src_shape::layout_type>)
+    {
+      if constexpr (std::is_trivially_copyable_v<scalar>)
+        std::memcpy(dst.data(), src.data(), src.size() * sizeof(scalar));
+      else
+        std::copy_n(src.data(), src.size(), dst.data());
+    }
+    else
+    {
+      std::array<index_t, Rank> extents;
+      std::array<stride_t, Rank> dst_strides, src_strides;
+      for (index_t d = 0; d < Rank; ++d)
+      {
+        extents[d] = src.shape(d);
+        dst_strides[d] = dst.stride(d);
+        src_strides[d] = src.stride(d);
+      }
+
+      if (src.size() > 0)
+        details::copy_strided<scalar, Rank>(dst.data(), dst_strides, src.data(), src_strides, extents);
+    }
+  }
+
+  /**
+   * @brief copies the elements of src into dst, converting them to the
+   * element type of dst.
+   *
+   * @details Use `convert` to store a `float` tensor in half precision and
+   * back, e.g. `convert(h, x)` where h is a `Tensor<float16, 3>`. Contiguous
+   * runs are converted a vector register at a time (see
+   * `details::convert_contiguous`), in the order of `copy`.
+   *
+   * @param dst tensor with the same shape as src.
+   * @param src the tensor to convert from. Must not overlap with dst.
+   */
+  template <typename Dst, typename Src, typename = std::enable_if_t<details::is_tensor_v<Dst> && details::is_tensor_v<Src>>>
+  inline void convert(Dst &&dst, const Src &src)
+  {
+    TENSOR_PROFILE_RANGE("tensor::convert");
+    using dst_type = std::decay_t<Dst>;
+    using scalar = std::remove_cv_t<typename dst_type::value_type>;
+    using src_scalar = std::remove_cv_t<typename Src::value_type>;
+    using dst_shape = typename dst_type::shape_type;
+    using src_shape = typename Src::shape_type;
+    constexpr size_t Rank = dst_shape::order();
+    static_assert(Rank == src_shape::order(), "convert requires tensors with the same number of dimensions.");
+
+#ifdef TENSOR_CHECK_BOUNDS
+    for (index_t d = 0; d < Rank; ++d)
+      if (dst.shape(d) != src.shape(d))
+        tensor_shape_mismatch();
+#endif
+
+    if constexpr (std::is_same_v<scalar, src_scalar>)
+    {
+      copy(dst, src);
+    }
+    else if constexpr (dst_shape::is_contiguous() && src_shape::is_contiguous() && std::is_same_v<typename dst_shape::layout_type, typename src_shape::layout_type>)
+    {
+      details::convert_contiguous(dst.data(), src.data(), src.size());
+    }
+    else
+    {
+      std::array<index_t, Rank> extents;
+      std::array<stride_t, Rank> dst_strides, src_strides;
+      for (index_t d = 0; d < Rank; ++d)
+      {
+        extents[d] = src.shape(d);
+        dst_strides[d] = dst.stride(d);
+        src_strides[d] = src.stride(d);
+      }
+
+      if (src.size() > 0)
+        details::copy_strided<scalar, Rank, src_scalar>(dst.data(), dst_strides, src.data(), src_strides, extents);
+    }
+  }
+} // namespace tensor
+
+#endif
@@ -0,0 +1,380 @@
+#ifndef __TENSOR_VIEW_CUDA_KERNELS_HPP__
+#define __TENSOR_VIEW_CUDA_KERNELS_HPP__
+
+#include "tensorview_config.hpp"
+
+#if defined(TENSOR_USE_CUDA) && defined(__CUDACC__)
+
+#include <cmath>
+#include <limits>
+
+#include <cuda_runtime.h>
+
+#include "errors.hpp"
+#include "multi_index.hpp"
+#include "expressions.hpp"
+#include "DeviceTensor.hpp"
+
+namespace tensor::cuda::details
+{
+  using namespace tensor::details;
+
+  /// @brief threads per block of every kernel.
+  inline constexpr int block_size = 256;
+
+  /// @brief blocks per multiprocessor launched by the grid-stride kernels,
+  /// enough to hide memory latency without oversubscribing.
+  inline constexpr int blocks_per_sm = 8;
+
+  // number of blocks for a grid-stride loop over n elements.
+  inline int grid_size(index_t n)
+  {
+    thread_local int sm_count = 0;
+    if (sm_count == 0)
+    {
+      int device;
+      cuda_check(cudaGetDevice(&device));
+      cuda_check(cudaDeviceGetAttribute(&sm_count, cudaDevAttrMultiProcessorCount, device));
+    }
+    const index_t blocks = (n + block_size - 1) / block_size;
+    return (int)((blocks < (index_t)(sm_count * blocks_per_sm)) ? blocks : (index_t)(sm_count * blocks_per_sm));
+  }
+
+  inline void check_launch()
+  {
+    cuda_check(cudaGetLastError());
+  }
+
+  // dst = expr by linear index, when dst and every operand of expr are
+  // contiguous with the same layout: the accesses of consecutive threads
+  // are coalesced.
+  template <typename View, typename Expr>
+  __global__ void assign_linear(View dst, Expr expr, index_t n)
+  {
+    auto *out = dst.data();
+    for (index_t i = blockIdx.x * blockDim.x + threadIdx.x; i < n; i += blockDim.x * gridDim.x)
+      out[i] = expr[i];
+  }
+
+  // dst = expr by multi-index, e.g. for subviews and mixed layouts.
+  template <typename View, typename Expr>
+  __global__ void assign_strided(View dst, Expr expr, index_t n)
+  {
+    constexpr size_t N = View::order();
+    auto *out = dst.data();
+    for (index_t i = blockIdx.x * blockDim.x + threadIdx.x; i < n; i += blockDim.x * gridDim.x)
+    {
+      const auto idx = unravel_index<N>(i, dst.shape());
+      out[(stride_t)apply_index(dst.shape(), idx)] = expr(idx);
+    }
+  }
+
+  template <typename T, typename Op>
+  __device__ T warp_reduce(T v, Op op)
+  {
+    for (int offset = warpSize / 2; offset > 0; offset /= 2)
+      v = op(v, __shfl_down_sync(0xffffffff, v, offset));
+    return v;
+  }
+
+  // reduces v over the threads of a block with warp shuffles; the result is
+  // valid in thread 0.
+  template <typename T, typename Op>
+  __device__ T block_reduce(T v, T init, Op op)
+  {
+    __shared__ T warp_results[block_size / 32];
+    const int lane = threadIdx.x % warpSize;
+    const int warp = threadIdx.x / warpSize;
+
+    v = warp_reduce(v, op);
+    if (lane == 0)
+      warp_results[warp] = v;
+    __syncthreads();
+
+    v = (threadIdx.x < blockDim.x / warpSize) ? warp_results[lane] : init;
+    if (warp == 0)
+      v = warp_reduce(v, op);
+    return v;
+  }
+
+  // partial[blockIdx.x] = op-reduction of the elements of x visited by the block.
+  template <bool Linear, typename Expr, typename T, typename Op>
+  __global__ void reduce_kernel(Expr x, index_t n, T init, Op op, T *partial)
+  {
+    constexpr size_t N = Expr::order();
+    T acc = init;
+    for (index_t i = blockIdx.x * blockDim.x + threadIdx.x; i < n; i += blockDim.x * gridDim.x)
+    {
+      if constexpr (Linear)
+        acc = op(acc, x[i]);
+      else
+        acc = op(acc, x(unravel_index<N>(i, x)));
+    }
+
+    acc = block_reduce(acc, init, op);
+    if (threadIdx.x == 0)
+      partial[blockIdx.x] = acc;
+  }
+
+  // out(j) = op-reduction of x along dim, one thread per output element.
+  // Used when dim is not the fastest dimension of x, so that neighboring
+  // threads read neighboring elements.
+  template <typename Expr, typename Out, typename T, typename Op>
+  __global__ void reduce_axis_threads(Expr x, index_t dim, Out out, T init, Op op)
+  {
+    constexpr size_t N = Expr::order();
+    const index_t m = out.size(), len = x.shape(dim);
+    for (index_t j = blockIdx.x * blockDim.x + threadIdx.x; j < m; j += blockDim.x * gridDim.x)
+    {
+      const auto oidx = unravel_index<N - 1>(j, out.shape());
+      std::array<index_t, N> idx;
+      for (index_t d = 0, e = 0; d < N; ++d)
+        idx[d] = (d == dim) ? 0 : oidx[e++];
+
+      T acc = init;
+      for (index_t k = 0; k < len; ++k)
+      {
+        idx[dim] = k;
+        acc = op(acc, x(idx));
+      }
+      out.data()[(stride_t)apply_index(out.shape(), oidx)] = acc;
+    }
+  }
+
+  // out(j) = op-reduction of x along dim, one warp per output element.
+  // Used when dim is the fastest dimension of x.
+  template <typename Expr, typename Out, typename T, typename Op>
+  __global__ void reduce_axis_warps(Expr x, index_t dim, Out out, T init, Op op)
+  {
+    constexpr size_t N = Expr::order();
+    const index_t m = out.size(), len = x.shape(dim);
+    const index_t lane = threadIdx.x % warpSize;
+    const index_t warps = (blockDim.x * gridDim.x) / warpSize;
+    for (index_t j = (blockIdx.x * blockDim.x + threadIdx.x) / warpSize; j < m; j += warps)
+    {
+      const auto oidx = unravel_index<N - 1>(j, out.shape());
+      std::array<index_t, N> idx;
+      for (index_t d = 0, e = 0; d < N; ++d)
+        idx[d] = (d == dim) ? 0 : oidx[e++];
+
+      T acc = init;
+      for (index_t k = lane; k < len; k += warpSize)
+      {
+        idx[dim] = k;
+        acc = op(acc, x(idx));
+      }
+      acc = warp_reduce(acc, op);
+      if (lane == 0)
+        out.data()[(stride_t)apply_index(out.shape(), oidx)] = acc;
+    }
+  }
+
+  struct abs_op
+  {
+    template <typename T>
+    __host__ __device__ T operator()(T x) const { return (x < T(0)) ? -x : x; }
+  };
+} // namespace tensor::cuda::details
+
+namespace tensor::cuda
+{
+  /**
+   * @brief evaluates an elementwise expression into a view of device
+   * memory, e.g. `cuda::assign(y, 2.0 * x + y, stream)`.
+   *
+   * @details When dst and every operand of expr are contiguous with the
+   * same layout, the kernel reads and writes by linear index so that the
+   * accesses are coalesced. Otherwise (subviews, strided views, mixed
+   * layouts) each thread computes the multi-index of its element.
+   *
+   * @param dst `TensorView`, `SubView`, or `StridedView` of device memory.
+   * @param expr a tensor view or expression of views of device memory.
+   * @param stream the stream to launch the kernel on.
+   */
+  template <typename View, typename Expr>
+  inline void assign(View &&dst, const Expr &expr, cudaStream_t stream = 0)
+  {
+    using view_type = std::decay_t<View>;
+    using shape_type = typename view_type::shape_type;
+    const auto e = tensor::details::as_expression(expr);
+    using expr_type = decltype(e);
+    static_assert(expr_type::order() == shape_type::order(), "expression has the wrong number of dimensions.");
+
+#ifdef TENSOR_CHECK_BOUNDS
+    for (index_t d = 0; d < shape_type::order(); ++d)
+      if (e.shape(d) != dst.shape(d))
+        tensor_shape_mismatch();
+#endif
+
+    const index_t n = dst.size();
+    if (n == 0)
+      return;
+
+    const int grid = details::grid_size(n);
+    if constexpr (shape_type::is_contiguous() && expr_type::is_contiguous() && tensor::details::same_layout_v<typename shape_type::layout_type, typename expr_type::layout_type>)
+      details::assign_linear<<<grid, details::block_size, 0, stream>>>(dst, e, n);
+    else
+      details::assign_strided<<<grid, details::block_size, 0, stream>>>(dst, e, n);
+    details::check_launch();
+  }
+
+  /// @brief y = a * x + y for views of device memory.
+  template <typename T, typename X, typename Y>
+  inline void axpy(T a, const X &x, Y &&y, cudaStream_t stream = 0)
+  {
+    assign(y, a * x + y, stream);
+  }
+
+  /**
+   * @brief reduces the elements of a view of device memory (or an
+   * expression of views, e.g. `x * y`) with `op` and returns the result.
+   *
+   * @details Each thread accumulates a grid-stride slice, the threads of a
+   * block are reduced with warp shuffles, and a second single-block launch
+   * reduces the per-block results. The call waits for the stream to
+   * finish.
+   *
+   * @param x view or expression of views of device memory.
+   * @param init identity of op.
+   * @param op associative binary operation callable on the device, e.g.
+   * `tensor::details::plus_op`.
+   */
+  template <typename X, typename T, typename Op>
+  inline T reduce(const X &x, T init, Op op, cudaStream_t stream = 0)
+  {
+    const auto e = tensor::details::as_expression(x);
+    using expr_type = decltype(e);
+    const index_t n = e.size();
+    if (n == 0)
+      return init;
+
+    const int grid = details::grid_size(n);
+    DeviceTensor<T, 1> partial(stream, grid);
+    DeviceTensor<T, 1> result(stream, 1);
+
+    details::reduce_kernel<expr_type::is_contiguous()><<<grid, details::block_size, 0, stream>>>(e, n, init, op, partial.data());
+    details::check_launch();
+
+    const auto p = tensor::details::as_expression(partial.view());
+    details::reduce_kernel<true><<<1, details::block_size, 0, stream>>>(p, (index_t)grid, init, op, result.data());
+    details::check_launch();
+
+    T value;
+    tensor::details::cuda_check(cudaMemcpyAsync(&value, result.data(), sizeof(T), cudaMemcpyDeviceToHost, stream));
+    tensor::details::cuda_check(cudaStreamSynchronize(stream));
+    return value;
+  }
+
+  /// @brief returns the sum of the elements of a view of device memory.
+  template <typename X>
+  inline auto sum(const X &x, cudaStream_t stream = 0)
+  {
+    using T = typename decltype(tensor::details::as_expression(x))::value_type;
+    return reduce(x, T(0), tensor::details::plus_op{}, stream);
+  }
+
+  /// @brief returns the dot product of two views of device memory.
+  template <typename X, typename Y>
+  inline auto dot(const X &x, const Y &y, cudaStream_t stream = 0)
+  {
+    return sum(x * y, stream);
+  }
+
+  /// @brief returns the Euclidean norm of a view of device memory.
+  template <typename X>
+  inline auto norm2(const X &x, cudaStream_t stream = 0)
+  {
+    return std::sqrt(sum(x * x, stream));
+  }
+
+  /// @brief returns the largest absolute value of the elements of a view of device memory.
+  template <typename X>
+  inline auto max_abs(const X &x, cudaStream_t stream = 0)
+  {
+    const auto a = tensor::details::make_unary(details::abs_op{}, x);
+    using T = typename decltype(a)::value_type;
+    return reduce(a, T(0), tensor::details::max_op{}, stream);
+  }
+
+  /// @brief returns the smallest element of a view of device memory.
+  template <typename X>
+  inline auto min(const X &x, cudaStream_t stream = 0)
+  {
+    using T = typename decltype(tensor::details::as_expression(x))::value_type;
+    return reduce(x, std::numeric_limits<T>::max(), tensor::details::min_op{}, stream);
+  }
+
+  /// @brief returns the largest element of a view of device memory.
+  template <typename X>
+  inline auto max(const X &x, cudaStream_t stream = 0)
+  {
+    using T = typename decltype(tensor::details::as_expression(x))::value_type;
+    return reduce(x, std::numeric_limits<T>::lowest(), tensor::details::max_op{}, stream);
+  }
+
+  /**
+   * @brief reduces x along dimension dim into out, which has the shape of
+   * x with dim removed: `out(i, k) = op(x(i, 0, k), x(i, 1, k), ...)`.
+   *
+   * @details When dim has unit stride in x each output element is reduced
+   * by a warp, otherwise by a thread, so that the reads are coalesced in
+   * both cases. The kernel is queued on stream; the call does not wait.
+   */
+  template <typename X, typename Out, typename T, typename Op>
+  inline void reduce_axis(const X &x, index_t dim, Out &&out, T init, Op op, cudaStream_t stream = 0)
+  {
+    const auto e = tensor::details::as_expression(x);
+    using expr_type = decltype(e);
+    constexpr size_t N = expr_type::order();
+    static_assert(N >= 2, "reduce_axis requires a tensor of rank at least 2.");
+    static_assert(std::decay_t<Out>::order() == N - 1, "the output of reduce_axis must have one dimension less than the input.");
+
+#ifdef TENSOR_CHECK_BOUNDS
+    if (dim < 0 || dim >= N)
+      tensor_dimension_out_of_range(dim, N);
+    for (index_t d = 0, k = 0; d < N; ++d)
+      if (d != dim && e.shape(d) != out.shape(k++))
+        tensor_shape_mismatch();
+#endif
+
+    const index_t m = out.size();
+    if (m == 0)
+      return;
+
+    bool unit_stride = false;
+    if constexpr (tensor::details::is_tensor_v<X>)
+      unit_stride = x.stride(dim) == 1;
+
+    if (unit_stride)
+    {
+      const int grid = details::grid_size(m * 32);
+      details::reduce_axis_warps<<<grid, details::block_size, 0, stream>>>(e, dim, out, init, op);
+    }
+    else
+    {
+      const int grid = details::grid_size(m);
+      details::reduce_axis_threads<<<grid, details::block_size, 0, stream>>>(e, dim, out, init, op);
+    }
+    details::check_launch();
+  }
+
+  /// @brief sums x along dimension dim into out, see `reduce_axis`.
+  template <typename X, typename Out>
+  inline void sum(const X &x, index_t dim, Out &&out, cudaStream_t stream = 0)
+  {
+    using T = typename decltype(tensor::details::as_expression(x))::value_type;
+    reduce_axis(x, dim, out, T(0), tensor::details::plus_op{}, stream);
+  }
+
+  /// @brief largest element of x along dimension dim into out, see `reduce_axis`.
+  template <typename X, typename Out>
+  inline void max(const X &x, index_t dim, Out &&out, cudaStream_t stream = 0)
+  {
+    using T = typename decltype(tensor::details::as_expression(x))::value_type;
+    reduce_axis(x, dim, out, std::numeric_limits<T>::lowest(), tensor::details::max_op{}, stream);
+  }
+} // namespace tensor::cuda
+
+#endif // TENSOR_USE_CUDA && __CUDACC__
+
+#endif
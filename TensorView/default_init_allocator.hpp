@@ -0,0 +1,55 @@
+#ifndef __TENSOR_VIEW_DEFAULT_INIT_ALLOCATOR_HPP__
+#define __TENSOR_VIEW_DEFAULT_INIT_ALLOCATOR_HPP__
+
+#include <memory>
+
+#include "tensorview_config.hpp"
+
+namespace tensor::details
+{
+  /// @brief allocator adaptor which default-initializes (rather than
+  /// value-initializes) elements constructed without arguments.
+  ///
+  /// @details `std::vector<T, default_init_allocator<A>>(n)` and `resize(n)`
+  /// leave trivial types such as `double` uninitialized instead of writing
+  /// zeros. The memory is then first touched by whichever code writes it,
+  /// e.g. the thread that owns each page. Construction with arguments (e.g.
+  /// `resize(n, value)`) is forwarded to A.
+  ///
+  /// @tparam A the underlying allocator
+  template <typename A>
+  class default_init_allocator : public A
+  {
+    using traits = std::allocator_traits<A>;
+
+  public:
+    template <typename U>
+    struct rebind
+    {
+      using other = default_init_allocator<typename traits::template rebind_alloc<U>>;
+    };
+
+    using A::A;
+
+    default_init_allocator() = default;
+
+    default_init_allocator(const A &a) noexcept : A(a) {}
+
+    template <typename B>
+    default_init_allocator(const default_init_allocator<B> &other) noexcept : A(static_cast<const B &>(other)) {}
+
+    template <typename U>
+    void construct(U *ptr) noexcept(std::is_nothrow_default_constructible_v<U>)
+    {
+      ::new (static_cast<void *>(ptr)) U;
+    }
+
+    template <typename U, typename... Args>
+    void construct(U *ptr, Args &&...args)
+    {
+      traits::construct(static_cast<A &>(*this), ptr, std::forward<Args>(args)...);
+    }
+  };
+} // namespace tensor::details
+
+#endif
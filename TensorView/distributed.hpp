@@ -0,0 +1,494 @@
+#ifndef __TENSOR_VIEW_DISTRIBUTED_HPP__
+#define __TENSOR_VIEW_DISTRIBUTED_HPP__
+
+#include "tensorview_config.hpp"
+
+#ifdef TENSOR_USE_MPI
+
+#include <algorithm>
+#include <array>
+#include <complex>
+#include <cstdint>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <mpi.h>
+
+#include "errors.hpp"
+#include "span.hpp"
+#include "layout.hpp"
+#include "Tensor.hpp"
+
+namespace tensor
+{
+  /// @brief which neighbors `DistributedTensor::exchange_halos` exchanges
+  /// with: only across faces (enough for e.g. a seven point stencil), or
+  /// also across edges and corners (e.g. a twenty-seven point stencil).
+  enum class halo_type
+  {
+    faces,
+    full
+  };
+
+  namespace details
+  {
+    /// @brief the MPI datatype of scalar, or MPI_DATATYPE_NULL if there is
+    /// no predefined type.
+    template <typename scalar>
+    inline MPI_Datatype mpi_datatype()
+    {
+      if constexpr (std::is_same_v<scalar, double>)
+        return MPI_DOUBLE;
+      else if constexpr (std::is_same_v<scalar, float>)
+        return MPI_FLOAT;
+      else if constexpr (std::is_same_v<scalar, long double>)
+        return MPI_LONG_DOUBLE;
+      else if constexpr (std::is_same_v<scalar, int>)
+        return MPI_INT;
+      else if constexpr (std::is_same_v<scalar, long>)
+        return MPI_LONG;
+      else if constexpr (std::is_same_v<scalar, long long>)
+        return MPI_LONG_LONG;
+      else if constexpr (std::is_same_v<scalar, unsigned>)
+        return MPI_UNSIGNED;
+      else if constexpr (std::is_same_v<scalar, unsigned long>)
+        return MPI_UNSIGNED_LONG;
+      else if constexpr (std::is_same_v<scalar, std::complex<float>>)
+        return MPI_CXX_FLOAT_COMPLEX;
+      else if constexpr (std::is_same_v<scalar, std::complex<double>>)
+        return MPI_CXX_DOUBLE_COMPLEX;
+      else
+        return MPI_DATATYPE_NULL;
+    }
+
+    // 3^n
+    constexpr int pow3(size_t n)
+    {
+      return (n == 0) ? 1 : 3 * pow3(n - 1);
+    }
+  } // namespace details
+
+  /**
+   * @brief a tensor split into blocks between the processes of an MPI
+   * communicator, with a halo of ghost elements around each block.
+   *
+   * @details The processes are arranged in a Cartesian grid (chosen by
+   * `MPI_Dims_create` unless given) and each owns a contiguous block of
+   * the global tensor, the blocks differing in size by at most one along
+   * each dimension. Each process stores its block and the halo in a
+   * `Tensor` of shape `local_shape(d) + 2 * halo()`, so the owned element
+   * with local index i is at `tensor()(i + halo(), ...)`.
+   *
+   * The halos are described by MPI subarray datatypes of the local tensor,
+   * created once by the constructor, so that `exchange_halos_begin()` sends
+   * and receives them in place, without packing. Between
+   * `exchange_halos_begin()` and `exchange_halos_end()` the halo must not
+   * be read and the owned elements must not be written; the elements of
+   * `interior_region()` do not depend on the halo and can be computed while
+   * the messages are in flight.
+   *
+   * The tensor must be destroyed before `MPI_Finalize`.
+   */
+  template <typename scalar, size_t Rank, typename Layout = layout::left>
+  class DistributedTensor
+  {
+  public:
+    static_assert(std::is_same_v<Layout, layout::left> || std::is_same_v<Layout, layout::right>, "DistributedTensor supports layout::left and layout::right.");
+
+    using value_type = scalar;
+    using local_type = Tensor<scalar, Rank, std::allocator<scalar>, Layout>;
+    using region_type = std::array<span, Rank>;
+
+    /**
+     * @brief decomposes a tensor of shape `global_shape` between the
+     * processes of comm. Collective over comm.
+     *
+     * @param comm the communicator of the processes.
+     * @param global_shape the shape of the whole tensor.
+     * @param halo width of the halo along every dimension.
+     * @param periodic whether each dimension wraps around, in which case
+     * the halos at the ends are exchanged with the process at the other end.
+     * @param dims number of processes along each dimension, zero to let MPI
+     * choose (see `MPI_Dims_create`).
+     */
+    DistributedTensor(MPI_Comm comm, const std::array<index_t, Rank> &global_shape, index_t halo = 1, const std::array<bool, Rank> &periodic = {}, std::array<int, Rank> dims = {})
+        : _global_shape{global_shape}, _halo{halo}
+    {
+      int n_procs;
+      MPI_Comm_size(comm, &n_procs);
+      MPI_Dims_create(n_procs, Rank, dims.data());
+
+      std::array<int, Rank> periods;
+      for (size_t d = 0; d < Rank; ++d)
+        periods[d] = periodic[d];
+      MPI_Cart_create(comm, Rank, dims.data(), periods.data(), 1, &cart);
+      MPI_Comm_rank(cart, &_rank);
+      MPI_Cart_coords(cart, _rank, Rank, _coords.data());
+      _dims = dims;
+      _periodic = periodic;
+
+      std::array<index_t, Rank> sizes;
+      for (size_t d = 0; d < Rank; ++d)
+      {
+        block(d, _coords[d], _offset[d], _local_shape[d]);
+        if (_local_shape[d] < std::max<index_t>(halo, 1))
+          throw std::invalid_argument("TensorView: every block of a DistributedTensor must be at least as wide as the halo.");
+        sizes[d] = _local_shape[d] + 2 * halo;
+      }
+      local = make_local(sizes, std::make_index_sequence<Rank>{});
+
+      elem_type = details::mpi_datatype<scalar>();
+      if (elem_type == MPI_DATATYPE_NULL)
+      {
+        MPI_Type_contiguous(sizeof(scalar), MPI_BYTE, &elem_type);
+        MPI_Type_commit(&elem_type);
+        own_elem_type = true;
+      }
+
+      neighbors.fill(MPI_PROC_NULL);
+      send_types.fill(MPI_DATATYPE_NULL);
+      recv_types.fill(MPI_DATATYPE_NULL);
+      if (halo > 0)
+        create_halo_types();
+    }
+
+    DistributedTensor(const DistributedTensor &) = delete;
+    DistributedTensor &operator=(const DistributedTensor &) = delete;
+
+    ~DistributedTensor()
+    {
+      if (!requests.empty())
+        MPI_Waitall(requests.size(), requests.data(), MPI_STATUSES_IGNORE);
+      for (auto *types : {&send_types, &recv_types})
+        for (MPI_Datatype &t : *types)
+          if (t != MPI_DATATYPE_NULL)
+            MPI_Type_free(&t);
+      if (own_elem_type)
+        MPI_Type_free(&elem_type);
+      MPI_Comm_free(&cart);
+    }
+
+    /// @brief the Cartesian communicator of the processes.
+    MPI_Comm comm() const { return cart; }
+
+    /// @brief the rank of this process in `comm()`.
+    int rank() const { return _rank; }
+
+    /// @brief the number of processes along each dimension.
+    const std::array<int, Rank> &dims() const { return _dims; }
+
+    /// @brief the coordinates of this process in the process grid.
+    const std::array<int, Rank> &coords() const { return _coords; }
+
+    index_t global_shape(index_t d) const { return _global_shape[d]; }
+
+    /// @brief the number of elements owned along dimension d.
+    index_t local_shape(index_t d) const { return _local_shape[d]; }
+
+    /// @brief the global index of the first owned element along dimension d.
+    index_t offset(index_t d) const { return _offset[d]; }
+
+    index_t halo() const { return _halo; }
+
+    /// @brief the local block with its halo.
+    local_type &tensor() { return local; }
+    const local_type &tensor() const { return local; }
+
+    /// @brief the `SubView` of `tensor()` selected by a region, e.g. one of
+    /// `owned_region()`, `interior_region()` or `boundary_regions()`.
+    auto at(const region_type &r) { return at(r, std::make_index_sequence<Rank>{}); }
+    auto at(const region_type &r) const { return at(r, std::make_index_sequence<Rank>{}); }
+
+    /// @brief the owned elements, i.e. `at(owned_region())`. Local index i
+    /// is global index `offset(d) + i`.
+    auto owned() { return at(owned_region()); }
+    auto owned() const { return at(owned_region()); }
+
+    /// @brief the owned elements, in the coordinates of `tensor()`.
+    region_type owned_region() const
+    {
+      return make_region([&](size_t d)
+                         { return span(_halo, _halo + _local_shape[d]); });
+    }
+
+    /// @brief the owned elements at least `halo()` elements away from the
+    /// halo, which can be updated by a stencil of radius `halo()` before the
+    /// halos are exchanged. Empty along a dimension if the block is at most
+    /// `2 * halo()` wide.
+    region_type interior_region() const
+    {
+      return make_region([&](size_t d)
+                         { return span(2 * _halo, std::max(2 * _halo, _local_shape[d])); });
+    }
+
+    /// @brief disjoint regions which cover the owned elements outside of
+    /// `interior_region()`: two slabs per dimension, each excluding the
+    /// slabs of the preceding dimensions. Empty regions are omitted.
+    std::vector<region_type> boundary_regions() const
+    {
+      std::vector<region_type> regions;
+      region_type inner = owned_region();
+      const region_type core = interior_region();
+      for (size_t d = 0; d < Rank; ++d)
+      {
+        const index_t lo = std::min(core[d].begin, core[d].end);
+        for (span s : {span(inner[d].begin, lo), span(std::max(lo, core[d].end), inner[d].end)})
+        {
+          if (s.end <= s.begin)
+            continue;
+          region_type r = inner;
+          r[d] = s;
+          regions.push_back(r);
+        }
+        inner[d] = span(lo, std::max(lo, core[d].end));
+        if (inner[d].end <= inner[d].begin)
+          break;
+      }
+      return regions;
+    }
+
+    /// @brief r grown by `halo()` along every dimension: the elements of
+    /// `tensor()` read by a stencil of radius `halo()` applied to r.
+    region_type window(const region_type &r) const
+    {
+      return make_region([&](size_t d)
+                         { return span(r[d].begin - _halo, r[d].end + _halo); });
+    }
+
+    /**
+     * @brief starts the exchange of the halos with the neighboring
+     * processes: the halo of this process is received from the elements
+     * owned by the neighbors, and vice versa. Returns immediately.
+     *
+     * @details Halos on the boundary of a non-periodic dimension are not
+     * modified.
+     */
+    void exchange_halos_begin(halo_type type = halo_type::full)
+    {
+      if (!requests.empty())
+        throw std::logic_error("TensorView: exchange_halos_begin called twice without exchange_halos_end.");
+      if (_halo == 0)
+        return;
+
+      constexpr int n_dirs = details::pow3(Rank);
+      for (int q = 0; q < n_dirs; ++q)
+      {
+        if (!active(q, type))
+          continue;
+        // the neighbor at q sent toward the opposite direction
+        requests.emplace_back();
+        MPI_Irecv(local.data(), 1, recv_types[q], neighbors[q], n_dirs - 1 - q, cart, &requests.back());
+      }
+      for (int q = 0; q < n_dirs; ++q)
+      {
+        if (!active(q, type))
+          continue;
+        requests.emplace_back();
+        MPI_Isend(local.data(), 1, send_types[q], neighbors[q], q, cart, &requests.back());
+      }
+    }
+
+    /// @brief waits for the exchange started by `exchange_halos_begin`.
+    void exchange_halos_end()
+    {
+      if (!requests.empty())
+        MPI_Waitall(requests.size(), requests.data(), MPI_STATUSES_IGNORE);
+      requests.clear();
+    }
+
+    /// @brief `exchange_halos_begin(); exchange_halos_end();`
+    void exchange_halos(halo_type type = halo_type::full)
+    {
+      exchange_halos_begin(type);
+      exchange_halos_end();
+    }
+
+    /**
+     * @brief collects the owned blocks of every process into a tensor of the
+     * global shape on process root. Collective over `comm()`.
+     *
+     * @details The blocks are received in place with subarray datatypes.
+     *
+     * @return the global tensor on root, an empty tensor elsewhere.
+     */
+    local_type gather(int root = 0) const
+    {
+      local_type global;
+      std::vector<MPI_Request> reqs;
+      std::vector<MPI_Datatype> types;
+      if (_rank == root)
+      {
+        global = make_local(_global_shape, std::make_index_sequence<Rank>{});
+        int n_procs;
+        MPI_Comm_size(cart, &n_procs);
+        for (int r = 0; r < n_procs; ++r)
+        {
+          std::array<int, Rank> c;
+          MPI_Cart_coords(cart, r, Rank, c.data());
+          std::array<index_t, Rank> start, size;
+          for (size_t d = 0; d < Rank; ++d)
+            block(d, c[d], start[d], size[d]);
+          types.push_back(subarray(_global_shape, size, start));
+          reqs.emplace_back();
+          MPI_Irecv(global.data(), 1, types.back(), r, 0, cart, &reqs.back());
+        }
+      }
+
+      std::array<index_t, Rank> start, sizes;
+      for (size_t d = 0; d < Rank; ++d)
+      {
+        start[d] = _halo;
+        sizes[d] = local.shape(d);
+      }
+      MPI_Datatype owned_type = subarray(sizes, _local_shape, start);
+      MPI_Send(local.data(), 1, owned_type, root, 0, cart);
+      MPI_Type_free(&owned_type);
+
+      if (!reqs.empty())
+        MPI_Waitall(reqs.size(), reqs.data(), MPI_STATUSES_IGNORE);
+      for (MPI_Datatype &t : types)
+        MPI_Type_free(&t);
+      return global;
+    }
+
+  private:
+    std::array<index_t, Rank> _global_shape;
+    std::array<index_t, Rank> _local_shape;
+    std::array<index_t, Rank> _offset;
+    std::array<int, Rank> _dims;
+    std::array<int, Rank> _coords;
+    std::array<bool, Rank> _periodic;
+    index_t _halo;
+    int _rank;
+    MPI_Comm cart;
+    local_type local;
+
+    MPI_Datatype elem_type;
+    bool own_elem_type = false;
+
+    // indexed by the direction q = sum_d (o_d + 1) 3^d of the neighbor at
+    // offset o in the process grid, o_d in {-1, 0, 1}
+    std::array<int, details::pow3(Rank)> neighbors;
+    std::array<MPI_Datatype, details::pow3(Rank)> send_types;
+    std::array<MPI_Datatype, details::pow3(Rank)> recv_types;
+    std::vector<MPI_Request> requests;
+
+    // the first global index and the size of the block of process c along d
+    void block(size_t d, int c, index_t &start, index_t &size) const
+    {
+      const index_t n = _global_shape[d], p = _dims[d];
+      size = n / p + (index_t(c) < n % p);
+      start = c * (n / p) + std::min<index_t>(c, n % p);
+    }
+
+    template <size_t... I>
+    static local_type make_local(const std::array<index_t, Rank> &sizes, std::index_sequence<I...>)
+    {
+      return local_type(sizes[I]...);
+    }
+
+    template <size_t... I>
+    auto at(const region_type &r, std::index_sequence<I...>) { return local.at(r[I]...); }
+
+    template <size_t... I>
+    auto at(const region_type &r, std::index_sequence<I...>) const { return local.at(r[I]...); }
+
+    template <typename F>
+    static region_type make_region(F &&f)
+    {
+      return make_region(f, std::make_index_sequence<Rank>{});
+    }
+
+    template <typename F, size_t... I>
+    static region_type make_region(F &&f, std::index_sequence<I...>)
+    {
+      return {f(I)...};
+    }
+
+    static std::array<int, Rank> offsets_of(int q)
+    {
+      std::array<int, Rank> o;
+      for (size_t d = 0; d < Rank; ++d, q /= 3)
+        o[d] = q % 3 - 1;
+      return o;
+    }
+
+    bool active(int q, halo_type type) const
+    {
+      if (neighbors[q] == MPI_PROC_NULL)
+        return false;
+      int nonzero = 0;
+      for (int o : offsets_of(q))
+        nonzero += (o != 0);
+      return nonzero == 1 || (nonzero > 1 && type == halo_type::full);
+    }
+
+    // a committed subarray datatype of an array of the given sizes
+    MPI_Datatype subarray(const std::array<index_t, Rank> &sizes, const std::array<index_t, Rank> &subsizes, const std::array<index_t, Rank> &starts) const
+    {
+      std::array<int, Rank> n, m, s;
+      for (size_t d = 0; d < Rank; ++d)
+      {
+        n[d] = sizes[d];
+        m[d] = subsizes[d];
+        s[d] = starts[d];
+      }
+      constexpr int order = std::is_same_v<Layout, layout::left> ? MPI_ORDER_FORTRAN : MPI_ORDER_C;
+      MPI_Datatype t;
+      MPI_Type_create_subarray(Rank, n.data(), m.data(), s.data(), order, elem_type, &t);
+      MPI_Type_commit(&t);
+      return t;
+    }
+
+    void create_halo_types()
+    {
+      const index_t h = _halo;
+      std::array<index_t, Rank> sizes;
+      for (size_t d = 0; d < Rank; ++d)
+        sizes[d] = local.shape(d);
+
+      for (int q = 0; q < details::pow3(Rank); ++q)
+      {
+        const auto o = offsets_of(q);
+
+        // the neighbor at offset o, wrapped around periodic dimensions
+        std::array<int, Rank> c;
+        bool exists = true, center = true;
+        for (size_t d = 0; d < Rank; ++d)
+        {
+          center = center && o[d] == 0;
+          c[d] = _coords[d] + o[d];
+          if (c[d] < 0 || c[d] >= _dims[d])
+          {
+            if (_periodic[d])
+              c[d] = (c[d] + _dims[d]) % _dims[d];
+            else
+              exists = false;
+          }
+        }
+        if (center || !exists)
+          continue;
+        MPI_Cart_rank(cart, c.data(), &neighbors[q]);
+
+        // send the owned slab next to the neighbor, receive into the halo
+        // on its side
+        std::array<index_t, Rank> sub, send_start, recv_start;
+        for (size_t d = 0; d < Rank; ++d)
+        {
+          const index_t n = _local_shape[d];
+          sub[d] = (o[d] == 0) ? n : h;
+          send_start[d] = (o[d] > 0) ? n : h;
+          recv_start[d] = (o[d] < 0) ? 0 : (o[d] == 0) ? h : n + h;
+        }
+        send_types[q] = subarray(sizes, sub, send_start);
+        recv_types[q] = subarray(sizes, sub, recv_start);
+      }
+    }
+  };
+} // namespace tensor
+
+#endif
+
+#endif
@@ -16,6 +16,38 @@ namespace tensor
 #endif
   }
 
+  /// @brief throws an out_of_range error for an index of dimension `dim` with size `extent`.
+  inline void tensor_index_out_of_range(long index, long dim, long extent)
+  {
+    char msg[100];
+    snprintf(msg, sizeof(msg), "Index %ld is out of range for dimension %ld with size %ld.", index, dim, extent);
+    tensor_out_of_range(msg);
+  }
+
+  /// @brief throws an out_of_range error for a span of dimension `dim` with size `extent`.
+  inline void tensor_span_out_of_range(long begin, long end, long dim, long extent)
+  {
+    char msg[100];
+    snprintf(msg, sizeof(msg), "span( %ld, %ld ) is out of range for dimension %ld with size %ld.", begin, end, dim, extent);
+    tensor_out_of_range(msg);
+  }
+
+  /// @brief throws an out_of_range error for a linear index of a tensor with `size` elements.
+  inline void tensor_linear_index_out_of_range(long index, long size)
+  {
+    char msg[100];
+    snprintf(msg, sizeof(msg), "linear index = %ld is out of range for tensor with size %ld.", index, size);
+    tensor_out_of_range(msg);
+  }
+
+  /// @brief throws an out_of_range error for a dimension `dim` of a tensor of rank `rank`.
+  inline void tensor_dimension_out_of_range(long dim, long rank)
+  {
+    char msg[100];
+    snprintf(msg, sizeof(msg), "Dimension %ld is out of range for tensor of rank %ld.", dim, rank);
+    tensor_out_of_range(msg);
+  }
+
   /// @brief terminates program/throws exception with message indicating bad memory access.
   inline void tensor_bad_memory_access()
   {
@@ -35,6 +67,17 @@ namespace tensor
     assert(false);
 #else
     throw std::logic_error("TensorView: all dimensions must be strictly positive.");
+#endif
+  }
+
+  /// @brief terminates program/throws exception with message indicating that the shapes of tensors in an operation do not agree.
+  inline void tensor_shape_mismatch()
+  {
+#ifdef TENSOR_USE_CUDA
+    printf("TensorView: the shapes of the tensors do not agree.");
+    assert(false);
+#else
+    throw std::logic_error("TensorView: the shapes of the tensors do not agree.");
 #endif
   }
 } // namespace tensor
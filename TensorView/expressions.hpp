@@ -0,0 +1,457 @@
+#ifndef __TENSOR_VIEW_EXPRESSIONS_HPP__
+#define __TENSOR_VIEW_EXPRESSIONS_HPP__
+
+#include <cmath>
+
+#include "tensorview_config.hpp"
+#include "errors.hpp"
+#include "multi_index.hpp"
+#include "BaseTensor.hpp"
+#include "float16.hpp"
+
+namespace tensor::details
+{
+  template <typename Shape, typename Container>
+  std::true_type is_tensor_impl(const BaseTensor<Shape, Container> *);
+
+  std::false_type is_tensor_impl(...);
+
+  /// @brief true if T is one of the tensor types, i.e. derives from `BaseTensor`.
+  template <typename T>
+  inline constexpr bool is_tensor_v = decltype(is_tensor_impl(std::declval<std::remove_reference_t<T> *>()))::value;
+
+  /// @brief true if T can appear in an elementwise expression as a tensor.
+  template <typename T>
+  inline constexpr bool is_operand_v = is_expression_v<T> || is_tensor_v<T>;
+
+  /// @brief true if T is broadcast to every element in an elementwise expression.
+  template <typename T>
+  inline constexpr bool is_scalar_v = std::is_arithmetic_v<std::decay_t<T>>;
+
+  template <typename L, typename R>
+  inline constexpr bool enable_binary_v = (is_operand_v<L> && (is_operand_v<R> || is_scalar_v<R>)) || (is_scalar_v<L> && is_operand_v<R>);
+
+  /// @brief leaf of an expression which reads from a tensor. Elements of
+  /// the storage types (e.g. `float16`) are read as `compute_t<T>`.
+  /// @tparam Shape shape of the tensor
+  /// @tparam T type of the tensor elements
+  template <typename Shape, typename T>
+  class TensorExpr : public expression_base
+  {
+  public:
+    using value_type = compute_t<std::remove_cv_t<T>>;
+    using layout_type = typename Shape::layout_type;
+
+    TENSOR_FUNC TensorExpr(const Shape &shape_, const T *data) : _shape(shape_), ptr{data} {}
+
+    static constexpr index_t order()
+    {
+      return Shape::order();
+    }
+
+    static constexpr bool is_contiguous()
+    {
+      return Shape::is_contiguous();
+    }
+
+    TENSOR_FUNC index_t shape(index_t d) const
+    {
+      return _shape.shape(d);
+    }
+
+    TENSOR_FUNC index_t size() const
+    {
+      return _shape.size();
+    }
+
+    TENSOR_FUNC value_type operator[](index_t index) const
+    {
+      return ptr[(stride_t)_shape.linear_offset(index)];
+    }
+
+    template <size_t N>
+    TENSOR_FUNC value_type operator()(const std::array<index_t, N> &idx) const
+    {
+      return ptr[(stride_t)apply_index(_shape, idx)];
+    }
+
+  private:
+    Shape _shape;
+    const T *ptr;
+  };
+
+  /// @brief leaf of an expression which broadcasts a scalar to every element.
+  template <typename T>
+  class ScalarExpr : public expression_base
+  {
+  public:
+    using value_type = T;
+    using layout_type = void;
+
+    TENSOR_FUNC ScalarExpr(T value_) : value{value_} {}
+
+    static constexpr index_t order()
+    {
+      return 0;
+    }
+
+    static constexpr bool is_contiguous()
+    {
+      return true;
+    }
+
+    TENSOR_FUNC index_t shape(index_t) const
+    {
+      return 1;
+    }
+
+    TENSOR_FUNC index_t size() const
+    {
+      return 1;
+    }
+
+    TENSOR_FUNC value_type operator[](index_t) const
+    {
+      return value;
+    }
+
+    template <size_t N>
+    TENSOR_FUNC value_type operator()(const std::array<index_t, N> &) const
+    {
+      return value;
+    }
+
+  private:
+    T value;
+  };
+
+  /// @brief elementwise `op(a)`.
+  template <typename Op, typename A>
+  class UnaryExpr : public expression_base
+  {
+  public:
+    using value_type = decltype(std::declval<Op>()(std::declval<typename A::value_type>()));
+    using layout_type = typename A::layout_type;
+
+    TENSOR_FUNC UnaryExpr(Op op_, const A &a_) : op(op_), a(a_) {}
+
+    static constexpr index_t order()
+    {
+      return A::order();
+    }
+
+    static constexpr bool is_contiguous()
+    {
+      return A::is_contiguous();
+    }
+
+    TENSOR_FUNC index_t shape(index_t d) const
+    {
+      return a.shape(d);
+    }
+
+    TENSOR_FUNC index_t size() const
+    {
+      return a.size();
+    }
+
+    TENSOR_FUNC value_type operator[](index_t index) const
+    {
+      return op(a[index]);
+    }
+
+    template <size_t N>
+    TENSOR_FUNC value_type operator()(const std::array<index_t, N> &idx) const
+    {
+      return op(a(idx));
+    }
+
+  private:
+    Op op;
+    A a;
+  };
+
+  /// @brief elementwise `op(a, b)`. Either operand may be a scalar.
+  template <typename Op, typename A, typename B>
+  class BinaryExpr : public expression_base
+  {
+  public:
+    using value_type = decltype(std::declval<Op>()(std::declval<typename A::value_type>(), std::declval<typename B::value_type>()));
+    using layout_type = common_layout_t<typename A::layout_type, typename B::layout_type>;
+
+    static_assert(A::order() == B::order() || A::order() == 0 || B::order() == 0, "operands of an elementwise expression must have the same number of dimensions.");
+
+    TENSOR_FUNC BinaryExpr(Op op_, const A &a_, const B &b_) : op(op_), a(a_), b(b_)
+    {
+#ifdef TENSOR_CHECK_BOUNDS
+      if constexpr (A::order() != 0 && B::order() != 0)
+      {
+        for (index_t d = 0; d < A::order(); ++d)
+          if (a.shape(d) != b.shape(d))
+            tensor_shape_mismatch();
+      }
+#endif
+    }
+
+    static constexpr index_t order()
+    {
+      return (A::order() != 0) ? A::order() : B::order();
+    }
+
+    /// @brief true if both operands are contiguous with the same layout.
+    static constexpr bool is_contiguous()
+    {
+      return A::is_contiguous() && B::is_contiguous() && same_layout_v<typename A::layout_type, typename B::layout_type>;
+    }
+
+    TENSOR_FUNC index_t shape(index_t d) const
+    {
+      if constexpr (A::order() != 0)
+        return a.shape(d);
+      else
+        return b.shape(d);
+    }
+
+    TENSOR_FUNC index_t size() const
+    {
+      if constexpr (A::order() != 0)
+        return a.size();
+      else
+        return b.size();
+    }
+
+    TENSOR_FUNC value_type operator[](index_t index) const
+    {
+      return op(a[index], b[index]);
+    }
+
+    template <size_t N>
+    TENSOR_FUNC value_type operator()(const std::array<index_t, N> &idx) const
+    {
+      return op(a(idx), b(idx));
+    }
+
+  private:
+    Op op;
+    A a;
+    B b;
+  };
+
+  /// @brief wraps a tensor, scalar, or expression as an expression node.
+  template <typename T>
+  TENSOR_FUNC auto as_expression(const T &x)
+  {
+    if constexpr (is_expression_v<T>)
+      return x;
+    else if constexpr (is_scalar_v<T>)
+      return ScalarExpr<T>(x);
+    else
+    {
+      using shape_type = std::decay_t<decltype(x.shape())>;
+      using value_type = std::remove_cv_t<typename T::value_type>;
+      return TensorExpr<shape_type, const value_type>(x.shape(), x.data());
+    }
+  }
+
+  template <typename Op, typename A>
+  TENSOR_FUNC auto make_unary(Op op, const A &a)
+  {
+    using expr_a = decltype(as_expression(a));
+    return UnaryExpr<Op, expr_a>(op, as_expression(a));
+  }
+
+  template <typename Op, typename A, typename B>
+  TENSOR_FUNC auto make_binary(Op op, const A &a, const B &b)
+  {
+    using expr_a = decltype(as_expression(a));
+    using expr_b = decltype(as_expression(b));
+    return BinaryExpr<Op, expr_a, expr_b>(op, as_expression(a), as_expression(b));
+  }
+
+  struct plus_op
+  {
+    template <typename T, typename U>
+    TENSOR_FUNC auto operator()(T x, U y) const { return x + y; }
+  };
+
+  struct minus_op
+  {
+    template <typename T, typename U>
+    TENSOR_FUNC auto operator()(T x, U y) const { return x - y; }
+  };
+
+  struct multiplies_op
+  {
+    template <typename T, typename U>
+    TENSOR_FUNC auto operator()(T x, U y) const { return x * y; }
+  };
+
+  struct divides_op
+  {
+    template <typename T, typename U>
+    TENSOR_FUNC auto operator()(T x, U y) const { return x / y; }
+  };
+
+  struct negate_op
+  {
+    template <typename T>
+    TENSOR_FUNC auto operator()(T x) const { return -x; }
+  };
+
+  // the math functions are not constexpr, so they are only marked host/device.
+#define TENSOR_UNARY_MATH_OP(name)                         \
+  struct name##_op                                         \
+  {                                                        \
+    template <typename T>                                  \
+    TENSOR_HOST_DEVICE inline auto operator()(T x) const   \
+    {                                                      \
+      using std::name;                                     \
+      return name(x);                                      \
+    }                                                      \
+  };
+
+  TENSOR_UNARY_MATH_OP(abs)
+  TENSOR_UNARY_MATH_OP(sqrt)
+  TENSOR_UNARY_MATH_OP(exp)
+  TENSOR_UNARY_MATH_OP(log)
+  TENSOR_UNARY_MATH_OP(sin)
+  TENSOR_UNARY_MATH_OP(cos)
+  TENSOR_UNARY_MATH_OP(tan)
+  TENSOR_UNARY_MATH_OP(tanh)
+
+#undef TENSOR_UNARY_MATH_OP
+
+  struct pow_op
+  {
+    template <typename T, typename U>
+    TENSOR_HOST_DEVICE inline auto operator()(T x, U y) const
+    {
+      using std::pow;
+      return pow(x, y);
+    }
+  };
+
+  struct min_op
+  {
+    template <typename T, typename U>
+    TENSOR_FUNC auto operator()(T x, U y) const { return (y < x) ? y : x; }
+  };
+
+  struct max_op
+  {
+    template <typename T, typename U>
+    TENSOR_FUNC auto operator()(T x, U y) const { return (x < y) ? y : x; }
+  };
+
+  /// @brief elementwise sum. Either operand may be a scalar.
+  template <typename A, typename B, typename = std::enable_if_t<enable_binary_v<A, B>>>
+  TENSOR_FUNC auto operator+(const A &a, const B &b)
+  {
+    return make_binary(plus_op{}, a, b);
+  }
+
+  /// @brief elementwise difference. Either operand may be a scalar.
+  template <typename A, typename B, typename = std::enable_if_t<enable_binary_v<A, B>>>
+  TENSOR_FUNC auto operator-(const A &a, const B &b)
+  {
+    return make_binary(minus_op{}, a, b);
+  }
+
+  /// @brief elementwise product. Either operand may be a scalar.
+  template <typename A, typename B, typename = std::enable_if_t<enable_binary_v<A, B>>>
+  TENSOR_FUNC auto operator*(const A &a, const B &b)
+  {
+    return make_binary(multiplies_op{}, a, b);
+  }
+
+  /// @brief elementwise quotient. Either operand may be a scalar.
+  template <typename A, typename B, typename = std::enable_if_t<enable_binary_v<A, B>>>
+  TENSOR_FUNC auto operator/(const A &a, const B &b)
+  {
+    return make_binary(divides_op{}, a, b);
+  }
+
+  /// @brief elementwise negation.
+  template <typename A, typename = std::enable_if_t<is_operand_v<A>>>
+  TENSOR_FUNC auto operator-(const A &a)
+  {
+    return make_unary(negate_op{}, a);
+  }
+
+  /// @brief x = x + b
+  template <typename A, typename B, typename = std::enable_if_t<is_tensor_v<A> && (is_operand_v<B> || is_scalar_v<B>)>>
+  TENSOR_FUNC std::remove_reference_t<A> &operator+=(A &&x, const B &b)
+  {
+    x = x + b;
+    return x;
+  }
+
+  /// @brief x = x - b
+  template <typename A, typename B, typename = std::enable_if_t<is_tensor_v<A> && (is_operand_v<B> || is_scalar_v<B>)>>
+  TENSOR_FUNC std::remove_reference_t<A> &operator-=(A &&x, const B &b)
+  {
+    x = x - b;
+    return x;
+  }
+
+  /// @brief x = x * b
+  template <typename A, typename B, typename = std::enable_if_t<is_tensor_v<A> && (is_operand_v<B> || is_scalar_v<B>)>>
+  TENSOR_FUNC std::remove_reference_t<A> &operator*=(A &&x, const B &b)
+  {
+    x = x * b;
+    return x;
+  }
+
+  /// @brief x = x / b
+  template <typename A, typename B, typename = std::enable_if_t<is_tensor_v<A> && (is_operand_v<B> || is_scalar_v<B>)>>
+  TENSOR_FUNC std::remove_reference_t<A> &operator/=(A &&x, const B &b)
+  {
+    x = x / b;
+    return x;
+  }
+} // namespace tensor::details
+
+namespace tensor
+{
+#define TENSOR_UNARY_MATH_FUNCTION(name)                                        \
+  /** @brief elementwise name(x) of a tensor or expression. */                 \
+  template <typename A, typename = std::enable_if_t<details::is_operand_v<A>>> \
+  TENSOR_FUNC auto name(const A &a)                                             \
+  {                                                                             \
+    return details::make_unary(details::name##_op{}, a);                        \
+  }
+
+  TENSOR_UNARY_MATH_FUNCTION(abs)
+  TENSOR_UNARY_MATH_FUNCTION(sqrt)
+  TENSOR_UNARY_MATH_FUNCTION(exp)
+  TENSOR_UNARY_MATH_FUNCTION(log)
+  TENSOR_UNARY_MATH_FUNCTION(sin)
+  TENSOR_UNARY_MATH_FUNCTION(cos)
+  TENSOR_UNARY_MATH_FUNCTION(tan)
+  TENSOR_UNARY_MATH_FUNCTION(tanh)
+
+#undef TENSOR_UNARY_MATH_FUNCTION
+
+  /// @brief elementwise pow(a, b). Either operand may be a scalar.
+  template <typename A, typename B, typename = std::enable_if_t<details::enable_binary_v<A, B>>>
+  TENSOR_FUNC auto pow(const A &a, const B &b)
+  {
+    return details::make_binary(details::pow_op{}, a, b);
+  }
+
+  /// @brief elementwise minimum. Either operand may be a scalar.
+  template <typename A, typename B, typename = std::enable_if_t<details::enable_binary_v<A, B>>>
+  TENSOR_FUNC auto min(const A &a, const B &b)
+  {
+    return details::make_binary(details::min_op{}, a, b);
+  }
+
+  /// @brief elementwise maximum. Either operand may be a scalar.
+  template <typename A, typename B, typename = std::enable_if_t<details::enable_binary_v<A, B>>>
+  TENSOR_FUNC auto max(const A &a, const B &b)
+  {
+    return details::make_binary(details::max_op{}, a, b);
+  }
+} // namespace tensor
+
+#endif
@@ -0,0 +1,335 @@
+#ifndef __TENSOR_VIEW_FIXED_LINALG_HPP__
+#define __TENSOR_VIEW_FIXED_LINALG_HPP__
+
+#include "tensorview_config.hpp"
+#include "FixedTensorShape.hpp"
+#include "BaseTensor.hpp"
+#include "FixedTensor.hpp"
+
+// Kernels for tensors whose shape is known at compile time. Every loop is
+// unrolled through a std::index_sequence over the shape so that the kernels
+// compile to straight-line code. All matrices are column major, i.e.
+// A(i, j) = A[i + M * j].
+
+namespace tensor::details
+{
+  template <typename A, typename B>
+  using product_t = decltype(std::declval<std::remove_cv_t<A>>() * std::declval<std::remove_cv_t<B>>());
+
+  template <typename T, typename Seq>
+  struct fixed_tensor_of;
+
+  template <typename T, size_t... S>
+  struct fixed_tensor_of<T, std::index_sequence<S...>>
+  {
+    using type = FixedTensor<T, S...>;
+  };
+
+  template <typename A, typename B>
+  struct concat_sequence;
+
+  template <size_t... I, size_t... J>
+  struct concat_sequence<std::index_sequence<I...>, std::index_sequence<J...>>
+  {
+    using type = std::index_sequence<I..., J...>;
+  };
+
+  // the shape S... with dimension Skip removed
+  template <size_t Skip, size_t... S>
+  struct drop_dim
+  {
+    static constexpr size_t dims[] = {S...};
+
+    template <size_t... k>
+    static auto make(std::index_sequence<k...>) -> std::index_sequence<dims[(k < Skip) ? k : k + 1]...>;
+
+    using type = decltype(make(std::make_index_sequence<sizeof...(S) - 1>{}));
+  };
+
+  // distance between consecutive entries along dimension Dim of a column
+  // major tensor with shape S...
+  template <size_t Dim, size_t... S>
+  constexpr size_t fixed_stride()
+  {
+    constexpr size_t dims[] = {S...};
+    size_t stride = 1;
+    for (size_t d = 0; d < Dim; ++d)
+      stride *= dims[d];
+    return stride;
+  }
+
+  // offset of the l-th element of the tensor with shape S... when dimension
+  // Skip is held at zero.
+  template <size_t Skip, size_t... S>
+  constexpr size_t fixed_offset_without(size_t l)
+  {
+    constexpr size_t dims[] = {S...};
+    size_t offset = 0, stride = 1;
+    for (size_t d = 0; d < sizeof...(S); ++d)
+    {
+      if (d != Skip)
+      {
+        offset += (l % dims[d]) * stride;
+        l /= dims[d];
+      }
+      stride *= dims[d];
+    }
+    return offset;
+  }
+
+  // a * b + c, fused when the target has a fast fma instruction. The host
+  // compiler does not contract a * b + c on its own in ISO C++ mode (nvcc
+  // does by default).
+  template <typename T>
+  TENSOR_FUNC T fmadd(T a, T b, T c)
+  {
+#ifndef __CUDA_ARCH__
+    if constexpr (std::is_same_v<T, double>)
+    {
+#ifdef __FP_FAST_FMA
+      return __builtin_fma(a, b, c);
+#endif
+    }
+    else if constexpr (std::is_same_v<T, float>)
+    {
+#ifdef __FP_FAST_FMAF
+      return __builtin_fmaf(a, b, c);
+#endif
+    }
+#endif
+    return a * b + c;
+  }
+
+  // sum_k a[oa + sa * k] * b[ob + sb * k]
+  template <size_t oa, size_t sa, size_t ob, size_t sb, typename R, typename A, typename B, size_t... k>
+  TENSOR_FUNC R fixed_dot(const A &a, const B &b, std::index_sequence<k...>)
+  {
+    R acc = 0;
+    ((acc = fmadd<R>(a[oa + sa * k], b[ob + sb * k], acc)), ...);
+    return acc;
+  }
+
+  template <size_t M, size_t K, typename C, typename A, typename B, size_t... L>
+  TENSOR_FUNC void fixed_matmul(C &c, const A &a, const B &b, std::index_sequence<L...>)
+  {
+    using R = std::remove_cv_t<typename C::value_type>;
+    ((c[L] = fixed_dot<L % M, M, K *(L / M), 1, R>(a, b, std::make_index_sequence<K>{})), ...);
+  }
+
+  template <size_t M, size_t N, typename C, typename A, size_t... L>
+  TENSOR_FUNC void fixed_transpose(C &c, const A &a, std::index_sequence<L...>)
+  {
+    // c(j, i) = a(i, j), L = i + M * j
+    ((c[L / M + N * (L % M)] = a[L]), ...);
+  }
+
+  template <size_t I, size_t J, typename Sa, typename Sb>
+  struct fixed_tensordot;
+
+  template <size_t I, size_t J, size_t... Sa, size_t... Sb>
+  struct fixed_tensordot<I, J, std::index_sequence<Sa...>, std::index_sequence<Sb...>>
+  {
+    static_assert(I < sizeof...(Sa) && J < sizeof...(Sb), "contracted dimension is out of range.");
+
+    static constexpr size_t dims_a[] = {Sa...};
+    static constexpr size_t dims_b[] = {Sb...};
+    static_assert(dims_a[I] == dims_b[J], "contracted dimensions must have the same size.");
+
+    // size of the contracted dimension
+    static constexpr size_t K = dims_a[I];
+    // number of elements of A and B without the contracted dimension
+    static constexpr size_t PA = (1 * ... * Sa) / K;
+    static constexpr size_t PB = (1 * ... * Sb) / K;
+
+    using shape_type = typename concat_sequence<typename drop_dim<I, Sa...>::type, typename drop_dim<J, Sb...>::type>::type;
+
+    template <typename C, typename A, typename B, size_t... L>
+    static TENSOR_FUNC void apply(C &c, const A &a, const B &b, std::index_sequence<L...>)
+    {
+      using R = std::remove_cv_t<typename C::value_type>;
+      ((c[L] = fixed_dot<fixed_offset_without<I, Sa...>(L % PA), fixed_stride<I, Sa...>(),
+                         fixed_offset_without<J, Sb...>(L / PA), fixed_stride<J, Sb...>(), R>(a, b, std::make_index_sequence<K>{})),
+       ...);
+    }
+  };
+} // namespace tensor::details
+
+namespace tensor
+{
+  /// @brief returns the matrix product A * B of fixed size matrices.
+  template <size_t M, size_t K, size_t N, typename CA, typename CB>
+  TENSOR_FUNC auto matmul(const details::BaseTensor<details::FixedTensorShape<M, K>, CA> &A, const details::BaseTensor<details::FixedTensorShape<K, N>, CB> &B)
+  {
+    using R = details::product_t<typename CA::value_type, typename CB::value_type>;
+    FixedTensor<R, M, N> C;
+    details::fixed_matmul<M, K>(C, A, B, std::make_index_sequence<M * N>{});
+    return C;
+  }
+
+  /// @brief returns the matrix-vector product A * x of a fixed size matrix and vector.
+  template <size_t M, size_t K, typename CA, typename CX>
+  TENSOR_FUNC auto matvec(const details::BaseTensor<details::FixedTensorShape<M, K>, CA> &A, const details::BaseTensor<details::FixedTensorShape<K>, CX> &x)
+  {
+    using R = details::product_t<typename CA::value_type, typename CX::value_type>;
+    FixedTensor<R, M> y;
+    details::fixed_matmul<M, K>(y, A, x, std::make_index_sequence<M>{});
+    return y;
+  }
+
+  /// @brief returns the transpose of a fixed size matrix as a new `FixedTensor`.
+  template <size_t M, size_t N, typename C>
+  TENSOR_FUNC auto transpose(const details::BaseTensor<details::FixedTensorShape<M, N>, C> &A)
+  {
+    FixedTensor<std::remove_cv_t<typename C::value_type>, N, M> At;
+    details::fixed_transpose<M, N>(At, A, std::make_index_sequence<M * N>{});
+    return At;
+  }
+
+  /// @brief returns the determinant of a fixed size square matrix with at most 4 rows.
+  template <size_t N, typename C>
+  TENSOR_FUNC auto det(const details::BaseTensor<details::FixedTensorShape<N, N>, C> &A)
+  {
+    static_assert(1 <= N && N <= 4, "det is only implemented for matrices of size 1x1 to 4x4.");
+    using T = std::remove_cv_t<typename C::value_type>;
+
+    if constexpr (N == 1)
+    {
+      return T(A[0]);
+    }
+    else if constexpr (N == 2)
+    {
+      return T(A(0, 0) * A(1, 1) - A(0, 1) * A(1, 0));
+    }
+    else if constexpr (N == 3)
+    {
+      return T(A(0, 0) * (A(1, 1) * A(2, 2) - A(1, 2) * A(2, 1)) + A(0, 1) * (A(1, 2) * A(2, 0) - A(1, 0) * A(2, 2)) + A(0, 2) * (A(1, 0) * A(2, 1) - A(1, 1) * A(2, 0)));
+    }
+    else
+    {
+      const T s0 = A(0, 0) * A(1, 1) - A(1, 0) * A(0, 1);
+      const T s1 = A(0, 0) * A(1, 2) - A(1, 0) * A(0, 2);
+      const T s2 = A(0, 0) * A(1, 3) - A(1, 0) * A(0, 3);
+      const T s3 = A(0, 1) * A(1, 2) - A(1, 1) * A(0, 2);
+      const T s4 = A(0, 1) * A(1, 3) - A(1, 1) * A(0, 3);
+      const T s5 = A(0, 2) * A(1, 3) - A(1, 2) * A(0, 3);
+
+      const T c5 = A(2, 2) * A(3, 3) - A(3, 2) * A(2, 3);
+      const T c4 = A(2, 1) * A(3, 3) - A(3, 1) * A(2, 3);
+      const T c3 = A(2, 1) * A(3, 2) - A(3, 1) * A(2, 2);
+      const T c2 = A(2, 0) * A(3, 3) - A(3, 0) * A(2, 3);
+      const T c1 = A(2, 0) * A(3, 2) - A(3, 0) * A(2, 2);
+      const T c0 = A(2, 0) * A(3, 1) - A(3, 0) * A(2, 1);
+
+      return s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+    }
+  }
+
+  /// @brief returns the inverse of a fixed size square matrix with at most 4
+  /// rows. The matrix is assumed to be invertible.
+  template <size_t N, typename C>
+  TENSOR_FUNC auto inv(const details::BaseTensor<details::FixedTensorShape<N, N>, C> &A)
+  {
+    static_assert(1 <= N && N <= 4, "inv is only implemented for matrices of size 1x1 to 4x4.");
+    using T = std::remove_cv_t<typename C::value_type>;
+    FixedTensor<T, N, N> B;
+
+    if constexpr (N == 1)
+    {
+      B[0] = T(1) / A[0];
+    }
+    else if constexpr (N == 2)
+    {
+      const T r = T(1) / det(A);
+      B(0, 0) = r * A(1, 1);
+      B(1, 0) = -r * A(1, 0);
+      B(0, 1) = -r * A(0, 1);
+      B(1, 1) = r * A(0, 0);
+    }
+    else if constexpr (N == 3)
+    {
+      const T c00 = A(1, 1) * A(2, 2) - A(1, 2) * A(2, 1);
+      const T c01 = A(1, 2) * A(2, 0) - A(1, 0) * A(2, 2);
+      const T c02 = A(1, 0) * A(2, 1) - A(1, 1) * A(2, 0);
+      const T r = T(1) / (A(0, 0) * c00 + A(0, 1) * c01 + A(0, 2) * c02);
+
+      B(0, 0) = r * c00;
+      B(1, 0) = r * c01;
+      B(2, 0) = r * c02;
+      B(0, 1) = r * (A(0, 2) * A(2, 1) - A(0, 1) * A(2, 2));
+      B(1, 1) = r * (A(0, 0) * A(2, 2) - A(0, 2) * A(2, 0));
+      B(2, 1) = r * (A(0, 1) * A(2, 0) - A(0, 0) * A(2, 1));
+      B(0, 2) = r * (A(0, 1) * A(1, 2) - A(0, 2) * A(1, 1));
+      B(1, 2) = r * (A(0, 2) * A(1, 0) - A(0, 0) * A(1, 2));
+      B(2, 2) = r * (A(0, 0) * A(1, 1) - A(0, 1) * A(1, 0));
+    }
+    else
+    {
+      const T s0 = A(0, 0) * A(1, 1) - A(1, 0) * A(0, 1);
+      const T s1 = A(0, 0) * A(1, 2) - A(1, 0) * A(0, 2);
+      const T s2 = A(0, 0) * A(1, 3) - A(1, 0) * A(0, 3);
+      const T s3 = A(0, 1) * A(1, 2) - A(1, 1) * A(0, 2);
+      const T s4 = A(0, 1) * A(1, 3) - A(1, 1) * A(0, 3);
+      const T s5 = A(0, 2) * A(1, 3) - A(1, 2) * A(0, 3);
+
+      const T c5 = A(2, 2) * A(3, 3) - A(3, 2) * A(2, 3);
+      const T c4 = A(2, 1) * A(3, 3) - A(3, 1) * A(2, 3);
+      const T c3 = A(2, 1) * A(3, 2) - A(3, 1) * A(2, 2);
+      const T c2 = A(2, 0) * A(3, 3) - A(3, 0) * A(2, 3);
+      const T c1 = A(2, 0) * A(3, 2) - A(3, 0) * A(2, 2);
+      const T c0 = A(2, 0) * A(3, 1) - A(3, 0) * A(2, 1);
+
+      const T r = T(1) / (s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0);
+
+      B(0, 0) = r * (A(1, 1) * c5 - A(1, 2) * c4 + A(1, 3) * c3);
+      B(0, 1) = r * (-A(0, 1) * c5 + A(0, 2) * c4 - A(0, 3) * c3);
+      B(0, 2) = r * (A(3, 1) * s5 - A(3, 2) * s4 + A(3, 3) * s3);
+      B(0, 3) = r * (-A(2, 1) * s5 + A(2, 2) * s4 - A(2, 3) * s3);
+
+      B(1, 0) = r * (-A(1, 0) * c5 + A(1, 2) * c2 - A(1, 3) * c1);
+      B(1, 1) = r * (A(0, 0) * c5 - A(0, 2) * c2 + A(0, 3) * c1);
+      B(1, 2) = r * (-A(3, 0) * s5 + A(3, 2) * s2 - A(3, 3) * s1);
+      B(1, 3) = r * (A(2, 0) * s5 - A(2, 2) * s2 + A(2, 3) * s1);
+
+      B(2, 0) = r * (A(1, 0) * c4 - A(1, 1) * c2 + A(1, 3) * c0);
+      B(2, 1) = r * (-A(0, 0) * c4 + A(0, 1) * c2 - A(0, 3) * c0);
+      B(2, 2) = r * (A(3, 0) * s4 - A(3, 1) * s2 + A(3, 3) * s0);
+      B(2, 3) = r * (-A(2, 0) * s4 + A(2, 1) * s2 - A(2, 3) * s0);
+
+      B(3, 0) = r * (-A(1, 0) * c3 + A(1, 1) * c1 - A(1, 2) * c0);
+      B(3, 1) = r * (A(0, 0) * c3 - A(0, 1) * c1 + A(0, 2) * c0);
+      B(3, 2) = r * (-A(3, 0) * s3 + A(3, 1) * s1 - A(3, 2) * s0);
+      B(3, 3) = r * (A(2, 0) * s3 - A(2, 1) * s1 + A(2, 2) * s0);
+    }
+
+    return B;
+  }
+
+  /**
+   * @brief contracts dimension I of A with dimension J of B.
+   *
+   * @details The result has the dimensions of A without I followed by the
+   * dimensions of B without J, e.g. `tensordot<1, 0>(A, B)` is the matrix
+   * product of two matrices. When both A and B are vectors, the result is a
+   * scalar.
+   */
+  template <size_t I, size_t J, size_t... Sa, size_t... Sb, typename CA, typename CB>
+  TENSOR_FUNC auto tensordot(const details::BaseTensor<details::FixedTensorShape<Sa...>, CA> &A, const details::BaseTensor<details::FixedTensorShape<Sb...>, CB> &B)
+  {
+    using R = details::product_t<typename CA::value_type, typename CB::value_type>;
+    using kernel = details::fixed_tensordot<I, J, std::index_sequence<Sa...>, std::index_sequence<Sb...>>;
+    using shape_type = typename kernel::shape_type;
+
+    if constexpr (shape_type::size() == 0)
+    {
+      return details::fixed_dot<0, 1, 0, 1, R>(A, B, std::make_index_sequence<kernel::K>{});
+    }
+    else
+    {
+      typename details::fixed_tensor_of<R, shape_type>::type C;
+      kernel::apply(C, A, B, std::make_index_sequence<kernel::PA * kernel::PB>{});
+      return C;
+    }
+  }
+} // namespace tensor
+
+#endif
@@ -0,0 +1,203 @@
+#ifndef __TENSOR_VIEW_FLOAT16_HPP__
+#define __TENSOR_VIEW_FLOAT16_HPP__
+
+#include <cstdint>
+#include <cstring>
+
+#include "tensorview_config.hpp"
+
+#if defined(__F16C__) && !defined(__CUDA_ARCH__) && !defined(TENSOR_NO_SIMD)
+#include <immintrin.h>
+#define TENSOR_F16C
+#endif
+
+namespace tensor
+{
+  namespace details
+  {
+    TENSOR_HOST_DEVICE inline float bits_to_float(uint32_t u)
+    {
+      float x;
+      std::memcpy(&x, &u, sizeof(x));
+      return x;
+    }
+
+    TENSOR_HOST_DEVICE inline uint32_t float_to_bits(float x)
+    {
+      uint32_t u;
+      std::memcpy(&u, &x, sizeof(u));
+      return u;
+    }
+
+    /// @brief IEEE binary16 bits of x rounded to nearest even. Values too
+    /// large for half precision become infinite, NaNs stay NaNs.
+    TENSOR_HOST_DEVICE inline uint16_t float_to_half_bits(float x)
+    {
+#ifdef TENSOR_F16C
+      return _cvtss_sh(x, _MM_FROUND_TO_NEAREST_INT);
+#else
+      uint32_t f = float_to_bits(x);
+      const uint32_t sign = f & 0x80000000u;
+      f ^= sign;
+
+      uint16_t h;
+      if (f >= 0x47800000u) // |x| >= 65536: infinity or NaN
+      {
+        h = (f > 0x7f800000u) ? 0x7e00 : 0x7c00;
+      }
+      else if (f < 0x38800000u) // |x| < 2^-14: subnormal or zero
+      {
+        // the addition shifts the mantissa into place and rounds it
+        const uint32_t magic = 126u << 23;
+        h = static_cast<uint16_t>(float_to_bits(bits_to_float(f) + bits_to_float(magic)) - magic);
+      }
+      else
+      {
+        const uint32_t odd = (f >> 13) & 1;
+        f += (uint32_t(15 - 127) << 23) + 0xfff + odd;
+        h = static_cast<uint16_t>(f >> 13);
+      }
+      return h | static_cast<uint16_t>(sign >> 16);
+#endif
+    }
+
+    /// @brief the value of IEEE binary16 bits h. The conversion is exact.
+    TENSOR_HOST_DEVICE inline float half_bits_to_float(uint16_t h)
+    {
+#ifdef TENSOR_F16C
+      return _cvtsh_ss(h);
+#else
+      const uint32_t shifted_exp = 0x7c00u << 13;
+      uint32_t f = uint32_t(h & 0x7fff) << 13;
+      const uint32_t exp = f & shifted_exp;
+      f += uint32_t(127 - 15) << 23;
+
+      if (exp == shifted_exp) // infinity or NaN
+        f += uint32_t(128 - 16) << 23;
+      else if (exp == 0) // subnormal or zero
+        f = float_to_bits(bits_to_float(f + (1u << 23)) - bits_to_float(113u << 23));
+
+      return bits_to_float(f | (uint32_t(h & 0x8000) << 16));
+#endif
+    }
+
+    /// @brief bfloat16 bits of x rounded to nearest even. NaNs stay NaNs.
+    TENSOR_HOST_DEVICE inline uint16_t float_to_bfloat16_bits(float x)
+    {
+      const uint32_t f = float_to_bits(x);
+      if ((f & 0x7fffffffu) > 0x7f800000u)
+        return static_cast<uint16_t>((f >> 16) | 0x0040);
+      return static_cast<uint16_t>((f + 0x7fff + ((f >> 16) & 1)) >> 16);
+    }
+
+    /// @brief the value of bfloat16 bits b. The conversion is exact.
+    TENSOR_HOST_DEVICE inline float bfloat16_bits_to_float(uint16_t b)
+    {
+      return bits_to_float(uint32_t(b) << 16);
+    }
+  } // namespace details
+
+  /**
+   * @brief IEEE half precision (binary16) storage type.
+   *
+   * @details Elements are stored in 16 bits and read and written as `float`:
+   * a `float16` converts implicitly to and from `float`, so a
+   * `Tensor<float16, 3>` is indexed, viewed and sliced like any other tensor,
+   * `A(i, j) = 0.5f` rounds to half precision, and arithmetic on its elements
+   * is done in single precision. Elementwise expressions and the reductions
+   * compute in `float` (see `compute_t`). The range is about 6e-8 to 65504
+   * with 11 significant bits.
+   */
+  struct float16
+  {
+    uint16_t bits;
+
+    float16() = default;
+
+    TENSOR_HOST_DEVICE inline float16(float x) : bits{details::float_to_half_bits(x)} {}
+
+    TENSOR_HOST_DEVICE inline operator float() const
+    {
+      return details::half_bits_to_float(bits);
+    }
+
+    /// @brief the value with the given binary16 bits.
+    TENSOR_HOST_DEVICE static inline float16 from_bits(uint16_t b)
+    {
+      float16 h;
+      h.bits = b;
+      return h;
+    }
+
+    TENSOR_HOST_DEVICE inline float16 &operator+=(float x) { return *this = float(*this) + x; }
+    TENSOR_HOST_DEVICE inline float16 &operator-=(float x) { return *this = float(*this) - x; }
+    TENSOR_HOST_DEVICE inline float16 &operator*=(float x) { return *this = float(*this) * x; }
+    TENSOR_HOST_DEVICE inline float16 &operator/=(float x) { return *this = float(*this) / x; }
+  };
+
+  /**
+   * @brief bfloat16 storage type: the upper 16 bits of a `float`.
+   *
+   * @details Like `float16`, elements are read and written as `float`.
+   * bfloat16 keeps the range of `float` with 8 significant bits, and
+   * converts to `float` with a shift.
+   */
+  struct bfloat16
+  {
+    uint16_t bits;
+
+    bfloat16() = default;
+
+    TENSOR_HOST_DEVICE inline bfloat16(float x) : bits{details::float_to_bfloat16_bits(x)} {}
+
+    TENSOR_HOST_DEVICE inline operator float() const
+    {
+      return details::bfloat16_bits_to_float(bits);
+    }
+
+    /// @brief the value with the given bfloat16 bits.
+    TENSOR_HOST_DEVICE static inline bfloat16 from_bits(uint16_t b)
+    {
+      bfloat16 h;
+      h.bits = b;
+      return h;
+    }
+
+    TENSOR_HOST_DEVICE inline bfloat16 &operator+=(float x) { return *this = float(*this) + x; }
+    TENSOR_HOST_DEVICE inline bfloat16 &operator-=(float x) { return *this = float(*this) - x; }
+    TENSOR_HOST_DEVICE inline bfloat16 &operator*=(float x) { return *this = float(*this) * x; }
+    TENSOR_HOST_DEVICE inline bfloat16 &operator/=(float x) { return *this = float(*this) / x; }
+  };
+
+  /// @brief the type in which elements of type T are computed: `float` for
+  /// the 16 bit storage types, T otherwise.
+  template <typename T>
+  struct compute_type
+  {
+    using type = T;
+  };
+
+  template <>
+  struct compute_type<float16>
+  {
+    using type = float;
+  };
+
+  template <>
+  struct compute_type<bfloat16>
+  {
+    using type = float;
+  };
+
+  template <typename T>
+  using compute_t = typename compute_type<T>::type;
+
+  namespace details
+  {
+    /// @brief true for the types which are only stored, see `compute_t`.
+    template <typename T>
+    inline constexpr bool is_storage_type_v = !std::is_same_v<compute_t<T>, T>;
+  } // namespace details
+} // namespace tensor
+
+#endif
@@ -0,0 +1,93 @@
+#ifndef __TENSOR_VIEW_LAYOUT_HPP__
+#define __TENSOR_VIEW_LAYOUT_HPP__
+
+#include "tensorview_config.hpp"
+
+namespace tensor::layout
+{
+  /// @brief column-major (Fortran) order: the first index is the fastest.
+  /// This is the default layout of every tensor.
+  struct left
+  {
+    static constexpr size_t padding = 1;
+  };
+
+  /// @brief row-major (C) order: the last index is the fastest. Matches the
+  /// default layout of NumPy and PyTorch arrays.
+  struct right
+  {
+    static constexpr size_t padding = 1;
+  };
+
+  /// @brief column-major order where the leading dimension (the distance
+  /// between consecutive columns) is padded to a multiple of `Padding`
+  /// elements, so that every column starts at the same alignment as the
+  /// first one.
+  template <size_t Padding>
+  struct left_padded
+  {
+    static_assert(Padding > 0, "the padding must be positive.");
+    static constexpr size_t padding = Padding;
+  };
+
+  /// @brief row-major order where the distance between consecutive rows is
+  /// padded to a multiple of `Padding` elements.
+  template <size_t Padding>
+  struct right_padded
+  {
+    static_assert(Padding > 0, "the padding must be positive.");
+    static constexpr size_t padding = Padding;
+  };
+
+  /// @brief arbitrary strides, e.g. `SubView` and `StridedView`.
+  struct stride
+  {
+  };
+} // namespace tensor::layout
+
+namespace tensor::details
+{
+  template <typename Layout>
+  struct layout_traits
+  {
+    static constexpr bool is_right = false;
+    static constexpr index_t padding = 1;
+  };
+
+  template <>
+  struct layout_traits<layout::right>
+  {
+    static constexpr bool is_right = true;
+    static constexpr index_t padding = 1;
+  };
+
+  template <size_t Padding>
+  struct layout_traits<layout::left_padded<Padding>>
+  {
+    static constexpr bool is_right = false;
+    static constexpr index_t padding = Padding;
+  };
+
+  template <size_t Padding>
+  struct layout_traits<layout::right_padded<Padding>>
+  {
+    static constexpr bool is_right = true;
+    static constexpr index_t padding = Padding;
+  };
+
+  // true for the layouts which may leave gaps between columns (or rows).
+  template <typename Layout>
+  inline constexpr bool is_padded_layout_v = (layout_traits<Layout>::padding > 1);
+
+  // true if two tensors with layouts A and B store their elements in the
+  // same order, so that they can be traversed together by linear index.
+  // `void` is the layout of operands without an order, e.g. scalars.
+  template <typename A, typename B>
+  inline constexpr bool same_layout_v = std::is_void_v<A> || std::is_void_v<B> || std::is_same_v<A, B>;
+
+  // the layout of an expression with operands of layouts A and B.
+  template <typename A, typename B>
+  using common_layout_t = std::conditional_t<std::is_void_v<A>, B, A>;
+} // namespace tensor::details
+
+#endif
@@ -0,0 +1,462 @@
+#ifndef __TENSOR_VIEW_MAPPED_FILE_HPP__
+#define __TENSOR_VIEW_MAPPED_FILE_HPP__
+
+#include "tensorview_config.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+
+#include <cerrno>
+#include <complex>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "errors.hpp"
+#include "layout.hpp"
+#include "DynamicTensorView.hpp"
+#include "multi_index.hpp"
+#include "expressions.hpp"
+#include "aligned_allocator.hpp"
+
+namespace tensor
+{
+  /// @brief throws an exception describing a failed operation on a tensor file.
+  inline void tensor_file_error(const std::string &path, const std::string &what)
+  {
+    throw std::runtime_error("TensorView: " + path + ": " + what);
+  }
+
+  /// @brief how `map_file` maps a tensor file into memory.
+  enum class map_mode
+  {
+    /// the mapping is read only and shared with other processes.
+    read_only,
+    /// writes to the tensor are written to the file.
+    read_write,
+    /// writes to the tensor are private to the process and are not written to the file.
+    copy_on_write
+  };
+
+  namespace details
+  {
+    /**
+     * @brief header of a tensor file (.tv), followed by `rank` 64 bit
+     * extents. The elements start at `data_offset`, a multiple of
+     * `alignment`, and are stored in `layout` order (0 for column-major, 1
+     * for row-major) in the native byte order.
+     */
+    struct tensor_file_header
+    {
+      char magic[8];
+      uint32_t version;
+      uint32_t dtype;
+      uint32_t element_size;
+      uint32_t rank;
+      uint32_t layout;
+      uint32_t alignment;
+      uint64_t data_offset;
+    };
+
+    inline constexpr char tensor_file_magic[8] = {'T', 'E', 'N', 'S', 'O', 'R', 'V', 'W'};
+    inline constexpr uint32_t tensor_file_version = 1;
+
+    // code of the element type stored in the header of a tensor file.
+    template <typename T>
+    struct dtype_code
+    {
+      static_assert(sizeof(T) == 0, "tensor files only store arithmetic and complex element types.");
+    };
+
+#define TENSOR_DTYPE_CODE(type, code)                  \
+  template <>                                          \
+  struct dtype_code<type>                              \
+  {                                                    \
+    static constexpr uint32_t value = code;            \
+  };
+
+    TENSOR_DTYPE_CODE(int8_t, 1)
+    TENSOR_DTYPE_CODE(uint8_t, 2)
+    TENSOR_DTYPE_CODE(int16_t, 3)
+    TENSOR_DTYPE_CODE(uint16_t, 4)
+    TENSOR_DTYPE_CODE(int32_t, 5)
+    TENSOR_DTYPE_CODE(uint32_t, 6)
+    TENSOR_DTYPE_CODE(int64_t, 7)
+    TENSOR_DTYPE_CODE(uint64_t, 8)
+    TENSOR_DTYPE_CODE(float, 9)
+    TENSOR_DTYPE_CODE(double, 10)
+    TENSOR_DTYPE_CODE(std::complex<float>, 11)
+    TENSOR_DTYPE_CODE(std::complex<double>, 12)
+    TENSOR_DTYPE_CODE(char, 13)
+
+#undef TENSOR_DTYPE_CODE
+
+    template <typename Layout>
+    constexpr uint32_t layout_code()
+    {
+      static_assert(!is_padded_layout_v<Layout>, "tensor files store unpadded layouts.");
+      return layout_traits<Layout>::is_right ? 1 : 0;
+    }
+
+    // closes a file descriptor on destruction.
+    struct file_descriptor
+    {
+      int fd;
+
+      ~file_descriptor()
+      {
+        if (fd >= 0)
+          ::close(fd);
+      }
+    };
+
+    inline void write_all(int fd, const void *buf, size_t bytes, const std::string &path)
+    {
+      const char *p = static_cast<const char *>(buf);
+      while (bytes > 0)
+      {
+        const ssize_t n = ::write(fd, p, bytes);
+        if (n < 0)
+        {
+          if (errno == EINTR)
+            continue;
+          tensor_file_error(path, std::strerror(errno));
+        }
+        p += n;
+        bytes -= n;
+      }
+    }
+
+    inline void read_all(int fd, void *buf, size_t bytes, uint64_t offset, const std::string &path)
+    {
+      char *p = static_cast<char *>(buf);
+      while (bytes > 0)
+      {
+        const ssize_t n = ::pread(fd, p, bytes, offset);
+        if (n <= 0)
+        {
+          if (n < 0 && errno == EINTR)
+            continue;
+          tensor_file_error(path, (n < 0) ? std::strerror(errno) : "unexpected end of file.");
+        }
+        p += n;
+        bytes -= n;
+        offset += n;
+      }
+    }
+
+    inline void pwrite_all(int fd, const void *buf, size_t bytes, uint64_t offset, const std::string &path)
+    {
+      const char *p = static_cast<const char *>(buf);
+      while (bytes > 0)
+      {
+        const ssize_t n = ::pwrite(fd, p, bytes, offset);
+        if (n < 0)
+        {
+          if (errno == EINTR)
+            continue;
+          tensor_file_error(path, std::strerror(errno));
+        }
+        p += n;
+        bytes -= n;
+        offset += n;
+      }
+    }
+
+    /**
+     * @brief writes the elements of x to fd in column-major order without
+     * copying x. Runs along the first dimension are written straight from
+     * the memory of x when they have unit stride, otherwise the elements
+     * are gathered into a small buffer.
+     */
+    template <typename T>
+    inline void write_column_major(int fd, const T &x, const std::string &path)
+    {
+      using scalar = std::remove_cv_t<typename T::value_type>;
+      constexpr size_t Rank = T::shape_type::order();
+      if (x.size() == 0)
+        return;
+
+      if (x.stride(0) == 1 || x.shape(0) == 1)
+      {
+        const index_t run = x.shape(0);
+        std::array<index_t, Rank> idx{};
+        do
+        {
+          stride_t offset = 0;
+          for (index_t d = 1; d < Rank; ++d)
+            offset += (stride_t)idx[d] * x.stride(d);
+          write_all(fd, x.data() + offset, run * sizeof(scalar), path);
+          idx[0] = run - 1;
+        } while (next_index(idx, x.shape()));
+      }
+      else
+      {
+        // iteration visits the elements in first index fastest order
+        constexpr index_t chunk = 4096;
+        std::vector<scalar> buf;
+        buf.reserve(chunk);
+        for (const auto &e : x)
+        {
+          buf.push_back(e);
+          if (buf.size() == chunk)
+          {
+            write_all(fd, buf.data(), buf.size() * sizeof(scalar), path);
+            buf.clear();
+          }
+        }
+        write_all(fd, buf.data(), buf.size() * sizeof(scalar), path);
+      }
+    }
+
+    // writes the header of a tensor file and returns the offset of the data.
+    template <typename scalar, size_t Rank>
+    inline uint64_t write_header(int fd, const std::array<uint64_t, Rank> &extents, uint32_t layout, uint32_t alignment, const std::string &path)
+    {
+      tensor_file_header h;
+      std::memcpy(h.magic, tensor_file_magic, sizeof(h.magic));
+      h.version = tensor_file_version;
+      h.dtype = dtype_code<std::remove_cv_t<scalar>>::value;
+      h.element_size = sizeof(scalar);
+      h.rank = Rank;
+      h.layout = layout;
+      h.alignment = alignment;
+
+      const uint64_t header_size = sizeof(h) + Rank * sizeof(uint64_t);
+      h.data_offset = (header_size + alignment - 1) / alignment * alignment;
+
+      std::vector<char> buf(h.data_offset, 0);
+      std::memcpy(buf.data(), &h, sizeof(h));
+      std::memcpy(buf.data() + sizeof(h), extents.data(), Rank * sizeof(uint64_t));
+      write_all(fd, buf.data(), buf.size(), path);
+      return h.data_offset;
+    }
+  } // namespace details
+
+  /**
+   * @brief `TensorView` of a memory-mapped tensor file, which unmaps the
+   * file when destroyed.
+   *
+   * @details Only the pages which are accessed are read from disk, and
+   * read only mappings of the same file share the page cache between
+   * processes.
+   */
+  template <typename scalar, size_t Rank, typename Layout = layout::left>
+  class MappedTensor : public TensorView<scalar, Rank, Layout>
+  {
+  public:
+    using view_type = TensorView<scalar, Rank, Layout>;
+
+    MappedTensor() = default;
+
+    MappedTensor(const view_type &view, void *mapping, size_t length) : view_type(view), _mapping(mapping), _length(length) {}
+
+    ~MappedTensor()
+    {
+      if (_mapping)
+        ::munmap(_mapping, _length);
+    }
+
+    MappedTensor(const MappedTensor &) = delete;
+    MappedTensor &operator=(const MappedTensor &) = delete;
+
+    MappedTensor(MappedTensor &&other) noexcept : view_type(other), _mapping(std::exchange(other._mapping, nullptr)), _length(other._length) {}
+
+    MappedTensor &operator=(MappedTensor &&other) noexcept
+    {
+      if (this != &other)
+      {
+        if (_mapping)
+          ::munmap(_mapping, _length);
+        view_type::operator=(other);
+        _mapping = std::exchange(other._mapping, nullptr);
+        _length = other._length;
+      }
+      return *this;
+    }
+
+    using view_type::operator=;
+
+    /// @brief writes modified pages of a `read_write` mapping back to the
+    /// file, waiting until the writes are complete.
+    void sync()
+    {
+      if (_mapping && ::msync(_mapping, _length, MS_SYNC) != 0)
+        throw std::runtime_error(std::string("TensorView: msync failed: ") + std::strerror(errno));
+    }
+
+  private:
+    void *_mapping = nullptr;
+    size_t _length = 0;
+  };
+
+  namespace details
+  {
+    // checks the header of a tensor file of the given length against the
+    // element type, rank and layout, reads the extents and returns the offset
+    // of the data.
+    template <typename scalar, size_t Rank, typename Layout>
+    inline uint64_t read_tensor_header(int fd, uint64_t length, std::array<uint64_t, Rank> &extents, const std::string &path)
+    {
+      tensor_file_header h;
+      if (length < sizeof(h) || ::pread(fd, &h, sizeof(h), 0) != (ssize_t)sizeof(h) || std::memcmp(h.magic, tensor_file_magic, sizeof(h.magic)) != 0)
+        tensor_file_error(path, "not a tensor file.");
+      if (h.version != tensor_file_version)
+        tensor_file_error(path, "unsupported tensor file version " + std::to_string(h.version) + ".");
+      if (h.dtype != dtype_code<std::remove_cv_t<scalar>>::value || h.element_size != sizeof(scalar))
+        tensor_file_error(path, "the file stores a different element type.");
+      if (h.rank != Rank)
+        tensor_file_error(path, "the file stores a tensor of rank " + std::to_string(h.rank) + ".");
+      if (h.layout != layout_code<Layout>())
+        tensor_file_error(path, "the file stores a tensor with a different layout.");
+      if (::pread(fd, extents.data(), Rank * sizeof(uint64_t), sizeof(h)) != (ssize_t)(Rank * sizeof(uint64_t)))
+        tensor_file_error(path, "truncated header.");
+
+      uint64_t n = 1;
+      for (uint64_t e : extents)
+        n *= e;
+      if (h.data_offset % alignof(scalar) != 0 || length < h.data_offset + n * sizeof(scalar))
+        tensor_file_error(path, "the file is truncated.");
+
+      return h.data_offset;
+    }
+
+    template <typename scalar, size_t Rank, typename Layout, size_t... I>
+    inline MappedTensor<scalar, Rank, Layout> map_tensor(int fd, size_t length, map_mode mode, uint64_t data_offset, const std::array<uint64_t, Rank> &extents, const std::string &path, std::index_sequence<I...>)
+    {
+      const int prot = (mode == map_mode::read_only) ? PROT_READ : (PROT_READ | PROT_WRITE);
+      const int flags = (mode == map_mode::read_write) ? MAP_SHARED : MAP_PRIVATE;
+      void *ptr = ::mmap(nullptr, length, prot, flags, fd, 0);
+      if (ptr == MAP_FAILED)
+        tensor_file_error(path, std::string("mmap failed: ") + std::strerror(errno));
+
+      scalar *data = reinterpret_cast<scalar *>(static_cast<char *>(ptr) + data_offset);
+      return MappedTensor<scalar, Rank, Layout>(TensorView<scalar, Rank, Layout>(data, (index_t)extents[I]...), ptr, length);
+    }
+  } // namespace details
+
+  /**
+   * @brief maps a tensor file written by `save` or `create_file` into
+   * memory without reading it.
+   *
+   * @tparam scalar the element type stored in the file. Use a const type
+   * for read only mappings.
+   * @tparam Rank the number of dimensions stored in the file.
+   * @tparam Layout the layout stored in the file.
+   * @param path the file name.
+   * @param mode `read_only` (the default for const scalars), `read_write`
+   * (the default otherwise), or `copy_on_write`.
+   * @return a `MappedTensor`, i.e. a `TensorView` which owns the mapping.
+   */
+  template <typename scalar, size_t Rank, typename Layout = layout::left>
+  inline MappedTensor<scalar, Rank, Layout> map_file(const std::string &path, map_mode mode = std::is_const_v<scalar> ? map_mode::read_only : map_mode::read_write)
+  {
+    if (!std::is_const_v<scalar> && mode == map_mode::read_only)
+      tensor_file_error(path, "a read only mapping requires a const element type.");
+
+    details::file_descriptor file{::open(path.c_str(), (mode == map_mode::read_write) ? O_RDWR : O_RDONLY)};
+    if (file.fd < 0)
+      tensor_file_error(path, std::strerror(errno));
+
+    struct stat st;
+    if (::fstat(file.fd, &st) != 0)
+      tensor_file_error(path, std::strerror(errno));
+    const uint64_t length = st.st_size;
+
+    std::array<uint64_t, Rank> extents;
+    const uint64_t data_offset = details::read_tensor_header<scalar, Rank, Layout>(file.fd, length, extents, path);
+    return details::map_tensor<scalar, Rank, Layout>(file.fd, length, mode, data_offset, extents, path, std::make_index_sequence<Rank>{});
+  }
+
+  /**
+   * @brief creates a tensor file of the given shape filled with zeros and
+   * maps it for reading and writing. The file is allocated sparsely, so
+   * creating a large file is fast and only the pages which are written use
+   * disk space.
+   *
+   * @param path the file name. An existing file is overwritten.
+   * @param shape the size of each dimension.
+   */
+  template <typename scalar, typename Layout = layout::left, TENSOR_INT_LIKE... Sizes>
+  inline MappedTensor<scalar, sizeof...(Sizes), Layout> create_file(const std::string &path, Sizes... shape)
+  {
+    constexpr size_t Rank = sizeof...(Sizes);
+    static_assert(!std::is_const_v<scalar>, "create_file requires a mutable element type.");
+
+    details::file_descriptor file{::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644)};
+    if (file.fd < 0)
+      tensor_file_error(path, std::strerror(errno));
+
+    const std::array<uint64_t, Rank> extents{(uint64_t)shape...};
+    const uint64_t offset = details::write_header<scalar, Rank>(file.fd, extents, details::layout_code<Layout>(), cache_line_alignment, path);
+    const uint64_t length = offset + (uint64_t(1) * ... * (uint64_t)shape) * sizeof(scalar);
+    if (::ftruncate(file.fd, length) != 0)
+      tensor_file_error(path, std::strerror(errno));
+
+    return details::map_tensor<scalar, Rank, Layout>(file.fd, length, map_mode::read_write, offset, extents, path, std::make_index_sequence<Rank>{});
+  }
+
+  /**
+   * @brief writes a tensor to a file which can be mapped with `map_file`.
+   *
+   * @details Contiguous tensors are written in their layout with a single
+   * write. Other tensors (subviews, strided views, padded layouts) are
+   * written in column-major order.
+   *
+   * @param path the file name. An existing file is overwritten.
+   * @param x `Tensor`, `TensorView`, `SubView`, `StridedView`, etc.
+   * @param alignment the alignment in bytes of the data in the file, a
+   * power of two. Pages are always aligned in memory, so the data of a
+   * mapped tensor has at least this alignment.
+   */
+  template <typename T, typename = std::enable_if_t<details::is_tensor_v<T>>>
+  inline void save(const std::string &path, const T &x, uint32_t alignment = cache_line_alignment)
+  {
+    using shape_type = typename T::shape_type;
+    using scalar = std::remove_cv_t<typename T::value_type>;
+    constexpr size_t Rank = shape_type::order();
+    constexpr bool linear = shape_type::is_contiguous() && !std::is_same_v<typename shape_type::layout_type, layout::stride>;
+
+    if (alignment < alignof(scalar) || (alignment & (alignment - 1)) != 0)
+      tensor_file_error(path, "the alignment must be a power of two and at least the alignment of the element type.");
+
+    details::file_descriptor file{::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644)};
+    if (file.fd < 0)
+      tensor_file_error(path, std::strerror(errno));
+
+    std::array<uint64_t, Rank> extents;
+    for (index_t d = 0; d < Rank; ++d)
+      extents[d] = x.shape(d);
+
+    uint32_t layout = 0;
+    if constexpr (linear)
+      layout = details::layout_code<typename shape_type::layout_type>();
+
+    details::write_header<scalar, Rank>(file.fd, extents, layout, alignment, path);
+
+    if constexpr (linear)
+    {
+      details::write_all(file.fd, x.data(), x.size() * sizeof(scalar), path);
+    }
+    else
+    {
+      details::write_column_major(file.fd, x, path);
+    }
+
+    if (::close(file.fd) != 0)
+    {
+      file.fd = -1;
+      tensor_file_error(path, std::strerror(errno));
+    }
+    file.fd = -1;
+  }
+} // namespace tensor
+
+#endif // unix
+
+#endif
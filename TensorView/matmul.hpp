@@ -0,0 +1,355 @@
+#ifndef __TENSOR_VIEW_MATMUL_HPP__
+#define __TENSOR_VIEW_MATMUL_HPP__
+
+#include <algorithm>
+#include <climits>
+#include <vector>
+
+#include "tensorview_config.hpp"
+#include "errors.hpp"
+#include "profile.hpp"
+#include "expressions.hpp"
+#include "aligned_allocator.hpp"
+#include "parallel.hpp"
+
+#ifdef TENSOR_USE_BLAS
+extern "C"
+{
+  void sgemm_(const char *transa, const char *transb, const int *m, const int *n, const int *k, const float *alpha, const float *a, const int *lda, const float *b, const int *ldb, const float *beta, float *c, const int *ldc);
+  void dgemm_(const char *transa, const char *transb, const int *m, const int *n, const int *k, const double *alpha, const double *a, const int *lda, const double *b, const int *ldb, const double *beta, double *c, const int *ldc);
+}
+#endif
+
+namespace tensor::details
+{
+  // a matrix with arbitrary strides between rows and columns.
+  template <typename T>
+  struct strided_matrix
+  {
+    T *data;
+    index_t rows;
+    index_t cols;
+    stride_t rs;
+    stride_t cs;
+
+    T &operator()(index_t i, index_t j) const
+    {
+      return data[(stride_t)i * rs + (stride_t)j * cs];
+    }
+
+    strided_matrix transposed() const
+    {
+      return {data, cols, rows, cs, rs};
+    }
+  };
+
+  template <typename M>
+  inline auto make_strided_matrix(M &&A, index_t batch = 0)
+  {
+    using T = view_scalar_t<M>;
+    T *ptr = A.data();
+    if constexpr (std::decay_t<M>::order() == 3)
+      ptr += (stride_t)batch * A.stride(2);
+    return strided_matrix<T>{ptr, A.shape(0), A.shape(1), A.stride(0), A.stride(1)};
+  }
+
+  /// @brief register and cache blocking of the built-in matrix product.
+  ///
+  /// @details The micro kernel keeps an mr x nr block of C in registers:
+  /// mr is one 64 byte vector of scalars and nr = 6 columns. The operands
+  /// are packed into kc x mr panels of A (which fit in L1) and kc x nc
+  /// panels of B (which fit in L2/L3), so the kernel reads both with unit
+  /// stride whatever the strides of the views.
+  template <typename scalar>
+  struct gemm_blocking
+  {
+    static constexpr index_t mr = (sizeof(scalar) >= 64) ? 1 : 64 / sizeof(scalar);
+    static constexpr index_t nr = 6;
+    static constexpr index_t kc = 256;
+    static constexpr index_t mc = 16 * mr;
+    static constexpr index_t nc = 512 * nr;
+  };
+
+  /// @brief products with at most this many multiplications are computed
+  /// by a direct triple loop, e.g. the small matrices of a batched product.
+  inline constexpr index_t gemm_small_size = 4096;
+
+  /// @brief products with at least this many multiplications are split
+  /// between the threads of the `default_executor()`.
+  inline constexpr index_t gemm_parallel_size = index_t(1) << 22;
+
+  // C = beta * C, with beta == 0 discarding NaNs in C.
+  template <typename T>
+  inline void gemm_scale(const strided_matrix<T> &C, T beta)
+  {
+    for (index_t j = 0; j < C.cols; ++j)
+      for (index_t i = 0; i < C.rows; ++i)
+        C(i, j) = (beta == T(0)) ? T(0) : beta * C(i, j);
+  }
+
+  template <typename T, typename TA, typename TB>
+  inline void gemm_small(const strided_matrix<T> &C, const strided_matrix<TA> &A, const strided_matrix<TB> &B, T alpha, T beta)
+  {
+    for (index_t j = 0; j < C.cols; ++j)
+      for (index_t i = 0; i < C.rows; ++i)
+      {
+        T s = 0;
+        for (index_t p = 0; p < A.cols; ++p)
+          s += A(i, p) * B(p, j);
+        C(i, j) = (beta == T(0)) ? alpha * s : alpha * s + beta * C(i, j);
+      }
+  }
+
+  // copies rows [i0, i0 + mc) and columns [p0, p0 + kc) of A into panels of
+  // mr rows, padding the last panel with zeros.
+  template <typename T, typename TA>
+  inline void gemm_pack_a(T *dst, const strided_matrix<TA> &A, index_t i0, index_t mc, index_t p0, index_t kc)
+  {
+    constexpr index_t mr = gemm_blocking<T>::mr;
+    for (index_t ir = 0; ir < mc; ir += mr)
+    {
+      const index_t m = std::min(mr, mc - ir);
+      for (index_t p = 0; p < kc; ++p)
+      {
+        for (index_t i = 0; i < m; ++i)
+          dst[i] = A(i0 + ir + i, p0 + p);
+        for (index_t i = m; i < mr; ++i)
+          dst[i] = T(0);
+        dst += mr;
+      }
+    }
+  }
+
+  // copies rows [p0, p0 + kc) and columns [j0, j0 + nc) of B into panels of
+  // nr columns, padding the last panel with zeros.
+  template <typename T, typename TB>
+  inline void gemm_pack_b(T *dst, const strided_matrix<TB> &B, index_t p0, index_t kc, index_t j0, index_t nc)
+  {
+    constexpr index_t nr = gemm_blocking<T>::nr;
+    for (index_t jr = 0; jr < nc; jr += nr)
+    {
+      const index_t n = std::min(nr, nc - jr);
+      for (index_t p = 0; p < kc; ++p)
+      {
+        for (index_t j = 0; j < n; ++j)
+          dst[j] = B(p0 + p, j0 + jr + j);
+        for (index_t j = n; j < nr; ++j)
+          dst[j] = T(0);
+        dst += nr;
+      }
+    }
+  }
+
+  // C(0:m, 0:n) += alpha * Ap * Bp for an mr x kc panel Ap and a kc x nr panel Bp.
+  template <typename T>
+  inline void gemm_micro_kernel(index_t kc, const T *Ap, const T *Bp, const strided_matrix<T> &C, index_t i0, index_t j0, index_t m, index_t n, T alpha)
+  {
+    constexpr index_t mr = gemm_blocking<T>::mr;
+    constexpr index_t nr = gemm_blocking<T>::nr;
+
+    T acc[nr][mr] = {};
+    for (index_t p = 0; p < kc; ++p)
+    {
+      for (index_t j = 0; j < nr; ++j)
+      {
+        const T b = Bp[j];
+        for (index_t i = 0; i < mr; ++i)
+          acc[j][i] += Ap[i] * b;
+      }
+      Ap += mr;
+      Bp += nr;
+    }
+
+    for (index_t j = 0; j < n; ++j)
+      for (index_t i = 0; i < m; ++i)
+        C(i0 + i, j0 + j) += alpha * acc[j][i];
+  }
+
+  // C += alpha * A * B for the columns [j0, j1) of C.
+  template <typename T, typename TA, typename TB>
+  inline void gemm_blocked(const strided_matrix<T> &C, const strided_matrix<TA> &A, const strided_matrix<TB> &B, T alpha, index_t j0, index_t j1)
+  {
+    using blk = gemm_blocking<T>;
+    thread_local std::vector<T, aligned_allocator<T>> packed_a, packed_b;
+    packed_a.resize(blk::mc * blk::kc);
+    packed_b.resize(blk::nc * blk::kc);
+
+    const index_t K = A.cols;
+    for (index_t jc = j0; jc < j1; jc += blk::nc)
+    {
+      const index_t nc = std::min(blk::nc, j1 - jc);
+      for (index_t pc = 0; pc < K; pc += blk::kc)
+      {
+        const index_t kc = std::min(blk::kc, K - pc);
+        gemm_pack_b(packed_b.data(), B, pc, kc, jc, nc);
+
+        for (index_t ic = 0; ic < C.rows; ic += blk::mc)
+        {
+          const index_t mc = std::min(blk::mc, C.rows - ic);
+          gemm_pack_a(packed_a.data(), A, ic, mc, pc, kc);
+
+          for (index_t jr = 0; jr < nc; jr += blk::nr)
+            for (index_t ir = 0; ir < mc; ir += blk::mr)
+              gemm_micro_kernel(kc, packed_a.data() + ir * kc, packed_b.data() + jr * kc, C, ic + ir, jc + jr, std::min(blk::mr, mc - ir), std::min(blk::nr, nc - jr), alpha);
+        }
+      }
+    }
+  }
+
+#ifdef TENSOR_USE_BLAS
+  // the BLAS description (transpose flag and leading dimension) of A, if
+  // one of its dimensions has unit stride.
+  template <typename T>
+  inline bool blas_operand(const strided_matrix<T> &A, char &trans, int &ld)
+  {
+    if (A.rows > INT_MAX || A.cols > INT_MAX)
+      return false;
+
+    if ((A.rs == 1 || A.rows == 1) && (A.cs >= (stride_t)std::max<index_t>(1, A.rows) || A.cols == 1))
+    {
+      const stride_t l = std::max<stride_t>(A.cs, std::max<index_t>(1, A.rows));
+      trans = 'N';
+      ld = (int)l;
+      return l <= INT_MAX;
+    }
+    if ((A.cs == 1 || A.cols == 1) && (A.rs >= (stride_t)std::max<index_t>(1, A.cols) || A.rows == 1))
+    {
+      const stride_t l = std::max<stride_t>(A.rs, std::max<index_t>(1, A.cols));
+      trans = 'T';
+      ld = (int)l;
+      return l <= INT_MAX;
+    }
+    return false;
+  }
+
+  // computes C = alpha * A * B + beta * C with BLAS if the strides of all
+  // three matrices allow it.
+  template <typename T>
+  inline bool gemm_blas(strided_matrix<T> C, strided_matrix<const T> A, strided_matrix<const T> B, T alpha, T beta)
+  {
+    char tc, ta, tb;
+    int ldc, lda, ldb;
+    if (!blas_operand(C, tc, ldc))
+      return false;
+
+    if (tc == 'T') // row-major C: compute C^T = B^T * A^T instead
+    {
+      C = C.transposed();
+      std::swap(A, B);
+      A = A.transposed();
+      B = B.transposed();
+      blas_operand(C, tc, ldc);
+    }
+
+    if (!blas_operand(A, ta, lda) || !blas_operand(B, tb, ldb))
+      return false;
+
+    const int m = C.rows, n = C.cols, k = A.cols;
+    if constexpr (std::is_same_v<T, double>)
+      dgemm_(&ta, &tb, &m, &n, &k, &alpha, A.data, &lda, B.data, &ldb, &beta, C.data, &ldc);
+    else
+      sgemm_(&ta, &tb, &m, &n, &k, &alpha, A.data, &lda, B.data, &ldb, &beta, C.data, &ldc);
+    return true;
+  }
+#endif
+
+  // C = alpha * A * B + beta * C for a single matrix.
+  template <typename T, typename TA, typename TB>
+  inline void gemm(const strided_matrix<T> &C, const strided_matrix<TA> &A, const strided_matrix<TB> &B, T alpha, T beta, bool parallel)
+  {
+    const index_t M = C.rows, N = C.cols, K = A.cols;
+    if (M == 0 || N == 0)
+      return;
+
+    const index_t work = M * N * K;
+    if (work <= gemm_small_size)
+    {
+      gemm_small(C, A, B, alpha, beta);
+      return;
+    }
+
+#ifdef TENSOR_USE_BLAS
+    if constexpr ((std::is_same_v<T, double> || std::is_same_v<T, float>) && std::is_same_v<std::remove_const_t<TA>, T> && std::is_same_v<std::remove_const_t<TB>, T>)
+      if (gemm_blas<T>(C, {A.data, A.rows, A.cols, A.rs, A.cs}, {B.data, B.rows, B.cols, B.rs, B.cs}, alpha, beta))
+        return;
+#endif
+
+    gemm_scale(C, beta);
+    if (K == 0)
+      return;
+
+    constexpr index_t nr = gemm_blocking<T>::nr;
+    thread_pool &pool = default_executor();
+    if (parallel && work >= gemm_parallel_size && pool.concurrency() > 1 && N > nr)
+    {
+      // split the columns of C between the threads, in multiples of nr
+      const index_t n_tasks = std::min<index_t>(pool.concurrency(), (N + nr - 1) / nr);
+      const index_t cols = ((N + n_tasks - 1) / n_tasks + nr - 1) / nr * nr;
+      pool.bulk((N + cols - 1) / cols, [&](index_t t)
+                { gemm_blocked(C, A, B, alpha, t * cols, std::min(N, (t + 1) * cols)); });
+    }
+    else
+    {
+      gemm_blocked(C, A, B, alpha, 0, N);
+    }
+  }
+} // namespace tensor::details
+
+namespace tensor
+{
+  /**
+   * @brief computes the matrix product C = alpha * A * B + beta * C.
+   *
+   * @details A, B, and C may be any matrices with a pointer and strides:
+   * `matrix_view`, `Matrix`, `SubView`, row-major tensors, and transposed or
+   * permuted `StridedView`s, which are read in place without copying.
+   * Tiny products are computed directly. When TensorView is built with
+   * `TENSOR_USE_BLAS`, `float` and `double` products whose operands each
+   * have a unit stride dimension are computed by `sgemm`/`dgemm`.
+   * Otherwise a cache blocked kernel with packed operands and a register
+   * tiled micro kernel is used, split between the threads of the
+   * `default_executor()` for large products.
+   *
+   * If A, B, and C are rank 3 (e.g. `cube_view`), the product is batched
+   * along the last dimension: `C(:, :, b) = A(:, :, b) * B(:, :, b)`. The
+   * batches are distributed between threads, which is much faster than a
+   * loop over many small products.
+   *
+   * @param C the M x N (x batch) result. Must not overlap with A or B.
+   * @param A the M x K (x batch) left factor.
+   * @param B the K x N (x batch) right factor.
+   */
+  template <typename MC, typename MA, typename MB, typename scalar = std::remove_cv_t<typename std::decay_t<MC>::value_type>, typename = std::enable_if_t<details::is_tensor_v<MC> && details::is_tensor_v<MA> && details::is_tensor_v<MB>>>
+  inline void matmul(MC &&C, const MA &A, const MB &B, scalar alpha = scalar(1), scalar beta = scalar(0))
+  {
+    TENSOR_PROFILE_RANGE("tensor::matmul");
+    constexpr size_t Rank = std::decay_t<MC>::order();
+    static_assert(Rank == 2 || Rank == 3, "matmul requires matrices or batches of matrices.");
+    static_assert(MA::order() == Rank && MB::order() == Rank, "matmul requires operands of the same rank.");
+
+#ifdef TENSOR_CHECK_BOUNDS
+    if (A.shape(0) != C.shape(0) || B.shape(1) != C.shape(1) || A.shape(1) != B.shape(0))
+      tensor_shape_mismatch();
+    if constexpr (Rank == 3)
+      if (A.shape(2) != C.shape(2) || B.shape(2) != C.shape(2))
+        tensor_shape_mismatch();
+#endif
+
+    if constexpr (Rank == 2)
+    {
+      details::gemm(details::make_strided_matrix(C), details::make_strided_matrix(A), details::make_strided_matrix(B), alpha, beta, true);
+    }
+    else
+    {
+      const index_t n_batch = C.shape(2);
+      auto &exec = default_executor();
+      const index_t n_tasks = std::min<index_t>(n_batch, details::slabs_per_thread * exec.concurrency());
+      exec.bulk(n_tasks, [&](index_t t)
+                {
+                  for (index_t b = (n_batch * t) / n_tasks; b < (n_batch * (t + 1)) / n_tasks; ++b)
+                    details::gemm(details::make_strided_matrix(C, b), details::make_strided_matrix(A, b), details::make_strided_matrix(B, b), alpha, beta, false); });
+    }
+  }
+} // namespace tensor
+
+#endif
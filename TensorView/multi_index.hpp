@@ -0,0 +1,48 @@
+#ifndef __TENSOR_VIEW_MULTI_INDEX_HPP__
+#define __TENSOR_VIEW_MULTI_INDEX_HPP__
+
+#include "tensorview_config.hpp"
+
+namespace tensor::details
+{
+  // returns the offset of the multi-index idx in a tensor with the given
+  // shape. The indices are not bounds checked: callers iterate over ranges
+  // which are validated on entry.
+  template <typename Shape, size_t N>
+  TENSOR_FUNC index_t apply_index(const Shape &shape, const std::array<index_t, N> &idx)
+  {
+    return shape.offset(idx);
+  }
+
+  // advances the multi-index idx to the next element of a tensor with the
+  // given shape in first index fastest order. Returns false once every index
+  // has wrapped around.
+  template <typename Shape, size_t N>
+  TENSOR_FUNC bool next_index(std::array<index_t, N> &idx, const Shape &shape)
+  {
+    for (index_t d = 0; d < N; ++d)
+    {
+      if (++idx[d] < shape.shape(d))
+        return true;
+      idx[d] = 0;
+    }
+    return false;
+  }
+
+  // returns the multi-index of the element at position i of a tensor with
+  // the given shape in first index fastest order.
+  template <size_t N, typename Shape>
+  TENSOR_FUNC std::array<index_t, N> unravel_index(index_t i, const Shape &shape)
+  {
+    std::array<index_t, N> idx{};
+    for (index_t d = 0; d < N; ++d)
+    {
+      const index_t n = shape.shape(d);
+      idx[d] = i % n;
+      i /= n;
+    }
+    return idx;
+  }
+} // namespace tensor::details
+
+#endif
@@ -0,0 +1,365 @@
+#ifndef __TENSOR_VIEW_NPY_HPP__
+#define __TENSOR_VIEW_NPY_HPP__
+
+#include "tensorview_config.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+
+#include <algorithm>
+#include <complex>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#include "errors.hpp"
+#include "layout.hpp"
+#include "Tensor.hpp"
+#include "copy.hpp"
+#include "mapped_file.hpp"
+
+namespace tensor::details
+{
+  // the kind character and size of a type in a NumPy dtype string, e.g. f8.
+  template <typename T>
+  struct npy_type
+  {
+    static_assert(std::is_arithmetic_v<T>, "npy files store arithmetic and complex element types.");
+    static constexpr char kind = std::is_same_v<T, bool> ? 'b' : std::is_floating_point_v<T> ? 'f'
+                                                                : std::is_signed_v<T>         ? 'i'
+                                                                                              : 'u';
+    static constexpr size_t component_size = sizeof(T);
+  };
+
+  template <typename T>
+  struct npy_type<std::complex<T>>
+  {
+    static constexpr char kind = 'c';
+    static constexpr size_t component_size = sizeof(T);
+  };
+
+  inline bool is_little_endian()
+  {
+    const uint16_t one = 1;
+    char c;
+    std::memcpy(&c, &one, 1);
+    return c == 1;
+  }
+
+  // the dtype string of T in native byte order, e.g. "<f8".
+  template <typename T>
+  inline std::string npy_descr()
+  {
+    const char order = (sizeof(T) == 1) ? '|' : (is_little_endian() ? '<' : '>');
+    return std::string(1, order) + npy_type<T>::kind + std::to_string(sizeof(T));
+  }
+
+  struct npy_header
+  {
+    std::string descr;
+    bool fortran_order;
+    std::vector<uint64_t> shape;
+    uint64_t data_offset;
+  };
+
+  // returns the value of `key` in the header dictionary, up to the next
+  // top level comma or closing brace.
+  inline std::string npy_field(const std::string &dict, const std::string &key, const std::string &path)
+  {
+    size_t pos = dict.find("'" + key + "'");
+    if (pos == std::string::npos)
+      tensor_file_error(path, "the npy header has no '" + key + "'.");
+    pos = dict.find(':', pos);
+    if (pos == std::string::npos)
+      tensor_file_error(path, "malformed npy header.");
+    ++pos;
+
+    int depth = 0;
+    size_t end = pos;
+    for (; end < dict.size(); ++end)
+    {
+      const char c = dict[end];
+      if (c == '(' || c == '[')
+        ++depth;
+      else if (c == ')' || c == ']')
+        --depth;
+      else if ((c == ',' || c == '}') && depth == 0)
+        break;
+    }
+
+    std::string value = dict.substr(pos, end - pos);
+    const size_t b = value.find_first_not_of(" \t");
+    const size_t e = value.find_last_not_of(" \t");
+    return (b == std::string::npos) ? std::string() : value.substr(b, e - b + 1);
+  }
+
+  inline npy_header read_npy_header(int fd, const std::string &path)
+  {
+    unsigned char prefix[10];
+    if (::pread(fd, prefix, sizeof(prefix), 0) != (ssize_t)sizeof(prefix) || std::memcmp(prefix, "\x93NUMPY", 6) != 0)
+      tensor_file_error(path, "not an npy file.");
+
+    const int major = prefix[6];
+    uint64_t header_len, offset;
+    if (major == 1)
+    {
+      header_len = prefix[8] | (uint64_t(prefix[9]) << 8);
+      offset = 10;
+    }
+    else if (major == 2 || major == 3)
+    {
+      unsigned char len[4];
+      if (::pread(fd, len, 4, 8) != 4)
+        tensor_file_error(path, "truncated npy header.");
+      header_len = len[0] | (uint64_t(len[1]) << 8) | (uint64_t(len[2]) << 16) | (uint64_t(len[3]) << 24);
+      offset = 12;
+    }
+    else
+    {
+      tensor_file_error(path, "unsupported npy version " + std::to_string(major) + ".");
+      return {};
+    }
+
+    std::string dict(header_len, '\0');
+    if (::pread(fd, dict.data(), header_len, offset) != (ssize_t)header_len)
+      tensor_file_error(path, "truncated npy header.");
+
+    npy_header h;
+    h.data_offset = offset + header_len;
+
+    std::string descr = npy_field(dict, "descr", path);
+    if (descr.size() < 2 || (descr.front() != '\'' && descr.front() != '"'))
+      tensor_file_error(path, "structured npy dtypes are not supported.");
+    h.descr = descr.substr(1, descr.size() - 2);
+
+    const std::string fortran = npy_field(dict, "fortran_order", path);
+    if (fortran != "True" && fortran != "False")
+      tensor_file_error(path, "malformed npy header.");
+    h.fortran_order = fortran == "True";
+
+    const std::string shape = npy_field(dict, "shape", path);
+    if (shape.empty() || shape.front() != '(' || shape.back() != ')')
+      tensor_file_error(path, "malformed npy header.");
+    size_t pos = 1;
+    while (pos < shape.size() - 1)
+    {
+      const size_t next = shape.find_first_of(",)", pos);
+      const std::string item = shape.substr(pos, next - pos);
+      if (item.find_first_not_of(" \t") != std::string::npos)
+        h.shape.push_back(std::stoull(item));
+      pos = next + 1;
+    }
+
+    return h;
+  }
+
+  // checks that the file stores elements of type T with the given rank and
+  // returns true if they are in the opposite byte order.
+  template <typename T, size_t Rank>
+  inline bool check_npy_header(const npy_header &h, uint64_t length, const std::string &path)
+  {
+    const std::string native = npy_descr<T>();
+    bool swap = false;
+    if (h.descr != native)
+    {
+      const char other = (native[0] == '<') ? '>' : '<';
+      if (native[0] != '|' && h.descr.size() == native.size() && h.descr[0] == other && h.descr.compare(1, std::string::npos, native, 1) == 0)
+        swap = true;
+      else
+        tensor_file_error(path, "the npy file stores dtype '" + h.descr + "', expected '" + native + "'.");
+    }
+
+    if (h.shape.size() != Rank)
+      tensor_file_error(path, "the npy file stores an array of rank " + std::to_string(h.shape.size()) + ".");
+
+    uint64_t n = 1;
+    for (uint64_t e : h.shape)
+      n *= e;
+    if (length < h.data_offset + n * sizeof(T))
+      tensor_file_error(path, "the npy file is truncated.");
+
+    return swap;
+  }
+
+  // reverses the byte order of the n elements of type T at x.
+  template <typename T>
+  inline void byteswap(T *x, size_t n)
+  {
+    constexpr size_t c = npy_type<T>::component_size;
+    unsigned char *p = reinterpret_cast<unsigned char *>(x);
+    for (size_t k = 0; k < n * sizeof(T); k += c)
+      std::reverse(p + k, p + k + c);
+  }
+
+  /**
+   * @brief the bytes of an npy header with the dictionary `dict`, padded
+   * with spaces so that the data starts at a multiple of `alignment` bytes
+   * (a multiple of 64). The header ends with a newline.
+   */
+  inline std::string npy_header_bytes(std::string dict, size_t alignment)
+  {
+    size_t prefix = 10;
+    size_t total = (prefix + dict.size() + 1 + alignment - 1) / alignment * alignment;
+    if (total - prefix > 65535)
+    {
+      prefix = 12;
+      total = (prefix + dict.size() + 1 + alignment - 1) / alignment * alignment;
+    }
+    dict.append(total - prefix - dict.size() - 1, ' ');
+    dict += '\n';
+
+    std::string header = "\x93NUMPY";
+    const uint32_t len = dict.size();
+    header += (prefix == 10) ? '\x01' : '\x02';
+    header += '\x00';
+    header += char(len & 0xff);
+    header += char((len >> 8) & 0xff);
+    if (prefix == 12)
+    {
+      header += char((len >> 16) & 0xff);
+      header += char((len >> 24) & 0xff);
+    }
+    header += dict;
+    return header;
+  }
+
+  template <typename scalar, size_t Rank, typename Layout, size_t... I>
+  inline auto make_uninitialized_tensor(const std::vector<uint64_t> &shape, std::index_sequence<I...>)
+  {
+    return Tensor<scalar, Rank, std::allocator<scalar>, Layout>(uninitialized, (index_t)shape[I]...);
+  }
+} // namespace tensor::details
+
+namespace tensor
+{
+  /**
+   * @brief maps the array of a NumPy .npy file into memory without reading it.
+   *
+   * @details Arrays saved with `fortran_order` map onto `layout::left`
+   * (the default) and C ordered arrays map onto `layout::right`; the file
+   * must match `Layout`. The dtype must match scalar in native byte order.
+   *
+   * @tparam scalar the element type. Use a const type for read only mappings.
+   * @param mode see `map_file`.
+   */
+  template <typename scalar, size_t Rank, typename Layout = layout::left>
+  inline MappedTensor<scalar, Rank, Layout> map_npy(const std::string &path, map_mode mode = std::is_const_v<scalar> ? map_mode::read_only : map_mode::read_write)
+  {
+    using T = std::remove_cv_t<scalar>;
+    if (!std::is_const_v<scalar> && mode == map_mode::read_only)
+      tensor_file_error(path, "a read only mapping requires a const element type.");
+
+    details::file_descriptor file{::open(path.c_str(), (mode == map_mode::read_write) ? O_RDWR : O_RDONLY)};
+    if (file.fd < 0)
+      tensor_file_error(path, std::strerror(errno));
+
+    struct stat st;
+    if (::fstat(file.fd, &st) != 0)
+      tensor_file_error(path, std::strerror(errno));
+
+    const details::npy_header h = details::read_npy_header(file.fd, path);
+    if (details::check_npy_header<T, Rank>(h, st.st_size, path))
+      tensor_file_error(path, "the npy file is not in native byte order and cannot be mapped; use load_npy.");
+    if (h.fortran_order == details::layout_traits<Layout>::is_right && Rank > 1)
+      tensor_file_error(path, h.fortran_order ? "the npy file is in Fortran order, map it with layout::left." : "the npy file is in C order, map it with layout::right.");
+    if (h.data_offset % alignof(T) != 0)
+      tensor_file_error(path, "the data of the npy file is not aligned.");
+
+    std::array<uint64_t, Rank> extents;
+    std::copy(h.shape.begin(), h.shape.end(), extents.begin());
+    return details::map_tensor<scalar, Rank, Layout>(file.fd, st.st_size, mode, h.data_offset, extents, path, std::make_index_sequence<Rank>{});
+  }
+
+  /**
+   * @brief reads the array of a NumPy .npy file into a new `Tensor`.
+   *
+   * @details The payload is read directly into the uninitialized storage of
+   * the tensor. If the file is not in the order of `Layout` (Fortran order
+   * for `layout::left`, C order for `layout::right`), it is read in its own
+   * order and transposed with `copy`. Files in the opposite byte order are
+   * byte swapped.
+   */
+  template <typename scalar, size_t Rank, typename Layout = layout::left>
+  inline Tensor<scalar, Rank, std::allocator<scalar>, Layout> load_npy(const std::string &path)
+  {
+    static_assert(!details::is_padded_layout_v<Layout>, "npy files store unpadded layouts.");
+
+    details::file_descriptor file{::open(path.c_str(), O_RDONLY)};
+    if (file.fd < 0)
+      tensor_file_error(path, std::strerror(errno));
+
+    struct stat st;
+    if (::fstat(file.fd, &st) != 0)
+      tensor_file_error(path, std::strerror(errno));
+
+    const details::npy_header h = details::read_npy_header(file.fd, path);
+    const bool swap = details::check_npy_header<scalar, Rank>(h, st.st_size, path);
+
+    auto read = [&](auto &&x)
+    {
+      details::read_all(file.fd, x.data(), x.size() * sizeof(scalar), h.data_offset, path);
+      if (swap)
+        details::byteswap(x.data(), x.size());
+    };
+
+    if (h.fortran_order != details::layout_traits<Layout>::is_right || Rank <= 1)
+    {
+      auto x = details::make_uninitialized_tensor<scalar, Rank, Layout>(h.shape, std::make_index_sequence<Rank>{});
+      read(x);
+      return x;
+    }
+    else
+    {
+      using file_layout = std::conditional_t<details::layout_traits<Layout>::is_right, layout::left, layout::right>;
+      auto y = details::make_uninitialized_tensor<scalar, Rank, file_layout>(h.shape, std::make_index_sequence<Rank>{});
+      read(y);
+      auto x = details::make_uninitialized_tensor<scalar, Rank, Layout>(h.shape, std::make_index_sequence<Rank>{});
+      copy(x, y);
+      return x;
+    }
+  }
+
+  /**
+   * @brief writes a tensor to a NumPy .npy file.
+   *
+   * @details Column-major tensors are written with `fortran_order: True`
+   * and row-major tensors in C order, both without copying.
+   * Subviews, strided views, and padded tensors are streamed in Fortran
+   * order: runs along the first dimension are written straight from the
+   * view when they have unit stride.
+   */
+  template <typename T, typename = std::enable_if_t<details::is_tensor_v<T>>>
+  inline void save_npy(const std::string &path, const T &x)
+  {
+    using shape_type = typename T::shape_type;
+    using scalar = std::remove_cv_t<typename T::value_type>;
+    constexpr size_t Rank = shape_type::order();
+    constexpr bool linear = shape_type::is_contiguous() && !std::is_same_v<typename shape_type::layout_type, layout::stride>;
+    constexpr bool c_order = linear && details::layout_traits<typename shape_type::layout_type>::is_right;
+
+    std::string dict = "{'descr': '" + details::npy_descr<scalar>() + "', 'fortran_order': " + (c_order ? "False" : "True") + ", 'shape': (";
+    for (index_t d = 0; d < Rank; ++d)
+      dict += std::to_string(x.shape(d)) + ((Rank == 1 || d + 1 < Rank) ? "," : "") + ((d + 1 < Rank) ? " " : "");
+    dict += "), }";
+
+    const std::string header = details::npy_header_bytes(dict, 64);
+
+    details::file_descriptor file{::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644)};
+    if (file.fd < 0)
+      tensor_file_error(path, std::strerror(errno));
+
+    details::write_all(file.fd, header.data(), header.size(), path);
+    if constexpr (linear)
+      details::write_all(file.fd, x.data(), x.size() * sizeof(scalar), path);
+    else
+      details::write_column_major(file.fd, x, path);
+
+    const int fd = file.fd;
+    file.fd = -1;
+    if (::close(fd) != 0)
+      tensor_file_error(path, std::strerror(errno));
+  }
+} // namespace tensor
+
+#endif // unix
+
+#endif
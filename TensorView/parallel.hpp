@@ -0,0 +1,546 @@
+#ifndef __TENSOR_VIEW_PARALLEL_HPP__
+#define __TENSOR_VIEW_PARALLEL_HPP__
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#ifdef TENSOR_USE_TBB
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/task_arena.h>
+#endif
+
+#ifdef TENSOR_USE_STD_EXECUTION
+#include <execution>
+#endif
+
+#include "tensorview_config.hpp"
+#include "errors.hpp"
+#include "profile.hpp"
+#include "layout.hpp"
+#include "StridedView.hpp"
+#include "expressions.hpp"
+
+namespace tensor
+{
+  namespace details
+  {
+    /// @brief tag base class of the executors accepted by `parallel_for` and
+    /// `parallel_reduce`.
+    ///
+    /// @details An executor provides `concurrency()`, the number of tasks it
+    /// can run at once, and `bulk(n, f)`, which calls `f(i)` for every `i` in
+    /// `[0, n)`, possibly concurrently, and returns when all calls have
+    /// finished.
+    struct executor_base
+    {
+    };
+
+    template <typename E>
+    inline constexpr bool is_executor_v = std::is_base_of_v<executor_base, std::decay_t<E>>;
+  } // namespace details
+
+  /// @brief runs every task on the calling thread.
+  class sequential_executor : public details::executor_base
+  {
+  public:
+    size_t concurrency() const
+    {
+      return 1;
+    }
+
+    template <typename F>
+    void bulk(index_t n, F &&f)
+    {
+      for (index_t i = 0; i < n; ++i)
+        f(i);
+    }
+  };
+
+  /**
+   * @brief fixed size pool of worker threads with work stealing.
+   *
+   * @details `bulk(n, f)` deals the tasks `[0, n)` out in contiguous ranges,
+   * one per thread (the calling thread takes part). Each thread runs its
+   * own range from the front; a thread which runs out of work steals tasks
+   * from the back of another thread's range, so irregular workloads are
+   * balanced without a shared queue. Calls of `bulk` from inside a task run
+   * sequentially on the calling thread.
+   */
+  class thread_pool : public details::executor_base
+  {
+  public:
+    /// @param n_threads the number of threads including the caller of `bulk`.
+    explicit thread_pool(size_t n_threads = std::max<size_t>(1, std::thread::hardware_concurrency()))
+        : queues(std::max<size_t>(1, n_threads))
+    {
+      for (size_t id = 1; id < queues.size(); ++id)
+        workers.emplace_back([this, id]()
+                             { work(id); });
+    }
+
+    ~thread_pool()
+    {
+      {
+        std::lock_guard<std::mutex> lock(mtx);
+        stop = true;
+      }
+      wake.notify_all();
+      for (auto &w : workers)
+        w.join();
+    }
+
+    thread_pool(const thread_pool &) = delete;
+    thread_pool &operator=(const thread_pool &) = delete;
+
+    size_t concurrency() const
+    {
+      return queues.size();
+    }
+
+    template <typename F>
+    void bulk(index_t n, F &&f)
+    {
+      if (n == 0)
+        return;
+
+      if (queues.size() == 1 || n == 1 || in_task())
+      {
+        for (index_t i = 0; i < n; ++i)
+          f(i);
+        return;
+      }
+
+      std::lock_guard<std::mutex> guard(bulk_mtx); // one job at a time
+
+      using Fn = std::remove_reference_t<F>;
+      job_fn = const_cast<void *>(static_cast<const void *>(&f));
+      job_call = [](void *fn, index_t i)
+      { (*static_cast<Fn *>(fn))(i); };
+      error = nullptr;
+
+      const index_t p = queues.size();
+      for (index_t id = 0; id < p; ++id)
+      {
+        queues[id].begin = (n * id) / p;
+        queues[id].end = (n * (id + 1)) / p;
+      }
+
+      {
+        std::lock_guard<std::mutex> lock(mtx);
+        busy = workers.size();
+        ++generation;
+      }
+      wake.notify_all();
+
+      run(0);
+
+      std::unique_lock<std::mutex> lock(mtx);
+      done.wait(lock, [this]()
+                { return busy == 0; });
+
+      if (error)
+        std::rethrow_exception(error);
+    }
+
+  private:
+    // the unclaimed tasks [begin, end) of one thread.
+    struct range_queue
+    {
+      std::mutex mtx;
+      index_t begin = 0;
+      index_t end = 0;
+    };
+
+    std::vector<range_queue> queues;
+    std::vector<std::thread> workers;
+
+    std::mutex bulk_mtx;
+    std::mutex mtx;
+    std::condition_variable wake;
+    std::condition_variable done;
+    size_t generation = 0;
+    size_t busy = 0;
+    bool stop = false;
+
+    void *job_fn = nullptr;
+    void (*job_call)(void *, index_t) = nullptr;
+    std::mutex error_mtx;
+    std::exception_ptr error;
+
+    static bool &in_task()
+    {
+      thread_local bool flag = false;
+      return flag;
+    }
+
+    bool take(size_t id, index_t &task)
+    {
+      {
+        range_queue &q = queues[id];
+        std::lock_guard<std::mutex> lock(q.mtx);
+        if (q.begin < q.end)
+        {
+          task = q.begin++;
+          return true;
+        }
+      }
+
+      for (size_t k = 1; k < queues.size(); ++k)
+      {
+        range_queue &q = queues[(id + k) % queues.size()];
+        std::lock_guard<std::mutex> lock(q.mtx);
+        if (q.begin < q.end)
+        {
+          task = --q.end;
+          return true;
+        }
+      }
+
+      return false;
+    }
+
+    void run(size_t id)
+    {
+      in_task() = true;
+      index_t task;
+      while (take(id, task))
+      {
+        try
+        {
+          job_call(job_fn, task);
+        }
+        catch (...)
+        {
+          std::lock_guard<std::mutex> lock(error_mtx);
+          if (!error)
+            error = std::current_exception();
+        }
+      }
+      in_task() = false;
+    }
+
+    void work(size_t id)
+    {
+      size_t seen = 0;
+      while (true)
+      {
+        {
+          std::unique_lock<std::mutex> lock(mtx);
+          wake.wait(lock, [&]()
+                    { return stop || generation != seen; });
+          if (stop)
+            return;
+          seen = generation;
+        }
+
+        run(id);
+
+        {
+          std::lock_guard<std::mutex> lock(mtx);
+          --busy;
+        }
+        done.notify_one();
+      }
+    }
+  };
+
+#ifdef _OPENMP
+  /// @brief runs the tasks in an OpenMP parallel loop with dynamic scheduling.
+  class openmp_executor : public details::executor_base
+  {
+  public:
+    size_t concurrency() const
+    {
+      return omp_get_max_threads();
+    }
+
+    template <typename F>
+    void bulk(index_t n, F &&f)
+    {
+      const long m = n;
+#pragma omp parallel for schedule(dynamic, 1)
+      for (long i = 0; i < m; ++i)
+        f((index_t)i);
+    }
+  };
+#endif
+
+#ifdef TENSOR_USE_TBB
+  /// @brief runs the tasks with `tbb::parallel_for`, which balances them by
+  /// work stealing.
+  class tbb_executor : public details::executor_base
+  {
+  public:
+    size_t concurrency() const
+    {
+      return tbb::this_task_arena::max_concurrency();
+    }
+
+    template <typename F>
+    void bulk(index_t n, F &&f)
+    {
+      tbb::parallel_for(tbb::blocked_range<index_t>(0, n, 1), [&](const tbb::blocked_range<index_t> &r)
+                        {
+                          for (index_t i = r.begin(); i != r.end(); ++i)
+                            f(i); });
+    }
+  };
+#endif
+
+#ifdef TENSOR_USE_STD_EXECUTION
+  /// @brief runs the tasks with `std::for_each(std::execution::par, ...)`.
+  class std_executor : public details::executor_base
+  {
+  public:
+    size_t concurrency() const
+    {
+      return std::max<size_t>(1, std::thread::hardware_concurrency());
+    }
+
+    template <typename F>
+    void bulk(index_t n, F &&f)
+    {
+      std::vector<index_t> tasks(n);
+      std::iota(tasks.begin(), tasks.end(), index_t(0));
+      std::for_each(std::execution::par, tasks.begin(), tasks.end(), [&](index_t i)
+                    { f(i); });
+    }
+  };
+#endif
+
+  /// @brief returns the thread pool used by `parallel_for` and
+  /// `parallel_reduce` when no executor is given. It has one thread per
+  /// hardware thread and is created on first use.
+  inline thread_pool &default_executor()
+  {
+    static thread_pool pool;
+    return pool;
+  }
+
+  namespace details
+  {
+    /// @brief the number of slabs per thread of the executor. More slabs than
+    /// threads let work stealing balance irregular workloads.
+    inline constexpr index_t slabs_per_thread = 4;
+
+    // the slowest varying dimension of T.
+    template <typename T>
+    constexpr index_t outer_dim()
+    {
+      using shape_type = typename std::decay_t<T>::shape_type;
+      if constexpr (layout_traits<typename shape_type::layout_type>::is_right)
+        return 0;
+      else
+        return shape_type::order() - 1;
+    }
+
+    /**
+     * @brief splits dimension `dim` of x into at most `n_slabs` slabs and
+     * calls `f(k, slab)` for each slab k on the executor.
+     *
+     * @details When the tensor moves by a fixed number of bytes per index
+     * along dim, the slab boundaries are rounded to multiples of 64 bytes
+     * where possible so that two threads do not write to the same cache
+     * line.
+     */
+    template <typename Executor, typename T, typename F>
+    void for_each_slab(Executor &exec, T &&x, index_t dim, index_t n_slabs, F &&f)
+    {
+      using scalar = view_scalar_t<T>;
+      constexpr size_t Rank = std::decay_t<T>::order();
+
+#ifdef TENSOR_CHECK_BOUNDS
+      if (dim < 0 || dim >= Rank)
+        tensor_dimension_out_of_range(dim, Rank);
+#endif
+
+      std::array<index_t, Rank> extents;
+      std::array<stride_t, Rank> strides;
+      for (index_t d = 0; d < Rank; ++d)
+      {
+        extents[d] = x.shape(d);
+        strides[d] = x.stride(d);
+      }
+
+      const index_t n = extents[dim];
+      if (n == 0 || x.size() == 0)
+        return;
+
+      // smallest number of indices along dim spanning a multiple of a cache line
+      const size_t bytes = sizeof(scalar) * (size_t)((strides[dim] < 0) ? -strides[dim] : strides[dim]);
+      const index_t grain = (bytes == 0) ? n : 64 / std::gcd<size_t>(64, bytes);
+
+      index_t chunk = (n + n_slabs - 1) / n_slabs;
+      if (grain <= chunk)
+        chunk = ((chunk + grain - 1) / grain) * grain;
+      const index_t m = (n + chunk - 1) / chunk;
+
+      scalar *ptr = x.data();
+      exec.bulk(m, [&](index_t k)
+                {
+                  const index_t b = k * chunk;
+                  std::array<index_t, Rank> e = extents;
+                  e[dim] = std::min(n, b + chunk) - b;
+                  f(k, StridedView<scalar, Rank>(ptr + (stride_t)b * strides[dim], e, strides)); });
+    }
+  } // namespace details
+
+  /**
+   * @brief partitions x into slabs along dimension `dim` and calls `f(slab)`
+   * for every slab in parallel.
+   *
+   * @details The slabs are `StridedView`s of x which are contiguous subsets
+   * of the indices along dim. There are several slabs per thread of the
+   * executor and the slab boundaries are aligned to cache lines where
+   * possible.
+   *
+   * @param exec `thread_pool` (the default), `sequential_executor`,
+   * `openmp_executor`, `tbb_executor` or `std_executor`.
+   * @param x `Tensor`, `TensorView`, `SubView`, `StridedView`, etc.
+   * @param f called as `f(StridedView<scalar, Rank>)`. Calls for different
+   * slabs may run concurrently.
+   * @param dim the dimension to partition along. Default is the slowest
+   * varying dimension (the last one for column-major tensors).
+   */
+  template <typename Executor, typename T, typename F, typename = std::enable_if_t<details::is_executor_v<Executor> && details::is_tensor_v<T>>>
+  inline void parallel_for(Executor &&exec, T &&x, F &&f, index_t dim = details::outer_dim<T>())
+  {
+    TENSOR_PROFILE_RANGE("tensor::parallel_for");
+    const index_t n_slabs = details::slabs_per_thread * exec.concurrency();
+    details::for_each_slab(exec, x, dim, n_slabs, [&](index_t, auto slab)
+                           {
+                             TENSOR_PROFILE_RANGE("tensor::parallel_for slab");
+                             f(slab); });
+  }
+
+  /// @brief `parallel_for` with the `default_executor()`.
+  template <typename T, typename F, typename = std::enable_if_t<details::is_tensor_v<T>>>
+  inline void parallel_for(T &&x, F &&f, index_t dim = details::outer_dim<T>())
+  {
+    parallel_for(default_executor(), std::forward<T>(x), std::forward<F>(f), dim);
+  }
+
+  /// @brief calls `f(e)` for every element e of x in parallel. Calls for
+  /// different elements may run concurrently.
+  template <typename Executor, typename T, typename F, typename = std::enable_if_t<details::is_executor_v<Executor> && details::is_tensor_v<T>>>
+  inline void parallel_for_each(Executor &&exec, T &&x, F &&f)
+  {
+    parallel_for(exec, x, [&](auto slab)
+                 {
+                   for (auto &e : slab)
+                     f(e); });
+  }
+
+  /// @brief `parallel_for_each` with the `default_executor()`.
+  template <typename T, typename F, typename = std::enable_if_t<details::is_tensor_v<T>>>
+  inline void parallel_for_each(T &&x, F &&f)
+  {
+    parallel_for_each(default_executor(), std::forward<T>(x), std::forward<F>(f));
+  }
+
+  /**
+   * @brief reduces the elements of x with `op` in parallel.
+   *
+   * @details Each slab of x (see `parallel_for`) is reduced on its own
+   * starting from `init`, and the partial results are then combined in
+   * order with `op`. The result is deterministic for a fixed executor, but
+   * differs from a sequential reduction if `op` is not associative (e.g.
+   * floating point addition), and `init` must be an identity of `op`.
+   *
+   * @param exec the executor, see `parallel_for`.
+   * @param x `Tensor`, `TensorView`, `SubView`, `StridedView`, etc.
+   * @param init identity of op, e.g. 0 for `std::plus`.
+   * @param op associative binary operation, called as `op(T, element)` and
+   * `op(T, T)`.
+   * @param dim the dimension to partition along.
+   */
+  template <typename Executor, typename T, typename V, typename Op, typename = std::enable_if_t<details::is_executor_v<Executor> && details::is_tensor_v<T>>>
+  inline V parallel_reduce(Executor &&exec, T &&x, V init, Op op, index_t dim = details::outer_dim<T>())
+  {
+    TENSOR_PROFILE_RANGE("tensor::parallel_reduce");
+    const index_t n_slabs = details::slabs_per_thread * exec.concurrency();
+    std::vector<V> partial(n_slabs, init);
+    details::for_each_slab(exec, x, dim, n_slabs, [&](index_t k, auto slab)
+                           {
+                             TENSOR_PROFILE_RANGE("tensor::parallel_reduce slab");
+                             V acc = init;
+                             for (const auto &e : slab)
+                               acc = op(acc, e);
+                             partial[k] = acc; });
+
+    V result = init;
+    for (const V &p : partial)
+      result = op(result, p);
+    return result;
+  }
+
+  /// @brief `parallel_reduce` with the `default_executor()`.
+  template <typename T, typename V, typename Op, typename = std::enable_if_t<details::is_tensor_v<T>>>
+  inline V parallel_reduce(T &&x, V init, Op op, index_t dim = details::outer_dim<T>())
+  {
+    return parallel_reduce(default_executor(), std::forward<T>(x), init, op, dim);
+  }
+
+  /**
+   * @brief reduces the elements of an expression, e.g. `abs(u - u_old)`,
+   * with `op` in parallel without evaluating it into a temporary.
+   *
+   * @details The elements are split in first index fastest order into
+   * several ranges per thread of the executor, each range is reduced on its
+   * own starting from `init`, and the partial results are combined in order
+   * with `op`, with the same caveats as the reduction of a tensor.
+   */
+  template <typename Executor, typename E, typename V, typename Op, typename = std::enable_if_t<details::is_executor_v<Executor> && details::is_expression_v<E>>>
+  inline V parallel_reduce(Executor &&exec, const E &e, V init, Op op)
+  {
+    TENSOR_PROFILE_RANGE("tensor::parallel_reduce");
+    const index_t n = e.size();
+    const index_t n_slabs = std::max<index_t>(1, std::min<index_t>(n, details::slabs_per_thread * exec.concurrency()));
+    std::vector<V> partial(n_slabs, init);
+    exec.bulk(n_slabs, [&](index_t k)
+              {
+                TENSOR_PROFILE_RANGE("tensor::parallel_reduce slab");
+                const index_t b = (n * k) / n_slabs, end = (n * (k + 1)) / n_slabs;
+                V acc = init;
+                if constexpr (E::is_contiguous())
+                {
+                  for (index_t i = b; i < end; ++i)
+                    acc = op(acc, e[i]);
+                }
+                else
+                {
+                  auto idx = details::unravel_index<E::order()>(b, e);
+                  for (index_t i = b; i < end; ++i)
+                  {
+                    acc = op(acc, e(idx));
+                    details::next_index(idx, e);
+                  }
+                }
+                partial[k] = acc; });
+
+    V result = init;
+    for (const V &p : partial)
+      result = op(result, p);
+    return result;
+  }
+
+  /// @brief `parallel_reduce` of an expression with the `default_executor()`.
+  template <typename E, typename V, typename Op, typename = std::enable_if_t<details::is_expression_v<E>>>
+  inline V parallel_reduce(const E &e, V init, Op op)
+  {
+    return parallel_reduce(default_executor(), e, init, op);
+  }
+} // namespace tensor
+
+#endif
@@ -0,0 +1,450 @@
+#ifndef __TENSOR_VIEW_PROFILE_HPP__
+#define __TENSOR_VIEW_PROFILE_HPP__
+
+#include "tensorview_config.hpp"
+
+// The hooks below compile to nothing unless TENSOR_PROFILE is defined, and
+// never run in device code.
+#if defined(TENSOR_PROFILE) && !defined(__CUDA_ARCH__)
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <iomanip>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+
+#if __has_include(<source_location>) && __cplusplus >= 202002L
+#include <source_location>
+#endif
+
+#ifdef TENSOR_USE_NVTX
+#include <nvtx3/nvToolsExt.h>
+#endif
+
+#ifdef TENSOR_USE_ITT
+#include <ittnotify.h>
+#endif
+
+namespace tensor::profile
+{
+  /// @brief the source location of a profiled range.
+  struct source_site
+  {
+    const char *file = "";
+    unsigned line = 0;
+    const char *function = "";
+
+    /// @brief returns the location of the caller when used as a default argument.
+#if defined(__cpp_lib_source_location)
+    static constexpr source_site current(std::source_location loc = std::source_location::current()) noexcept
+    {
+      return {loc.file_name(), (unsigned)loc.line(), loc.function_name()};
+    }
+#else
+    static constexpr source_site current(const char *file = __builtin_FILE(), unsigned line = __builtin_LINE(), const char *function = __builtin_FUNCTION()) noexcept
+    {
+      return {file, line, function};
+    }
+#endif
+  };
+
+  /// @brief the accesses counted for a site or a view.
+  struct counters
+  {
+    /// `x(i, j, ...)` and `x.at(i, j, ...)` with integer indices.
+    uint64_t element_accesses = 0;
+    /// `x[i]`.
+    uint64_t linear_accesses = 0;
+    /// dereferences of iterators.
+    uint64_t iterator_accesses = 0;
+    /// subviews created with spans.
+    uint64_t subviews = 0;
+    /// bytes read or written through the accesses above.
+    uint64_t bytes = 0;
+
+    uint64_t accesses() const
+    {
+      return element_accesses + linear_accesses + iterator_accesses;
+    }
+
+    counters &operator+=(const counters &other)
+    {
+      element_accesses += other.element_accesses;
+      linear_accesses += other.linear_accesses;
+      iterator_accesses += other.iterator_accesses;
+      subviews += other.subviews;
+      bytes += other.bytes;
+      return *this;
+    }
+  };
+
+  /// @brief counters of a profiled range, identified by its name and source location.
+  struct site_stats
+  {
+    std::string name;
+    source_site site;
+    uint64_t calls = 0;
+    double seconds = 0;
+    counters count;
+  };
+
+  /// @brief counters of a view, identified by the address of its first
+  /// element and its shape.
+  struct view_stats
+  {
+    const void *data = nullptr;
+    index_t rank = 0;
+    std::array<index_t, 8> shape{};
+    std::array<stride_t, 8> strides{};
+    /// true if stride(0) == 1, i.e. the innermost loop of a column-major
+    /// traversal walks contiguous memory.
+    bool unit_stride = false;
+    counters count;
+  };
+
+  namespace details
+  {
+    enum class access_kind
+    {
+      element,
+      linear,
+      iterator,
+      subview
+    };
+
+    struct view_key
+    {
+      const void *data;
+      uint64_t shape_hash;
+
+      bool operator==(const view_key &other) const
+      {
+        return data == other.data && shape_hash == other.shape_hash;
+      }
+    };
+
+    struct view_key_hash
+    {
+      size_t operator()(const view_key &k) const
+      {
+        return std::hash<const void *>()(k.data) ^ (k.shape_hash * 0x9e3779b97f4a7c15ull);
+      }
+    };
+
+    struct thread_profile;
+
+    // the profiles of all threads, and the totals of threads which exited.
+    struct registry
+    {
+      std::mutex mutex;
+      std::vector<thread_profile *> threads;
+      std::unordered_map<std::string, site_stats> sites;
+      std::unordered_map<view_key, view_stats, view_key_hash> views;
+
+      static registry &instance()
+      {
+        static registry r;
+        return r;
+      }
+    };
+
+    inline std::string site_key(const char *name, const source_site &site)
+    {
+      return std::string(name) + '@' + site.file + ':' + std::to_string(site.line);
+    }
+
+    inline void merge(std::unordered_map<std::string, site_stats> &into, const std::unordered_map<std::string, site_stats> &from)
+    {
+      for (auto &[key, s] : from)
+      {
+        auto [it, inserted] = into.try_emplace(key, s);
+        if (!inserted)
+        {
+          it->second.calls += s.calls;
+          it->second.seconds += s.seconds;
+          it->second.count += s.count;
+        }
+      }
+    }
+
+    inline void merge(std::unordered_map<view_key, view_stats, view_key_hash> &into, const std::unordered_map<view_key, view_stats, view_key_hash> &from)
+    {
+      for (auto &[key, v] : from)
+      {
+        auto [it, inserted] = into.try_emplace(key, v);
+        if (!inserted)
+          it->second.count += v.count;
+      }
+    }
+
+    // counters of one thread; recording never takes a lock.
+    struct thread_profile
+    {
+      std::unordered_map<std::string, site_stats> sites;
+      std::unordered_map<view_key, view_stats, view_key_hash> views;
+      site_stats *current = nullptr;
+
+      thread_profile()
+      {
+        registry &r = registry::instance();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        r.threads.push_back(this);
+      }
+
+      ~thread_profile()
+      {
+        registry &r = registry::instance();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        merge(r.sites, sites);
+        merge(r.views, views);
+        r.threads.erase(std::find(r.threads.begin(), r.threads.end(), this));
+      }
+
+      static thread_profile &instance()
+      {
+        static thread_local thread_profile p;
+        return p;
+      }
+
+      // the innermost active range, or the root site outside of all ranges.
+      site_stats &site()
+      {
+        if (current)
+          return *current;
+        auto [it, inserted] = sites.try_emplace("<no range>");
+        if (inserted)
+          it->second.name = "<no range>";
+        current = &it->second;
+        return it->second;
+      }
+    };
+
+    inline void count(counters &c, access_kind kind, size_t bytes)
+    {
+      switch (kind)
+      {
+      case access_kind::element:
+        ++c.element_accesses;
+        break;
+      case access_kind::linear:
+        ++c.linear_accesses;
+        break;
+      case access_kind::iterator:
+        ++c.iterator_accesses;
+        break;
+      case access_kind::subview:
+        ++c.subviews;
+        return;
+      }
+      c.bytes += bytes;
+    }
+
+    /// @brief records an access through a view of shape `shape` whose first
+    /// element is at `data`.
+    template <typename Shape>
+    inline void record(access_kind kind, const void *data, const Shape &shape, size_t bytes)
+    {
+      thread_profile &p = thread_profile::instance();
+      count(p.site().count, kind, bytes);
+
+      constexpr index_t rank = Shape::order();
+      uint64_t h = rank;
+      for (index_t d = 0; d < rank; ++d)
+        h = (h * 1099511628211ull) ^ (uint64_t(shape.shape(d)) * 31 + uint64_t(shape.stride(d)));
+
+      auto [it, inserted] = p.views.try_emplace(view_key{data, h});
+      view_stats &v = it->second;
+      if (inserted)
+      {
+        v.data = data;
+        v.rank = rank;
+        for (index_t d = 0; d < rank && d < v.shape.size(); ++d)
+        {
+          v.shape[d] = shape.shape(d);
+          v.strides[d] = shape.stride(d);
+        }
+        v.unit_stride = shape.stride(0) == 1;
+      }
+      count(v.count, kind, bytes);
+    }
+
+    /// @brief records an iterator dereference, which is attributed to the
+    /// current range only.
+    inline void record_iterator(size_t bytes)
+    {
+      count(thread_profile::instance().site().count, access_kind::iterator, bytes);
+    }
+  } // namespace details
+
+  /**
+   * @brief RAII profiled range. Accesses made by the calling thread while
+   * the range is alive are attributed to it, and its calls and elapsed
+   * time are recorded. If `TENSOR_USE_NVTX` or `TENSOR_USE_ITT` is defined,
+   * the range is also annotated for Nsight Systems or VTune.
+   *
+   * @code {.cpp}
+   * {
+   *   tensor::profile::range r("stencil");
+   *   ... // accesses are counted under "stencil@file.cpp:line"
+   * }
+   * @endcode
+   */
+  class range
+  {
+  public:
+    explicit range(const char *name, source_site site = source_site::current())
+    {
+      details::thread_profile &p = details::thread_profile::instance();
+      _parent = p.current;
+
+      auto [it, inserted] = p.sites.try_emplace(details::site_key(name, site));
+      if (inserted)
+      {
+        it->second.name = name;
+        it->second.site = site;
+      }
+      _site = &it->second;
+      ++_site->calls;
+      p.current = _site;
+
+#ifdef TENSOR_USE_NVTX
+      nvtxRangePushA(name);
+#endif
+#ifdef TENSOR_USE_ITT
+      static __itt_domain *domain = __itt_domain_create("TensorView");
+      __itt_task_begin(domain, __itt_null, __itt_null, __itt_string_handle_create(name));
+      _domain = domain;
+#endif
+      _start = std::chrono::steady_clock::now();
+    }
+
+    ~range()
+    {
+      _site->seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - _start).count();
+      details::thread_profile::instance().current = _parent;
+#ifdef TENSOR_USE_ITT
+      __itt_task_end(_domain);
+#endif
+#ifdef TENSOR_USE_NVTX
+      nvtxRangePop();
+#endif
+    }
+
+    range(const range &) = delete;
+    range &operator=(const range &) = delete;
+
+  private:
+    site_stats *_site;
+    site_stats *_parent;
+    std::chrono::steady_clock::time_point _start;
+#ifdef TENSOR_USE_ITT
+    __itt_domain *_domain;
+#endif
+  };
+
+  /// @brief returns the counters of every range, summed over all threads.
+  /// Do not call while other threads run instrumented code.
+  inline std::vector<site_stats> sites()
+  {
+    details::registry &r = details::registry::instance();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    std::unordered_map<std::string, site_stats> all = r.sites;
+    for (auto *t : r.threads)
+      details::merge(all, t->sites);
+
+    std::vector<site_stats> out;
+    for (auto &[key, s] : all)
+      out.push_back(s);
+    std::sort(out.begin(), out.end(), [](const site_stats &a, const site_stats &b)
+              { return a.count.accesses() > b.count.accesses(); });
+    return out;
+  }
+
+  /// @brief returns the counters of every view, summed over all threads and
+  /// sorted from the most to the least accessed. Do not call while other
+  /// threads run instrumented code.
+  inline std::vector<view_stats> views()
+  {
+    details::registry &r = details::registry::instance();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    std::unordered_map<details::view_key, view_stats, details::view_key_hash> all = r.views;
+    for (auto *t : r.threads)
+      details::merge(all, t->views);
+
+    std::vector<view_stats> out;
+    for (auto &[key, v] : all)
+      out.push_back(v);
+    std::sort(out.begin(), out.end(), [](const view_stats &a, const view_stats &b)
+              { return a.count.accesses() + a.count.subviews > b.count.accesses() + b.count.subviews; });
+    return out;
+  }
+
+  /// @brief clears all counters. Do not call while other threads run
+  /// instrumented code or while a range is alive.
+  inline void reset()
+  {
+    details::registry &r = details::registry::instance();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    r.sites.clear();
+    r.views.clear();
+    for (auto *t : r.threads)
+    {
+      t->sites.clear();
+      t->views.clear();
+      t->current = nullptr;
+    }
+  }
+
+  /// @brief prints the counters of the ranges and of the `max_views` most
+  /// accessed views.
+  inline void report(std::ostream &out, size_t max_views = 20)
+  {
+    out << "TensorView profile\n";
+    out << std::left << std::setw(40) << "range" << std::right << std::setw(10) << "calls" << std::setw(12) << "seconds"
+        << std::setw(14) << "element" << std::setw(14) << "linear" << std::setw(14) << "iterator" << std::setw(10) << "subviews" << std::setw(16) << "bytes" << '\n';
+    for (auto &s : sites())
+    {
+      std::string where = s.name;
+      if (s.site.line)
+        where += std::string(" (") + s.site.file + ":" + std::to_string(s.site.line) + ")";
+      out << std::left << std::setw(40) << where << std::right << std::setw(10) << s.calls << std::setw(12) << s.seconds
+          << std::setw(14) << s.count.element_accesses << std::setw(14) << s.count.linear_accesses << std::setw(14) << s.count.iterator_accesses
+          << std::setw(10) << s.count.subviews << std::setw(16) << s.count.bytes << '\n';
+    }
+
+    out << "\nmost accessed views\n";
+    size_t k = 0;
+    for (auto &v : views())
+    {
+      if (k++ == max_views)
+        break;
+      out << v.data << " shape (";
+      for (index_t d = 0; d < v.rank && d < v.shape.size(); ++d)
+        out << (d ? ", " : "") << v.shape[d];
+      out << ") strides (";
+      for (index_t d = 0; d < v.rank && d < v.strides.size(); ++d)
+        out << (d ? ", " : "") << v.strides[d];
+      out << ")" << (v.unit_stride ? "" : " non-unit") << ": " << v.count.accesses() << " accesses, " << v.count.subviews << " subviews, " << v.count.bytes << " bytes\n";
+    }
+  }
+} // namespace tensor::profile
+
+#define TENSOR_PROFILE_ACCESS(kind, data, shape, bytes) ::tensor::profile::details::record(::tensor::profile::details::access_kind::kind, data, shape, bytes)
+#define TENSOR_PROFILE_ITERATOR(bytes) ::tensor::profile::details::record_iterator(bytes)
+#define TENSOR_PROFILE_CONCAT_(a, b) a##b
+#define TENSOR_PROFILE_CONCAT(a, b) TENSOR_PROFILE_CONCAT_(a, b)
+#define TENSOR_PROFILE_RANGE(name) ::tensor::profile::range TENSOR_PROFILE_CONCAT(_tensor_profile_range_, __LINE__)(name)
+
+#else
+
+#define TENSOR_PROFILE_ACCESS(kind, data, shape, bytes)
+#define TENSOR_PROFILE_ITERATOR(bytes)
+#define TENSOR_PROFILE_RANGE(name)
+
+#endif
+
+#endif
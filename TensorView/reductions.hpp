@@ -0,0 +1,516 @@
+#ifndef __TENSOR_VIEW_REDUCTIONS_HPP__
+#define __TENSOR_VIEW_REDUCTIONS_HPP__
+
+#include <algorithm>
+#include <cmath>
+
+#include "tensorview_config.hpp"
+#include "errors.hpp"
+#include "multi_index.hpp"
+#include "simd.hpp"
+#include "Tensor.hpp"
+#include "expressions.hpp"
+
+namespace tensor::details
+{
+  /// @brief the type in which the elements of T are reduced, `float` for
+  /// tensors of `float16` and `bfloat16`.
+  template <typename T>
+  using element_t = compute_t<std::remove_cv_t<typename T::value_type>>;
+
+  /// @brief number of elements of an expression evaluated at a time by the
+  /// reductions. A block of 512 doubles (4 KB) stays in L1 between being
+  /// written by the expression and read by the vector kernel.
+  inline constexpr index_t reduce_block_size = 512;
+
+  /**
+   * @brief evaluates the expression e block by block into a buffer on the
+   * stack and folds each block into init with `block(acc, ptr, n)`.
+   *
+   * @details Every operand of e is read once and no temporary tensor is
+   * allocated. Contiguous expressions are evaluated by linear index, others
+   * by multi-index in first index fastest order.
+   */
+  template <typename Expr, typename V, typename Block>
+  inline V reduce_blocks(const Expr &e, V init, Block block)
+  {
+    using scalar = element_t<Expr>;
+    constexpr index_t B = reduce_block_size;
+    scalar buf[B];
+
+    const index_t n = e.size();
+    std::array<index_t, Expr::order()> idx{};
+    for (index_t b = 0; b < n; b += B)
+    {
+      const index_t m = std::min(B, n - b);
+      if constexpr (Expr::is_contiguous())
+      {
+        for (index_t i = 0; i < m; ++i)
+          buf[i] = e[b + i];
+      }
+      else
+      {
+        for (index_t i = 0; i < m; ++i)
+        {
+          buf[i] = e(idx);
+          next_index(idx, e);
+        }
+      }
+      init = block(init, buf, m);
+    }
+    return init;
+  }
+
+  // reduces every element of x into init with op(acc, value). Contiguous
+  // tensors call the vector kernel, other tensors are visited with their
+  // iterator.
+  template <typename T, typename Step, typename Combine, typename Op>
+  inline element_t<T> reduce_elements(const T &x, element_t<T> init, Step step, Combine combine, Op op)
+  {
+    using shape_type = std::decay_t<decltype(x.shape())>;
+    if constexpr (shape_type::is_contiguous())
+    {
+      return simd_reduce(x.size(), init, step, combine);
+    }
+    else
+    {
+      element_t<T> result = init;
+      for (auto it = x.begin(); it != x.end(); ++it)
+        result = op(result, *it);
+      return result;
+    }
+  }
+
+  template <typename T, typename Layout, size_t N, size_t... I>
+  inline auto make_tensor_from_extents(const std::array<index_t, N> &extents, std::index_sequence<I...>)
+  {
+    return Tensor<T, N, std::allocator<T>, Layout>(extents[I]...);
+  }
+
+  /**
+   * @brief reduces x along dimension `dim` into a tensor of one lower order.
+   *
+   * @param x the tensor or expression
+   * @param dim the dimension to reduce
+   * @param init value of every element of the result before reducing
+   * @param op `op(acc, value)` scalar reduction
+   * @param row `row(ptr, n)` reduces n contiguous values, used when x is
+   * contiguous and `dim` is its fastest dimension. Expressions are
+   * evaluated into blocks of at most `reduce_block_size` values first.
+   * @return a `Tensor` with the layout of x if x is contiguous.
+   */
+  template <typename T, typename Op, typename Row>
+  inline auto reduce_axis(const T &x, index_t dim, element_t<T> init, Op op, Row row)
+  {
+    using scalar = element_t<T>;
+    using expr_type = std::decay_t<decltype(as_expression(x))>;
+    constexpr size_t Rank = expr_type::order();
+    static_assert(Rank > 1, "axis reductions require a tensor of order > 1.");
+
+#ifdef TENSOR_CHECK_BOUNDS
+    if (dim < 0 || dim >= Rank)
+      tensor_dimension_out_of_range(dim, Rank);
+#endif
+
+    std::array<index_t, Rank - 1> extents;
+    for (index_t d = 0, k = 0; d < Rank; ++d)
+      if (d != dim)
+        extents[k++] = x.shape(d);
+
+    using layout_type = std::conditional_t<expr_type::is_contiguous(), typename expr_type::layout_type, layout::left>;
+    auto result = make_tensor_from_extents<scalar, layout_type>(extents, std::make_index_sequence<Rank - 1>{});
+    scalar *out = result.data();
+    for (index_t i = 0; i < result.size(); ++i)
+      out[i] = init;
+
+    if constexpr (expr_type::is_contiguous())
+    {
+      // inner: the extent of the dimensions stored faster than dim, outer:
+      // the extent of the dimensions stored slower.
+      index_t inner = 1, outer = 1;
+      for (index_t d = 0; d < dim; ++d)
+        inner *= x.shape(d);
+      for (index_t d = dim + 1; d < Rank; ++d)
+        outer *= x.shape(d);
+      if constexpr (std::is_same_v<layout_type, layout::right>)
+        std::swap(inner, outer);
+      const index_t n = x.shape(dim);
+
+      for (index_t o = 0; o < outer; ++o)
+      {
+        if constexpr (is_expression_v<T>)
+        {
+          scalar *dst = out + inner * o;
+          if (inner == 1)
+          {
+            scalar buf[reduce_block_size];
+            for (index_t b = 0; b < n; b += reduce_block_size)
+            {
+              const index_t m = std::min(reduce_block_size, n - b);
+              for (index_t i = 0; i < m; ++i)
+                buf[i] = x[b + i + n * o];
+              *dst = op(*dst, row(buf, m));
+            }
+            continue;
+          }
+
+          for (index_t k = 0; k < n; ++k)
+            for (index_t i = 0; i < inner; ++i)
+              dst[i] = op(dst[i], x[i + inner * (k + n * o)]);
+        }
+        else
+        {
+          const auto *px = x.data();
+          if (inner == 1)
+          {
+            out[o] = op(out[o], row(px + n * o, n));
+            continue;
+          }
+
+          scalar *dst = out + inner * o;
+          for (index_t k = 0; k < n; ++k)
+          {
+            const auto *src = px + inner * (k + n * o);
+            for (index_t i = 0; i < inner; ++i)
+              dst[i] = op(dst[i], src[i]);
+          }
+        }
+      }
+    }
+    else
+    {
+      std::array<index_t, Rank> idx{};
+      std::array<index_t, Rank - 1> out_idx;
+      const index_t n = x.size();
+      for (index_t i = 0; i < n; ++i)
+      {
+        for (index_t d = 0, k = 0; d < Rank; ++d)
+          if (d != dim)
+            out_idx[k++] = idx[d];
+
+        scalar &acc = out[apply_index(result.shape(), out_idx)];
+        if constexpr (is_expression_v<T>)
+        {
+          acc = op(acc, x(idx));
+          next_index(idx, x);
+        }
+        else
+        {
+          acc = op(acc, x.data()[(stride_t)apply_index(x.shape(), idx)]);
+          next_index(idx, x.shape());
+        }
+      }
+    }
+
+    return result;
+  }
+
+  template <typename T>
+  inline compute_t<T> sum_contiguous(const T *x, index_t n)
+  {
+    using C = compute_t<T>;
+    return simd_reduce(
+        n, C(0),
+        [x](auto ops, auto acc, index_t i)
+        { return ops.add(acc, ops.load(x + i)); },
+        [](auto ops, auto a, auto b)
+        { return ops.add(a, b); });
+  }
+
+  template <typename T>
+  inline compute_t<T> max_abs_contiguous(const T *x, index_t n)
+  {
+    using C = compute_t<T>;
+    return simd_reduce(
+        n, C(0),
+        [x](auto ops, auto acc, index_t i)
+        { return ops.max(acc, ops.abs(ops.load(x + i))); },
+        [](auto ops, auto a, auto b)
+        { return ops.max(a, b); });
+  }
+
+  template <typename T>
+  inline compute_t<T> sum_squares_contiguous(const T *x, index_t n)
+  {
+    using C = compute_t<T>;
+    return simd_reduce(
+        n, C(0),
+        [x](auto ops, auto acc, index_t i)
+        {
+          auto v = ops.load(x + i);
+          return ops.fma(v, v, acc);
+        },
+        [](auto ops, auto a, auto b)
+        { return ops.add(a, b); });
+  }
+
+  // the smallest of n > 0 contiguous values.
+  template <typename T>
+  inline compute_t<T> min_contiguous(const T *x, index_t n)
+  {
+    using C = compute_t<T>;
+    return simd_reduce(
+        n, C(x[0]),
+        [x](auto ops, auto acc, index_t i)
+        { return ops.min(acc, ops.load(x + i)); },
+        [](auto ops, auto a, auto b)
+        { return ops.min(a, b); });
+  }
+
+  // the largest of n > 0 contiguous values.
+  template <typename T>
+  inline compute_t<T> max_contiguous(const T *x, index_t n)
+  {
+    using C = compute_t<T>;
+    return simd_reduce(
+        n, C(x[0]),
+        [x](auto ops, auto acc, index_t i)
+        { return ops.max(acc, ops.load(x + i)); },
+        [](auto ops, auto a, auto b)
+        { return ops.max(a, b); });
+  }
+
+  // the first element of a tensor or expression in first index fastest order.
+  template <typename T>
+  inline element_t<T> first_element(const T &x)
+  {
+    if constexpr (is_expression_v<T>)
+    {
+      std::array<index_t, T::order()> idx{};
+      return x(idx);
+    }
+    else
+    {
+      return *x.begin();
+    }
+  }
+  // dot product of two tensors.
+  template <typename A, typename B>
+  inline auto dot_tensors(const A &x, const B &y)
+  {
+    using scalar = element_t<A>;
+    using shape_a = std::decay_t<decltype(x.shape())>;
+    using shape_b = std::decay_t<decltype(y.shape())>;
+    static_assert(std::is_same_v<scalar, element_t<B>>, "dot requires tensors with the same element type.");
+    static_assert(shape_a::order() == shape_b::order(), "dot requires tensors with the same number of dimensions.");
+
+#ifdef TENSOR_CHECK_BOUNDS
+    for (index_t d = 0; d < shape_a::order(); ++d)
+      if (x.shape(d) != y.shape(d))
+        tensor_shape_mismatch();
+#endif
+
+    if constexpr (shape_a::is_contiguous() && shape_b::is_contiguous() && std::is_same_v<typename shape_a::layout_type, typename shape_b::layout_type>)
+    {
+      const auto *px = x.data();
+      const auto *py = y.data();
+      return simd_reduce(
+          x.size(), scalar(0),
+          [px, py](auto ops, auto acc, index_t i)
+          { return ops.fma(ops.load(px + i), ops.load(py + i), acc); },
+          [](auto ops, auto a, auto b)
+          { return ops.add(a, b); });
+    }
+    else if constexpr (std::is_same_v<typename shape_a::layout_type, typename shape_b::layout_type>)
+    {
+      // iterators of tensors with the same layout visit the elements in the same order
+      scalar result = 0;
+      auto ix = x.begin();
+      auto iy = y.begin();
+      for (; ix != x.end(); ++ix, ++iy)
+        result += (*ix) * (*iy);
+      return result;
+    }
+    else
+    {
+      const auto *px = x.data();
+      const auto *py = y.data();
+      scalar result = 0;
+      std::array<index_t, shape_a::order()> idx{};
+      for (index_t i = 0; i < x.size(); ++i)
+      {
+        result += px[(stride_t)apply_index(x.shape(), idx)] * py[(stride_t)apply_index(y.shape(), idx)];
+        next_index(idx, x.shape());
+      }
+      return result;
+    }
+  }
+} // namespace tensor::details
+
+namespace tensor
+{
+  /// @brief returns the sum of the elements of x, a tensor or an
+  /// expression such as `sum(a * b)`. Expressions are evaluated without
+  /// temporaries (see `details::reduce_blocks`).
+  template <typename T, typename = std::enable_if_t<details::is_operand_v<T>>>
+  inline auto sum(const T &x)
+  {
+    using scalar = details::element_t<T>;
+    if constexpr (details::is_expression_v<T>)
+    {
+      return details::reduce_blocks(x, scalar(0), [](scalar acc, const scalar *p, index_t n)
+                                    { return acc + details::sum_contiguous(p, n); });
+    }
+    else
+    {
+      const auto *px = x.data();
+      return details::reduce_elements(
+          x, scalar(0),
+          [px](auto ops, auto acc, index_t i)
+          { return ops.add(acc, ops.load(px + i)); },
+          [](auto ops, auto a, auto b)
+          { return ops.add(a, b); },
+          [](scalar acc, scalar v)
+          { return acc + v; });
+    }
+  }
+
+  /// @brief returns the sum of x, a tensor or an expression, over dimension
+  /// `dim` as a tensor of one lower order.
+  template <typename T, typename = std::enable_if_t<details::is_operand_v<T>>>
+  inline auto sum(const T &x, index_t dim)
+  {
+    using scalar = details::element_t<T>;
+    return details::reduce_axis(
+        x, dim, scalar(0),
+        [](scalar acc, scalar v)
+        { return acc + v; },
+        [](const auto *p, index_t n)
+        { return details::sum_contiguous(p, n); });
+  }
+
+  /// @brief returns the sum of the elementwise product of x and y. If
+  /// either is an expression this is `sum(x * y)`.
+  template <typename A, typename B, typename = std::enable_if_t<details::is_operand_v<A> && details::is_operand_v<B>>>
+  inline auto dot(const A &x, const B &y)
+  {
+    if constexpr (details::is_expression_v<A> || details::is_expression_v<B>)
+      return sum(x * y);
+    else
+      return details::dot_tensors(x, y);
+  }
+
+  /// @brief returns the Euclidean norm of the elements of x, a tensor or an
+  /// expression.
+  template <typename T, typename = std::enable_if_t<details::is_operand_v<T>>>
+  inline auto norm2(const T &x)
+  {
+    using scalar = details::element_t<T>;
+    using std::sqrt;
+    if constexpr (details::is_expression_v<T>)
+    {
+      return sqrt(details::reduce_blocks(x, scalar(0), [](scalar acc, const scalar *p, index_t n)
+                                         { return acc + details::sum_squares_contiguous(p, n); }));
+    }
+    else
+    {
+      const auto *px = x.data();
+      return sqrt(details::reduce_elements(
+          x, scalar(0),
+          [px](auto ops, auto acc, index_t i)
+          {
+            auto v = ops.load(px + i);
+            return ops.fma(v, v, acc);
+          },
+          [](auto ops, auto a, auto b)
+          { return ops.add(a, b); },
+          [](scalar acc, scalar v)
+          { return acc + v * v; }));
+    }
+  }
+
+  /// @brief returns the largest magnitude of the elements of x, a tensor or
+  /// an expression such as `max_abs(u - u_old)`, or zero if x is empty.
+  template <typename T, typename = std::enable_if_t<details::is_operand_v<T>>>
+  inline auto max_abs(const T &x)
+  {
+    using scalar = details::element_t<T>;
+    using S = details::simd_scalar<scalar>;
+    if constexpr (details::is_expression_v<T>)
+    {
+      return details::reduce_blocks(x, scalar(0), [](scalar acc, const scalar *p, index_t n)
+                                    { return S::max(acc, details::max_abs_contiguous(p, n)); });
+    }
+    else
+    {
+      const auto *px = x.data();
+      return details::reduce_elements(
+          x, scalar(0),
+          [px](auto ops, auto acc, index_t i)
+          { return ops.max(acc, ops.abs(ops.load(px + i))); },
+          [](auto ops, auto a, auto b)
+          { return ops.max(a, b); },
+          [](scalar acc, scalar v)
+          { return S::max(acc, S::abs(v)); });
+    }
+  }
+
+  /// @brief returns the largest magnitude of x, a tensor or an expression,
+  /// along dimension `dim` as a tensor of one lower order.
+  template <typename T, typename = std::enable_if_t<details::is_operand_v<T>>>
+  inline auto max_abs(const T &x, index_t dim)
+  {
+    using scalar = details::element_t<T>;
+    using S = details::simd_scalar<scalar>;
+    return details::reduce_axis(
+        x, dim, scalar(0),
+        [](scalar acc, scalar v)
+        { return S::max(acc, S::abs(v)); },
+        [](const auto *p, index_t n)
+        { return details::max_abs_contiguous(p, n); });
+  }
+
+  /// @brief returns the smallest element of x, a tensor or an expression.
+  /// x must not be empty.
+  template <typename T, typename = std::enable_if_t<details::is_operand_v<T>>>
+  inline auto min(const T &x)
+  {
+    using scalar = details::element_t<T>;
+    using S = details::simd_scalar<scalar>;
+    if constexpr (details::is_expression_v<T>)
+    {
+      return details::reduce_blocks(x, details::first_element(x), [](scalar acc, const scalar *p, index_t n)
+                                    { return S::min(acc, details::min_contiguous(p, n)); });
+    }
+    else
+    {
+      const auto *px = x.data();
+      return details::reduce_elements(
+          x, *x.begin(),
+          [px](auto ops, auto acc, index_t i)
+          { return ops.min(acc, ops.load(px + i)); },
+          [](auto ops, auto a, auto b)
+          { return ops.min(a, b); },
+          [](scalar acc, scalar v)
+          { return S::min(acc, v); });
+    }
+  }
+
+  /// @brief returns the largest element of x, a tensor or an expression such
+  /// as `max(abs(u - u_old))`. x must not be empty.
+  template <typename T, typename = std::enable_if_t<details::is_operand_v<T>>>
+  inline auto max(const T &x)
+  {
+    using scalar = details::element_t<T>;
+    using S = details::simd_scalar<scalar>;
+    if constexpr (details::is_expression_v<T>)
+    {
+      return details::reduce_blocks(x, details::first_element(x), [](scalar acc, const scalar *p, index_t n)
+                                    { return S::max(acc, details::max_contiguous(p, n)); });
+    }
+    else
+    {
+      const auto *px = x.data();
+      return details::reduce_elements(
+          x, *x.begin(),
+          [px](auto ops, auto acc, index_t i)
+          { return ops.max(acc, ops.load(px + i)); },
+          [](auto ops, auto a, auto b)
+          { return ops.max(a, b); },
+          [](scalar acc, scalar v)
+          { return S::max(acc, v); });
+    }
+  }
+} // namespace tensor
+
+#endif
@@ -6,6 +6,7 @@
 #include "FixedTensorView.hpp"
 #include "Tensor.hpp"
 #include "FixedTensor.hpp"
+#include "SmallTensor.hpp"
 
 namespace tensor
 {
@@ -21,60 +22,84 @@ namespace tensor
     return TensorView<scalar, sizeof...(Sizes)>(data, shape...);
   }
 
-  /// @brief Returns new TensorView with new shape but points to same data.
-  template <typename scalar, size_t Rank, TENSOR_INT_LIKE... Sizes>
-  TENSOR_FUNC auto reshape(const TensorView<scalar, Rank> &tensor, Sizes... shape)
+  namespace details
   {
-    return reshape(tensor.data(), std::forward<Sizes>(shape)...);
+    template <typename Layout, typename scalar, TENSOR_INT_LIKE... Sizes>
+    TENSOR_FUNC auto reshape_view(scalar *data, Sizes... shape)
+    {
+      static_assert(!is_padded_layout_v<Layout>, "padded tensors cannot be reshaped.");
+      return TensorView<scalar, sizeof...(Sizes), Layout>(data, shape...);
+    }
+  } // namespace details
+
+  /// @brief Returns new TensorView with new shape and the same layout but points to same data.
+  template <typename scalar, size_t Rank, typename Layout, TENSOR_INT_LIKE... Sizes>
+  TENSOR_FUNC auto reshape(const TensorView<scalar, Rank, Layout> &tensor, Sizes... shape)
+  {
+    return details::reshape_view<Layout>(tensor.data(), std::forward<Sizes>(shape)...);
+  }
+
+  /// @brief Returns new TensorView with new shape and the same layout but points to same data.
+  template <typename scalar, size_t Rank, typename Layout, TENSOR_INT_LIKE... Sizes>
+  TENSOR_FUNC auto reshape(TensorView<scalar, Rank, Layout> &tensor, Sizes... shape)
+  {
+    return details::reshape_view<Layout>(tensor.data(), std::forward<Sizes>(shape)...);
+  }
+
+  /// @brief Returns new TensorView with new shape and the same layout but points to same data.
+  template <typename scalar, typename Layout, size_t... Shape, TENSOR_INT_LIKE... Sizes>
+  TENSOR_FUNC auto reshape(const BasicFixedTensorView<scalar, Layout, Shape...> &tensor, Sizes... shape)
+  {
+    return details::reshape_view<Layout>(tensor.data(), std::forward<Sizes>(shape)...);
   }
 
-  /// @brief Returns new TensorView with new shape but points to same data.
-  template <typename scalar, size_t Rank, TENSOR_INT_LIKE... Sizes>
-  TENSOR_FUNC auto reshape(TensorView<scalar, Rank> &tensor, Sizes... shape)
+  /// @brief Returns new TensorView with new shape and the same layout but points to same data.
+  template <typename scalar, typename Layout, size_t... Shape, TENSOR_INT_LIKE... Sizes>
+  TENSOR_FUNC auto reshape(BasicFixedTensorView<scalar, Layout, Shape...> &tensor, Sizes... shape)
   {
-    return reshape(tensor.data(), std::forward<Sizes>(shape)...);
+    return details::reshape_view<Layout>(tensor.data(), std::forward<Sizes>(shape)...);
   }
 
-  /// @brief Returns new TensorView with new shape but points to same data.
-  template <typename scalar, size_t... Shape, TENSOR_INT_LIKE... Sizes>
-  TENSOR_FUNC auto reshape(FixedTensorView<scalar, Shape...> &tensor, Sizes... shape)
+  /// @brief Returns new TensorView with new shape and the same layout but points to same data.
+  template <typename scalar, typename Layout, size_t... Shape, TENSOR_INT_LIKE... Sizes>
+  TENSOR_FUNC auto reshape(const BasicFixedTensor<scalar, Layout, Shape...> &tensor, Sizes... shape)
   {
-    return reshape(tensor.data(), std::forward<Sizes>(shape)...);
+    return details::reshape_view<Layout>(tensor.data(), std::forward<Sizes>(shape)...);
   }
 
-  /// @brief Returns new TensorView with new shape but points to same data.
-  template <typename scalar, size_t... Shape, TENSOR_INT_LIKE... Sizes>
-  TENSOR_FUNC auto reshape(const FixedTensorView<scalar, Shape...> &tensor, Sizes... shape)
+  /// @brief Returns new TensorView with new shape and the same layout but points to same data.
+  template <typename scalar, typename Layout, size_t... Shape, TENSOR_INT_LIKE... Sizes>
+  TENSOR_FUNC auto reshape(BasicFixedTensor<scalar, Layout, Shape...> &tensor, Sizes... shape)
   {
-    return reshape(tensor.data(), std::forward<Sizes>(shape)...);
+    return details::reshape_view<Layout>(tensor.data(), std::forward<Sizes>(shape)...);
   }
 
-  /// @brief Returns new TensorView with new shape but points to same data.
-  template <typename scalar, size_t... Shape, TENSOR_INT_LIKE... Sizes>
-  TENSOR_FUNC auto reshape(FixedTensor<scalar, Shape...> &tensor, Sizes... shape)
+  /// @brief Returns new TensorView with new shape and the same layout but points to same data.
+  template <typename scalar, size_t Rank, typename Allocator, typename Layout, TENSOR_INT_LIKE... Sizes>
+  TENSOR_FUNC auto reshape(const Tensor<scalar, Rank, Allocator, Layout> &tensor, Sizes... shape)
   {
-    return reshape(tensor.data(), std::forward<Sizes>(shape)...);
+    return details::reshape_view<Layout>(tensor.data(), std::forward<Sizes>(shape)...);
   }
 
-  /// @brief Returns new TensorView with new shape but points to same data.
-  template <typename scalar, size_t... Shape, TENSOR_INT_LIKE... Sizes>
-  TENSOR_FUNC auto reshape(const FixedTensor<scalar, Shape...> &tensor, Sizes... shape)
+  /// @brief Returns new TensorView with new shape and the same layout but points to same data.
+  template <typename scalar, size_t Rank, typename Allocator, typename Layout, TENSOR_INT_LIKE... Sizes>
+  TENSOR_FUNC auto reshape(Tensor<scalar, Rank, Allocator, Layout> &tensor, Sizes... shape)
   {
-    return reshape(tensor.data(), std::forward<Sizes>(shape)...);
+    return details::reshape_view<Layout>(tensor.data(), std::forward<Sizes>(shape)...);
   }
 
-  /// @brief Returns new TensorView with new shape but points to same data.
-  template <typename scalar, size_t Rank, TENSOR_INT_LIKE... Sizes>
-  TENSOR_FUNC auto reshape(const Tensor<scalar, Rank> &tensor, Sizes... shape)
+  /// @brief Returns new TensorView with new shape and the same layout but points to same data.
+  template <typename scalar, size_t Rank, size_t InlineCapacity, typename Allocator, typename Layout, TENSOR_INT_LIKE... Sizes>
+  TENSOR_FUNC auto reshape(const SmallTensor<scalar, Rank, InlineCapacity, Allocator, Layout> &tensor, Sizes... shape)
   {
-    return reshape(tensor.data(), std::forward<Sizes>(shape)...);
+    return details::reshape_view<Layout>(tensor.data(), std::forward<Sizes>(shape)...);
   }
 
-  /// @brief Returns new TensorView with new shape but points to same data.
-  template <typename scalar, size_t Rank, TENSOR_INT_LIKE... Sizes>
-  TENSOR_FUNC auto reshape(Tensor<scalar, Rank> &tensor, Sizes... shape)
+  /// @brief Returns new TensorView with new shape and the same layout but points to same data.
+  template <typename scalar, size_t Rank, size_t InlineCapacity, typename Allocator, typename Layout, TENSOR_INT_LIKE... Sizes>
+  TENSOR_FUNC auto reshape(SmallTensor<scalar, Rank, InlineCapacity, Allocator, Layout> &tensor, Sizes... shape)
   {
-    return reshape(tensor.data(), std::forward<Sizes>(shape)...);
+    return details::reshape_view<Layout>(tensor.data(), std::forward<Sizes>(shape)...);
   }
 } // namespace tensor
 
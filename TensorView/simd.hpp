@@ -0,0 +1,361 @@
+#ifndef __TENSOR_VIEW_SIMD_HPP__
+#define __TENSOR_VIEW_SIMD_HPP__
+
+#include "tensorview_config.hpp"
+#include "float16.hpp"
+
+// The instruction set is chosen at compile time from the target flags (e.g.
+// -mavx2 -mfma, -mavx512f, or -march=native). Define TENSOR_NO_SIMD to always
+// use the scalar kernels.
+#if !defined(TENSOR_NO_SIMD) && !defined(__CUDA_ARCH__)
+#if defined(__AVX512F__)
+#include <immintrin.h>
+#define TENSOR_SIMD_AVX512
+#elif defined(__AVX__)
+#include <immintrin.h>
+#define TENSOR_SIMD_AVX
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define TENSOR_SIMD_SSE2
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define TENSOR_SIMD_NEON
+#endif
+#endif
+
+namespace tensor::details
+{
+  /// @brief scalar implementation of the simd interface. Used for the tail
+  /// of every kernel and for types without a vector specialization.
+  template <typename T>
+  struct simd_scalar
+  {
+    using type = T;
+    static constexpr index_t width = 1;
+
+    static inline type broadcast(T x) { return x; }
+    static inline type load(const T *p) { return *p; }
+    static inline void store(T *p, type a) { *p = a; }
+    // converting loads and stores, e.g. of `float16` into `float`
+    template <typename U>
+    static inline type load(const U *p) { return type(*p); }
+    template <typename U>
+    static inline void store(U *p, type a) { *p = a; }
+    static inline type add(type a, type b) { return a + b; }
+    static inline type mul(type a, type b) { return a * b; }
+    static inline type fma(type a, type b, type c) { return a * b + c; }
+    static inline type abs(type a) { return (a < T(0)) ? -a : a; }
+    static inline type min(type a, type b) { return (b < a) ? b : a; }
+    static inline type max(type a, type b) { return (a < b) ? b : a; }
+  };
+
+  /// @brief loads `V::width` elements of a storage type (e.g. `float16`)
+  /// into a vector of `float` one element at a time, for targets without
+  /// conversion instructions.
+  template <typename V, typename U>
+  inline typename V::type load_converted(const U *p)
+  {
+    float x[V::width];
+    for (index_t k = 0; k < V::width; ++k)
+      x[k] = p[k];
+    return V::load(x);
+  }
+
+  /// @brief stores a vector of `float` as `V::width` elements of a storage
+  /// type one element at a time.
+  template <typename V, typename U>
+  inline void store_converted(U *p, typename V::type a)
+  {
+    float x[V::width];
+    V::store(x, a);
+    for (index_t k = 0; k < V::width; ++k)
+      p[k] = x[k];
+  }
+
+  /// @brief thin wrapper over the vector registers of the target
+  /// architecture. `width` elements of type T are processed at a time.
+  template <typename T>
+  struct simd : simd_scalar<T>
+  {
+  };
+
+#if defined(TENSOR_SIMD_AVX512)
+  template <>
+  struct simd<double>
+  {
+    using type = __m512d;
+    static constexpr index_t width = 8;
+
+    static inline type broadcast(double x) { return _mm512_set1_pd(x); }
+    static inline type load(const double *p) { return _mm512_loadu_pd(p); }
+    static inline void store(double *p, type a) { _mm512_storeu_pd(p, a); }
+    static inline type add(type a, type b) { return _mm512_add_pd(a, b); }
+    static inline type mul(type a, type b) { return _mm512_mul_pd(a, b); }
+    static inline type fma(type a, type b, type c) { return _mm512_fmadd_pd(a, b, c); }
+    static inline type abs(type a) { return _mm512_abs_pd(a); }
+    static inline type min(type a, type b) { return _mm512_min_pd(a, b); }
+    static inline type max(type a, type b) { return _mm512_max_pd(a, b); }
+  };
+
+  template <>
+  struct simd<float>
+  {
+    using type = __m512;
+    static constexpr index_t width = 16;
+
+    static inline type broadcast(float x) { return _mm512_set1_ps(x); }
+    static inline type load(const float *p) { return _mm512_loadu_ps(p); }
+    static inline void store(float *p, type a) { _mm512_storeu_ps(p, a); }
+    static inline type load(const float16 *p) { return _mm512_cvtph_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(p))); }
+    static inline void store(float16 *p, type a) { _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), _mm512_cvtps_ph(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC)); }
+    static inline type load(const bfloat16 *p) { return _mm512_castsi512_ps(_mm512_slli_epi32(_mm512_cvtepu16_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(p))), 16)); }
+    static inline void store(bfloat16 *p, type a)
+    {
+      // round to nearest even, NaNs are kept quiet
+      const __m512i x = _mm512_castps_si512(a);
+      const __m512i odd = _mm512_and_si512(_mm512_srli_epi32(x, 16), _mm512_set1_epi32(1));
+      __m512i r = _mm512_add_epi32(x, _mm512_add_epi32(_mm512_set1_epi32(0x7fff), odd));
+      r = _mm512_mask_mov_epi32(r, _mm512_cmp_ps_mask(a, a, _CMP_UNORD_Q), _mm512_or_si512(x, _mm512_set1_epi32(0x00400000)));
+      _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), _mm512_cvtepi32_epi16(_mm512_srli_epi32(r, 16)));
+    }
+    static inline type add(type a, type b) { return _mm512_add_ps(a, b); }
+    static inline type mul(type a, type b) { return _mm512_mul_ps(a, b); }
+    static inline type fma(type a, type b, type c) { return _mm512_fmadd_ps(a, b, c); }
+    static inline type abs(type a) { return _mm512_abs_ps(a); }
+    static inline type min(type a, type b) { return _mm512_min_ps(a, b); }
+    static inline type max(type a, type b) { return _mm512_max_ps(a, b); }
+  };
+#elif defined(TENSOR_SIMD_AVX)
+  template <>
+  struct simd<double>
+  {
+    using type = __m256d;
+    static constexpr index_t width = 4;
+
+    static inline type broadcast(double x) { return _mm256_set1_pd(x); }
+    static inline type load(const double *p) { return _mm256_loadu_pd(p); }
+    static inline void store(double *p, type a) { _mm256_storeu_pd(p, a); }
+    static inline type add(type a, type b) { return _mm256_add_pd(a, b); }
+    static inline type mul(type a, type b) { return _mm256_mul_pd(a, b); }
+#ifdef __FMA__
+    static inline type fma(type a, type b, type c) { return _mm256_fmadd_pd(a, b, c); }
+#else
+    static inline type fma(type a, type b, type c) { return _mm256_add_pd(_mm256_mul_pd(a, b), c); }
+#endif
+    static inline type abs(type a) { return _mm256_andnot_pd(_mm256_set1_pd(-0.0), a); }
+    static inline type min(type a, type b) { return _mm256_min_pd(a, b); }
+    static inline type max(type a, type b) { return _mm256_max_pd(a, b); }
+  };
+
+  template <>
+  struct simd<float>
+  {
+    using type = __m256;
+    static constexpr index_t width = 8;
+
+    static inline type broadcast(float x) { return _mm256_set1_ps(x); }
+    static inline type load(const float *p) { return _mm256_loadu_ps(p); }
+    static inline void store(float *p, type a) { _mm256_storeu_ps(p, a); }
+#ifdef __F16C__
+    static inline type load(const float16 *p) { return _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p))); }
+    static inline void store(float16 *p, type a) { _mm_storeu_si128(reinterpret_cast<__m128i *>(p), _mm256_cvtps_ph(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC)); }
+#else
+    static inline type load(const float16 *p) { return load_converted<simd>(p); }
+    static inline void store(float16 *p, type a) { store_converted<simd>(p, a); }
+#endif
+#ifdef __AVX2__
+    static inline type load(const bfloat16 *p) { return _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p))), 16)); }
+    static inline void store(bfloat16 *p, type a)
+    {
+      // round to nearest even, NaNs are kept quiet
+      const __m256i x = _mm256_castps_si256(a);
+      const __m256i odd = _mm256_and_si256(_mm256_srli_epi32(x, 16), _mm256_set1_epi32(1));
+      __m256i r = _mm256_add_epi32(x, _mm256_add_epi32(_mm256_set1_epi32(0x7fff), odd));
+      r = _mm256_blendv_epi8(r, _mm256_or_si256(x, _mm256_set1_epi32(0x00400000)), _mm256_castps_si256(_mm256_cmp_ps(a, a, _CMP_UNORD_Q)));
+      r = _mm256_packus_epi32(_mm256_srli_epi32(r, 16), _mm256_setzero_si256());
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(p), _mm256_castsi256_si128(_mm256_permute4x64_epi64(r, 0x08)));
+    }
+#else
+    static inline type load(const bfloat16 *p) { return load_converted<simd>(p); }
+    static inline void store(bfloat16 *p, type a) { store_converted<simd>(p, a); }
+#endif
+    static inline type add(type a, type b) { return _mm256_add_ps(a, b); }
+    static inline type mul(type a, type b) { return _mm256_mul_ps(a, b); }
+#ifdef __FMA__
+    static inline type fma(type a, type b, type c) { return _mm256_fmadd_ps(a, b, c); }
+#else
+    static inline type fma(type a, type b, type c) { return _mm256_add_ps(_mm256_mul_ps(a, b), c); }
+#endif
+    static inline type abs(type a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a); }
+    static inline type min(type a, type b) { return _mm256_min_ps(a, b); }
+    static inline type max(type a, type b) { return _mm256_max_ps(a, b); }
+  };
+#elif defined(TENSOR_SIMD_SSE2)
+  template <>
+  struct simd<double>
+  {
+    using type = __m128d;
+    static constexpr index_t width = 2;
+
+    static inline type broadcast(double x) { return _mm_set1_pd(x); }
+    static inline type load(const double *p) { return _mm_loadu_pd(p); }
+    static inline void store(double *p, type a) { _mm_storeu_pd(p, a); }
+    static inline type add(type a, type b) { return _mm_add_pd(a, b); }
+    static inline type mul(type a, type b) { return _mm_mul_pd(a, b); }
+    static inline type fma(type a, type b, type c) { return _mm_add_pd(_mm_mul_pd(a, b), c); }
+    static inline type abs(type a) { return _mm_andnot_pd(_mm_set1_pd(-0.0), a); }
+    static inline type min(type a, type b) { return _mm_min_pd(a, b); }
+    static inline type max(type a, type b) { return _mm_max_pd(a, b); }
+  };
+
+  template <>
+  struct simd<float>
+  {
+    using type = __m128;
+    static constexpr index_t width = 4;
+
+    static inline type broadcast(float x) { return _mm_set1_ps(x); }
+    static inline type load(const float *p) { return _mm_loadu_ps(p); }
+    static inline void store(float *p, type a) { _mm_storeu_ps(p, a); }
+    static inline type load(const float16 *p)
+    {
+      // the conversion of half_bits_to_float with masks for the branches
+      const __m128i h = _mm_unpacklo_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(p)), _mm_setzero_si128());
+      const __m128i shifted_exp = _mm_set1_epi32(0x7c00 << 13);
+      __m128i f = _mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(0x7fff)), 13);
+      const __m128i exp = _mm_and_si128(f, shifted_exp);
+      f = _mm_add_epi32(f, _mm_set1_epi32((127 - 15) << 23));
+      f = _mm_add_epi32(f, _mm_and_si128(_mm_cmpeq_epi32(exp, shifted_exp), _mm_set1_epi32((128 - 16) << 23)));
+      const __m128i zero = _mm_cmpeq_epi32(exp, _mm_setzero_si128());
+      const __m128i sub = _mm_castps_si128(_mm_sub_ps(_mm_castsi128_ps(_mm_add_epi32(f, _mm_set1_epi32(1 << 23))), _mm_castsi128_ps(_mm_set1_epi32(113 << 23))));
+      f = _mm_or_si128(_mm_andnot_si128(zero, f), _mm_and_si128(zero, sub));
+      return _mm_castsi128_ps(_mm_or_si128(f, _mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(0x8000)), 16)));
+    }
+    static inline void store(float16 *p, type a)
+    {
+      // the conversion of float_to_half_bits with masks for the branches
+      const __m128i x = _mm_castps_si128(a);
+      const __m128i sign = _mm_and_si128(x, _mm_set1_epi32(int(0x80000000u)));
+      const __m128i f = _mm_xor_si128(x, sign);
+      const __m128i big = _mm_cmpgt_epi32(f, _mm_set1_epi32(0x477fffff));
+      const __m128i nan = _mm_cmpgt_epi32(f, _mm_set1_epi32(0x7f800000));
+      const __m128i small = _mm_cmplt_epi32(f, _mm_set1_epi32(0x38800000));
+      const __m128i magic = _mm_set1_epi32(126 << 23);
+      const __m128i sub = _mm_sub_epi32(_mm_castps_si128(_mm_add_ps(_mm_castsi128_ps(f), _mm_castsi128_ps(magic))), magic);
+      const __m128i odd = _mm_and_si128(_mm_srli_epi32(f, 13), _mm_set1_epi32(1));
+      const __m128i norm = _mm_srli_epi32(_mm_add_epi32(_mm_add_epi32(f, _mm_set1_epi32(int(0xc8000fffu))), odd), 13);
+      const __m128i inf = _mm_or_si128(_mm_and_si128(nan, _mm_set1_epi32(0x7e00)), _mm_andnot_si128(nan, _mm_set1_epi32(0x7c00)));
+      __m128i h = _mm_or_si128(_mm_andnot_si128(small, norm), _mm_and_si128(small, sub));
+      h = _mm_or_si128(_mm_andnot_si128(big, h), _mm_and_si128(big, inf));
+      h = _mm_or_si128(h, _mm_srli_epi32(sign, 16));
+      // sign extend the 16 bit results to use the signed pack
+      h = _mm_srai_epi32(_mm_slli_epi32(h, 16), 16);
+      _mm_storel_epi64(reinterpret_cast<__m128i *>(p), _mm_packs_epi32(h, _mm_setzero_si128()));
+    }
+    static inline type load(const bfloat16 *p) { return _mm_castsi128_ps(_mm_unpacklo_epi16(_mm_setzero_si128(), _mm_loadl_epi64(reinterpret_cast<const __m128i *>(p)))); }
+    static inline void store(bfloat16 *p, type a)
+    {
+      // round to nearest even, NaNs are kept quiet. The arithmetic shift
+      // keeps the upper halves in the range of the signed pack.
+      const __m128i x = _mm_castps_si128(a);
+      const __m128i odd = _mm_and_si128(_mm_srli_epi32(x, 16), _mm_set1_epi32(1));
+      const __m128i r = _mm_add_epi32(x, _mm_add_epi32(_mm_set1_epi32(0x7fff), odd));
+      const __m128i nan = _mm_castps_si128(_mm_cmpunord_ps(a, a));
+      const __m128i y = _mm_or_si128(_mm_andnot_si128(nan, r), _mm_and_si128(nan, _mm_or_si128(x, _mm_set1_epi32(0x00400000))));
+      _mm_storel_epi64(reinterpret_cast<__m128i *>(p), _mm_packs_epi32(_mm_srai_epi32(y, 16), _mm_setzero_si128()));
+    }
+    static inline type add(type a, type b) { return _mm_add_ps(a, b); }
+    static inline type mul(type a, type b) { return _mm_mul_ps(a, b); }
+    static inline type fma(type a, type b, type c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+    static inline type abs(type a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+    static inline type min(type a, type b) { return _mm_min_ps(a, b); }
+    static inline type max(type a, type b) { return _mm_max_ps(a, b); }
+  };
+#elif defined(TENSOR_SIMD_NEON)
+  template <>
+  struct simd<double>
+  {
+    using type = float64x2_t;
+    static constexpr index_t width = 2;
+
+    static inline type broadcast(double x) { return vdupq_n_f64(x); }
+    static inline type load(const double *p) { return vld1q_f64(p); }
+    static inline void store(double *p, type a) { vst1q_f64(p, a); }
+    static inline type add(type a, type b) { return vaddq_f64(a, b); }
+    static inline type mul(type a, type b) { return vmulq_f64(a, b); }
+    static inline type fma(type a, type b, type c) { return vfmaq_f64(c, a, b); }
+    static inline type abs(type a) { return vabsq_f64(a); }
+    static inline type min(type a, type b) { return vminq_f64(a, b); }
+    static inline type max(type a, type b) { return vmaxq_f64(a, b); }
+  };
+
+  template <>
+  struct simd<float>
+  {
+    using type = float32x4_t;
+    static constexpr index_t width = 4;
+
+    static inline type broadcast(float x) { return vdupq_n_f32(x); }
+    static inline type load(const float *p) { return vld1q_f32(p); }
+    static inline void store(float *p, type a) { vst1q_f32(p, a); }
+    static inline type load(const float16 *p) { return vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16(reinterpret_cast<const uint16_t *>(p)))); }
+    static inline void store(float16 *p, type a) { vst1_u16(reinterpret_cast<uint16_t *>(p), vreinterpret_u16_f16(vcvt_f16_f32(a))); }
+    static inline type load(const bfloat16 *p) { return vreinterpretq_f32_u32(vshll_n_u16(vld1_u16(reinterpret_cast<const uint16_t *>(p)), 16)); }
+    static inline void store(bfloat16 *p, type a) { store_converted<simd>(p, a); }
+    static inline type add(type a, type b) { return vaddq_f32(a, b); }
+    static inline type mul(type a, type b) { return vmulq_f32(a, b); }
+    static inline type fma(type a, type b, type c) { return vfmaq_f32(c, a, b); }
+    static inline type abs(type a) { return vabsq_f32(a); }
+    static inline type min(type a, type b) { return vminq_f32(a, b); }
+    static inline type max(type a, type b) { return vmaxq_f32(a, b); }
+  };
+#endif
+
+  /**
+   * @brief reduces n elements with four independent vector accumulators.
+   *
+   * @param n number of elements
+   * @param init initial value of every accumulator. Must be an identity of
+   * `combine`, or `combine` must be idempotent (e.g. min/max with an element).
+   * @param step `step(ops, acc, i)` folds the (vector of) element(s) starting
+   * at i into acc, where `ops` is either `simd<T>` or `simd_scalar<T>`.
+   * @param combine `combine(ops, a, b)` merges two accumulators.
+   */
+  template <typename T, typename Step, typename Combine>
+  inline T simd_reduce(index_t n, T init, Step step, Combine combine)
+  {
+    using V = simd<T>;
+    using S = simd_scalar<T>;
+    constexpr index_t W = V::width;
+
+    auto a0 = V::broadcast(init);
+    auto a1 = a0, a2 = a0, a3 = a0;
+
+    index_t i = 0;
+    for (; i + 4 * W <= n; i += 4 * W)
+    {
+      a0 = step(V{}, a0, i);
+      a1 = step(V{}, a1, i + W);
+      a2 = step(V{}, a2, i + 2 * W);
+      a3 = step(V{}, a3, i + 3 * W);
+    }
+    for (; i + W <= n; i += W)
+      a0 = step(V{}, a0, i);
+
+    a0 = combine(V{}, combine(V{}, a0, a1), combine(V{}, a2, a3));
+
+    T lanes[W];
+    V::store(lanes, a0);
+
+    T result = init;
+    for (index_t k = 0; k < W; ++k)
+      result = combine(S{}, result, lanes[k]);
+
+    for (; i < n; ++i)
+      result = step(S{}, result, i);
+
+    return result;
+  }
+} // namespace tensor::details
+
+#endif
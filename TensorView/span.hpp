@@ -14,9 +14,17 @@ namespace tensor
 
     constexpr explicit span(index_t Begin, index_t End, index_t inc = 1) : begin{Begin}, end{End}, stride{inc} {}
 
+    /// @brief returns the number of indices in the span. Spans produced by
+    /// scaling with a negative stride are counted in signed arithmetic, and a
+    /// span with stride zero (a broadcast dimension) has `end - begin`
+    /// elements.
     TENSOR_FUNC index_t size() const
     {
-      return (end - begin) / stride;
+      const stride_t n = (stride_t)(end - begin);
+      const stride_t s = (stride_t)stride;
+      if (s == 0)
+        return n;
+      return (s > 0) ? (n + s - 1) / s : (n + s + 1) / s;
     }
   };
 
@@ -38,9 +46,11 @@ namespace tensor
       return span(x.begin + i, x.end + i, x.stride);
     }
 
-    // scale a span
+    // scale a span. Scaling by zero keeps the number of elements in `end`.
     constexpr span operator*(index_t s, const span &x)
     {
+      if (s == 0)
+        return span(0, x.size(), 0);
       return span(s * x.begin, s * x.end, s * x.stride);
     }
 
@@ -129,7 +139,8 @@ namespace tensor
       return concat(a, b, std::make_index_sequence<N>{}, std::make_index_sequence<M>{});
     }
 
-    // compute offset of a multidimensional span
+    // compute offset of a multidimensional span. The offset may be negative
+    // (as a stride_t) for views with negative strides.
     template <size_t N>
     constexpr index_t offset(const std::array<span, N> &spans)
     {
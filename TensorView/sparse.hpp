@@ -0,0 +1,818 @@
+#ifndef __TENSOR_VIEW_SPARSE_HPP__
+#define __TENSOR_VIEW_SPARSE_HPP__
+
+#include <algorithm>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "tensorview_config.hpp"
+#include "errors.hpp"
+#include "profile.hpp"
+#include "DynamicTensorView.hpp"
+#include "FixedTensorView.hpp"
+#include "parallel.hpp"
+#include "matmul.hpp"
+
+namespace tensor
+{
+  /**
+   * @brief non-owning view of a sparse matrix in compressed sparse row
+   * (CSR) format.
+   *
+   * @details The nonzeros of row i are `values()[p]` in column
+   * `columns()[p]` for `row_offsets()[i] <= p < row_offsets()[i + 1]`, with
+   * the columns of each row sorted. Like `TensorView`, a `CsrView` is three
+   * pointers and its sizes, so it is trivially copyable and may be passed by
+   * value to a `__global__` function when the arrays are in device memory.
+   *
+   * @tparam scalar the type of the nonzeros, `const` for a read only view.
+   * @tparam Index the type of the row offsets and column indices.
+   */
+  template <typename scalar, typename Index = index_t>
+  class CsrView
+  {
+  public:
+    using value_type = scalar;
+    using index_type = Index;
+
+    TENSOR_FUNC CsrView() : n_rows{0}, n_cols{0}, n_nonzeros{0}, row_ptr{nullptr}, col_idx{nullptr}, vals{nullptr} {}
+
+    /**
+     * @brief wraps the arrays of a CSR matrix.
+     *
+     * @param rows number of rows.
+     * @param cols number of columns.
+     * @param nnz number of stored nonzeros, i.e. `row_offsets[rows]`.
+     * @param row_offsets array of `rows + 1` offsets into columns and values.
+     * @param columns array of `nnz` column indices.
+     * @param values array of `nnz` nonzeros.
+     */
+    TENSOR_FUNC CsrView(index_t rows, index_t cols, index_t nnz, const Index *row_offsets, const Index *columns, scalar *values)
+        : n_rows{rows}, n_cols{cols}, n_nonzeros{nnz}, row_ptr{row_offsets}, col_idx{columns}, vals{values} {}
+
+    /// @brief a mutable view converts to a read only view.
+    template <typename T, typename = std::enable_if_t<std::is_same_v<const T, scalar> && !std::is_same_v<T, scalar>>>
+    TENSOR_FUNC CsrView(const CsrView<T, Index> &A) : CsrView(A.rows(), A.cols(), A.nnz(), A.row_ptr_data(), A.col_idx_data(), A.data()) {}
+
+    TENSOR_FUNC index_t rows() const { return n_rows; }
+    TENSOR_FUNC index_t cols() const { return n_cols; }
+    TENSOR_FUNC index_t nnz() const { return n_nonzeros; }
+
+    TENSOR_FUNC const Index *row_ptr_data() const { return row_ptr; }
+    TENSOR_FUNC const Index *col_idx_data() const { return col_idx; }
+    TENSOR_FUNC scalar *data() const { return vals; }
+
+    /// @brief the `rows() + 1` row offsets.
+    TENSOR_FUNC TensorView<const Index, 1> row_offsets() const { return TensorView<const Index, 1>(row_ptr, n_rows + 1); }
+
+    /// @brief the column index of each nonzero. Requires `nnz() > 0`.
+    TENSOR_FUNC TensorView<const Index, 1> columns() const { return TensorView<const Index, 1>(col_idx, n_nonzeros); }
+
+    /// @brief the nonzeros. Requires `nnz() > 0`.
+    TENSOR_FUNC TensorView<scalar, 1> values() const { return TensorView<scalar, 1>(vals, n_nonzeros); }
+
+    /// @brief returns `*this`, so that functions taking a matrix or a view
+    /// can call `A.view()` on either.
+    TENSOR_FUNC CsrView view() const { return *this; }
+
+    /// @brief returns A(i, j), which is zero if it is not stored. The column
+    /// is found by binary search within row i.
+    TENSOR_FUNC std::remove_cv_t<scalar> operator()(index_t i, index_t j) const
+    {
+#ifdef TENSOR_CHECK_BOUNDS
+      if (i >= n_rows)
+        tensor_index_out_of_range(i, 0, n_rows);
+      if (j >= n_cols)
+        tensor_index_out_of_range(j, 1, n_cols);
+#endif
+      index_t lo = row_ptr[i], hi = row_ptr[i + 1];
+      while (lo < hi)
+      {
+        const index_t mid = lo + (hi - lo) / 2;
+        if (index_t(col_idx[mid]) < j)
+          lo = mid + 1;
+        else
+          hi = mid;
+      }
+      return (lo < index_t(row_ptr[i + 1]) && index_t(col_idx[lo]) == j) ? vals[lo] : std::remove_cv_t<scalar>(0);
+    }
+
+  private:
+    index_t n_rows;
+    index_t n_cols;
+    index_t n_nonzeros;
+    const Index *row_ptr;
+    const Index *col_idx;
+    scalar *vals;
+  };
+
+  /**
+   * @brief non-owning view of a block sparse matrix in block compressed
+   * sparse row (BSR) format, with dense R x C blocks.
+   *
+   * @details The matrix has `block_rows()` x `block_cols()` blocks, of which
+   * block p is stored in block column `columns()[p]` for
+   * `row_offsets()[I] <= p < row_offsets()[I + 1]` of block row I. Each
+   * block is R x C column major, and `block(p)` returns it as a
+   * `FixedTensorView`, so block math has compile-time sizes.
+   */
+  template <typename scalar, index_t R, index_t C, typename Index = index_t>
+  class BsrView
+  {
+  public:
+    using value_type = scalar;
+    using index_type = Index;
+    using block_type = FixedTensorView<scalar, R, C>;
+
+    TENSOR_FUNC BsrView() : n_block_rows{0}, n_block_cols{0}, n_blocks{0}, row_ptr{nullptr}, col_idx{nullptr}, vals{nullptr} {}
+
+    /**
+     * @brief wraps the arrays of a BSR matrix.
+     *
+     * @param block_rows number of block rows, the matrix has `R * block_rows` rows.
+     * @param block_cols number of block columns, the matrix has `C * block_cols` columns.
+     * @param nnzb number of stored blocks.
+     * @param row_offsets array of `block_rows + 1` offsets into columns and blocks.
+     * @param columns array of `nnzb` block column indices.
+     * @param values array of `nnzb * R * C` nonzeros, block after block.
+     */
+    TENSOR_FUNC BsrView(index_t block_rows, index_t block_cols, index_t nnzb, const Index *row_offsets, const Index *columns, scalar *values)
+        : n_block_rows{block_rows}, n_block_cols{block_cols}, n_blocks{nnzb}, row_ptr{row_offsets}, col_idx{columns}, vals{values} {}
+
+    /// @brief a mutable view converts to a read only view.
+    template <typename T, typename = std::enable_if_t<std::is_same_v<const T, scalar> && !std::is_same_v<T, scalar>>>
+    TENSOR_FUNC BsrView(const BsrView<T, R, C, Index> &A) : BsrView(A.block_rows(), A.block_cols(), A.nnzb(), A.row_ptr_data(), A.col_idx_data(), A.data()) {}
+
+    TENSOR_FUNC index_t block_rows() const { return n_block_rows; }
+    TENSOR_FUNC index_t block_cols() const { return n_block_cols; }
+    TENSOR_FUNC index_t rows() const { return R * n_block_rows; }
+    TENSOR_FUNC index_t cols() const { return C * n_block_cols; }
+    TENSOR_FUNC index_t nnzb() const { return n_blocks; }
+    TENSOR_FUNC index_t nnz() const { return R * C * n_blocks; }
+
+    TENSOR_FUNC const Index *row_ptr_data() const { return row_ptr; }
+    TENSOR_FUNC const Index *col_idx_data() const { return col_idx; }
+    TENSOR_FUNC scalar *data() const { return vals; }
+
+    /// @brief the `block_rows() + 1` block row offsets.
+    TENSOR_FUNC TensorView<const Index, 1> row_offsets() const { return TensorView<const Index, 1>(row_ptr, n_block_rows + 1); }
+
+    /// @brief the block column of each block. Requires `nnzb() > 0`.
+    TENSOR_FUNC TensorView<const Index, 1> columns() const { return TensorView<const Index, 1>(col_idx, n_blocks); }
+
+    /// @brief the R x C block p.
+    TENSOR_FUNC block_type block(index_t p) const
+    {
+#ifdef TENSOR_CHECK_BOUNDS
+      if (p >= n_blocks)
+        tensor_linear_index_out_of_range(p, n_blocks);
+#endif
+      return block_type(vals + p * R * C);
+    }
+
+    TENSOR_FUNC BsrView view() const { return *this; }
+
+  private:
+    index_t n_block_rows;
+    index_t n_block_cols;
+    index_t n_blocks;
+    const Index *row_ptr;
+    const Index *col_idx;
+    scalar *vals;
+  };
+
+  /**
+   * @brief sparse matrix in CSR format which owns its arrays.
+   *
+   * @details Kernels take the `CsrView` returned by `view()`. A matrix
+   * constructed from its sizes has zero row offsets; the structure is
+   * filled in through `row_offsets()`, `columns()` and `values()`, or the
+   * matrix is built by `csr_from_triplets` or `csr_from_dense`.
+   */
+  template <typename scalar, typename Index = index_t, typename Allocator = std::allocator<scalar>>
+  class CsrMatrix
+  {
+  public:
+    using value_type = scalar;
+    using index_type = Index;
+    using view_type = CsrView<scalar, Index>;
+    using const_view_type = CsrView<const scalar, Index>;
+
+    CsrMatrix() : CsrMatrix(0, 0, 0) {}
+
+    /// @brief allocates a rows x cols matrix with room for nnz nonzeros.
+    CsrMatrix(index_t rows, index_t cols, index_t nnz) : n_rows{rows}, n_cols{cols}, row_ptr(rows + 1, Index(0)), col_idx(nnz), vals(nnz) {}
+
+    index_t rows() const { return n_rows; }
+    index_t cols() const { return n_cols; }
+    index_t nnz() const { return vals.size(); }
+
+    view_type view() { return view_type(n_rows, n_cols, nnz(), row_ptr.data(), col_idx.data(), vals.data()); }
+    const_view_type view() const { return const_view_type(n_rows, n_cols, nnz(), row_ptr.data(), col_idx.data(), vals.data()); }
+
+    TensorView<Index, 1> row_offsets() { return TensorView<Index, 1>(row_ptr.data(), n_rows + 1); }
+    TensorView<const Index, 1> row_offsets() const { return TensorView<const Index, 1>(row_ptr.data(), n_rows + 1); }
+    TensorView<Index, 1> columns() { return TensorView<Index, 1>(col_idx.data(), nnz()); }
+    TensorView<const Index, 1> columns() const { return TensorView<const Index, 1>(col_idx.data(), nnz()); }
+    TensorView<scalar, 1> values() { return TensorView<scalar, 1>(vals.data(), nnz()); }
+    TensorView<const scalar, 1> values() const { return TensorView<const scalar, 1>(vals.data(), nnz()); }
+
+    /// @brief returns A(i, j), which is zero if it is not stored.
+    scalar operator()(index_t i, index_t j) const { return view()(i, j); }
+
+  private:
+    using index_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Index>;
+
+    index_t n_rows;
+    index_t n_cols;
+    std::vector<Index, index_allocator> row_ptr;
+    std::vector<Index, index_allocator> col_idx;
+    std::vector<scalar, Allocator> vals;
+  };
+
+  /// @brief block sparse matrix in BSR format with R x C blocks, which owns
+  /// its arrays. Kernels take the `BsrView` returned by `view()`.
+  template <typename scalar, index_t R, index_t C, typename Index = index_t, typename Allocator = std::allocator<scalar>>
+  class BsrMatrix
+  {
+  public:
+    using value_type = scalar;
+    using index_type = Index;
+    using view_type = BsrView<scalar, R, C, Index>;
+    using const_view_type = BsrView<const scalar, R, C, Index>;
+
+    BsrMatrix() : BsrMatrix(0, 0, 0) {}
+
+    /// @brief allocates a matrix of block_rows x block_cols blocks with room
+    /// for nnzb blocks.
+    BsrMatrix(index_t block_rows, index_t block_cols, index_t nnzb) : n_block_rows{block_rows}, n_block_cols{block_cols}, row_ptr(block_rows + 1, Index(0)), col_idx(nnzb), vals(nnzb * R * C) {}
+
+    index_t block_rows() const { return n_block_rows; }
+    index_t block_cols() const { return n_block_cols; }
+    index_t rows() const { return R * n_block_rows; }
+    index_t cols() const { return C * n_block_cols; }
+    index_t nnzb() const { return col_idx.size(); }
+    index_t nnz() const { return vals.size(); }
+
+    view_type view() { return view_type(n_block_rows, n_block_cols, nnzb(), row_ptr.data(), col_idx.data(), vals.data()); }
+    const_view_type view() const { return const_view_type(n_block_rows, n_block_cols, nnzb(), row_ptr.data(), col_idx.data(), vals.data()); }
+
+    TensorView<Index, 1> row_offsets() { return TensorView<Index, 1>(row_ptr.data(), n_block_rows + 1); }
+    TensorView<const Index, 1> row_offsets() const { return TensorView<const Index, 1>(row_ptr.data(), n_block_rows + 1); }
+    TensorView<Index, 1> columns() { return TensorView<Index, 1>(col_idx.data(), nnzb()); }
+    TensorView<const Index, 1> columns() const { return TensorView<const Index, 1>(col_idx.data(), nnzb()); }
+
+    FixedTensorView<scalar, R, C> block(index_t p) { return view().block(p); }
+    FixedTensorView<const scalar, R, C> block(index_t p) const { return view().block(p); }
+
+  private:
+    using index_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Index>;
+
+    index_t n_block_rows;
+    index_t n_block_cols;
+    std::vector<Index, index_allocator> row_ptr;
+    std::vector<Index, index_allocator> col_idx;
+    std::vector<scalar, Allocator> vals;
+  };
+} // namespace tensor
+
+namespace tensor::details
+{
+  template <typename T>
+  struct is_sparse_view : std::false_type
+  {
+  };
+
+  template <typename scalar, typename Index>
+  struct is_sparse_view<CsrView<scalar, Index>> : std::true_type
+  {
+  };
+
+  template <typename scalar, index_t R, index_t C, typename Index>
+  struct is_sparse_view<BsrView<scalar, R, C, Index>> : std::true_type
+  {
+  };
+
+  template <typename M, typename = void>
+  struct sparse_check : std::false_type
+  {
+  };
+
+  template <typename M>
+  struct sparse_check<M, std::void_t<decltype(std::declval<const M &>().view())>> : is_sparse_view<std::decay_t<decltype(std::declval<const M &>().view())>>
+  {
+  };
+
+  /// @brief true for `CsrView`, `CsrMatrix`, `BsrView` and `BsrMatrix`.
+  template <typename M>
+  inline constexpr bool is_sparse_matrix_v = sparse_check<std::decay_t<M>>::value;
+
+  /// @brief sparse products with fewer stored nonzeros (times columns of
+  /// the dense factor) are computed on the calling thread.
+  inline constexpr index_t spmv_parallel_nnz = index_t(1) << 16;
+
+  /// @brief number of columns of the dense factor of `spmm` accumulated at
+  /// once for one row of the result.
+  inline constexpr index_t spmm_block_cols = 64;
+
+  /// @brief splits the rows of a sparse matrix into n_tasks ranges with
+  /// about the same number of nonzeros. Task t computes the rows
+  /// [first[t], first[t + 1]).
+  template <typename Index>
+  inline std::vector<index_t> balanced_rows(const Index *row_ptr, index_t rows, index_t n_tasks)
+  {
+    std::vector<index_t> first(n_tasks + 1);
+    const index_t nnz = row_ptr[rows];
+    for (index_t t = 0; t < n_tasks; ++t)
+    {
+      const Index target = Index((nnz * t) / n_tasks);
+      first[t] = std::lower_bound(row_ptr, row_ptr + rows, target) - row_ptr;
+    }
+    first[n_tasks] = rows;
+    return first;
+  }
+
+  /// @brief runs f(row_begin, row_end) over the rows of a sparse matrix, on
+  /// the threads of exec when the product has enough work.
+  template <typename Executor, typename Index, typename F>
+  inline void sparse_rows(Executor &exec, const Index *row_ptr, index_t rows, index_t work, F &&f)
+  {
+    if (rows == 0)
+      return;
+
+    const index_t n_tasks = std::min<index_t>(rows, slabs_per_thread * exec.concurrency());
+    if (n_tasks <= 1 || work < spmv_parallel_nnz)
+    {
+      f(index_t(0), rows);
+      return;
+    }
+
+    const auto first = balanced_rows(row_ptr, rows, n_tasks);
+    exec.bulk(n_tasks, [&](index_t t)
+              { f(first[t], first[t + 1]); });
+  }
+
+  template <typename T>
+  TENSOR_FUNC T sparse_update(T acc, T alpha, T beta, T y)
+  {
+    return (beta == T(0)) ? alpha * acc : alpha * acc + beta * y;
+  }
+
+  // y(i) = alpha * A(i, :) * x + beta * y(i) for rows [i0, i1).
+  template <typename T, typename TA, typename Index, typename TX>
+  inline void csr_spmv_rows(CsrView<TA, Index> A, const TX *x, stride_t sx, T *y, stride_t sy, T alpha, T beta, index_t i0, index_t i1)
+  {
+    const Index *row_ptr = A.row_ptr_data();
+    const Index *col = A.col_idx_data();
+    const TA *val = A.data();
+    for (index_t i = i0; i < i1; ++i)
+    {
+      // two accumulators hide the latency of the additions behind the
+      // gathers from x
+      T acc0 = 0, acc1 = 0;
+      index_t p = row_ptr[i];
+      const index_t end = row_ptr[i + 1];
+      for (; p + 1 < end; p += 2)
+      {
+        acc0 += val[p] * x[(stride_t)col[p] * sx];
+        acc1 += val[p + 1] * x[(stride_t)col[p + 1] * sx];
+      }
+      if (p < end)
+        acc0 += val[p] * x[(stride_t)col[p] * sx];
+
+      T &yi = y[(stride_t)i * sy];
+      yi = sparse_update<T>(acc0 + acc1, alpha, beta, yi);
+    }
+  }
+
+  // y(I*R : I*R+R) = alpha * A(I, :) * x + beta * y(...) for block rows [I0, I1).
+  template <typename T, typename TA, index_t R, index_t C, typename Index, typename TX>
+  inline void bsr_spmv_rows(BsrView<TA, R, C, Index> A, const TX *x, stride_t sx, T *y, stride_t sy, T alpha, T beta, index_t I0, index_t I1)
+  {
+    const Index *row_ptr = A.row_ptr_data();
+    const Index *col = A.col_idx_data();
+    const TA *val = A.data();
+    for (index_t I = I0; I < I1; ++I)
+    {
+      T acc[R] = {};
+      for (index_t p = row_ptr[I]; p < index_t(row_ptr[I + 1]); ++p)
+      {
+        // fixed size loops over the column major block, which the compiler
+        // unrolls and vectorizes along the rows
+        const TA *b = val + p * R * C;
+        const TX *xb = x + (stride_t)col[p] * C * sx;
+        for (index_t c = 0; c < C; ++c)
+        {
+          const T xc = xb[(stride_t)c * sx];
+          for (index_t r = 0; r < R; ++r)
+            acc[r] += b[r + R * c] * xc;
+        }
+      }
+
+      T *yb = y + (stride_t)I * R * sy;
+      for (index_t r = 0; r < R; ++r)
+        yb[(stride_t)r * sy] = sparse_update<T>(acc[r], alpha, beta, yb[(stride_t)r * sy]);
+    }
+  }
+
+  // C(i, :) = alpha * A(i, :) * B + beta * C(i, :) for rows [i0, i1). The
+  // row of C is accumulated spmm_block_cols columns at a time, each nonzero
+  // A(i, j) adding a multiple of a row of B.
+  template <index_t CS, typename T, typename TA, typename Index, typename TB>
+  inline void csr_spmm_rows(CsrView<TA, Index> A, const strided_matrix<TB> &B, const strided_matrix<T> &Cm, T alpha, T beta, index_t i0, index_t i1)
+  {
+    const Index *row_ptr = A.row_ptr_data();
+    const Index *col = A.col_idx_data();
+    const TA *val = A.data();
+    const index_t K = Cm.cols;
+    const stride_t cs = (CS != 0) ? stride_t(CS) : B.cs;
+    T acc[spmm_block_cols];
+    for (index_t i = i0; i < i1; ++i)
+    {
+      for (index_t c0 = 0; c0 < K; c0 += spmm_block_cols)
+      {
+        const index_t kb = std::min<index_t>(spmm_block_cols, K - c0);
+        for (index_t c = 0; c < kb; ++c)
+          acc[c] = T(0);
+        for (index_t p = row_ptr[i]; p < index_t(row_ptr[i + 1]); ++p)
+        {
+          const T v = val[p];
+          const TB *b = B.data + (stride_t)col[p] * B.rs + (stride_t)c0 * cs;
+          for (index_t c = 0; c < kb; ++c)
+            acc[c] += v * b[(stride_t)c * cs];
+        }
+        for (index_t c = 0; c < kb; ++c)
+        {
+          T &cij = Cm(i, c0 + c);
+          cij = sparse_update<T>(acc[c], alpha, beta, cij);
+        }
+      }
+    }
+  }
+} // namespace tensor::details
+
+namespace tensor
+{
+  /**
+   * @brief builds a CSR matrix from (row, column, value) triplets in any
+   * order. Duplicate entries are summed, as when a finite element matrix is
+   * assembled.
+   *
+   * @param rows number of rows.
+   * @param cols number of columns.
+   * @param I 1D tensor of row indices.
+   * @param J 1D tensor of column indices, the same size as I.
+   * @param V 1D tensor of values, the same size as I.
+   */
+  template <typename Index = index_t, typename TI, typename TJ, typename TV, typename scalar = std::remove_cv_t<typename TV::value_type>, typename = std::enable_if_t<details::is_tensor_v<TI> && details::is_tensor_v<TJ> && details::is_tensor_v<TV>>>
+  inline CsrMatrix<scalar, Index> csr_from_triplets(index_t rows, index_t cols, const TI &I, const TJ &J, const TV &V)
+  {
+    static_assert(TI::order() == 1 && TJ::order() == 1 && TV::order() == 1, "csr_from_triplets requires 1D tensors.");
+    const index_t n = V.size();
+#ifdef TENSOR_CHECK_BOUNDS
+    if (I.size() != n || J.size() != n)
+      tensor_shape_mismatch();
+    for (index_t k = 0; k < n; ++k)
+    {
+      if (index_t(I(k)) >= rows)
+        tensor_index_out_of_range(I(k), 0, rows);
+      if (index_t(J(k)) >= cols)
+        tensor_index_out_of_range(J(k), 1, cols);
+    }
+#endif
+
+    // bucket the triplets by row
+    std::vector<index_t> start(rows + 1, 0), order(n);
+    for (index_t k = 0; k < n; ++k)
+      ++start[index_t(I(k)) + 1];
+    for (index_t i = 0; i < rows; ++i)
+      start[i + 1] += start[i];
+    {
+      std::vector<index_t> next(start.begin(), start.end() - 1);
+      for (index_t k = 0; k < n; ++k)
+        order[next[index_t(I(k))]++] = k;
+    }
+
+    // sort each row by column and sum the duplicates
+    std::vector<Index> row_ptr(rows + 1, Index(0)), col_idx;
+    std::vector<scalar> vals;
+    col_idx.reserve(n);
+    vals.reserve(n);
+    for (index_t i = 0; i < rows; ++i)
+    {
+      std::sort(order.begin() + start[i], order.begin() + start[i + 1], [&](index_t a, index_t b)
+                { return index_t(J(a)) < index_t(J(b)); });
+      for (index_t q = start[i]; q < start[i + 1]; ++q)
+      {
+        const index_t k = order[q];
+        if (q > start[i] && index_t(J(k)) == index_t(col_idx.back()))
+          vals.back() += V(k);
+        else
+        {
+          col_idx.push_back(Index(J(k)));
+          vals.push_back(V(k));
+        }
+      }
+      row_ptr[i + 1] = Index(vals.size());
+    }
+
+    CsrMatrix<scalar, Index> A(rows, cols, vals.size());
+    auto offsets = A.row_offsets();
+    for (index_t i = 0; i <= rows; ++i)
+      offsets[i] = row_ptr[i];
+    for (index_t p = 0; p < A.nnz(); ++p)
+    {
+      A.columns()[p] = col_idx[p];
+      A.values()[p] = vals[p];
+    }
+    return A;
+  }
+
+  /// @brief builds a CSR matrix of the nonzero elements of a 2D tensor.
+  template <typename Index = index_t, typename M, typename scalar = std::remove_cv_t<typename M::value_type>, typename = std::enable_if_t<details::is_tensor_v<M>>>
+  inline CsrMatrix<scalar, Index> csr_from_dense(const M &dense)
+  {
+    static_assert(M::order() == 2, "csr_from_dense requires a matrix.");
+    const index_t rows = dense.shape(0), cols = dense.shape(1);
+
+    index_t nnz = 0;
+    for (index_t i = 0; i < rows; ++i)
+      for (index_t j = 0; j < cols; ++j)
+        nnz += dense(i, j) != scalar(0);
+
+    CsrMatrix<scalar, Index> A(rows, cols, nnz);
+    auto row_ptr = A.row_offsets();
+    index_t p = 0;
+    for (index_t i = 0; i < rows; ++i)
+    {
+      for (index_t j = 0; j < cols; ++j)
+      {
+        if (dense(i, j) != scalar(0))
+        {
+          A.columns()[p] = Index(j);
+          A.values()[p] = dense(i, j);
+          ++p;
+        }
+      }
+      row_ptr[i + 1] = Index(p);
+    }
+    return A;
+  }
+
+  /**
+   * @brief converts a CSR matrix to BSR with R x C blocks. Every block which
+   * contains a stored element of A is stored, the other elements of the
+   * block are zero.
+   *
+   * @details The sizes of A must be multiples of R and C.
+   */
+  template <index_t R, index_t C, typename M, typename = std::enable_if_t<details::is_sparse_matrix_v<M>>>
+  inline auto bsr_from_csr(const M &csr)
+  {
+    const auto A = csr.view();
+    using scalar = std::remove_cv_t<typename decltype(A)::value_type>;
+    using Index = typename decltype(A)::index_type;
+    if (A.rows() % R != 0 || A.cols() % C != 0)
+      tensor_shape_mismatch();
+
+    const index_t mb = A.rows() / R, nb = A.cols() / C;
+    const Index *row_ptr = A.row_ptr_data();
+    const Index *col = A.col_idx_data();
+
+    // the sorted block columns of each block row
+    std::vector<Index> block_ptr(mb + 1, Index(0)), block_col;
+    std::vector<index_t> mark(nb, index_t(-1));
+    for (index_t I = 0; I < mb; ++I)
+    {
+      const index_t first = block_col.size();
+      for (index_t i = I * R; i < (I + 1) * R; ++i)
+        for (index_t p = row_ptr[i]; p < index_t(row_ptr[i + 1]); ++p)
+        {
+          const index_t J = col[p] / C;
+          if (mark[J] != I)
+          {
+            mark[J] = I;
+            block_col.push_back(Index(J));
+          }
+        }
+      std::sort(block_col.begin() + first, block_col.end());
+      block_ptr[I + 1] = Index(block_col.size());
+    }
+
+    BsrMatrix<scalar, R, C, Index> B(mb, nb, block_col.size());
+    auto offsets = B.row_offsets();
+    for (index_t I = 0; I <= mb; ++I)
+      offsets[I] = block_ptr[I];
+    for (index_t q = 0; q < B.nnzb(); ++q)
+      B.columns()[q] = block_col[q];
+
+    for (index_t I = 0; I < mb; ++I)
+    {
+      for (index_t i = I * R; i < (I + 1) * R; ++i)
+      {
+        index_t q = block_ptr[I];
+        for (index_t p = row_ptr[i]; p < index_t(row_ptr[i + 1]); ++p)
+        {
+          // the columns of row i are sorted, so are its blocks
+          const index_t j = col[p];
+          while (index_t(block_col[q]) != j / C)
+            ++q;
+          B.block(q)(i - I * R, j % C) = A.data()[p];
+        }
+      }
+    }
+    return B;
+  }
+
+  /**
+   * @brief computes the sparse matrix-vector product y = alpha * A * x +
+   * beta * y with the threads of exec.
+   *
+   * @details The rows of y are split between tasks with about the same
+   * number of nonzeros, found by binary search in the row offsets, so that
+   * matrices with a few dense rows are balanced. Each element of y is
+   * computed by one task, so the result does not depend on the number of
+   * threads. When beta is zero, y is not read.
+   *
+   * @param exec executor, e.g. a `thread_pool` or `sequential_executor`.
+   * @param y 1D tensor with `A.rows()` elements, e.g. a `vector_view`.
+   * @param A `CsrMatrix`, `CsrView`, `BsrMatrix` or `BsrView`.
+   * @param x 1D tensor with `A.cols()` elements.
+   */
+  template <typename Executor, typename Y, typename M, typename X, typename scalar = std::remove_cv_t<typename std::decay_t<Y>::value_type>, typename = std::enable_if_t<details::is_executor_v<Executor> && details::is_tensor_v<Y> && details::is_sparse_matrix_v<M> && details::is_tensor_v<X>>>
+  inline void spmv(Executor &&exec, Y &&y, const M &A, const X &x, scalar alpha = scalar(1), scalar beta = scalar(0))
+  {
+    TENSOR_PROFILE_RANGE("tensor::spmv");
+    static_assert(std::decay_t<Y>::order() == 1 && X::order() == 1, "spmv requires 1D tensors.");
+    const auto a = A.view();
+
+#ifdef TENSOR_CHECK_BOUNDS
+    if (y.size() != a.rows() || x.size() != a.cols())
+      tensor_shape_mismatch();
+#endif
+
+    scalar *py = y.data();
+    const auto *px = x.data();
+    const stride_t sy = y.stride(0), sx = x.stride(0);
+    if constexpr (std::is_same_v<std::decay_t<decltype(a)>, CsrView<typename decltype(a)::value_type, typename decltype(a)::index_type>>)
+    {
+      details::sparse_rows(exec, a.row_ptr_data(), a.rows(), a.nnz(), [&](index_t i0, index_t i1)
+                           { details::csr_spmv_rows(a, px, sx, py, sy, alpha, beta, i0, i1); });
+    }
+    else
+    {
+      details::sparse_rows(exec, a.row_ptr_data(), a.block_rows(), a.nnz(), [&](index_t i0, index_t i1)
+                           { details::bsr_spmv_rows(a, px, sx, py, sy, alpha, beta, i0, i1); });
+    }
+  }
+
+  /// @brief `spmv` split between the threads of the `default_executor()`
+  /// when A has enough nonzeros, otherwise computed on the calling thread.
+  template <typename Y, typename M, typename X, typename scalar = std::remove_cv_t<typename std::decay_t<Y>::value_type>, typename = std::enable_if_t<details::is_tensor_v<Y> && details::is_sparse_matrix_v<M> && details::is_tensor_v<X>>>
+  inline void spmv(Y &&y, const M &A, const X &x, scalar alpha = scalar(1), scalar beta = scalar(0))
+  {
+    if (A.view().nnz() < details::spmv_parallel_nnz)
+      spmv(sequential_executor{}, std::forward<Y>(y), A, x, alpha, beta);
+    else
+      spmv(default_executor(), std::forward<Y>(y), A, x, alpha, beta);
+  }
+
+  /**
+   * @brief computes the product of a CSR matrix and a dense matrix, C =
+   * alpha * A * B + beta * C, with the threads of exec.
+   *
+   * @details Each row of C is accumulated from the rows of B selected by the
+   * nonzeros of A, a block of columns at a time, which is vectorized when
+   * the rows of B are contiguous (e.g. row-major tensors). The rows of C are
+   * split between tasks as in `spmv`.
+   *
+   * @param C dense M x K matrix, e.g. a `matrix_view`. Must not overlap B.
+   * @param A M x N `CsrMatrix` or `CsrView`.
+   * @param B dense N x K matrix.
+   */
+  template <typename Executor, typename MC, typename M, typename MB, typename scalar = std::remove_cv_t<typename std::decay_t<MC>::value_type>, typename = std::enable_if_t<details::is_executor_v<Executor> && details::is_tensor_v<MC> && details::is_sparse_matrix_v<M> && details::is_tensor_v<MB>>>
+  inline void spmm(Executor &&exec, MC &&C, const M &A, const MB &B, scalar alpha = scalar(1), scalar beta = scalar(0))
+  {
+    TENSOR_PROFILE_RANGE("tensor::spmm");
+    static_assert(std::decay_t<MC>::order() == 2 && MB::order() == 2, "spmm requires matrices.");
+    const auto a = A.view();
+    static_assert(std::is_same_v<std::decay_t<decltype(a)>, CsrView<typename decltype(a)::value_type, typename decltype(a)::index_type>>, "spmm requires a CSR matrix.");
+
+#ifdef TENSOR_CHECK_BOUNDS
+    if (C.shape(0) != a.rows() || B.shape(0) != a.cols() || B.shape(1) != C.shape(1))
+      tensor_shape_mismatch();
+#endif
+
+    const auto c = details::make_strided_matrix(C);
+    const auto b = details::make_strided_matrix(B);
+    details::sparse_rows(exec, a.row_ptr_data(), a.rows(), a.nnz() * c.cols, [&](index_t i0, index_t i1)
+                         {
+                           if (b.cs == 1)
+                             details::csr_spmm_rows<1>(a, b, c, alpha, beta, i0, i1);
+                           else
+                             details::csr_spmm_rows<0>(a, b, c, alpha, beta, i0, i1); });
+  }
+
+  /// @brief `spmm` with the `default_executor()` for large products.
+  template <typename MC, typename M, typename MB, typename scalar = std::remove_cv_t<typename std::decay_t<MC>::value_type>, typename = std::enable_if_t<details::is_tensor_v<MC> && details::is_sparse_matrix_v<M> && details::is_tensor_v<MB>>>
+  inline void spmm(MC &&C, const M &A, const MB &B, scalar alpha = scalar(1), scalar beta = scalar(0))
+  {
+    if (A.view().nnz() * C.shape(1) < details::spmv_parallel_nnz)
+      spmm(sequential_executor{}, std::forward<MC>(C), A, B, alpha, beta);
+    else
+      spmm(default_executor(), std::forward<MC>(C), A, B, alpha, beta);
+  }
+} // namespace tensor
+
+#if defined(TENSOR_USE_CUDA) && defined(__CUDACC__)
+
+#include "cuda_kernels.hpp"
+
+namespace tensor::cuda::details
+{
+  // y(i) = alpha * A(i, :) * x + beta * y(i), one warp per row: the lanes
+  // read consecutive nonzeros of the row, so the loads of the values and
+  // column indices are coalesced.
+  template <typename T, typename TA, typename Index, typename TX>
+  __global__ void csr_spmv_kernel(CsrView<TA, Index> A, const TX *x, stride_t sx, T *y, stride_t sy, T alpha, T beta)
+  {
+    const index_t lane = threadIdx.x % warpSize;
+    const index_t warps = (blockDim.x * gridDim.x) / warpSize;
+    const Index *row_ptr = A.row_ptr_data();
+    const Index *col = A.col_idx_data();
+    const TA *val = A.data();
+    for (index_t i = (blockIdx.x * blockDim.x + threadIdx.x) / warpSize; i < A.rows(); i += warps)
+    {
+      T acc = 0;
+      for (index_t p = row_ptr[i] + lane; p < index_t(row_ptr[i + 1]); p += warpSize)
+        acc += val[p] * x[(stride_t)col[p] * sx];
+      acc = warp_reduce(acc, plus_op{});
+      if (lane == 0)
+        y[(stride_t)i * sy] = sparse_update<T>(acc, alpha, beta, y[(stride_t)i * sy]);
+    }
+  }
+
+  // one thread per row of a BSR matrix; neighboring threads read the
+  // neighboring rows of the column major blocks.
+  template <typename T, typename TA, index_t R, index_t C, typename Index, typename TX>
+  __global__ void bsr_spmv_kernel(BsrView<TA, R, C, Index> A, const TX *x, stride_t sx, T *y, stride_t sy, T alpha, T beta)
+  {
+    const Index *row_ptr = A.row_ptr_data();
+    const Index *col = A.col_idx_data();
+    const TA *val = A.data();
+    for (index_t i = blockIdx.x * blockDim.x + threadIdx.x; i < A.rows(); i += blockDim.x * gridDim.x)
+    {
+      const index_t I = i / R, r = i % R;
+      T acc = 0;
+      for (index_t p = row_ptr[I]; p < index_t(row_ptr[I + 1]); ++p)
+      {
+        const TA *b = val + p * R * C + r;
+        const TX *xb = x + (stride_t)col[p] * C * sx;
+        for (index_t c = 0; c < C; ++c)
+          acc += b[R * c] * xb[(stride_t)c * sx];
+      }
+      y[(stride_t)i * sy] = sparse_update<T>(acc, alpha, beta, y[(stride_t)i * sy]);
+    }
+  }
+} // namespace tensor::cuda::details
+
+namespace tensor::cuda
+{
+  /**
+   * @brief y = alpha * A * x + beta * y on the device.
+   *
+   * @details A is a `CsrView` or `BsrView` of device arrays (e.g. the
+   * `data()` of `DeviceTensor`s), x and y are 1D views of device memory.
+   * CSR rows are computed by one warp each, BSR rows by one thread each.
+   */
+  template <typename Y, typename M, typename X, typename scalar = std::remove_cv_t<typename std::decay_t<Y>::value_type>>
+  inline void spmv(Y &&y, const M &A, const X &x, scalar alpha = scalar(1), scalar beta = scalar(0), cudaStream_t stream = 0)
+  {
+    static_assert(std::decay_t<Y>::order() == 1 && X::order() == 1, "spmv requires 1D views.");
+    const auto a = A.view();
+#ifdef TENSOR_CHECK_BOUNDS
+    if (y.size() != a.rows() || x.size() != a.cols())
+      tensor_shape_mismatch();
+#endif
+    if (a.rows() == 0)
+      return;
+
+    if constexpr (std::is_same_v<std::decay_t<decltype(a)>, CsrView<typename decltype(a)::value_type, typename decltype(a)::index_type>>)
+    {
+      const index_t warps_per_block = details::block_size / 32;
+      const int grid = details::grid_size((a.rows() + warps_per_block - 1) / warps_per_block * details::block_size);
+      details::csr_spmv_kernel<<<grid, details::block_size, 0, stream>>>(a, x.data(), x.stride(0), y.data(), y.stride(0), alpha, beta);
+    }
+    else
+    {
+      details::bsr_spmv_kernel<<<details::grid_size(a.rows()), details::block_size, 0, stream>>>(a, x.data(), x.stride(0), y.data(), y.stride(0), alpha, beta);
+    }
+    details::check_launch();
+  }
+} // namespace tensor::cuda
+
+#endif
+
+#endif
@@ -0,0 +1,467 @@
+#ifndef __TENSOR_VIEW_STENCIL_HPP__
+#define __TENSOR_VIEW_STENCIL_HPP__
+
+#include <algorithm>
+#include <cstdlib>
+#include <utility>
+
+#include "tensorview_config.hpp"
+#include "errors.hpp"
+#include "profile.hpp"
+#include "simd.hpp"
+#include "StridedView.hpp"
+#include "parallel.hpp"
+
+namespace tensor
+{
+  /// @brief offset of one point of a stencil from the element it is applied
+  /// to, e.g. `point<-1, 0, 0>` is the preceding element along the first
+  /// dimension of a 3D tensor.
+  template <long... Offsets>
+  struct point
+  {
+    static constexpr std::array<long, sizeof...(Offsets)> offsets = {Offsets...};
+
+    static constexpr size_t order()
+    {
+      return sizeof...(Offsets);
+    }
+  };
+
+  /**
+   * @brief linear stencil with offsets known at compile time.
+   *
+   * @details Applied to `in` at the multi-index i, the stencil computes
+   * `weights[0] * in(i + P0) + weights[1] * in(i + P1) + ...` where P0, P1,
+   * ... are the offsets of `Points`. The weights are set at run time, e.g.
+   * `stencil<double, point<0>, point<-1>, point<1>>{{-2.0, 1.0, 1.0}}`.
+   */
+  template <typename scalar, typename Point, typename... Points>
+  struct stencil
+  {
+    static_assert(((Points::order() == Point::order()) && ...), "all points of a stencil must have the same number of dimensions.");
+
+    using value_type = scalar;
+
+    std::array<scalar, 1 + sizeof...(Points)> weights;
+
+    /// @brief the number of dimensions of the tensors the stencil applies to.
+    static constexpr size_t order()
+    {
+      return Point::order();
+    }
+
+    /// @brief the number of points of the stencil.
+    static constexpr index_t size()
+    {
+      return 1 + sizeof...(Points);
+    }
+
+    /// @brief the offsets of the points, in the order of `weights`.
+    static constexpr std::array<std::array<long, Point::order()>, 1 + sizeof...(Points)> offsets()
+    {
+      return {Point::offsets, Points::offsets...};
+    }
+
+    /// @brief the number of elements the stencil reaches before the element
+    /// it is applied to along dimension d.
+    static constexpr index_t lower(index_t d)
+    {
+      long r = 0;
+      for (const auto &p : offsets())
+        r = std::max(r, -p[d]);
+      return r;
+    }
+
+    /// @brief the number of elements the stencil reaches after the element it
+    /// is applied to along dimension d.
+    static constexpr index_t upper(index_t d)
+    {
+      long r = 0;
+      for (const auto &p : offsets())
+        r = std::max(r, p[d]);
+      return r;
+    }
+  };
+
+  /// @brief how `stencil_apply` treats the points of a stencil which fall
+  /// outside of the input.
+  enum class boundary
+  {
+    /// the halo of the output, where the stencil does not fit inside the
+    /// input, is not written.
+    none,
+    /// elements outside of the input are zero.
+    zero,
+    /// elements outside of the input take the value of the nearest element
+    /// on the boundary.
+    clamp,
+    /// the input is extended periodically.
+    periodic
+  };
+
+  namespace details
+  {
+    template <typename scalar, size_t... I>
+    auto make_cube_stencil(std::index_sequence<I...>) -> stencil<scalar, point<long(I % 3) - 1, long(I / 3 % 3) - 1, long(I / 9) - 1>...>;
+
+    /// @brief working set of the interior loop of `stencil_apply` in bytes.
+    /// The rows of the input along the second fastest dimension are visited
+    /// in blocks so that the rows used by consecutive outer indices fit in a
+    /// 256 KB L2 cache.
+    inline constexpr size_t stencil_block_bytes = 256 * 1024;
+
+    /**
+     * @brief applies the stencil to a run of n elements starting at `in`,
+     * writing to `out`. delta[p] is the distance between an element and its
+     * p-th point in the input. Unit stride runs are vectorized with the
+     * points unrolled and two vectors in flight.
+     */
+    template <typename T, size_t N, size_t... P>
+    inline void stencil_row(T *out, stride_t os, const T *in, stride_t is, index_t n, const std::array<stride_t, N> &delta, const std::array<T, N> &weights, std::index_sequence<P...>)
+    {
+      // local copies: out may alias the arrays of the caller as far as the
+      // compiler can tell, which would reload them every iteration.
+      const std::array<stride_t, N> d = delta;
+      const std::array<T, N> w = weights;
+
+      index_t i = 0;
+      if (os == 1 && is == 1)
+      {
+        using V = simd<T>;
+        constexpr index_t W = V::width;
+
+        for (; i + 2 * W <= n; i += 2 * W)
+        {
+          auto a0 = V::mul(V::broadcast(w[0]), V::load(in + i + d[0]));
+          auto a1 = V::mul(V::broadcast(w[0]), V::load(in + i + W + d[0]));
+          ((a0 = V::fma(V::broadcast(w[P + 1]), V::load(in + i + d[P + 1]), a0),
+            a1 = V::fma(V::broadcast(w[P + 1]), V::load(in + i + W + d[P + 1]), a1)),
+           ...);
+          V::store(out + i, a0);
+          V::store(out + i + W, a1);
+        }
+
+        for (; i + W <= n; i += W)
+        {
+          auto a0 = V::mul(V::broadcast(w[0]), V::load(in + i + d[0]));
+          ((a0 = V::fma(V::broadcast(w[P + 1]), V::load(in + i + d[P + 1]), a0)), ...);
+          V::store(out + i, a0);
+        }
+      }
+
+      for (; i < n; ++i)
+      {
+        const T *x = in + (stride_t)i * is;
+        T acc = w[0] * x[d[0]];
+        ((acc = w[P + 1] * x[d[P + 1]] + acc), ...);
+        out[(stride_t)i * os] = acc;
+      }
+    }
+
+    // wraps or clamps the index i + off into [0, n). Returns false if it
+    // falls outside with boundary::zero.
+    inline bool stencil_boundary_index(index_t i, long off, index_t n, boundary b, index_t &q)
+    {
+      long k = (long)i + off;
+      if (k >= 0 && k < (long)n)
+      {
+        q = k;
+        return true;
+      }
+
+      switch (b)
+      {
+      case boundary::clamp:
+        q = (k < 0) ? 0 : n - 1;
+        return true;
+      case boundary::periodic:
+        k %= (long)n;
+        q = (k < 0) ? k + n : k;
+        return true;
+      default:
+        return false;
+      }
+    }
+
+    /// @brief applies the stencil at every index of the box [lo, hi) with
+    /// the boundary handling of b. Used for the halo.
+    template <typename T, size_t Rank, size_t N>
+    inline void stencil_box(T *out, const std::array<stride_t, Rank> &os, const T *in, const std::array<stride_t, Rank> &is, const std::array<index_t, Rank> &extents,
+                            const std::array<std::array<long, Rank>, N> &offsets, const std::array<T, N> &w, const std::array<index_t, Rank> &lo, const std::array<index_t, Rank> &hi, boundary b)
+    {
+      for (index_t d = 0; d < Rank; ++d)
+        if (lo[d] >= hi[d])
+          return;
+
+      std::array<index_t, Rank> idx = lo;
+      while (true)
+      {
+        T acc = T(0);
+        for (size_t p = 0; p < N; ++p)
+        {
+          stride_t off = 0;
+          bool inside = true;
+          for (index_t d = 0; d < Rank; ++d)
+          {
+            index_t q;
+            inside = stencil_boundary_index(idx[d], offsets[p][d], extents[d], b, q);
+            if (!inside)
+              break;
+            off += (stride_t)q * is[d];
+          }
+          if (inside)
+            acc = w[p] * in[off] + acc;
+        }
+
+        stride_t off = 0;
+        for (index_t d = 0; d < Rank; ++d)
+          off += (stride_t)idx[d] * os[d];
+        out[off] = acc;
+
+        index_t d = 0;
+        for (; d < Rank; ++d)
+        {
+          if (++idx[d] < hi[d])
+            break;
+          idx[d] = lo[d];
+        }
+        if (d == Rank)
+          return;
+      }
+    }
+
+    /**
+     * @brief applies the stencil to the interior box [lo, hi), where every
+     * point of the stencil is inside the input.
+     *
+     * @details `dims` lists the dimensions from the fastest to the slowest.
+     * Each run along dims[0] is a `stencil_row`. For three or more
+     * dimensions the runs are visited in blocks along dims[1], and within a
+     * block the slower dimensions form the outer loop, so that the runs
+     * shared by consecutive indices along dims[2] stay in cache.
+     */
+    template <typename T, size_t Rank, size_t N>
+    inline void stencil_interior(T *out, const std::array<stride_t, Rank> &os, const T *in, const std::array<stride_t, Rank> &is, const std::array<index_t, Rank> &dims,
+                                 const std::array<stride_t, N> &delta, const std::array<T, N> &w, index_t reach, const std::array<index_t, Rank> &lo, const std::array<index_t, Rank> &hi)
+    {
+      for (index_t d = 0; d < Rank; ++d)
+        if (lo[d] >= hi[d])
+          return;
+
+      const index_t inner = dims[0];
+      const index_t m = hi[inner] - lo[inner];
+
+      auto row = [&](const std::array<index_t, Rank> &idx)
+      {
+        stride_t ooff = 0, ioff = 0;
+        for (index_t d = 0; d < Rank; ++d)
+        {
+          ooff += (stride_t)idx[d] * os[d];
+          ioff += (stride_t)idx[d] * is[d];
+        }
+        stencil_row(out + ooff, os[inner], in + ioff, is[inner], m, delta, w, std::make_index_sequence<N - 1>{});
+      };
+
+      if constexpr (Rank == 1)
+      {
+        row(lo);
+      }
+      else
+      {
+        const index_t mid = dims[1];
+        index_t block = hi[mid] - lo[mid];
+        if constexpr (Rank >= 3)
+        {
+          const size_t row_bytes = std::max<size_t>(1, m * sizeof(T) * (1 + reach));
+          block = std::min<index_t>(block, std::max<size_t>(1, stencil_block_bytes / row_bytes));
+        }
+
+        std::array<index_t, Rank> idx = lo;
+        for (index_t jb = lo[mid]; jb < hi[mid]; jb += block)
+        {
+          const index_t je = std::min(hi[mid], jb + block);
+          for (index_t k = 2; k < Rank; ++k)
+            idx[dims[k]] = lo[dims[k]];
+
+          while (true)
+          {
+            for (index_t j = jb; j < je; ++j)
+            {
+              idx[mid] = j;
+              row(idx);
+            }
+
+            index_t k = 2;
+            for (; k < Rank; ++k)
+            {
+              if (++idx[dims[k]] < hi[dims[k]])
+                break;
+              idx[dims[k]] = lo[dims[k]];
+            }
+            if (k >= Rank)
+              break;
+          }
+        }
+      }
+    }
+  } // namespace details
+
+  /// @brief seven point stencil in 3D: `center` times the element plus
+  /// `neighbor` times each of its six face neighbors. The discrete Laplacian
+  /// with unit spacing is `seven_point_stencil(-6.0, 1.0)`.
+  template <typename scalar>
+  inline auto seven_point_stencil(scalar center, scalar neighbor)
+  {
+    using type = stencil<scalar, point<0, 0, 0>, point<-1, 0, 0>, point<1, 0, 0>, point<0, -1, 0>, point<0, 1, 0>, point<0, 0, -1>, point<0, 0, 1>>;
+    return type{{center, neighbor, neighbor, neighbor, neighbor, neighbor, neighbor}};
+  }
+
+  /// @brief 27 point stencil in 3D over the 3 x 3 x 3 cube around each
+  /// element. The weight of a point depends on how many of its offsets are
+  /// nonzero: `center` (none), `face` (one), `edge` (two) or `corner`
+  /// (three).
+  template <typename scalar>
+  inline auto twenty_seven_point_stencil(scalar center, scalar face, scalar edge, scalar corner)
+  {
+    using type = decltype(details::make_cube_stencil<scalar>(std::make_index_sequence<27>{}));
+    const scalar by_distance[] = {center, face, edge, corner};
+
+    type s{};
+    const auto offsets = type::offsets();
+    for (index_t p = 0; p < 27; ++p)
+      s.weights[p] = by_distance[(offsets[p][0] != 0) + (offsets[p][1] != 0) + (offsets[p][2] != 0)];
+    return s;
+  }
+
+  /**
+   * @brief applies a stencil to every element of `in`, writing the results
+   * to `out`.
+   *
+   * @details The offsets of the stencil are turned into constant distances
+   * in memory from the strides of `in`, so the interior, where every point
+   * of the stencil is inside `in`, is computed from one pointer per run
+   * along the fastest dimension, with vector instructions where both tensors
+   * have unit stride (see `details::stencil_interior` for the cache
+   * blocking). The interior is split along the slowest dimension into
+   * several slabs per thread of the executor. The halo, where the stencil
+   * reaches outside of `in`, is computed afterwards on the calling thread
+   * with the boundary handling of `b`, or left untouched with
+   * `boundary::none`.
+   *
+   * @param exec `thread_pool`, `sequential_executor`, etc., see `parallel_for`.
+   * @param out `Tensor`, `TensorView`, `FixedTensorView`, `SubView`, etc.
+   * with the same shape as in. Must not overlap with in.
+   * @param in the tensor the stencil is applied to.
+   * @param st the stencil, with as many dimensions as the tensors.
+   * @param b treatment of the points outside of in.
+   */
+  template <typename Executor, typename Out, typename In, typename scalar, typename... Points, typename = std::enable_if_t<details::is_executor_v<Executor> && details::is_tensor_v<Out> && details::is_tensor_v<In>>>
+  inline void stencil_apply(Executor &&exec, Out &&out, const In &in, const stencil<scalar, Points...> &st, boundary b = boundary::none)
+  {
+    TENSOR_PROFILE_RANGE("tensor::stencil_apply");
+    using stencil_type = stencil<scalar, Points...>;
+    using T = std::remove_cv_t<details::view_scalar_t<Out>>;
+    constexpr size_t Rank = std::decay_t<Out>::order();
+    constexpr size_t N = stencil_type::size();
+    static_assert(std::is_same_v<T, scalar> && std::is_same_v<T, std::remove_cv_t<details::view_scalar_t<const In>>>, "stencil_apply requires tensors and weights with the same element type.");
+    static_assert(Rank == In::order() && Rank == stencil_type::order(), "stencil_apply requires a stencil with as many dimensions as the tensors.");
+
+#ifdef TENSOR_CHECK_BOUNDS
+    for (index_t d = 0; d < Rank; ++d)
+      if (out.shape(d) != in.shape(d))
+        tensor_shape_mismatch();
+#endif
+
+    std::array<index_t, Rank> extents;
+    std::array<stride_t, Rank> os, is;
+    for (index_t d = 0; d < Rank; ++d)
+    {
+      extents[d] = in.shape(d);
+      os[d] = out.stride(d);
+      is[d] = in.stride(d);
+      if (extents[d] == 0)
+        return;
+    }
+
+    // the interior [lo, hi) along each dimension; the halo is the rest.
+    std::array<index_t, Rank> lo, hi;
+    for (index_t d = 0; d < Rank; ++d)
+    {
+      lo[d] = std::min(stencil_type::lower(d), extents[d]);
+      hi[d] = (extents[d] >= stencil_type::upper(d)) ? std::max(lo[d], extents[d] - stencil_type::upper(d)) : lo[d];
+    }
+
+    constexpr auto offsets = stencil_type::offsets();
+    std::array<stride_t, N> delta;
+    for (index_t p = 0; p < N; ++p)
+    {
+      delta[p] = 0;
+      for (index_t d = 0; d < Rank; ++d)
+        delta[p] += (stride_t)offsets[p][d] * is[d];
+    }
+
+    // dimensions from the fastest to the slowest varying in out
+    std::array<index_t, Rank> dims;
+    for (index_t d = 0; d < Rank; ++d)
+      dims[d] = d;
+    for (index_t d = 1; d < Rank; ++d)
+      for (index_t e = d; e > 0 && std::abs(os[dims[e]]) < std::abs(os[dims[e - 1]]); --e)
+        std::swap(dims[e], dims[e - 1]);
+
+    index_t reach = 0;
+    if constexpr (Rank >= 3)
+      reach = stencil_type::lower(dims[2]) + stencil_type::upper(dims[2]);
+
+    T *o = out.data();
+    const T *x = in.data();
+
+    const index_t slow = dims[Rank - 1];
+    const index_t n = hi[slow] - lo[slow];
+    if (n > 0)
+    {
+      const index_t n_slabs = std::min<index_t>(n, details::slabs_per_thread * exec.concurrency());
+      const index_t chunk = (n + n_slabs - 1) / n_slabs;
+      exec.bulk((n + chunk - 1) / chunk, [&](index_t k)
+                {
+                  TENSOR_PROFILE_RANGE("tensor::stencil_apply slab");
+                  std::array<index_t, Rank> l = lo, h = hi;
+                  l[slow] = lo[slow] + k * chunk;
+                  h[slow] = std::min(hi[slow], l[slow] + chunk);
+                  details::stencil_interior(o, os, x, is, dims, delta, st.weights, reach, l, h); });
+    }
+
+    if (b == boundary::none)
+      return;
+
+    // the halo as disjoint boxes: along dimension d the box covers one side
+    // of the halo, the preceding dimensions their interior and the following
+    // dimensions their full extent.
+    for (index_t d = 0; d < Rank; ++d)
+    {
+      std::array<index_t, Rank> l{}, h = extents;
+      for (index_t e = 0; e < d; ++e)
+      {
+        l[e] = lo[e];
+        h[e] = hi[e];
+      }
+
+      l[d] = 0;
+      h[d] = lo[d];
+      details::stencil_box(o, os, x, is, extents, offsets, st.weights, l, h, b);
+
+      l[d] = hi[d];
+      h[d] = extents[d];
+      details::stencil_box(o, os, x, is, extents, offsets, st.weights, l, h, b);
+    }
+  }
+
+  /// @brief `stencil_apply` on the calling thread.
+  template <typename Out, typename In, typename scalar, typename... Points, typename = std::enable_if_t<details::is_tensor_v<Out> && details::is_tensor_v<In>>>
+  inline void stencil_apply(Out &&out, const In &in, const stencil<scalar, Points...> &st, boundary b = boundary::none)
+  {
+    stencil_apply(sequential_executor{}, std::forward<Out>(out), in, st, b);
+  }
+} // namespace tensor
+
+#endif
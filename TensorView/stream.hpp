@@ -0,0 +1,616 @@
+#ifndef __TENSOR_VIEW_STREAM_HPP__
+#define __TENSOR_VIEW_STREAM_HPP__
+
+#include "tensorview_config.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+
+#include <algorithm>
+#include <array>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "errors.hpp"
+#include "layout.hpp"
+#include "DynamicTensorView.hpp"
+#include "Tensor.hpp"
+#include "copy.hpp"
+#include "aligned_allocator.hpp"
+#include "mapped_file.hpp"
+#include "npy.hpp"
+
+namespace tensor
+{
+  /// @brief alignment of the frame buffers of `StreamReader` and
+  /// `StreamWriter` and of the data in the files written by `StreamWriter`:
+  /// the block size required by O_DIRECT on common file systems.
+  inline constexpr size_t direct_io_alignment = 4096;
+
+  /// @brief options of `StreamReader` and `StreamWriter`.
+  struct stream_options
+  {
+    /// the number of frame buffers, at least 2. One frame is held by the
+    /// caller while the others are read ahead or written behind.
+    size_t buffers = 2;
+    /// the number of background threads reading or writing frames.
+    size_t threads = 1;
+    /// read and write with O_DIRECT, bypassing the page cache, if the data
+    /// offset and the size of a frame are multiples of
+    /// `direct_io_alignment` and the file system supports it.
+    bool direct = false;
+  };
+
+  namespace details
+  {
+    // opens path with O_DIRECT if the data of a stream can be transferred
+    // with it, returns -1 otherwise.
+    inline int open_direct(const std::string &path, int flags, uint64_t data_offset, uint64_t frame_bytes)
+    {
+#ifdef O_DIRECT
+      if (data_offset % direct_io_alignment == 0 && frame_bytes % direct_io_alignment == 0)
+        return ::open(path.c_str(), flags | O_DIRECT);
+#else
+      (void)path, (void)flags, (void)data_offset, (void)frame_bytes;
+#endif
+      return -1;
+    }
+
+    inline bool is_npy_path(const std::string &path)
+    {
+      return path.size() >= 4 && path.compare(path.size() - 4, 4, ".npy") == 0;
+    }
+
+    /**
+     * @brief reads the header of a tensor file (.tv) or npy file storing a
+     * tensor of order Rank + 1 whose slowest dimension is the frame index:
+     * the last dimension for `layout::left`, the first for `layout::right`.
+     *
+     * @param[out] shape the shape of a frame.
+     * @param[out] frames the number of frames.
+     * @return the offset of the first frame in the file.
+     */
+    template <typename scalar, size_t Rank, typename Layout>
+    inline uint64_t read_stream_header(int fd, uint64_t length, std::array<index_t, Rank> &shape, uint64_t &frames, const std::string &path)
+    {
+      constexpr bool right = layout_traits<Layout>::is_right;
+      std::array<uint64_t, Rank + 1> extents;
+      uint64_t data_offset;
+
+      char magic[6];
+      if (::pread(fd, magic, sizeof(magic), 0) == (ssize_t)sizeof(magic) && std::memcmp(magic, "\x93NUMPY", 6) == 0)
+      {
+        const npy_header h = read_npy_header(fd, path);
+        if (check_npy_header<scalar, Rank + 1>(h, length, path))
+          tensor_file_error(path, "the npy file is not in native byte order.");
+        if (h.fortran_order == right)
+          tensor_file_error(path, h.fortran_order ? "the npy file is in Fortran order, read it with layout::left." : "the npy file is in C order, read it with layout::right.");
+        std::copy(h.shape.begin(), h.shape.end(), extents.begin());
+        data_offset = h.data_offset;
+      }
+      else
+      {
+        data_offset = read_tensor_header<scalar, Rank + 1, Layout>(fd, length, extents, path);
+      }
+
+      frames = right ? extents[0] : extents[Rank];
+      for (index_t d = 0; d < Rank; ++d)
+        shape[d] = extents[right ? d + 1 : d];
+      return data_offset;
+    }
+
+    template <typename View, typename scalar, size_t Rank, size_t... I>
+    inline View frame_view(scalar *data, const std::array<index_t, Rank> &shape, std::index_sequence<I...>)
+    {
+      return View(data, shape[I]...);
+    }
+  } // namespace details
+
+  /**
+   * @brief reads the frames of a tensor file or npy file in order, reading
+   * ahead on background threads.
+   *
+   * @details The file stores a tensor of order Rank + 1 whose slowest
+   * dimension is the frame index, e.g. written by `StreamWriter`, `save`,
+   * or NumPy: for `layout::left` frames are along the last dimension (npy
+   * files in Fortran order), and for `layout::right` along the first (npy
+   * files in C order). Frames are read with `pread` directly into a ring of
+   * `stream_options::buffers` page aligned buffers, and `next()` returns a
+   * view of a buffer without copying. While the caller works on one frame
+   * the background threads fill the other buffers with the following
+   * frames.
+   *
+   * @tparam scalar the element type stored in the file.
+   * @tparam Rank the order of a frame.
+   * @tparam Layout the layout of the file.
+   */
+  template <typename scalar, size_t Rank, typename Layout = layout::left>
+  class StreamReader
+  {
+  public:
+    using value_type = std::remove_cv_t<scalar>;
+    using view_type = TensorView<const value_type, Rank, Layout>;
+
+    static_assert(!details::is_padded_layout_v<Layout>, "streams store unpadded layouts.");
+
+    /// @brief opens a file of frames and starts reading the first frames.
+    explicit StreamReader(const std::string &path_, const stream_options &options = stream_options()) : path(path_)
+    {
+      if (options.buffers < 2 || options.threads < 1)
+        tensor_file_error(path, "a stream requires at least two buffers and one thread.");
+
+      file.fd = ::open(path.c_str(), O_RDONLY);
+      if (file.fd < 0)
+        tensor_file_error(path, std::strerror(errno));
+
+      struct stat st;
+      if (::fstat(file.fd, &st) != 0)
+        tensor_file_error(path, std::strerror(errno));
+
+      data_offset = details::read_stream_header<value_type, Rank, Layout>(file.fd, st.st_size, _shape, n_frames, path);
+      frame_size = 1;
+      for (index_t e : _shape)
+        frame_size *= e;
+      if (frame_size == 0)
+        tensor_file_error(path, "the frames of the stream are empty.");
+
+      if (options.direct)
+        direct_file.fd = details::open_direct(path, O_RDONLY, data_offset, frame_size * sizeof(value_type));
+
+      buffers.reserve(options.buffers);
+      for (size_t b = 0; b < options.buffers; ++b)
+        buffers.emplace_back(uninitialized, frame_size);
+      ready.assign(options.buffers, no_frame);
+      errors.resize(options.buffers);
+
+      for (size_t k = 0; k < options.threads; ++k)
+        threads.emplace_back([this]()
+                             { work(); });
+    }
+
+    ~StreamReader()
+    {
+      {
+        std::lock_guard<std::mutex> lock(mtx);
+        stop = true;
+      }
+      cv.notify_all();
+      for (auto &t : threads)
+        t.join();
+    }
+
+    StreamReader(const StreamReader &) = delete;
+    StreamReader &operator=(const StreamReader &) = delete;
+
+    /// @brief the number of frames in the file.
+    index_t frames() const
+    {
+      return n_frames;
+    }
+
+    /// @brief the extent of dimension d of a frame.
+    index_t shape(index_t d) const
+    {
+      return _shape[d];
+    }
+
+    /// @brief the index of the frame returned by the next call to `next()`.
+    index_t position() const
+    {
+      return consumed + holding;
+    }
+
+    /// @brief true if every frame has been returned by `next()`.
+    bool done() const
+    {
+      return position() == n_frames;
+    }
+
+    /// @brief true if the frames are read with O_DIRECT.
+    bool direct() const
+    {
+      return direct_file.fd >= 0;
+    }
+
+    /**
+     * @brief waits until the next frame has been read and returns a view of
+     * it. The view is valid until the following call to `next()` or the
+     * destruction of the reader, after which its buffer is refilled.
+     * Errors of the background reads are rethrown here, in frame order.
+     */
+    view_type next()
+    {
+      std::unique_lock<std::mutex> lock(mtx);
+      if (holding)
+      {
+        ++consumed;
+        holding = false;
+        cv.notify_all();
+      }
+      if (consumed >= n_frames)
+        tensor_out_of_range("StreamReader::next() called after the last frame.");
+
+      const uint64_t t = consumed;
+      const size_t b = t % buffers.size();
+      cv.wait(lock, [&]()
+              { return ready[b] == t; });
+      if (errors[b])
+        std::rethrow_exception(errors[b]);
+
+      holding = true;
+      return details::frame_view<view_type>(buffers[b].data(), _shape, std::make_index_sequence<Rank>{});
+    }
+
+  private:
+    using buffer_type = Tensor<value_type, 1, aligned_allocator<value_type, direct_io_alignment>>;
+    static constexpr uint64_t no_frame = ~uint64_t(0);
+
+    std::string path;
+    details::file_descriptor file{-1};
+    details::file_descriptor direct_file{-1};
+    uint64_t data_offset = 0;
+    uint64_t n_frames = 0;
+    index_t frame_size = 0;
+    std::array<index_t, Rank> _shape{};
+
+    std::vector<buffer_type> buffers;
+    std::vector<uint64_t> ready; // the frame in each buffer, once it has been read
+    std::vector<std::exception_ptr> errors;
+    uint64_t next_read = 0;
+    uint64_t consumed = 0; // frames returned by next() whose buffers have been released
+    bool holding = false;  // the caller holds frame `consumed`
+    bool stop = false;
+
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::vector<std::thread> threads;
+
+    // reads frames into the buffers which have been released, in order.
+    void work()
+    {
+      const int fd = (direct_file.fd >= 0) ? direct_file.fd : file.fd;
+      const size_t bytes = frame_size * sizeof(value_type);
+
+      std::unique_lock<std::mutex> lock(mtx);
+      while (true)
+      {
+        cv.wait(lock, [&]()
+                { return stop || (next_read < n_frames && next_read < consumed + buffers.size()); });
+        if (stop)
+          return;
+
+        const uint64_t t = next_read++;
+        const size_t b = t % buffers.size();
+        value_type *dst = buffers[b].data();
+        lock.unlock();
+
+        std::exception_ptr error;
+        try
+        {
+          details::read_all(fd, dst, bytes, data_offset + t * bytes, path);
+        }
+        catch (...)
+        {
+          error = std::current_exception();
+        }
+
+        lock.lock();
+        errors[b] = error;
+        ready[b] = t;
+        cv.notify_all();
+      }
+    }
+  };
+
+  /**
+   * @brief writes frames to a tensor file or npy file in order, writing on
+   * background threads.
+   *
+   * @details `acquire()` returns a view of a free page aligned buffer which
+   * the caller fills, and `submit()` queues it to be written with `pwrite`
+   * while the caller goes on to the next frame; `write(x)` does both,
+   * converting x with `convert`. The file stores a tensor of order Rank + 1
+   * whose slowest dimension is the frame index (see `StreamReader`), so it
+   * can be read back with `StreamReader`, `map_file` or `map_npy`, and by
+   * NumPy. Paths ending in `.npy` are written as npy files, others as
+   * tensor files. The data starts at a multiple of `direct_io_alignment`,
+   * and the number of frames in the header is updated by `close()`.
+   *
+   * @tparam scalar the element type.
+   * @tparam Rank the order of a frame.
+   * @tparam Layout the layout of a frame and of the file.
+   */
+  template <typename scalar, size_t Rank, typename Layout = layout::left>
+  class StreamWriter
+  {
+  public:
+    using value_type = scalar;
+    using view_type = TensorView<scalar, Rank, Layout>;
+
+    static_assert(!std::is_const_v<scalar>, "StreamWriter requires a mutable element type.");
+    static_assert(!details::is_padded_layout_v<Layout>, "streams store unpadded layouts.");
+
+    /// @brief creates (or overwrites) the file `path` for frames of the given shape.
+    StreamWriter(const std::string &path_, const std::array<index_t, Rank> &shape_, const stream_options &options = stream_options()) : path(path_), _shape(shape_)
+    {
+      if (options.buffers < 2 || options.threads < 1)
+        tensor_file_error(path, "a stream requires at least two buffers and one thread.");
+
+      frame_size = 1;
+      for (index_t e : _shape)
+        frame_size *= e;
+      if (frame_size == 0)
+        tensor_file_error(path, "the frames of the stream are empty.");
+
+      file.fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+      if (file.fd < 0)
+        tensor_file_error(path, std::strerror(errno));
+      write_header();
+
+      if (options.direct)
+        direct_file.fd = details::open_direct(path, O_WRONLY, data_offset, frame_size * sizeof(scalar));
+
+      buffers.reserve(options.buffers);
+      for (size_t b = 0; b < options.buffers; ++b)
+        buffers.emplace_back(uninitialized, frame_size);
+      busy.assign(options.buffers, false);
+
+      for (size_t k = 0; k < options.threads; ++k)
+        threads.emplace_back([this]()
+                             { work(); });
+    }
+
+    /// @brief closes the stream, see `close()`. Errors are ignored; call
+    /// `close()` to handle them.
+    ~StreamWriter()
+    {
+      try
+      {
+        close();
+      }
+      catch (...)
+      {
+      }
+    }
+
+    StreamWriter(const StreamWriter &) = delete;
+    StreamWriter &operator=(const StreamWriter &) = delete;
+
+    /// @brief the number of frames submitted.
+    index_t frames() const
+    {
+      return submitted;
+    }
+
+    /// @brief the extent of dimension d of a frame.
+    index_t shape(index_t d) const
+    {
+      return _shape[d];
+    }
+
+    /// @brief true if the frames are written with O_DIRECT.
+    bool direct() const
+    {
+      return direct_file.fd >= 0;
+    }
+
+    /**
+     * @brief waits until a buffer is free and returns a view of it, to be
+     * filled with the next frame and passed to `submit()`. Calling
+     * `acquire()` again before `submit()` returns the same buffer. The
+     * contents of the buffer are unspecified.
+     */
+    view_type acquire()
+    {
+      std::unique_lock<std::mutex> lock(mtx);
+      if (closed)
+        tensor_file_error(path, "the stream is closed.");
+      const size_t b = submitted % buffers.size();
+      cv.wait(lock, [&]()
+              { return !busy[b] || error; });
+      if (error)
+        std::rethrow_exception(error);
+
+      acquired = true;
+      return details::frame_view<view_type>(buffers[b].data(), _shape, std::make_index_sequence<Rank>{});
+    }
+
+    /// @brief queues the buffer returned by `acquire()` to be written as the
+    /// next frame. The view must not be used afterwards.
+    void submit()
+    {
+      {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (!acquired)
+          tensor_file_error(path, "submit() requires a buffer from acquire().");
+        busy[submitted % buffers.size()] = true;
+        ++submitted;
+        acquired = false;
+      }
+      cv.notify_all();
+    }
+
+    /// @brief writes x as the next frame, converting its elements to
+    /// `scalar`. x may be any tensor of the shape of a frame; the call
+    /// returns once x is copied.
+    template <typename T, typename = std::enable_if_t<details::is_tensor_v<T>>>
+    void write(const T &x)
+    {
+      convert(acquire(), x);
+      submit();
+    }
+
+    /**
+     * @brief waits until every submitted frame is written, writes the number
+     * of frames to the header and closes the file. Errors of the background
+     * writes are rethrown here (and by `acquire()`). Does nothing if the
+     * stream is closed.
+     */
+    void close()
+    {
+      {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (closed)
+          return;
+        closed = true;
+        stop = true;
+      }
+      cv.notify_all();
+      for (auto &t : threads)
+        t.join();
+
+      std::exception_ptr e = error;
+      if (!e)
+      {
+        try
+        {
+          write_frame_count();
+        }
+        catch (...)
+        {
+          e = std::current_exception();
+        }
+      }
+      const int fd = std::exchange(file.fd, -1);
+      const int dfd = std::exchange(direct_file.fd, -1);
+      if (dfd >= 0)
+        ::close(dfd);
+      if (::close(fd) != 0 && !e)
+        tensor_file_error(path, std::strerror(errno));
+      if (e)
+        std::rethrow_exception(e);
+    }
+
+  private:
+    using buffer_type = Tensor<scalar, 1, aligned_allocator<scalar, direct_io_alignment>>;
+
+    std::string path;
+    details::file_descriptor file{-1};
+    details::file_descriptor direct_file{-1};
+    uint64_t data_offset = 0;
+    uint64_t count_offset = 0; // where the number of frames is stored in the header
+    index_t frame_size = 0;
+    std::array<index_t, Rank> _shape;
+
+    std::vector<buffer_type> buffers;
+    std::vector<bool> busy; // the buffer is queued or being written
+    uint64_t submitted = 0;
+    uint64_t taken = 0; // frames taken by the threads
+    bool acquired = false;
+    bool stop = false;
+    bool closed = false;
+    std::exception_ptr error;
+
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::vector<std::thread> threads;
+
+    // the width of the number of frames in the shape of an npy header,
+    // padded with spaces so that it can be overwritten in place.
+    static constexpr size_t npy_count_width = 20;
+
+    void write_header()
+    {
+      constexpr bool right = details::layout_traits<Layout>::is_right;
+      if (details::is_npy_path(path))
+      {
+        std::string dict = "{'descr': '" + details::npy_descr<scalar>() + "', 'fortran_order': " + (right ? "False" : "True") + ", 'shape': (";
+        for (index_t d = 0; d <= Rank; ++d)
+        {
+          if ((right && d == 0) || (!right && d == Rank))
+          {
+            count_offset = dict.size();
+            dict += std::string(npy_count_width - 1, ' ') + "0";
+          }
+          else
+          {
+            dict += std::to_string(_shape[right ? d - 1 : d]);
+          }
+          dict += (d < Rank) ? ", " : "";
+        }
+        dict += "), }";
+
+        const std::string header = details::npy_header_bytes(dict, direct_io_alignment);
+        count_offset += (header[6] == '\x01') ? 10 : 12;
+        data_offset = header.size();
+        details::write_all(file.fd, header.data(), header.size(), path);
+      }
+      else
+      {
+        std::array<uint64_t, Rank + 1> extents;
+        for (index_t d = 0; d <= Rank; ++d)
+          extents[d] = ((right && d == 0) || (!right && d == Rank)) ? 0 : _shape[right ? d - 1 : d];
+        count_offset = sizeof(details::tensor_file_header) + (right ? 0 : Rank) * sizeof(uint64_t);
+        data_offset = details::write_header<scalar, Rank + 1>(file.fd, extents, details::layout_code<Layout>(), direct_io_alignment, path);
+      }
+    }
+
+    void write_frame_count()
+    {
+      if (details::is_npy_path(path))
+      {
+        std::string count = std::to_string(submitted);
+        count.insert(0, npy_count_width - count.size(), ' ');
+        details::pwrite_all(file.fd, count.data(), count.size(), count_offset, path);
+      }
+      else
+      {
+        const uint64_t n = submitted;
+        details::pwrite_all(file.fd, &n, sizeof(n), count_offset, path);
+      }
+    }
+
+    // writes the submitted frames, until the stream is closed.
+    void work()
+    {
+      const int fd = (direct_file.fd >= 0) ? direct_file.fd : file.fd;
+      const size_t bytes = frame_size * sizeof(scalar);
+
+      std::unique_lock<std::mutex> lock(mtx);
+      while (true)
+      {
+        cv.wait(lock, [&]()
+                { return stop || taken < submitted; });
+        if (taken == submitted)
+          return;
+
+        const uint64_t t = taken++;
+        const size_t b = t % buffers.size();
+        const scalar *src = buffers[b].data();
+        const bool failed = bool(error); // frames after an error are dropped
+        lock.unlock();
+
+        std::exception_ptr e;
+        try
+        {
+          if (!failed)
+            details::pwrite_all(fd, src, bytes, data_offset + t * bytes, path);
+        }
+        catch (...)
+        {
+          e = std::current_exception();
+        }
+
+        lock.lock();
+        if (e && !error)
+          error = e;
+        busy[b] = false;
+        cv.notify_all();
+      }
+    }
+  };
+} // namespace tensor
+
+#endif // unix
+
+#endif
@@ -20,7 +20,15 @@
 #define TENSOR_CONST_QUAL(type) const type
 #endif
 
-#ifdef TENSOR_DEBUG
+// TENSOR_CHECK_BOUNDS validates indices and spans given by the user, the
+// shapes of tensors as they are constructed, and the operands of bulk
+// operations on entry. TENSOR_DEBUG additionally checks every access to a
+// TensorView for null pointers.
+#if defined(TENSOR_DEBUG) && !defined(TENSOR_CHECK_BOUNDS)
+#define TENSOR_CHECK_BOUNDS
+#endif
+
+#if defined(TENSOR_DEBUG) || defined(TENSOR_PROFILE)
 #define TENSOR_CONSTEXPR
 #else
 #define TENSOR_CONSTEXPR constexpr
@@ -44,6 +52,12 @@ namespace tensor
   /// @brief type for indexing into tensor views.
   using index_t = unsigned long;
 #endif
+
+  /// @brief signed type for the distance between tensor elements. Offsets
+  /// of views with negative strides are computed in `index_t` arithmetic
+  /// (modulo 2^N) and converted to `stride_t` before they are applied to a
+  /// pointer.
+  using stride_t = std::make_signed_t<index_t>;
 }
 
 #endif
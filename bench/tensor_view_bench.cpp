@@ -0,0 +1,636 @@
+#include "TensorView.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdlib>
+#include <memory>
+
+using namespace tensor;
+
+// reports the throughput of a benchmark which touches `elements` elements
+// of `bytes` bytes each per iteration, as GB/s and ns/element.
+static void report(benchmark::State &state, double elements, double bytes)
+{
+  const double n = elements * state.iterations();
+  state.SetItemsProcessed(n);
+  state.SetBytesProcessed(n * bytes);
+  state.counters["GB/s"] = benchmark::Counter(n * bytes * 1e-9, benchmark::Counter::kIsRate);
+  state.counters["ns/element"] = benchmark::Counter(n * 1e-9, benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+}
+
+static void fill(double *x, index_t n)
+{
+  for (index_t i = 0; i < n; ++i)
+    x[i] = double(std::rand()) / RAND_MAX;
+}
+
+template <typename T>
+static void fill(T &x)
+{
+  fill(x.data(), x.size());
+}
+
+// ----- indexing -----
+
+template <index_t N>
+static void index_raw(benchmark::State &state)
+{
+  std::unique_ptr<double[]> x(new double[N * N * N]);
+  fill(x.get(), N * N * N);
+  const double *p = x.get();
+
+  for (auto _ : state)
+  {
+    double s = 0;
+    for (index_t k = 0; k < N; ++k)
+      for (index_t j = 0; j < N; ++j)
+        for (index_t i = 0; i < N; ++i)
+          s += p[i + N * (j + N * k)];
+    benchmark::DoNotOptimize(s);
+  }
+  report(state, N * N * N, sizeof(double));
+}
+
+template <index_t N>
+static void index_dynamic(benchmark::State &state)
+{
+  Tensor<double, 3> x(N, N, N);
+  fill(x);
+
+  for (auto _ : state)
+  {
+    double s = 0;
+    for (index_t k = 0; k < N; ++k)
+      for (index_t j = 0; j < N; ++j)
+        for (index_t i = 0; i < N; ++i)
+          s += x(i, j, k);
+    benchmark::DoNotOptimize(s);
+  }
+  report(state, N * N * N, sizeof(double));
+}
+
+template <index_t N>
+static void index_fixed(benchmark::State &state)
+{
+  auto x = std::make_unique<FixedTensor<double, N, N, N>>();
+  fill(*x);
+
+  for (auto _ : state)
+  {
+    double s = 0;
+    for (index_t k = 0; k < N; ++k)
+      for (index_t j = 0; j < N; ++j)
+        for (index_t i = 0; i < N; ++i)
+          s += (*x)(i, j, k);
+    benchmark::DoNotOptimize(s);
+  }
+  report(state, N * N * N, sizeof(double));
+}
+
+template <index_t N>
+static void index_subview(benchmark::State &state)
+{
+  Tensor<double, 3> x(N + 2, N, N);
+  fill(x);
+  auto y = x.at(span(1, N + 1), all{}, all{});
+
+  for (auto _ : state)
+  {
+    double s = 0;
+    for (index_t k = 0; k < N; ++k)
+      for (index_t j = 0; j < N; ++j)
+        for (index_t i = 0; i < N; ++i)
+          s += y(i, j, k);
+    benchmark::DoNotOptimize(s);
+  }
+  report(state, N * N * N, sizeof(double));
+}
+
+BENCHMARK_TEMPLATE(index_raw, 32);
+BENCHMARK_TEMPLATE(index_raw, 128);
+BENCHMARK_TEMPLATE(index_dynamic, 32);
+BENCHMARK_TEMPLATE(index_dynamic, 128);
+BENCHMARK_TEMPLATE(index_fixed, 32);
+BENCHMARK_TEMPLATE(index_fixed, 128);
+BENCHMARK_TEMPLATE(index_subview, 32);
+BENCHMARK_TEMPLATE(index_subview, 128);
+
+// ----- iteration -----
+
+static void iterate_tensor(benchmark::State &state)
+{
+  const index_t n = state.range(0);
+  Tensor<double, 3> x(n, n, n);
+  fill(x);
+
+  for (auto _ : state)
+  {
+    double s = 0;
+    for (double v : x)
+      s += v;
+    benchmark::DoNotOptimize(s);
+  }
+  report(state, x.size(), sizeof(double));
+}
+
+static void iterate_subview(benchmark::State &state)
+{
+  const index_t n = state.range(0);
+  Tensor<double, 3> x(n + 2, n, n);
+  fill(x);
+  auto y = x.at(span(1, n + 1), all{}, all{});
+
+  for (auto _ : state)
+  {
+    double s = 0;
+    for (double v : y)
+      s += v;
+    benchmark::DoNotOptimize(s);
+  }
+  report(state, y.size(), sizeof(double));
+}
+
+BENCHMARK(iterate_tensor)->Arg(32)->Arg(128);
+BENCHMARK(iterate_subview)->Arg(32)->Arg(128);
+
+// ----- reshape -----
+
+static void reshape_2d(benchmark::State &state)
+{
+  const index_t n = state.range(0);
+  Tensor<double, 3> x(n, n, n);
+  fill(x);
+  TensorView<double, 3> v(x.data(), n, n, n);
+
+  for (auto _ : state)
+  {
+    auto y = reshape(v, n * n, n);
+    double s = 0;
+    for (index_t j = 0; j < n; ++j)
+      for (index_t i = 0; i < n * n; ++i)
+        s += y(i, j);
+    benchmark::DoNotOptimize(s);
+  }
+  report(state, x.size(), sizeof(double));
+}
+
+BENCHMARK(reshape_2d)->Arg(32)->Arg(128);
+
+// ----- reductions -----
+
+static void reduce_sum(benchmark::State &state)
+{
+  Tensor<double, 1> x(state.range(0));
+  fill(x);
+
+  for (auto _ : state)
+    benchmark::DoNotOptimize(sum(x));
+  report(state, x.size(), sizeof(double));
+}
+
+static void reduce_sum_subview(benchmark::State &state)
+{
+  const index_t n = state.range(0);
+  Tensor<double, 2> x(n + 2, n);
+  fill(x);
+  auto y = x.at(span(1, n + 1), all{});
+
+  for (auto _ : state)
+    benchmark::DoNotOptimize(sum(y));
+  report(state, y.size(), sizeof(double));
+}
+
+static void reduce_sum_dim(benchmark::State &state)
+{
+  const index_t n = state.range(0);
+  Tensor<double, 2> x(n, n);
+  fill(x);
+
+  for (auto _ : state)
+  {
+    auto s = sum(x, 1);
+    benchmark::DoNotOptimize(s.data());
+  }
+  report(state, x.size(), sizeof(double));
+}
+
+static void reduce_dot(benchmark::State &state)
+{
+  Tensor<double, 1> x(state.range(0)), y(state.range(0));
+  fill(x);
+  fill(y);
+
+  for (auto _ : state)
+    benchmark::DoNotOptimize(dot(x, y));
+  report(state, x.size(), 2 * sizeof(double));
+}
+
+static void reduce_max_abs(benchmark::State &state)
+{
+  Tensor<double, 1> x(state.range(0));
+  fill(x);
+
+  for (auto _ : state)
+    benchmark::DoNotOptimize(max_abs(x));
+  report(state, x.size(), sizeof(double));
+}
+
+static void reduce_parallel(benchmark::State &state)
+{
+  Tensor<double, 1> x(state.range(0));
+  fill(x);
+
+  for (auto _ : state)
+    benchmark::DoNotOptimize(parallel_reduce(x, 0.0, [](double a, double b)
+                                             { return a + b; }));
+  report(state, x.size(), sizeof(double));
+}
+
+static void reduce_fused_dot(benchmark::State &state)
+{
+  Tensor<double, 1> x(state.range(0)), y(state.range(0));
+  fill(x);
+  fill(y);
+
+  for (auto _ : state)
+    benchmark::DoNotOptimize(sum(x * y));
+  report(state, x.size(), 2 * sizeof(double));
+}
+
+static void reduce_fused_max_diff(benchmark::State &state)
+{
+  Tensor<double, 1> x(state.range(0)), y(state.range(0));
+  fill(x);
+  fill(y);
+
+  for (auto _ : state)
+    benchmark::DoNotOptimize(max(abs(x - y)));
+  report(state, x.size(), 2 * sizeof(double));
+}
+
+// the same reduction through a temporary, as before expressions could be reduced.
+static void reduce_temporary_max_diff(benchmark::State &state)
+{
+  Tensor<double, 1> x(state.range(0)), y(state.range(0));
+  fill(x);
+  fill(y);
+
+  for (auto _ : state)
+  {
+    Tensor<double, 1> t(uninitialized, x.size());
+    t = abs(x - y);
+    benchmark::DoNotOptimize(max(t));
+  }
+  report(state, x.size(), 2 * sizeof(double));
+}
+
+BENCHMARK(reduce_sum)->Arg(1 << 12)->Arg(1 << 22);
+BENCHMARK(reduce_sum_subview)->Arg(64)->Arg(2048);
+BENCHMARK(reduce_sum_dim)->Arg(64)->Arg(2048);
+BENCHMARK(reduce_dot)->Arg(1 << 12)->Arg(1 << 22);
+BENCHMARK(reduce_max_abs)->Arg(1 << 12)->Arg(1 << 22);
+BENCHMARK(reduce_parallel)->Arg(1 << 12)->Arg(1 << 22);
+BENCHMARK(reduce_fused_dot)->Arg(1 << 12)->Arg(1 << 22);
+BENCHMARK(reduce_fused_max_diff)->Arg(1 << 12)->Arg(1 << 22);
+BENCHMARK(reduce_temporary_max_diff)->Arg(1 << 12)->Arg(1 << 22);
+
+// ----- elementwise -----
+
+static void elementwise_axpy(benchmark::State &state)
+{
+  Tensor<double, 1> x(state.range(0)), y(state.range(0)), z(state.range(0));
+  fill(x);
+  fill(y);
+
+  for (auto _ : state)
+  {
+    z = 2.0 * x + y;
+    benchmark::DoNotOptimize(z.data());
+  }
+  report(state, x.size(), 3 * sizeof(double));
+}
+
+static void elementwise_unary(benchmark::State &state)
+{
+  Tensor<double, 1> x(state.range(0)), z(state.range(0));
+  fill(x);
+
+  for (auto _ : state)
+  {
+    z = sqrt(abs(x)) + exp(-x);
+    benchmark::DoNotOptimize(z.data());
+  }
+  report(state, x.size(), 2 * sizeof(double));
+}
+
+static void elementwise_subview(benchmark::State &state)
+{
+  const index_t n = state.range(0);
+  Tensor<double, 2> x(n + 2, n), y(n + 2, n), z(n, n);
+  fill(x);
+  fill(y);
+  auto xs = x.at(span(1, n + 1), all{});
+  auto ys = y.at(span(0, n), all{});
+
+  for (auto _ : state)
+  {
+    z = 2.0 * xs + ys;
+    benchmark::DoNotOptimize(z.data());
+  }
+  report(state, z.size(), 3 * sizeof(double));
+}
+
+static void copy_transpose(benchmark::State &state)
+{
+  const index_t n = state.range(0);
+  Tensor<double, 2> x(n, n);
+  Tensor<double, 2, std::allocator<double>, layout::right> y(n, n);
+  fill(x);
+
+  for (auto _ : state)
+  {
+    copy(y, x);
+    benchmark::DoNotOptimize(y.data());
+  }
+  report(state, x.size(), 2 * sizeof(double));
+}
+
+BENCHMARK(elementwise_axpy)->Arg(1 << 12)->Arg(1 << 22);
+BENCHMARK(elementwise_unary)->Arg(1 << 12)->Arg(1 << 22);
+BENCHMARK(elementwise_subview)->Arg(64)->Arg(2048);
+BENCHMARK(copy_transpose)->Arg(64)->Arg(2048);
+
+// ----- stencils -----
+
+static void stencil_naive(benchmark::State &state)
+{
+  const index_t n = state.range(0);
+  Tensor<double, 3> u(n, n, n), v(n, n, n);
+  fill(u);
+
+  for (auto _ : state)
+  {
+    for (index_t k = 1; k + 1 < n; ++k)
+      for (index_t j = 1; j + 1 < n; ++j)
+        for (index_t i = 1; i + 1 < n; ++i)
+          v(i, j, k) = u(i - 1, j, k) + u(i + 1, j, k) + u(i, j - 1, k) + u(i, j + 1, k) + u(i, j, k - 1) + u(i, j, k + 1) - 6.0 * u(i, j, k);
+    benchmark::DoNotOptimize(v.data());
+  }
+  report(state, (n - 2) * (n - 2) * (n - 2), 2 * sizeof(double));
+}
+
+static void stencil_seven_point(benchmark::State &state)
+{
+  const index_t n = state.range(0);
+  Tensor<double, 3> u(n, n, n), v(n, n, n);
+  fill(u);
+  const auto st = seven_point_stencil(-6.0, 1.0);
+
+  for (auto _ : state)
+  {
+    stencil_apply(v, u, st);
+    benchmark::DoNotOptimize(v.data());
+  }
+  report(state, (n - 2) * (n - 2) * (n - 2), 2 * sizeof(double));
+}
+
+static void stencil_twenty_seven_point(benchmark::State &state)
+{
+  const index_t n = state.range(0);
+  Tensor<double, 3> u(n, n, n), v(n, n, n);
+  fill(u);
+  const auto st = twenty_seven_point_stencil(-4.0, 0.5, 0.25, 0.125);
+
+  for (auto _ : state)
+  {
+    stencil_apply(v, u, st);
+    benchmark::DoNotOptimize(v.data());
+  }
+  report(state, (n - 2) * (n - 2) * (n - 2), 2 * sizeof(double));
+}
+
+BENCHMARK(stencil_naive)->Arg(64)->Arg(256);
+BENCHMARK(stencil_seven_point)->Arg(64)->Arg(256);
+BENCHMARK(stencil_twenty_seven_point)->Arg(64)->Arg(256);
+
+// ----- matmul -----
+
+static void matmul_square(benchmark::State &state)
+{
+  const index_t n = state.range(0);
+  Tensor<double, 2> a(n, n), b(n, n), c(n, n);
+  fill(a);
+  fill(b);
+
+  for (auto _ : state)
+  {
+    matmul(c, a, b);
+    benchmark::DoNotOptimize(c.data());
+  }
+  report(state, 3 * n * n, sizeof(double));
+  state.counters["GFLOPS"] = benchmark::Counter(2e-9 * n * n * n * state.iterations(), benchmark::Counter::kIsRate);
+}
+
+BENCHMARK(matmul_square)->Arg(16)->Arg(256)->Arg(1024);
+
+// ----- sparse -----
+
+// the seven point Laplacian on an n x n x n grid, as a CSR matrix.
+static CsrMatrix<double, int> laplacian(index_t n)
+{
+  const index_t N = n * n * n;
+  Tensor<int, 1> I(7 * N), J(7 * N);
+  Tensor<double, 1> V(7 * N);
+  index_t p = 0;
+  for (index_t k = 0; k < n; ++k)
+    for (index_t j = 0; j < n; ++j)
+      for (index_t i = 0; i < n; ++i)
+      {
+        const index_t row = i + n * (j + n * k);
+        const long nbr[][3] = {{0, 0, 0}, {-1, 0, 0}, {1, 0, 0}, {0, -1, 0}, {0, 1, 0}, {0, 0, -1}, {0, 0, 1}};
+        for (const auto &d : nbr)
+        {
+          const long a = i + d[0], b = j + d[1], c = k + d[2];
+          if (a < 0 || b < 0 || c < 0 || a >= (long)n || b >= (long)n || c >= (long)n)
+            continue;
+          I[p] = row;
+          J[p] = a + n * (b + n * c);
+          V[p] = (d[0] == 0 && d[1] == 0 && d[2] == 0) ? 6.0 : -1.0;
+          ++p;
+        }
+      }
+  return csr_from_triplets<int>(N, N, I.at(span(0, p)), J.at(span(0, p)), V.at(span(0, p)));
+}
+
+static void sparse_csr_spmv(benchmark::State &state)
+{
+  const auto A = laplacian(state.range(0));
+  Tensor<double, 1> x(A.cols()), y(A.rows());
+  fill(x);
+
+  for (auto _ : state)
+  {
+    spmv(y, A, x);
+    benchmark::DoNotOptimize(y.data());
+  }
+  // each nonzero reads a value, a column index and an element of x
+  report(state, A.nnz(), sizeof(double) + sizeof(int));
+}
+
+static void sparse_bsr_spmv(benchmark::State &state)
+{
+  const auto A = bsr_from_csr<4, 4>(laplacian(state.range(0)));
+  Tensor<double, 1> x(A.cols()), y(A.rows());
+  fill(x);
+
+  for (auto _ : state)
+  {
+    spmv(y, A, x);
+    benchmark::DoNotOptimize(y.data());
+  }
+  report(state, A.nnz(), sizeof(double));
+}
+
+static void sparse_csr_spmm(benchmark::State &state)
+{
+  const auto A = laplacian(state.range(0));
+  Tensor<double, 2, std::allocator<double>, layout::right> B(A.cols(), 8), C(A.rows(), 8);
+  fill(B);
+
+  for (auto _ : state)
+  {
+    spmm(C, A, B);
+    benchmark::DoNotOptimize(C.data());
+  }
+  report(state, A.nnz() * 8, sizeof(double));
+}
+
+BENCHMARK(sparse_csr_spmv)->Arg(32)->Arg(96);
+BENCHMARK(sparse_bsr_spmv)->Arg(32)->Arg(96);
+BENCHMARK(sparse_csr_spmm)->Arg(32)->Arg(96);
+
+// ----- contractions -----
+
+static constexpr char ikl_kjl[] = "ikl,kjl->ij";
+
+// C(i, j) = sum_k,l A(i, k, l) B(k, j, l) with nested loops over operator()
+static void contract_naive(benchmark::State &state)
+{
+  const index_t n = state.range(0);
+  Tensor<double, 3> a(n, n, 8), b(n, n, 8);
+  Tensor<double, 2> c(n, n);
+  fill(a);
+  fill(b);
+
+  for (auto _ : state)
+  {
+    for (index_t i = 0; i < n; ++i)
+      for (index_t j = 0; j < n; ++j)
+      {
+        double s = 0;
+        for (index_t k = 0; k < n; ++k)
+          for (index_t l = 0; l < 8; ++l)
+            s += a(i, k, l) * b(k, j, l);
+        c(i, j) = s;
+      }
+    benchmark::DoNotOptimize(c.data());
+  }
+  report(state, 2 * n * n * 8, sizeof(double));
+  state.counters["GFLOPS"] = benchmark::Counter(16e-9 * n * n * n * state.iterations(), benchmark::Counter::kIsRate);
+}
+
+static void contract_einsum(benchmark::State &state)
+{
+  const index_t n = state.range(0);
+  Tensor<double, 3> a(n, n, 8), b(n, n, 8);
+  Tensor<double, 2> c(n, n);
+  fill(a);
+  fill(b);
+
+  for (auto _ : state)
+  {
+    contract<ikl_kjl>(c, a, b);
+    benchmark::DoNotOptimize(c.data());
+  }
+  report(state, 2 * n * n * 8, sizeof(double));
+  state.counters["GFLOPS"] = benchmark::Counter(16e-9 * n * n * n * state.iterations(), benchmark::Counter::kIsRate);
+}
+
+BENCHMARK(contract_naive)->Arg(16)->Arg(256);
+BENCHMARK(contract_einsum)->Arg(16)->Arg(256);
+
+// ----- small tensors -----
+
+// a runtime sized n x n temporary per "particle", which Tensor allocates and
+// SmallTensor stores inline
+template <typename Matrix>
+static void small_temporaries(benchmark::State &state)
+{
+  const index_t n = state.range(0);
+  const index_t particles = 1000;
+
+  for (auto _ : state)
+  {
+    double s = 0;
+    for (index_t p = 0; p < particles; ++p)
+    {
+      Matrix a(n, n);
+      for (index_t j = 0; j < n; ++j)
+        for (index_t i = 0; i < n; ++i)
+          a(i, j) = double(p + i + j);
+      for (index_t i = 0; i < n; ++i)
+        s += a(i, i);
+    }
+    benchmark::DoNotOptimize(s);
+  }
+  report(state, particles * n * n, sizeof(double));
+}
+
+BENCHMARK(small_temporaries<Tensor<double, 2>>)->Arg(3)->Arg(5);
+BENCHMARK(small_temporaries<SmallTensor<double, 2, 25>>)->Arg(3)->Arg(5);
+
+// ----- 16 bit storage -----
+
+// an expression reduced over n^3 elements stored as T, computed in float
+template <typename T>
+static void storage_dot(benchmark::State &state)
+{
+  const index_t n = state.range(0);
+  Tensor<float, 3> xf(n, n, n), yf(n, n, n);
+  for (index_t i = 0; i < xf.size(); ++i)
+  {
+    xf[i] = std::sin(0.001f * i);
+    yf[i] = std::cos(0.001f * i);
+  }
+  Tensor<T, 3> x(n, n, n), y(n, n, n);
+  convert(x, xf);
+  convert(y, yf);
+
+  for (auto _ : state)
+    benchmark::DoNotOptimize(dot(x, y));
+  report(state, 2 * n * n * n, sizeof(T));
+}
+
+BENCHMARK(storage_dot<float>)->Arg(64)->Arg(256);
+BENCHMARK(storage_dot<float16>)->Arg(64)->Arg(256);
+BENCHMARK(storage_dot<bfloat16>)->Arg(64)->Arg(256);
+
+int main(int argc, char **argv)
+{
+#ifdef TENSOR_DEBUG
+  benchmark::AddCustomContext("TENSOR_DEBUG", "on");
+#else
+  benchmark::AddCustomContext("TENSOR_DEBUG", "off");
+#endif
+#ifdef TENSOR_CHECK_BOUNDS
+  benchmark::AddCustomContext("TENSOR_CHECK_BOUNDS", "on");
+#else
+  benchmark::AddCustomContext("TENSOR_CHECK_BOUNDS", "off");
+#endif
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv))
+    return 1;
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+  return 0;
+}
@@ -0,0 +1,59 @@
+#include "TensorView.hpp"
+
+#include <iostream>
+#include <cstdint>
+
+using namespace tensor;
+
+static bool is_aligned(const void *ptr, size_t alignment)
+{
+  return reinterpret_cast<std::uintptr_t>(ptr) % alignment == 0;
+}
+
+int main()
+{
+  int fails = 0;
+
+  Tensor<double, 2, aligned_allocator<double>> A(13, 7);
+  fails += !is_aligned(A.data(), 64);
+
+  Tensor<float, 1, aligned_allocator<float, 128>> v(1001);
+  fails += !is_aligned(v.data(), 128);
+
+  std::vector<int, aligned_allocator<int>> ints(3, 1);
+  ints.resize(1000, 2);
+  fails += !is_aligned(ints.data(), 64);
+  fails += ints[0] != 1 || ints[999] != 2;
+
+  // every column of an aligned tensor starts on a cache line
+  AlignedTensor<double, 3> B(13, 5, 2);
+  fails += B.stride(1) != 16 || B.stride(2) != 80;
+  fails += decltype(B)::shape_type::layout_type::padding != 8;
+  for (int k = 0; k < 2; k++)
+    for (int j = 0; j < 5; j++)
+      fails += !is_aligned(&B(0, j, k), 64);
+
+  for (int i = 0; i < B.size(); i++)
+    B[i] = i;
+  for (int k = 0, n = 0; k < 2; k++)
+    for (int j = 0; j < 5; j++)
+      for (int i = 0; i < 13; i++, n++)
+        fails += B(i, j, k) != n;
+
+  // huge page aligned allocation
+  Tensor<double, 1, aligned_allocator<double, huge_page_alignment>> H(size_t(1) << 19);
+  fails += !is_aligned(H.data(), huge_page_alignment);
+  H(H.size() - 1) = 1.0;
+  fails += H(H.size() - 1) != 1.0;
+
+  if (fails)
+  {
+    std::cout << "Aligned allocator test failed!" << std::endl;
+  }
+  else
+  {
+    std::cout << "Aligned allocator test passed!" << std::endl;
+  }
+
+  return fails;
+}
@@ -0,0 +1,95 @@
+#include "TensorView.hpp"
+
+#include <iostream>
+#include <cstdint>
+#include <thread>
+#include <algorithm>
+
+using namespace tensor;
+
+int main()
+{
+  int fails = 0;
+
+  // bump allocation and scoped reset
+  Arena arena(1024);
+  {
+    auto scope = arena.scope();
+    auto x = arena.make_tensor<double>(4, 5);
+    fails += x.shape(0) != 4 || x.shape(1) != 5;
+    fails += reinterpret_cast<std::uintptr_t>(x.data()) % alignof(double) != 0;
+    for (int i = 0; i < x.size(); i++)
+      x[i] = i;
+
+    auto y = arena.make_tensor<double>(4, 5);
+    fails += y.data() == x.data();
+    y = 2.0 * x;
+    for (int i = 0; i < y.size(); i++)
+      fails += y[i] != 2.0 * i;
+  }
+
+  // after the scope, the memory is handed out again
+  const Arena::Marker m = arena.mark();
+  fails += m.block != 0 || m.offset != 0;
+
+  // allocations larger than a block get a block of their own
+  auto big = arena.make_tensor<double>(1000);
+  std::fill(big.begin(), big.end(), 1.0);
+  fails += big.size() != 1000 || sum(big) != 1000.0;
+  const size_t cap = arena.capacity();
+  arena.reset();
+  auto big2 = arena.make_tensor<double>(1000);
+  fails += arena.capacity() != cap;
+  (void)big2;
+  arena.reset();
+
+  // arena backed Tensor
+  {
+    auto scope = Arena::thread_local_arena().scope();
+    Tensor<double, 2, ArenaAllocator<double>> A(10, 10);
+    fails += sum(A) != 0.0;
+    std::fill(A.begin(), A.end(), 3.0);
+    fails += sum(A) != 300.0;
+  }
+
+  // pool reuses freed blocks of the same size class
+  {
+    Pool pool;
+    void *p = pool.allocate(100 * sizeof(double));
+    fails += reinterpret_cast<std::uintptr_t>(p) % 64 != 0;
+    pool.deallocate(p, 100 * sizeof(double));
+    void *q = pool.allocate(120 * sizeof(double));
+    fails += p != q;
+    pool.deallocate(q, 120 * sizeof(double));
+  }
+
+  double *first = nullptr;
+  for (int step = 0; step < 3; step++)
+  {
+    Tensor<double, 2, PoolAllocator<double>> T(8, 8);
+    if (step == 0)
+      first = T.data();
+    fails += T.data() != first;
+    std::fill(T.begin(), T.end(), 1.0);
+    fails += sum(T) != 64.0;
+  }
+
+  // each thread has its own arena and pool
+  Arena *main_arena = &Arena::thread_local_arena();
+  Arena *other_arena = nullptr;
+  std::thread t([&]()
+                { other_arena = &Arena::thread_local_arena(); });
+  t.join();
+  fails += main_arena == other_arena;
+
+  if (fails)
+  {
+    std::cout << "Arena test failed!" << std::endl;
+  }
+  else
+  {
+    std::cout << "Arena test passed!" << std::endl;
+  }
+
+  return fails;
+}
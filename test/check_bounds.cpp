@@ -0,0 +1,108 @@
+#ifndef TENSOR_CHECK_BOUNDS
+#define TENSOR_CHECK_BOUNDS
+#endif
+#include "TensorView.hpp"
+
+#include <iostream>
+
+using namespace tensor;
+
+// shapes keep their constexpr offsets with bounds checking enabled
+#if !defined(TENSOR_DEBUG) && !defined(TENSOR_PROFILE)
+static_assert(details::FixedTensorShape<2, 3>{}(1, 2) == 5, "constexpr offset");
+#endif
+
+template <typename F>
+static int throws_out_of_range(F &&f)
+{
+  try
+  {
+    f();
+  }
+  catch (const std::out_of_range &e)
+  {
+    return 0;
+  }
+  return 1;
+}
+
+int main()
+{
+  int fails = 0;
+
+  Tensor<double, 3> x(3, 4, 5), y(3, 4, 5);
+  for (index_t i = 0; i < x.size(); i++)
+    x[i] = i;
+
+  // indices and spans given by the user are checked
+  fails += throws_out_of_range([&]()
+                               { x(3, 0, 0); });
+  fails += throws_out_of_range([&]()
+                               { x[60]; });
+  fails += throws_out_of_range([&]()
+                               { x.at(span(0, 4), all{}, 0); });
+
+  auto s = x.at(span(0, 3, 2), all{}, 1);
+  fails += s.shape(0) != 2;
+  fails += throws_out_of_range([&]()
+                               { s(2, 0); });
+
+  // dimensions given by the user are checked
+  fails += throws_out_of_range([&]()
+                               { sum(x, 3); });
+  fails += throws_out_of_range([&]()
+                               { details::FixedTensorShape<2, 3>::shape(2); });
+
+  // a span may end at the extent of a one dimensional view
+  auto v = x.at(all{}, 1, 2);
+  auto w = v(span(0, 3));
+  fails += w.size() != 3 || w(2) != x(2, 1, 2);
+  fails += throws_out_of_range([&]()
+                               { v(span(0, 4)); });
+
+  // the operands of bulk operations are checked on entry
+  Tensor<double, 3> z(3, 4, 4);
+  int caught = 0;
+  try
+  {
+    z = x + y;
+  }
+  catch (const std::logic_error &)
+  {
+    caught++;
+  }
+  try
+  {
+    copy(z, x);
+  }
+  catch (const std::logic_error &)
+  {
+    caught++;
+  }
+  fails += caught != 2;
+
+  // bulk operations over validated ranges
+  y = 2.0 * x;
+  Tensor<double, 2> t(2, 4);
+  t = s + 1.0;
+  for (index_t j = 0; j < 4; j++)
+    for (index_t i = 0; i < 2; i++)
+      fails += t(i, j) != x(2 * i, j, 1) + 1.0;
+
+  double total = 0;
+  for (double e : s)
+    total += e;
+  fails += total != sum(s);
+  fails += sum(y) != 2.0 * sum(x);
+
+  if (fails)
+  {
+    std::cout << "Check bounds test failed!" << std::endl;
+  }
+  else
+  {
+    std::cout << "Check bounds test passed!" << std::endl;
+  }
+
+  return fails;
+}
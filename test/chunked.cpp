@@ -0,0 +1,162 @@
+#include "TensorView.hpp"
+
+#include <iostream>
+#include <cstdio>
+#include <utility>
+
+#include <unistd.h>
+
+using namespace tensor;
+
+int main()
+{
+  int fails = 0;
+  const char *path = "chunked_test.tvc";
+
+  // 10 x 7 x 5 in tiles of 4 x 3 x 5: a 3 x 3 x 1 grid with partial edge tiles
+  const index_t n0 = 10, n1 = 7, n2 = 5;
+  auto value = [](index_t i, index_t j, index_t k)
+  { return double(i + 100 * j + 10000 * k); };
+
+  {
+    auto x = create_chunked<double, 3>(path, {n0, n1, n2}, {4, 3, 5}, 2);
+    fails += x.num_tiles() != 9 || x.grid()[0] != 3 || x.grid()[1] != 3 || x.grid()[2] != 1;
+
+    // fill through the tiles; only two tiles are ever resident
+    x.for_each_tile([&](auto tile, const std::array<index_t, 3> &offset)
+                    {
+      for (index_t k = 0; k < tile.shape(2); k++)
+        for (index_t j = 0; j < tile.shape(1); j++)
+          for (index_t i = 0; i < tile.shape(0); i++)
+            tile(i, j, k) = value(offset[0] + i, offset[1] + j, offset[2] + k); });
+    fails += x.resident_tiles() > 2;
+
+    // the edge tile along the first dimension has 2 visible rows
+    auto edge = x.tile({2, 0, 0});
+    fails += edge.shape(0) != 2 || edge.shape(1) != 3 || edge.shape(2) != 5;
+
+    // element access and views use global indices
+    fails += x.at(9, 6, 4) != value(9, 6, 4);
+    x.at(5, 4, 3) = -1.0;
+
+    auto s = x.at(span(4, 8), 5, all{});
+    fails += s.shape(0) != 4 || s.shape(1) != n2;
+    fails += s(1, 3) != value(5, 5, 3);
+    fails += sum(s) != [&]()
+    {
+      double t = 0;
+      for (index_t k = 0; k < n2; k++)
+        for (index_t i = 4; i < 8; i++)
+          t += value(i, 5, k);
+      return t;
+    }();
+
+    // spans may not cross tiles
+    int caught = 0;
+    try
+    {
+      x.at(span(2, 6), 0, 0);
+    }
+    catch (const std::out_of_range &)
+    {
+      caught++;
+    }
+    try
+    {
+      x.at(all{}, 0, 0);
+    }
+    catch (const std::out_of_range &)
+    {
+      caught++;
+    }
+    fails += caught != 2;
+  }
+
+  // modified tiles persist, traversing the grid with dimension 1 fastest
+  {
+    auto x = open_chunked<const double, 3>(path, 3);
+    x.traversal({1, 0, 2}, 2);
+
+    int errors = 0;
+    x.for_each_tile([&](auto tile, const std::array<index_t, 3> &offset)
+                    {
+      for (index_t k = 0; k < tile.shape(2); k++)
+        for (index_t j = 0; j < tile.shape(1); j++)
+          for (index_t i = 0; i < tile.shape(0); i++)
+          {
+            const index_t gi = offset[0] + i, gj = offset[1] + j, gk = offset[2] + k;
+            const double expected = (gi == 5 && gj == 4 && gk == 3) ? -1.0 : value(gi, gj, gk);
+            errors += tile(i, j, k) != expected;
+          } });
+    fails += errors;
+    fails += x.resident_tiles() > 3;
+  }
+
+  // read only accesses do not write tiles back: a change made through
+  // another handle survives the eviction of the tile
+  {
+    auto x = open_chunked<double, 3>(path, 1);
+    fails += std::as_const(x).at(0, 0, 0) != value(0, 0, 0);
+    {
+      auto y = open_chunked<double, 3>(path, 1);
+      y.at(0, 0, 0) = -2.0;
+    }
+    std::as_const(x).for_each_tile([](auto, const std::array<index_t, 3> &) {});
+  }
+  {
+    auto x = open_chunked<const double, 3>(path, 1);
+    fails += x.at(0, 0, 0) != -2.0;
+  }
+
+  // a failed read is not cached: the next access reads the tile again
+  {
+    auto x = open_chunked<const double, 3>(path, 1);
+    if (::truncate(path, 4096) != 0)
+      fails++;
+    int caught = 0;
+    for (int attempt = 0; attempt < 2; attempt++)
+    {
+      try
+      {
+        x.at(9, 6, 4);
+      }
+      catch (const std::runtime_error &)
+      {
+        caught++;
+      }
+    }
+    fails += caught != 2 || x.resident_tiles() != 0;
+  }
+  // mismatched element type or rank
+  int caught = 0;
+  try
+  {
+    open_chunked<const float, 3>(path, 1);
+  }
+  catch (const std::runtime_error &)
+  {
+    caught++;
+  }
+  try
+  {
+    open_chunked<const double, 2>(path, 1);
+  }
+  catch (const std::runtime_error &)
+  {
+    caught++;
+  }
+  fails += caught != 2;
+
+  std::remove(path);
+
+  if (fails)
+  {
+    std::cout << "Chunked tensor test failed!" << std::endl;
+  }
+  else
+  {
+    std::cout << "Chunked tensor test passed!" << std::endl;
+  }
+
+  return fails;
+}
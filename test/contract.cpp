@@ -0,0 +1,181 @@
+#include "TensorView.hpp"
+
+#include <iostream>
+#include <cmath>
+
+using namespace tensor;
+
+static constexpr char ikl_kjl[] = "ikl,kjl->ij";
+static constexpr char ij_jk[] = "ij,jk->ik";
+static constexpr char bij_bjk[] = "bij,bjk->bik";
+static constexpr char ijkl_lkm[] = "ijkl,lkm->mji";
+static constexpr char ij_ij[] = "ij,ij->ij";
+static constexpr char ij_ij_full[] = "ij,ij->";
+static constexpr char outer[] = "i,j";
+static constexpr char ij_j[] = "ij,j->i";
+static constexpr char ijk_j[] = "ijk,j->ik";
+
+template <typename T>
+static void fill(T &x, double scale)
+{
+  for (index_t i = 0; i < x.size(); i++)
+    x[i] = std::sin(scale * i);
+}
+
+static int check(double value, double expected)
+{
+  return std::abs(value - expected) > 1e-10 * std::max(1.0, std::abs(expected));
+}
+
+int main()
+{
+  int fails = 0;
+
+  // the spec is parsed at compile time
+  constexpr auto spec = details::parse_contraction("ikl,kjl->ij");
+  static_assert(spec.valid && spec.n_labels == 4 && spec.rank[0] == 3 && spec.rank[2] == 2, "parse_contraction");
+  static_assert(details::parse_contraction("ij,jk").rank[2] == 2 && details::parse_contraction("ij,jk").label[2][1] == 2, "implicit result");
+  static_assert(!details::parse_contraction("ii,ij->j").valid && !details::parse_contraction("ij,jk->iz").valid && !details::parse_contraction("ij").valid, "invalid specs");
+
+  // C(i, j) = sum_k,l A(i, k, l) B(k, j, l), in the loop and the matrix
+  // product paths
+  for (index_t n : {3, 20})
+  {
+    Tensor<double, 3> A(n, n + 1, 4), B(n + 1, n + 2, 4);
+    fill(A, 0.1);
+    fill(B, 0.37);
+    auto C = contract<ikl_kjl>(A, B);
+    fails += C.shape(0) != n || C.shape(1) != n + 2;
+    for (index_t i = 0; i < n; i++)
+      for (index_t j = 0; j < n + 2; j++)
+      {
+        double s = 0;
+        for (index_t k = 0; k < n + 1; k++)
+          for (index_t l = 0; l < 4; l++)
+            s += A(i, k, l) * B(k, j, l);
+        fails += check(C(i, j), s);
+      }
+  }
+
+  // matrix products of subviews and transposed operands match matmul
+  Tensor<double, 2> X(40, 30), Y(30, 50), Z(40, 50), W(40, 50);
+  fill(X, 0.2);
+  fill(Y, 0.3);
+  matmul(Z, X, Y);
+  contract<ij_jk>(W, X, Y);
+  for (index_t i = 0; i < Z.size(); i++)
+    fails += check(W[i], Z[i]);
+
+  Tensor<double, 2, std::allocator<double>, layout::right> Yr(30, 50);
+  copy(Yr, Y);
+  auto Wr = contract<ij_jk>(X, Yr);
+  for (index_t i = 0; i < Z.size(); i++)
+    fails += check(Wr[i], Z[i]);
+
+  auto Xs = X.at(span(0, 40, 2), span(1, 30));
+  auto Ys = Y.at(span(1, 30), all{});
+  Tensor<double, 2> Zs(20, 50);
+  matmul(Zs, Xs, Ys);
+  auto Ws = contract<ij_jk>(Xs, Ys);
+  for (index_t i = 0; i < Zs.size(); i++)
+    fails += check(Ws[i], Zs[i]);
+
+  // batched with the batch index first, and many batches
+  Tensor<double, 3> P(64, 9, 11), Q(64, 11, 7);
+  fill(P, 0.05);
+  fill(Q, 0.07);
+  auto R = contract<bij_bjk>(P, Q);
+  for (index_t b = 0; b < 64; b++)
+    for (index_t i = 0; i < 9; i++)
+      for (index_t k = 0; k < 7; k++)
+      {
+        double s = 0;
+        for (index_t j = 0; j < 11; j++)
+          s += P(b, i, j) * Q(b, j, k);
+        fails += check(R(b, i, k), s);
+      }
+
+  // rank 4 with permuted result and merged contracted indices
+  Tensor<double, 4> A4(5, 6, 7, 8);
+  Tensor<double, 3> B3(8, 7, 9);
+  fill(A4, 0.011);
+  fill(B3, 0.013);
+  auto C3 = contract<ijkl_lkm>(A4, B3);
+  fails += C3.shape(0) != 9 || C3.shape(1) != 6 || C3.shape(2) != 5;
+  for (index_t m = 0; m < 9; m++)
+    for (index_t j = 0; j < 6; j++)
+      for (index_t i = 0; i < 5; i++)
+      {
+        double s = 0;
+        for (index_t k = 0; k < 7; k++)
+          for (index_t l = 0; l < 8; l++)
+            s += A4(i, j, k, l) * B3(l, k, m);
+        fails += check(C3(m, j, i), s);
+      }
+
+  // elementwise, full, outer and matrix-vector contractions
+  auto H = contract<ij_ij>(X, X);
+  double ss = 0;
+  for (index_t i = 0; i < X.size(); i++)
+  {
+    fails += check(H[i], X[i] * X[i]);
+    ss += X[i] * X[i];
+  }
+  fails += check(contract<ij_ij_full>(X, X), ss);
+
+  Tensor<double, 1> u(40), v(30);
+  fill(u, 0.5);
+  fill(v, 0.9);
+  auto uv = contract<outer>(u, v);
+  for (index_t i = 0; i < 40; i++)
+    for (index_t j = 0; j < 30; j++)
+      fails += check(uv(i, j), u(i) * v(j));
+
+  auto Xv = contract<ij_j>(X, v);
+  for (index_t i = 0; i < 40; i++)
+  {
+    double s = 0;
+    for (index_t j = 0; j < 30; j++)
+      s += X(i, j) * v(j);
+    fails += check(Xv(i), s);
+  }
+
+  auto T3 = contract<ijk_j>(P, Q.at(0, span(0, 9), 0));
+  for (index_t i = 0; i < 64; i++)
+    for (index_t k = 0; k < 11; k++)
+    {
+      double s = 0;
+      for (index_t j = 0; j < 9; j++)
+        s += P(i, j, k) * Q(0, j, 0);
+      fails += check(T3(i, k), s);
+    }
+
+  // empty indices: an empty sum gives zero, an empty result is not touched
+  Tensor<double, 2> F(3, 4);
+  for (index_t i = 0; i < F.size(); i++)
+    F[i] = 1.0;
+  contract<ij_jk>(F, X.at(span(0, 3), span(0, 0)), Y.at(span(0, 0), span(0, 4)));
+  for (index_t i = 0; i < F.size(); i++)
+    fails += F[i] != 0.0;
+
+  contract<ij_jk>(F.at(span(0, 0), all{}), X.at(span(0, 0), span(0, 5)), Y.at(span(0, 5), span(0, 4)));
+  for (index_t i = 0; i < F.size(); i++)
+    fails += F[i] != 0.0;
+
+#if __cplusplus >= 202002L
+  auto C20 = contract<"ij,jk->ik">(X, Y);
+  for (index_t i = 0; i < Z.size(); i++)
+    fails += check(C20[i], Z[i]);
+#endif
+
+  if (fails)
+  {
+    std::cout << "Contract test failed!" << std::endl;
+  }
+  else
+  {
+    std::cout << "Contract test passed!" << std::endl;
+  }
+
+  return fails;
+}
@@ -0,0 +1,88 @@
+#include "TensorView.hpp"
+
+#include <iostream>
+
+using namespace tensor;
+
+template <typename A, typename B>
+static int compare(const A &a, const B &b, const char *name)
+{
+  int fails = 0;
+  auto ia = a.begin();
+  for (auto ib = b.begin(); ib != b.end(); ++ia, ++ib)
+    fails += *ia != *ib;
+  if (fails)
+    std::cout << name << " failed." << std::endl;
+  return fails;
+}
+
+int main()
+{
+  // sizes which are not multiples of the tile size
+  const int n0 = 71, n1 = 45, n2 = 3;
+  Tensor<double, 3> x(n0, n1, n2);
+  Tensor<float, 2> f(n0, n1);
+  for (double &v : x)
+    v = static_cast<double>(rand()) / RAND_MAX;
+  for (float &v : f)
+    v = static_cast<float>(rand()) / RAND_MAX;
+
+  int fails = 0;
+
+  // contiguous
+  Tensor<double, 3> y(n0, n1, n2);
+  copy(y, x);
+  fails += compare(y, x, "contiguous copy");
+
+  // transposes
+  Tensor<double, 3> p(n1, n0, n2);
+  copy(p, permute<1, 0, 2>(x));
+  fails += compare(p, permute<1, 0, 2>(x), "permuted copy");
+
+  Tensor<double, 3> q(n2, n0, n1);
+  copy(q, permute<2, 0, 1>(x));
+  fails += compare(q, permute<2, 0, 1>(x), "permuted copy (2, 0, 1)");
+
+  Tensor<double, 3> z(n0, n1, n2);
+  copy(permute<1, 2, 0>(z), permute<1, 2, 0>(x));
+  fails += compare(z, x, "copy between permuted views");
+
+  Tensor<float, 2> ft(n1, n0);
+  copy(ft, transpose(f));
+  fails += compare(ft, transpose(f), "float transpose");
+
+  TensorView<float, 2> ftv(ft.data(), n1, n0);
+  Tensor<float, 2> f2(n0, n1);
+  copy(transpose(f2), ftv);
+  fails += compare(f2, f, "copy into transposed view");
+
+  // subviews
+  Tensor<double, 2> s(n0, 20);
+  copy(s.at(span(0, n0), span(0, 20, 2)), x.at(all{}, span(1, 40, 4), 1));
+  fails += compare(s.at(all{}, span(0, 20, 2)), x.at(all{}, span(1, 40, 4), 1), "subview copy");
+
+  Tensor<double, 2> st(10, n0);
+  copy(st, transpose(x.at(all{}, span(1, 40, 4), 1)));
+  fails += compare(st, transpose(x.at(all{}, span(1, 40, 4), 1)), "transposed subview copy");
+
+  // negative strides
+  Tensor<double, 3> r(n0, n1, n2);
+  copy(r, flip(x, 0));
+  fails += compare(r, flip(x, 0), "flipped copy");
+
+  // one dimensional
+  Tensor<double, 1> v(n1);
+  copy(v, x.at(3, all{}, 2));
+  fails += compare(v, x.at(3, all{}, 2), "1D copy");
+
+  if (fails)
+  {
+    std::cout << "Copy test failed!" << std::endl;
+  }
+  else
+  {
+    std::cout << "Copy test passed!" << std::endl;
+  }
+
+  return fails;
+}
@@ -0,0 +1,98 @@
+#include "TensorView.hpp"
+
+#include <iostream>
+#include <cmath>
+
+using namespace tensor;
+
+int main()
+{
+  double x_data[60], y_data[60];
+  for (int i = 0; i < 60; i++)
+  {
+    x_data[i] = static_cast<double>(rand()) / RAND_MAX;
+    y_data[i] = static_cast<double>(rand()) / RAND_MAX;
+  }
+
+  TensorView<double, 3> x(x_data, 3, 4, 5);
+  FixedTensorView<double, 3, 4, 5> y(y_data);
+  Tensor<double, 3> z(3, 4, 5);
+  FixedTensor<double, 3, 4, 5> w;
+
+  int fails = 0;
+
+  // contiguous operands
+  z = 2.0 * x + y / 4.0;
+  for (int i = 0; i < 60; i++)
+    fails += z[i] != 2.0 * x_data[i] + y_data[i] / 4.0;
+
+  w = x * y - z;
+  for (int i = 0; i < 60; i++)
+    fails += w[i] != x_data[i] * y_data[i] - z[i];
+
+  // unary functions
+  z = sqrt(abs(x - y)) + exp(-x);
+  for (int i = 0; i < 60; i++)
+    fails += std::abs(z[i] - (std::sqrt(std::abs(x_data[i] - y_data[i])) + std::exp(-x_data[i]))) > 1e-14;
+
+  z = pow(x, 2) + max(x, 0.5);
+  for (int i = 0; i < 60; i++)
+    fails += std::abs(z[i] - (x_data[i] * x_data[i] + std::max(x_data[i], 0.5))) > 1e-14;
+
+  // compound assignment
+  z = 1.0 * x;
+  z += y;
+  z *= 3.0;
+  for (int i = 0; i < 60; i++)
+    fails += std::abs(z[i] - 3.0 * (x_data[i] + y_data[i])) > 1e-14;
+
+  // strided operands and destinations
+  auto xs = x.at(span(0, 3, 2), all{}, 1);
+  auto ys = y.at(span(1, 3), all{}, 1);
+  Tensor<double, 2> u(2, 4);
+
+  u = xs + 2.0 * ys;
+  for (int i = 0; i < 2; i++)
+    for (int j = 0; j < 4; j++)
+      fails += u(i, j) != x(2 * i, j, 1) + 2.0 * y(1 + i, j, 1);
+
+  z = 0.0 * x;
+  auto zs = z.at(span(0, 2), all{}, 3);
+  zs = u - ys;
+  for (int i = 0; i < 2; i++)
+    for (int j = 0; j < 4; j++)
+      fails += z(i, j, 3) != u(i, j) - y(1 + i, j, 1);
+
+  z.at(all{}, all{}, 4) = x.at(all{}, all{}, 0) * y.at(all{}, all{}, 4);
+  for (int i = 0; i < 3; i++)
+    for (int j = 0; j < 4; j++)
+      fails += z(i, j, 4) != x(i, j, 0) * y(i, j, 4);
+
+  z.at(1, all{}, 0) -= 1.0;
+  for (int j = 0; j < 4; j++)
+    fails += z(1, j, 0) != -1.0;
+
+#ifdef TENSOR_CHECK_BOUNDS
+  fails++;
+  try
+  {
+    u = x.at(all{}, all{}, 0) + 1.0;
+  }
+  catch (const std::logic_error &e)
+  {
+    std::cout << "Caught exception as expected: " << e.what() << std::endl;
+    fails--;
+  }
+#endif
+
+  if (fails)
+  {
+    std::cout << "Expressions test failed!" << std::endl;
+  }
+  else
+  {
+    std::cout << "Expressions test passed!" << std::endl;
+  }
+
+  return fails;
+}
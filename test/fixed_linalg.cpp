@@ -0,0 +1,136 @@
+#include "TensorView.hpp"
+
+#include <iostream>
+#include <cmath>
+
+using namespace tensor;
+
+template <size_t N>
+static int check_inverse(const FixedTensor<double, N, N> &A)
+{
+  auto B = inv(A);
+  auto I = matmul(A, B);
+
+  int fails = 0;
+  for (int i = 0; i < (int)N; i++)
+    for (int j = 0; j < (int)N; j++)
+      fails += std::abs(I(i, j) - (i == j)) > 1e-10;
+
+  // det(A) * det(inv(A)) == 1
+  fails += std::abs(det(A) * det(B) - 1.0) > 1e-10;
+
+  if (fails)
+    std::cout << "inverse of " << N << "x" << N << " matrix failed." << std::endl;
+  return fails;
+}
+
+template <size_t N>
+static FixedTensor<double, N, N> random_matrix()
+{
+  FixedTensor<double, N, N> A;
+  for (double &a : A)
+    a = static_cast<double>(rand()) / RAND_MAX - 0.5;
+  for (int i = 0; i < (int)N; i++)
+    A(i, i) += N; // well conditioned
+  return A;
+}
+
+int main()
+{
+  int fails = 0;
+
+  FixedTensor<double, 3, 4> A;
+  FixedTensor<double, 4, 2> B;
+  FixedTensor<double, 4> x;
+  for (double &a : A)
+    a = static_cast<double>(rand()) / RAND_MAX;
+  for (double &b : B)
+    b = static_cast<double>(rand()) / RAND_MAX;
+  for (double &v : x)
+    v = static_cast<double>(rand()) / RAND_MAX;
+
+  // matmul, also from views
+  FixedTensorView<double, 4, 2> Bv(B.data());
+  auto C = matmul(A, Bv);
+  for (int i = 0; i < 3; i++)
+    for (int j = 0; j < 2; j++)
+    {
+      double c = 0;
+      for (int k = 0; k < 4; k++)
+        c += A(i, k) * B(k, j);
+      fails += std::abs(C(i, j) - c) > 1e-14;
+    }
+
+  // matvec
+  auto y = matvec(A, x);
+  for (int i = 0; i < 3; i++)
+  {
+    double v = 0;
+    for (int k = 0; k < 4; k++)
+      v += A(i, k) * x(k);
+    fails += std::abs(y(i) - v) > 1e-14;
+  }
+
+  // transpose
+  auto At = transpose(A);
+  for (int i = 0; i < 3; i++)
+    for (int j = 0; j < 4; j++)
+      fails += At(j, i) != A(i, j);
+
+  // determinants of known matrices
+  FixedTensor<double, 3, 3> D;
+  D(0, 0) = 2, D(1, 1) = 3, D(2, 2) = 4, D(0, 2) = 1;
+  fails += std::abs(det(D) - 24.0) > 1e-14;
+
+  fails += check_inverse(random_matrix<1>());
+  fails += check_inverse(random_matrix<2>());
+  fails += check_inverse(random_matrix<3>());
+  fails += check_inverse(random_matrix<4>());
+
+  // contractions
+  auto C2 = tensordot<1, 0>(A, B);
+  for (int i = 0; i < 6; i++)
+    fails += std::abs(C2[i] - C[i]) > 1e-14;
+
+  FixedTensor<double, 2, 3, 4> T;
+  for (double &t : T)
+    t = static_cast<double>(rand()) / RAND_MAX;
+
+  auto Tx = tensordot<2, 0>(T, x); // (2, 3)
+  auto AT = tensordot<0, 1>(A, T); // (4, 2, 4)
+  for (int i = 0; i < 2; i++)
+    for (int j = 0; j < 3; j++)
+    {
+      double v = 0;
+      for (int k = 0; k < 4; k++)
+        v += T(i, j, k) * x(k);
+      fails += std::abs(Tx(i, j) - v) > 1e-14;
+    }
+
+  for (int l = 0; l < 4; l++)
+    for (int i = 0; i < 2; i++)
+      for (int k = 0; k < 4; k++)
+      {
+        double v = 0;
+        for (int j = 0; j < 3; j++)
+          v += A(j, l) * T(i, j, k);
+        fails += std::abs(AT(l, i, k) - v) > 1e-14;
+      }
+
+  double xx = tensordot<0, 0>(x, x);
+  double expected = 0;
+  for (int k = 0; k < 4; k++)
+    expected += x(k) * x(k);
+  fails += std::abs(xx - expected) > 1e-14;
+
+  if (fails)
+  {
+    std::cout << "Fixed linear algebra test failed!" << std::endl;
+  }
+  else
+  {
+    std::cout << "Fixed linear algebra test passed!" << std::endl;
+  }
+
+  return fails;
+}
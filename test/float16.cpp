@@ -0,0 +1,190 @@
+#include "TensorView.hpp"
+
+#include <iostream>
+#include <cmath>
+#include <limits>
+
+using namespace tensor;
+
+static_assert(sizeof(float16) == 2 && sizeof(bfloat16) == 2, "storage types are 16 bits.");
+static_assert(std::is_trivially_copyable_v<float16> && std::is_trivially_default_constructible_v<bfloat16>, "storage types are trivial.");
+static_assert(std::is_same_v<compute_t<float16>, float> && std::is_same_v<compute_t<double>, double>, "compute_t");
+
+// true if h is a closest value of type H to x, i.e. no neighbour of h is
+// closer.
+template <typename H>
+static bool is_nearest(float x, H h)
+{
+  const double e = std::abs(double(float(h)) - x);
+  for (int d : {-1, 1})
+  {
+    const H g = H::from_bits(uint16_t(h.bits + d));
+    const float y = g;
+    if (std::isfinite(y) && (std::signbit(y) == std::signbit(float(h)) || y == 0.0f) && std::abs(double(y) - x) < e)
+      return false;
+  }
+  return true;
+}
+
+template <typename H>
+static int test_round_trip()
+{
+  int fails = 0;
+  for (uint32_t b = 0; b < 0x10000; b++)
+  {
+    const H h = H::from_bits(uint16_t(b));
+    const float x = h;
+    if (std::isnan(x))
+      fails += !std::isnan(float(H(x)));
+    else
+      fails += H(x).bits != h.bits;
+  }
+  return fails;
+}
+
+// tricky values: ties, the edges of the subnormal and finite ranges,
+// infinities and NaNs.
+static Vector<float> special_values(index_t n)
+{
+  const float values[] = {0.0f, -0.0f, 1.0f, -2.5f, 65504.0f, 65519.0f, 65520.0f, 1e30f, -1e30f, std::ldexp(1.0f, -24),
+                          std::ldexp(1.0f, -25), std::ldexp(3.0f, -26), std::ldexp(1.0f, -14), 1.0f + std::ldexp(1.0f, -11), 1.0f + std::ldexp(3.0f, -11),
+                          1.0f + std::ldexp(1.0f, -8), 1.0f + std::ldexp(3.0f, -8), std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity(),
+                          std::numeric_limits<float>::quiet_NaN(), details::bits_to_float(0x7f800001u), details::bits_to_float(0xffffffffu), 3.4e38f, 1e-40f};
+  const index_t k = sizeof(values) / sizeof(float);
+  Vector<float> x(n);
+  for (index_t i = 0; i < n; i++)
+    x(i) = (i < k) ? values[i] : std::ldexp(std::sin(0.37f * i), int(i % 40) - 30);
+  return x;
+}
+
+template <typename H>
+static bool same(H a, H b)
+{
+  return (std::isnan(float(a)) && std::isnan(float(b))) || a.bits == b.bits;
+}
+
+template <typename H>
+static int test_convert()
+{
+  int fails = 0;
+
+  // the vector conversions round like the scalar conversion, for lengths
+  // with and without a tail
+  for (index_t n : {7, 100, 1003})
+  {
+    auto x = special_values(n);
+    Vector<H> h(n);
+    convert(h, x);
+    Vector<float> y(n);
+    convert(y, h);
+    for (index_t i = 0; i < n; i++)
+    {
+      fails += !same(h(i), H(x(i)));
+      fails += !(std::isnan(y(i)) ? std::isnan(float(h(i))) : y(i) == float(h(i)));
+      if (std::isfinite(x(i)) && std::abs(x(i)) < 6e4f)
+        fails += !is_nearest(x(i), h(i));
+    }
+  }
+
+  // strided and transposed conversions
+  Tensor<float, 2> X(30, 20);
+  for (index_t i = 0; i < X.size(); i++)
+    X[i] = 0.1f * i;
+  Tensor<H, 2, std::allocator<H>, layout::right> R(30, 20);
+  convert(R, X);
+  Tensor<H, 2> S(10, 20);
+  convert(S, X.at(span(0, 30, 3), all{}));
+  for (index_t j = 0; j < 20; j++)
+    for (index_t i = 0; i < 30; i++)
+    {
+      fails += !same(R(i, j), H(X(i, j)));
+      if (i % 3 == 0)
+        fails += !same(S(i / 3, j), H(X(i, j)));
+    }
+
+  return fails;
+}
+
+template <typename H>
+static int test_tensors(float tol)
+{
+  int fails = 0;
+  const index_t m = 37, n = 29;
+
+  // elements are read and written as float
+  Tensor<H, 2> A(m, n), B(m, n);
+  for (index_t j = 0; j < n; j++)
+    for (index_t i = 0; i < m; i++)
+    {
+      A(i, j) = std::sin(0.1f * (i + m * j));
+      B(i, j) = 0.5f + 0.01f * i;
+    }
+  fails += A(0, 0).bits != 0 || float(B(0, 0)) != 0.5f;
+  A(1, 1) += 1.0f;
+  fails += std::abs(float(A(1, 1)) - (1.0f + std::sin(0.1f * (1 + m)))) > tol;
+
+  Tensor<float, 2> Af(m, n), Bf(m, n);
+  convert(Af, A);
+  convert(Bf, B);
+
+  // expressions compute in float and round when stored
+  Tensor<float, 2> C(m, n);
+  C = A * B + 1.0f;
+  Tensor<H, 2> D(m, n);
+  D = 2.0f * A - B;
+  for (index_t i = 0; i < A.size(); i++)
+  {
+    fails += C[i] != Af[i] * Bf[i] + 1.0f;
+    fails += !same(D[i], H(2.0f * Af[i] - Bf[i]));
+  }
+
+  // reductions accumulate in float, with float results
+  auto s = sum(A);
+  static_assert(std::is_same_v<decltype(s), float>, "the sum of a float16 tensor is a float.");
+  fails += std::abs(s - sum(Af)) > 1e-4f;
+  fails += std::abs(norm2(A) - norm2(Af)) > 1e-4f;
+  fails += max_abs(A) != max_abs(Af) || min(A) != min(Af) || max(B) != max(Bf);
+  fails += std::abs(dot(A, B) - dot(Af, Bf)) > 1e-4f;
+  fails += std::abs(sum(A * B) - dot(Af, Bf)) > 1e-4f;
+
+  auto cols = sum(A, 0);
+  auto cols_f = sum(Af, 0);
+  for (index_t j = 0; j < n; j++)
+    fails += std::abs(cols(j) - cols_f(j)) > 1e-5f;
+
+  auto As = A.at(span(1, m, 2), span(0, n));
+  auto Afs = Af.at(span(1, m, 2), span(0, n));
+  fails += std::abs(sum(As) - sum(Afs)) > 1e-4f || max_abs(As) != max_abs(Afs);
+
+  return fails;
+}
+
+int main()
+{
+  int fails = 0;
+
+  fails += float16(1.0f).bits != 0x3c00 || float16(-2.0f).bits != 0xc000 || float16(65504.0f).bits != 0x7bff;
+  fails += float16(65520.0f).bits != 0x7c00 || float16(1e-8f).bits != 0 || float16(std::ldexp(1.0f, -24)).bits != 1;
+  fails += float16(1.0f + std::ldexp(1.0f, -11)).bits != 0x3c00 || float16(1.0f + std::ldexp(3.0f, -11)).bits != 0x3c02;
+  fails += float(float16::from_bits(0x0001)) != std::ldexp(1.0f, -24) || float(float16::from_bits(0x3555)) != 0.333251953125f;
+  fails += bfloat16(1.0f).bits != 0x3f80 || bfloat16(-3.0f).bits != 0xc040 || !std::isnan(float(bfloat16(std::numeric_limits<float>::quiet_NaN())));
+  fails += bfloat16(1.0f + std::ldexp(1.0f, -8)).bits != 0x3f80 || bfloat16(1.0f + std::ldexp(3.0f, -8)).bits != 0x3f82;
+
+  fails += test_round_trip<float16>();
+  fails += test_round_trip<bfloat16>();
+  fails += test_convert<float16>();
+  fails += test_convert<bfloat16>();
+  fails += test_tensors<float16>(1e-3f);
+  fails += test_tensors<bfloat16>(1e-2f);
+
+  if (fails)
+  {
+    std::cout << "float16 test failed!" << std::endl;
+  }
+  else
+  {
+    std::cout << "float16 test passed!" << std::endl;
+  }
+
+  return fails;
+}
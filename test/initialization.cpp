@@ -1,6 +1,7 @@
 #include "TensorView.hpp"
 
 #include <iostream>
+#include <cstdint>
 
 using namespace tensor;
 
@@ -20,6 +21,45 @@ int main()
   std::cout << "Initializing FixedTensor object..." << std::endl;
   FixedTensor<double, 2, 3> fixed_tensor;
 
-  std::cout << "Initialization test passed!" << std::endl;
-  return 0;
+  int fails = 0;
+
+  std::cout << "Initializing Tensor object with zeros..." << std::endl;
+  Tensor<double, 2> zeros(4, 5);
+  for (double z : zeros)
+    fails += z != 0.0;
+
+  std::cout << "Initializing uninitialized Tensor object..." << std::endl;
+  Tensor<double, 3> scratch(uninitialized, 4, 5, 6);
+  fails += scratch.size() != 120 || scratch.shape(2) != 6;
+  for (double &x : scratch)
+    x = 1.0;
+
+  std::cout << "Reshaping Tensor object..." << std::endl;
+  zeros(3, 4) = 7.0;
+  zeros.reshape(5, 5);
+  fails += zeros[19] != 7.0 || zeros[24] != 0.0;
+
+  // reshape_discard reuses the array when it is large enough
+  const double *p = scratch.data();
+  scratch.reshape_discard(2, 5, 6);
+  fails += scratch.data() != p || scratch.size() != 60;
+  scratch.reshape_discard(10, 10, 10);
+  fails += scratch.size() != 1000 || scratch.shape(0) != 10;
+  for (double &x : scratch)
+    x = 2.0;
+  fails += scratch(9, 9, 9) != 2.0;
+
+  Tensor<double, 2, aligned_allocator<double>> aligned(uninitialized, 3, 3);
+  fails += reinterpret_cast<std::uintptr_t>(aligned.data()) % 64 != 0;
+
+  if (fails)
+  {
+    std::cout << "Initialization test failed!" << std::endl;
+  }
+  else
+  {
+    std::cout << "Initialization test passed!" << std::endl;
+  }
+
+  return fails;
 }
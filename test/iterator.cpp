@@ -1,6 +1,8 @@
 #include "TensorView.hpp"
 
 #include <iostream>
+#include <numeric>
+#include <algorithm>
 
 using namespace tensor;
 
@@ -31,6 +33,31 @@ int main()
     position++;
   }
 
+  // iterators over contiguous tensors are pointer-like
+  static_assert(std::is_same_v<std::iterator_traits<TensorView<double, 4>::iterator>::iterator_category, std::random_access_iterator_tag>);
+#if __cplusplus >= 202002L
+  static_assert(std::contiguous_iterator<TensorView<double, 4>::iterator>);
+  static_assert(std::contiguous_iterator<FixedTensorView<double, 5, 10, 2, 5>::const_iterator>);
+  static_assert(std::contiguous_iterator<Tensor<double, 2>::iterator>);
+#endif
+
+  fails += &*tensor_view.begin() != data;
+  fails += &*tensor_view.end() != data + 500;
+
+  const double sum = std::accumulate(tensor_view.begin(), tensor_view.end(), 0.0);
+  fails += sum != std::accumulate(data, data + 500, 0.0);
+
+  Tensor<double, 4> tensor(5, 10, 2, 5);
+  std::transform(fixed_tensor_view.begin(), fixed_tensor_view.end(), tensor.begin(), [](double x)
+                 { return 2.0 * x; });
+  for (int i = 0; i < 500; ++i)
+    fails += tensor[i] != 2.0 * data[i];
+
+  const Tensor<double, 4> &const_tensor = tensor;
+  Tensor<double, 4>::const_iterator cit = tensor.begin();
+  fails += cit != const_tensor.begin();
+  fails += (const_tensor.end() - cit) != 500;
+
   if (fails)
   {
     std::cout << "Iterator test failed!" << std::endl;
@@ -0,0 +1,146 @@
+#include "TensorView.hpp"
+
+#include <iostream>
+#include <cmath>
+
+using namespace tensor;
+
+int main()
+{
+  const int n0 = 3, n1 = 4, n2 = 5;
+  double data[n0 * n1 * n2];
+  for (int i = 0; i < n0 * n1 * n2; i++)
+    data[i] = static_cast<double>(rand()) / RAND_MAX;
+
+  int fails = 0;
+
+  // row-major indexing
+  TensorView<double, 3, layout::right> x(data, n0, n1, n2);
+  for (int i = 0; i < n0; i++)
+    for (int j = 0; j < n1; j++)
+      for (int k = 0; k < n2; k++)
+        fails += x(i, j, k) != data[k + n2 * (j + n1 * i)];
+
+  fails += x.stride(0) != n1 * n2 || x.stride(1) != n2 || x.stride(2) != 1;
+
+  // iterating a contiguous tensor follows memory order
+  int pos = 0;
+  for (double v : x)
+    fails += v != data[pos++];
+
+  // slicing
+  auto s = x.at(1, span(1, 4), all{});
+  for (int j = 0; j < 3; j++)
+    for (int k = 0; k < n2; k++)
+      fails += s(j, k) != x(1, 1 + j, k);
+
+  auto s2 = x.at(span(0, 3, 2), 2, span(1, 5, 3));
+  for (int i = 0; i < 2; i++)
+    for (int k = 0; k < 2; k++)
+      fails += s2(i, k) != x(2 * i, 2, 1 + 3 * k);
+
+  // reshape keeps the layout
+  auto r = reshape(x, n0 * n1, n2);
+  static_assert(std::is_same_v<decltype(r), TensorView<double, 2, layout::right>>);
+  for (int i = 0; i < n0; i++)
+    for (int j = 0; j < n1; j++)
+      for (int k = 0; k < n2; k++)
+        fails += r(j + n1 * i, k) != x(i, j, k);
+
+  // fixed size
+  BasicFixedTensor<double, layout::right, 2, 3> F;
+  for (int i = 0; i < 6; i++)
+    F[i] = i;
+  for (int i = 0; i < 2; i++)
+    for (int j = 0; j < 3; j++)
+      fails += F(i, j) != 3 * i + j;
+
+  auto Fr = reshape(F, 3, 2);
+  static_assert(std::is_same_v<decltype(Fr), TensorView<double, 2, layout::right>>);
+  fails += Fr(2, 1) != 5 || Fr(1, 0) != 2;
+
+  // expressions and copies between layouts
+  Tensor<double, 3> y(n0, n1, n2);
+  copy(y, x);
+  for (int i = 0; i < n0; i++)
+    for (int j = 0; j < n1; j++)
+      for (int k = 0; k < n2; k++)
+        fails += y(i, j, k) != x(i, j, k);
+
+  Tensor<double, 3, std::allocator<double>, layout::right> z(n0, n1, n2);
+  z = x + 2.0 * y;
+  for (int i = 0; i < n0; i++)
+    for (int j = 0; j < n1; j++)
+      for (int k = 0; k < n2; k++)
+        fails += z(i, j, k) != 3.0 * x(i, j, k);
+
+  Tensor<double, 3> w(n0, n1, n2);
+  w = z - x;
+  for (int i = 0; i < n0; i++)
+    for (int j = 0; j < n1; j++)
+      for (int k = 0; k < n2; k++)
+        fails += std::abs(w(i, j, k) - 2.0 * x(i, j, k)) > 1e-14;
+
+  // reductions
+  double d = 0;
+  for (int i = 0; i < n0; i++)
+    for (int j = 0; j < n1; j++)
+      for (int k = 0; k < n2; k++)
+        d += x(i, j, k) * w(i, j, k);
+  fails += std::abs(dot(x, w) - d) > 1e-12;
+
+  for (int dim = 0; dim < 3; dim++)
+  {
+    auto sx = sum(x, dim);
+    auto sy = sum(y, dim);
+    for (int i = 0; i < sx.shape(0); i++)
+      for (int j = 0; j < sx.shape(1); j++)
+        fails += std::abs(sx(i, j) - sy(i, j)) > 1e-12;
+  }
+
+  // padded leading dimension
+  Tensor<double, 3, std::allocator<double>, layout::left_padded<8>> P(7, n1, n2);
+  fails += P.stride(0) != 1 || P.stride(1) != 8 || P.stride(2) != 8 * n1;
+  fails += &P(0, 1, 0) - &P(0, 0, 0) != 8;
+
+  Tensor<double, 3> Q(7, n1, n2);
+  for (int i = 0; i < Q.size(); i++)
+    Q[i] = i;
+  P = 1.0 * Q;
+  for (int i = 0; i < 7; i++)
+    for (int j = 0; j < n1; j++)
+      for (int k = 0; k < n2; k++)
+        fails += P(i, j, k) != Q(i, j, k);
+
+  pos = 0;
+  for (double v : P)
+    fails += v != Q[pos++];
+  for (int i = 0; i < P.size(); i++)
+    fails += P[i] != Q[i];
+
+  fails += std::abs(sum(P) - sum(Q)) > 1e-12;
+  auto Ps = P.at(span(1, 6), 2, all{});
+  for (int i = 0; i < 5; i++)
+    for (int k = 0; k < n2; k++)
+      fails += Ps(i, k) != Q(1 + i, 2, k);
+
+  Tensor<double, 3> Q2(7, n1, n2);
+  copy(Q2, P);
+  for (int i = 0; i < Q.size(); i++)
+    fails += Q2[i] != Q[i];
+
+  TensorView<double, 2, layout::right_padded<4>> R(data, 3, 5); // rows of 8
+  fails += R.stride(0) != 8 || R.stride(1) != 1;
+  fails += R(2, 3) != data[19];
+
+  if (fails)
+  {
+    std::cout << "Layout test failed!" << std::endl;
+  }
+  else
+  {
+    std::cout << "Layout test passed!" << std::endl;
+  }
+
+  return fails;
+}
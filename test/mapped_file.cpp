@@ -0,0 +1,147 @@
+#include "TensorView.hpp"
+
+#include <iostream>
+#include <cstdio>
+#include <cstdint>
+
+using namespace tensor;
+
+int main()
+{
+  int fails = 0;
+  const char *path = "mapped_file_test.tv";
+
+  const int n0 = 3, n1 = 4, n2 = 5, n3 = 6;
+  Tensor<double, 4> x(n0, n1, n2, n3);
+  for (index_t i = 0; i < x.size(); i++)
+    x[i] = i;
+
+  // round trip through a read only mapping
+  save(path, x);
+  {
+    auto y = map_file<const double, 4>(path);
+    fails += y.shape(0) != n0 || y.shape(1) != n1 || y.shape(2) != n2 || y.shape(3) != n3;
+    fails += reinterpret_cast<std::uintptr_t>(y.data()) % 64 != 0;
+    for (index_t i = 0; i < x.size(); i++)
+      fails += y[i] != x[i];
+    fails += sum(y) != sum(x);
+  }
+
+  // writes through a read_write mapping reach the file
+  {
+    auto y = map_file<double, 4>(path);
+    y(1, 2, 3, 4) = -1.0;
+    y.sync();
+  }
+  {
+    auto y = map_file<const double, 4>(path);
+    fails += y(1, 2, 3, 4) != -1.0;
+  }
+
+  // copy_on_write mappings leave the file unchanged
+  {
+    auto y = map_file<double, 4>(path, map_mode::copy_on_write);
+    y(1, 2, 3, 4) = 7.0;
+    fails += y(1, 2, 3, 4) != 7.0;
+  }
+  {
+    auto y = map_file<const double, 4>(path);
+    fails += y(1, 2, 3, 4) != -1.0;
+  }
+
+  // mismatched element type, rank, or layout
+  int caught = 0;
+  try
+  {
+    map_file<const float, 4>(path);
+  }
+  catch (const std::runtime_error &)
+  {
+    caught++;
+  }
+  try
+  {
+    map_file<const double, 3>(path);
+  }
+  catch (const std::runtime_error &)
+  {
+    caught++;
+  }
+  try
+  {
+    map_file<const double, 4, layout::right>(path);
+  }
+  catch (const std::runtime_error &)
+  {
+    caught++;
+  }
+  try
+  {
+    map_file<const double, 4>("does_not_exist.tv");
+  }
+  catch (const std::runtime_error &)
+  {
+    caught++;
+  }
+  fails += caught != 4;
+
+  // subviews are stored in column-major order
+  auto s = x.at(span(0, 3), 1, span(1, 5), all{});
+  save(path, s);
+  {
+    auto y = map_file<const double, 3>(path);
+    for (int i = 0; i < 3; i++)
+      for (int k = 0; k < 4; k++)
+        for (int l = 0; l < n3; l++)
+          fails += y(i, k, l) != s(i, k, l);
+  }
+
+  // row-major and padded tensors
+  Tensor<int, 2, std::allocator<int>, layout::right> r(4, 7);
+  for (int i = 0; i < 4; i++)
+    for (int j = 0; j < 7; j++)
+      r(i, j) = 10 * i + j;
+  save(path, r);
+  {
+    auto y = map_file<const int, 2, layout::right>(path);
+    for (int i = 0; i < 4; i++)
+      for (int j = 0; j < 7; j++)
+        fails += y(i, j) != r(i, j);
+  }
+
+  Tensor<int, 2, std::allocator<int>, layout::right_padded<8>> p(4, 7);
+  for (int i = 0; i < 4; i++)
+    for (int j = 0; j < 7; j++)
+      p(i, j) = 10 * i + j;
+  save(path, p);
+  {
+    auto y = map_file<const int, 2>(path);
+    for (int i = 0; i < 4; i++)
+      for (int j = 0; j < 7; j++)
+        fails += y(i, j) != p(i, j);
+  }
+
+  // files created empty and filled through the mapping
+  {
+    auto z = create_file<float>(path, 100, 200);
+    fails += sum(z) != 0.0f;
+    z(99, 199) = 1.5f;
+  }
+  {
+    auto z = map_file<const float, 2>(path);
+    fails += z.shape(0) != 100 || z.shape(1) != 200 || z(99, 199) != 1.5f;
+  }
+
+  std::remove(path);
+
+  if (fails)
+  {
+    std::cout << "Mapped file test failed!" << std::endl;
+  }
+  else
+  {
+    std::cout << "Mapped file test passed!" << std::endl;
+  }
+
+  return fails;
+}
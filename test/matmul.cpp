@@ -0,0 +1,128 @@
+#include "TensorView.hpp"
+
+#include <iostream>
+#include <cmath>
+
+using namespace tensor;
+
+template <typename MC, typename MA, typename MB>
+double max_error(const MC &C, const MA &A, const MB &B)
+{
+  double err = 0;
+  for (index_t i = 0; i < C.shape(0); i++)
+    for (index_t j = 0; j < C.shape(1); j++)
+    {
+      double s = 0;
+      for (index_t p = 0; p < A.shape(1); p++)
+        s += A(i, p) * B(p, j);
+      err = std::max(err, std::abs(C(i, j) - s));
+    }
+  return err;
+}
+
+template <typename M>
+void randomize(M &&A)
+{
+  for (auto &a : A)
+    a = 2.0 * rand() / RAND_MAX - 1.0;
+}
+
+int main()
+{
+  int fails = 0;
+  const double tol = 1e-12;
+
+  // small, blocked (with edge panels), and multithreaded sizes
+  const int sizes[][3] = {{3, 4, 5}, {37, 29, 41}, {130, 70, 300}, {200, 190, 210}};
+  for (auto &s : sizes)
+  {
+    const int m = s[0], n = s[1], k = s[2];
+    Matrix<double> A(m, k), B(k, n), C(m, n);
+    randomize(A);
+    randomize(B);
+
+    matmul(C, A, B);
+    fails += max_error(C, A, B) > tol;
+
+    // transposed views are read in place
+    Matrix<double> At(k, m), Bt(n, k);
+    copy(At, transpose(A));
+    copy(Bt, transpose(B));
+    Matrix<double> D(m, n);
+    matmul(D, transpose(At), transpose(Bt));
+    fails += max_error(D, A, B) > tol;
+
+    // row-major result and alpha, beta
+    Tensor<double, 2, std::allocator<double>, layout::right> R(m, n);
+    for (int i = 0; i < m; i++)
+      for (int j = 0; j < n; j++)
+        R(i, j) = 1.0;
+    matmul(R, A, B, 2.0, 0.5);
+    double err = 0;
+    for (int i = 0; i < m; i++)
+      for (int j = 0; j < n; j++)
+        err = std::max(err, std::abs(R(i, j) - (2.0 * C(i, j) + 0.5)));
+    fails += err > tol;
+  }
+
+  // subviews with non-unit strides in both dimensions
+  {
+    Matrix<double> A(60, 80), B(80, 90), C(30, 30);
+    randomize(A);
+    randomize(B);
+    auto As = A.at(span(0, 60, 2), span(0, 80, 2));
+    auto Bs = B.at(span(0, 40), span(0, 90, 3));
+    matmul(C, As, Bs);
+    fails += max_error(C, As, Bs) > tol;
+  }
+
+  // float
+  {
+    Matrix<float> A(50, 60), B(60, 70), C(50, 70);
+    randomize(A);
+    randomize(B);
+    matmul(C, A, B);
+    fails += max_error(C, A, B) > 1e-4;
+  }
+
+  // batched products along the last dimension
+  {
+    const int m = 4, n = 3, k = 5, nb = 1000;
+    Cube<double> A(m, k, nb), B(k, n, nb), C(m, n, nb);
+    randomize(A);
+    randomize(B);
+    matmul(C, A, B);
+    double err = 0;
+    for (int b = 0; b < nb; b++)
+      err = std::max(err, max_error(C.at(all{}, all{}, b), A.at(all{}, all{}, b), B.at(all{}, all{}, b)));
+    fails += err > tol;
+
+    // batch of transposed matrices
+    Cube<double> Bt(n, k, nb);
+    copy(Bt, permute<1, 0, 2>(B));
+    Cube<double> D(m, n, nb);
+    matmul(D, A, permute<1, 0, 2>(Bt));
+    for (index_t i = 0; i < D.size(); i++)
+      fails += std::abs(D[i] - C[i]) > tol;
+
+    Cube<double> E(40, 40, 8), F(40, 40, 8), G(40, 40, 8);
+    randomize(E);
+    randomize(F);
+    matmul(G, E, F);
+    err = 0;
+    for (int b = 0; b < 8; b++)
+      err = std::max(err, max_error(G.at(all{}, all{}, b), E.at(all{}, all{}, b), F.at(all{}, all{}, b)));
+    fails += err > tol;
+  }
+
+  if (fails)
+  {
+    std::cout << "Matmul test failed!" << std::endl;
+  }
+  else
+  {
+    std::cout << "Matmul test passed!" << std::endl;
+  }
+
+  return fails;
+}
@@ -0,0 +1,188 @@
+#include "TensorView.hpp"
+
+#include <iostream>
+#include <cmath>
+
+using namespace tensor;
+
+struct cell
+{
+  int id;
+  float value;
+};
+
+// the value stored at a global index
+static double g(long i, long j, long k)
+{
+  return 1.0 + i + 100.0 * j + 10000.0 * k;
+}
+
+// checks every element of the local tensor (including the halo) against
+// the global values after an exchange. Halos outside of non-periodic
+// dimensions are zero, and so are edges and corners if only faces were
+// exchanged.
+template <typename T>
+static int check_halos(const T &u, const long n[3], const bool periodic[3], halo_type type)
+{
+  int fails = 0;
+  const auto &t = u.tensor();
+  const long h = u.halo();
+  for (long c = 0; c < (long)t.shape(2); c++)
+    for (long b = 0; b < (long)t.shape(1); b++)
+      for (long a = 0; a < (long)t.shape(0); a++)
+      {
+        long idx[] = {(long)u.offset(0) + a - h, (long)u.offset(1) + b - h, (long)u.offset(2) + c - h};
+        const long local[] = {a, b, c};
+        bool outside = false;
+        int in_halo = 0;
+        for (int d = 0; d < 3; d++)
+        {
+          in_halo += local[d] < h || local[d] >= h + (long)u.local_shape(d);
+          if (idx[d] < 0 || idx[d] >= n[d])
+          {
+            if (periodic[d])
+              idx[d] = (idx[d] + n[d]) % n[d];
+            else
+              outside = true;
+          }
+        }
+        const bool exchanged = !outside && (in_halo <= 1 || type == halo_type::full);
+        const double expected = exchanged ? g(idx[0], idx[1], idx[2]) : 0.0;
+        fails += t(a, b, c) != expected;
+      }
+  return fails;
+}
+
+int main(int argc, char **argv)
+{
+  MPI_Init(&argc, &argv);
+  int fails = 0;
+  {
+    const long n[] = {10, 7, 5};
+    const bool periodic[] = {true, false, false};
+
+    for (halo_type type : {halo_type::full, halo_type::faces})
+    {
+      DistributedTensor<double, 3> u(MPI_COMM_WORLD, {10, 7, 5}, 1, {true, false, false});
+      auto owned = u.owned();
+      for (index_t k = 0; k < u.local_shape(2); k++)
+        for (index_t j = 0; j < u.local_shape(1); j++)
+          for (index_t i = 0; i < u.local_shape(0); i++)
+            owned(i, j, k) = g(u.offset(0) + i, u.offset(1) + j, u.offset(2) + k);
+
+      u.exchange_halos_begin(type);
+      u.exchange_halos_end();
+      fails += check_halos(u, n, periodic, type);
+
+      // the owned blocks are gathered into the global tensor
+      auto global = u.gather(0);
+      if (u.rank() == 0)
+      {
+        for (long k = 0; k < n[2]; k++)
+          for (long j = 0; j < n[1]; j++)
+            for (long i = 0; i < n[0]; i++)
+              fails += global(i, j, k) != g(i, j, k);
+      }
+      else
+      {
+        fails += global.size() != 0;
+      }
+    }
+
+    // wide halos, a given process grid, row major storage and a type
+    // without a predefined MPI datatype
+    int n_procs;
+    MPI_Comm_size(MPI_COMM_WORLD, &n_procs);
+    std::array<int, 2> dims{0, 0};
+    MPI_Dims_create(n_procs, 2, dims.data());
+
+    const index_t m[] = {20, 12};
+    DistributedTensor<cell, 2, layout::right> w(MPI_COMM_WORLD, {m[0], m[1]}, 2, {true, true}, dims);
+    fails += w.dims() != dims;
+    for (int d = 0; d < 2; d++)
+      fails += w.local_shape(d) != m[d] / dims[d] + (w.offset(d) < (m[d] % dims[d]) * (m[d] / dims[d] + 1));
+
+    // the coordinate of the process owning global index i along d
+    auto owner_coord = [&](int d, index_t i)
+    {
+      const index_t q = m[d] / dims[d], r = m[d] % dims[d];
+      return int((i < r * (q + 1)) ? i / (q + 1) : r + (i - r * (q + 1)) / q);
+    };
+
+    auto wo = w.owned();
+    for (index_t i = 0; i < w.local_shape(0); i++)
+      for (index_t j = 0; j < w.local_shape(1); j++)
+        wo(i, j) = cell{int(w.offset(0) + i + m[0] * (w.offset(1) + j)), 0.5f * w.rank()};
+    w.exchange_halos();
+    for (index_t a = 0; a < w.local_shape(0) + 4; a++)
+      for (index_t b = 0; b < w.local_shape(1) + 4; b++)
+      {
+        const index_t i = (w.offset(0) + a + m[0] - 2) % m[0], j = (w.offset(1) + b + m[1] - 2) % m[1];
+        int coords[] = {owner_coord(0, i), owner_coord(1, j)}, owner;
+        MPI_Cart_rank(w.comm(), coords, &owner);
+        fails += w.tensor()(a, b).id != int(i + m[0] * j) || w.tensor()(a, b).value != 0.5f * owner;
+      }
+
+    // a periodic Laplacian, with the interior computed while the halos are
+    // in flight
+    DistributedTensor<double, 3> p(MPI_COMM_WORLD, {12, 9, 8}, 1, {true, true, true});
+    DistributedTensor<double, 3> q(MPI_COMM_WORLD, {12, 9, 8}, 1, {true, true, true});
+    auto po = p.owned();
+    for (index_t k = 0; k < p.local_shape(2); k++)
+      for (index_t j = 0; j < p.local_shape(1); j++)
+        for (index_t i = 0; i < p.local_shape(0); i++)
+          po(i, j, k) = std::sin(0.3 * (p.offset(0) + i)) * std::cos(0.2 * (p.offset(1) + j)) + 0.1 * (p.offset(2) + k);
+
+    const auto st = seven_point_stencil(-6.0, 1.0);
+    p.exchange_halos_begin(halo_type::faces);
+    stencil_apply(q.at(p.window(p.interior_region())), p.at(p.window(p.interior_region())), st);
+    p.exchange_halos_end();
+    for (const auto &r : p.boundary_regions())
+      stencil_apply(q.at(p.window(r)), p.at(p.window(r)), st);
+
+    auto pg = p.gather(0);
+    auto qg = q.gather(0);
+    if (p.rank() == 0)
+    {
+      Tensor<double, 3> ref(12, 9, 8);
+      stencil_apply(ref, pg, st, boundary::periodic);
+      for (index_t i = 0; i < ref.size(); i++)
+        fails += std::abs(ref[i] - qg[i]) > 1e-12;
+    }
+
+    // the boundary regions and the interior cover the owned elements once
+    Tensor<int, 3> count(p.tensor().shape(0), p.tensor().shape(1), p.tensor().shape(2));
+    auto regions = p.boundary_regions();
+    regions.push_back(p.interior_region());
+    for (const auto &r : regions)
+      for (index_t c = r[2].begin; c < r[2].end; c++)
+        for (index_t b = r[1].begin; b < r[1].end; b++)
+          for (index_t a = r[0].begin; a < r[0].end; a++)
+            count(a, b, c)++;
+    for (index_t c = 0; c < count.shape(2); c++)
+      for (index_t b = 0; b < count.shape(1); b++)
+        for (index_t a = 0; a < count.shape(0); a++)
+        {
+          const bool owned_element = a >= 1 && b >= 1 && c >= 1 && a <= p.local_shape(0) && b <= p.local_shape(1) && c <= p.local_shape(2);
+          fails += count(a, b, c) != (owned_element ? 1 : 0);
+        }
+  }
+
+  int total = 0, rank;
+  MPI_Allreduce(&fails, &total, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  if (rank == 0)
+  {
+    if (total)
+    {
+      std::cout << "Distributed test failed!" << std::endl;
+    }
+    else
+    {
+      std::cout << "Distributed test passed!" << std::endl;
+    }
+  }
+
+  MPI_Finalize();
+  return total;
+}
@@ -0,0 +1,156 @@
+#include "TensorView.hpp"
+
+#include <iostream>
+#include <fstream>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+using namespace tensor;
+
+// writes an npy file with the given header dictionary and payload
+static void write_raw(const char *path, std::string dict, const void *data, size_t bytes)
+{
+  while ((10 + dict.size() + 1) % 64 != 0)
+    dict += ' ';
+  dict += '\n';
+
+  std::ofstream out(path, std::ios::binary);
+  out.write("\x93NUMPY\x01\x00", 8);
+  const uint16_t len = dict.size();
+  const char l[2] = {char(len & 0xff), char(len >> 8)};
+  out.write(l, 2);
+  out.write(dict.data(), dict.size());
+  out.write(static_cast<const char *>(data), bytes);
+}
+
+int main()
+{
+  int fails = 0;
+  const char *path = "npy_test.npy";
+
+  const int n0 = 3, n1 = 4, n2 = 5;
+  Tensor<double, 3> x(n0, n1, n2);
+  for (index_t i = 0; i < x.size(); i++)
+    x[i] = i;
+
+  // the header is readable by NumPy and the payload is 64 byte aligned
+  save_npy(path, x);
+  {
+    std::ifstream in(path, std::ios::binary);
+    std::string file((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    fails += file.compare(0, 6, "\x93NUMPY") != 0;
+    fails += file.find("'descr': '<f8', 'fortran_order': True, 'shape': (3, 4, 5), }") == std::string::npos;
+    fails += (file.size() - x.size() * sizeof(double)) % 64 != 0;
+  }
+
+  // round trip through load and map
+  {
+    auto y = load_npy<double, 3>(path);
+    fails += y.shape(0) != n0 || y.shape(1) != n1 || y.shape(2) != n2;
+    for (index_t i = 0; i < x.size(); i++)
+      fails += y[i] != x[i];
+
+    auto z = map_npy<const double, 3>(path);
+    for (index_t i = 0; i < x.size(); i++)
+      fails += z[i] != x[i];
+  }
+
+  // C ordered arrays load into either layout
+  {
+    Tensor<float, 2, std::allocator<float>, layout::right> r(3, 7);
+    for (index_t i = 0; i < r.size(); i++)
+      r[i] = i;
+    save_npy(path, r);
+
+    auto a = load_npy<float, 2, layout::right>(path);
+    auto b = load_npy<float, 2>(path);
+    auto c = map_npy<const float, 2, layout::right>(path);
+    for (int i = 0; i < 3; i++)
+      for (int j = 0; j < 7; j++)
+        fails += a(i, j) != r(i, j) || b(i, j) != r(i, j) || c(i, j) != r(i, j);
+  }
+
+  // subviews are streamed in Fortran order
+  {
+    auto s = x.at(span(1, 3), all{}, span(0, 5, 2));
+    save_npy(path, s);
+    auto y = load_npy<double, 3>(path);
+    fails += y.shape(0) != 2 || y.shape(1) != n1 || y.shape(2) != 3;
+    for (int i = 0; i < 2; i++)
+      for (int j = 0; j < n1; j++)
+        for (int k = 0; k < 3; k++)
+          fails += y(i, j, k) != s(i, j, k);
+  }
+
+  // files in the opposite byte order are swapped on load
+  {
+    const int32_t v[3] = {1, 256, -2};
+    int32_t swapped[3];
+    for (int i = 0; i < 3; i++)
+    {
+      const unsigned char *p = reinterpret_cast<const unsigned char *>(v + i);
+      unsigned char *q = reinterpret_cast<unsigned char *>(swapped + i);
+      for (int b = 0; b < 4; b++)
+        q[b] = p[3 - b];
+    }
+    const bool little = details::is_little_endian();
+    write_raw(path, std::string("{'descr': '") + (little ? ">" : "<") + "i4', 'fortran_order': False, 'shape': (3,), }", swapped, sizeof(swapped));
+
+    auto y = load_npy<int32_t, 1>(path);
+    fails += y.shape(0) != 3 || y(0) != 1 || y(1) != 256 || y(2) != -2;
+  }
+
+  // mismatched dtype, rank, order, or byte order
+  save_npy(path, x);
+  int caught = 0;
+  try
+  {
+    load_npy<float, 3>(path);
+  }
+  catch (const std::runtime_error &)
+  {
+    caught++;
+  }
+  try
+  {
+    load_npy<double, 2>(path);
+  }
+  catch (const std::runtime_error &)
+  {
+    caught++;
+  }
+  try
+  {
+    map_npy<const double, 3, layout::right>(path);
+  }
+  catch (const std::runtime_error &)
+  {
+    caught++;
+  }
+  try
+  {
+    const int32_t v = 0;
+    write_raw(path, std::string("{'descr': '") + (details::is_little_endian() ? ">" : "<") + "i4', 'fortran_order': False, 'shape': (1,), }", &v, sizeof(v));
+    map_npy<const int32_t, 1>(path);
+  }
+  catch (const std::runtime_error &)
+  {
+    caught++;
+  }
+  fails += caught != 4;
+
+  std::remove(path);
+
+  if (fails)
+  {
+    std::cout << "Npy test failed!" << std::endl;
+  }
+  else
+  {
+    std::cout << "Npy test passed!" << std::endl;
+  }
+
+  return fails;
+}
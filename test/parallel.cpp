@@ -0,0 +1,122 @@
+#include "TensorView.hpp"
+
+#include <iostream>
+#include <cmath>
+#include <functional>
+
+using namespace tensor;
+
+template <typename Executor>
+int test_executor(Executor &&exec)
+{
+  int fails = 0;
+
+  const int n0 = 7, n1 = 5, n2 = 37;
+  Tensor<double, 3> x(n0, n1, n2);
+  for (index_t i = 0; i < x.size(); i++)
+    x[i] = i;
+
+  // every element is visited exactly once
+  Tensor<int, 3> count(n0, n1, n2);
+  for (index_t dim = 0; dim < 3; dim++)
+    parallel_for(exec, count, [](auto slab)
+                 {
+                   for (int &c : slab)
+                     c++; }, dim);
+  for (int c : count)
+    fails += c != 3;
+
+  parallel_for_each(exec, x, [](double &e)
+                    { e *= 2.0; });
+  for (index_t i = 0; i < x.size(); i++)
+    fails += x[i] != 2.0 * i;
+
+  // slabs are views of the tensor, so expressions can be assigned to them
+  Tensor<double, 3> y(n0, n1, n2);
+  parallel_for(exec, y, [](auto slab)
+               { slab = 0.5 * slab + 1.0; });
+  for (double e : y)
+    fails += e != 1.0;
+
+  const double n = x.size();
+  const double s = parallel_reduce(exec, x, 0.0, std::plus<>{});
+  fails += s != n * (n - 1);
+
+  const double mx = parallel_reduce(
+      exec, x, -INFINITY, [](double a, double b)
+      { return std::max(a, b); },
+      0);
+  fails += mx != 2.0 * (n - 1);
+
+  // subviews and row-major tensors
+  auto sub = x.at(span(1, 6), all{}, span(0, 30, 3));
+  double rsum = 0;
+  for (double e : sub)
+    rsum += e;
+  fails += parallel_reduce(exec, sub, 0.0, std::plus<>{}) != rsum;
+
+  Tensor<double, 2, std::allocator<double>, layout::right> r(100, 3);
+  for (index_t i = 0; i < r.size(); i++)
+    r.data()[i] = 1.0;
+  fails += parallel_reduce(exec, r, 0.0, std::plus<>{}) != 300.0;
+
+  return fails;
+}
+
+int main()
+{
+  int fails = 0;
+
+  fails += test_executor(sequential_executor{});
+
+  thread_pool pool(4);
+  fails += pool.concurrency() != 4;
+  fails += test_executor(pool);
+  fails += test_executor(default_executor());
+
+#ifdef _OPENMP
+  fails += test_executor(openmp_executor{});
+#endif
+
+#ifdef TENSOR_USE_TBB
+  fails += test_executor(tbb_executor{});
+#endif
+
+#ifdef TENSOR_USE_STD_EXECUTION
+  fails += test_executor(std_executor{});
+#endif
+
+  // irregular tasks are balanced by stealing, nested calls run inline
+  Tensor<double, 1> w(64);
+  parallel_for(pool, w, [&](auto slab)
+               {
+                 parallel_for(pool, slab, [](auto s)
+                              {
+                                for (double &e : s)
+                                  e = 1.0; }); });
+  fails += sum(w) != 64.0;
+
+  // exceptions thrown by a task are rethrown by the caller
+  bool caught = false;
+  try
+  {
+    parallel_for(pool, w, [](auto)
+                 { throw std::runtime_error("task failed"); });
+  }
+  catch (const std::runtime_error &)
+  {
+    caught = true;
+  }
+  fails += !caught;
+
+  if (fails)
+  {
+    std::cout << "Parallel test failed!" << std::endl;
+  }
+  else
+  {
+    std::cout << "Parallel test passed!" << std::endl;
+  }
+
+  return fails;
+}
@@ -0,0 +1,99 @@
+#ifndef TENSOR_PROFILE
+#define TENSOR_PROFILE
+#endif
+#include "TensorView.hpp"
+
+#include <iostream>
+#include <sstream>
+#include <string>
+
+using namespace tensor;
+
+static const profile::site_stats *find_site(const std::vector<profile::site_stats> &sites, const std::string &name)
+{
+  for (auto &s : sites)
+    if (s.name == name)
+      return &s;
+  return nullptr;
+}
+
+int main()
+{
+  int fails = 0;
+
+  Tensor<double, 2> x(4, 6);
+  profile::reset();
+
+  // accesses are attributed to the innermost range
+  {
+    profile::range r("fill");
+    for (index_t j = 0; j < 6; j++)
+      for (index_t i = 0; i < 4; i++)
+        x(i, j) = i + j;
+  }
+  {
+    profile::range r("sum");
+    double s = 0;
+    for (index_t i = 0; i < x.size(); i++)
+      s += x[i];
+    for (double v : x)
+      s += v;
+    fails += s != 2 * 96.0;
+
+    auto y = x.at(span(1, 3), all{});
+    {
+      profile::range inner("subview");
+      for (double v : y)
+        s += v;
+    }
+  }
+  x(0, 0) = 1.0; // outside of all ranges
+
+  auto sites = profile::sites();
+  const auto *fill = find_site(sites, "fill");
+  const auto *sum = find_site(sites, "sum");
+  const auto *sub = find_site(sites, "subview");
+  const auto *root = find_site(sites, "<no range>");
+  fails += !fill || !sum || !sub || !root;
+  if (fill && sum && sub && root)
+  {
+    fails += fill->calls != 1 || fill->count.element_accesses != 24 || fill->count.bytes != 24 * sizeof(double);
+    fails += std::string(fill->site.file).find("profile.cpp") == std::string::npos || fill->site.line == 0;
+    fails += sum->count.linear_accesses != 24 || sum->count.iterator_accesses != 24 || sum->count.subviews != 1;
+    fails += sub->count.iterator_accesses != 12;
+    fails += root->count.element_accesses != 1;
+  }
+
+  // views are told apart by their first element and shape
+  auto views = profile::views();
+  fails += views.empty();
+  if (!views.empty())
+  {
+    fails += views[0].data != x.data() || views[0].rank != 2 || views[0].shape[0] != 4 || views[0].shape[1] != 6;
+    fails += !views[0].unit_stride || views[0].strides[1] != 4;
+    fails += views[0].count.element_accesses != 25 || views[0].count.linear_accesses != 24 || views[0].count.subviews != 1;
+  }
+
+  // bulk operations open their own ranges
+  Tensor<double, 2> z(4, 6);
+  copy(z, x);
+  fails += find_site(profile::sites(), "tensor::copy") == nullptr;
+
+  std::ostringstream out;
+  profile::report(out);
+  fails += out.str().find("fill") == std::string::npos;
+
+  profile::reset();
+  fails += !profile::sites().empty() || !profile::views().empty();
+
+  if (fails)
+  {
+    std::cout << "Profile test failed!" << std::endl;
+  }
+  else
+  {
+    std::cout << "Profile test passed!" << std::endl;
+  }
+
+  return fails;
+}
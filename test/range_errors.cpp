@@ -9,7 +9,7 @@ int main()
   double data[6] = {1, 2, 3, 4, 5, 6};
   TensorView<double, 2> tensor_view(data, 2, 3);
 
-#ifdef TENSOR_DEBUG
+#ifdef TENSOR_CHECK_BOUNDS
   int fails = 3;
   
   try
@@ -0,0 +1,187 @@
+#include "TensorView.hpp"
+
+#include <iostream>
+#include <cmath>
+
+using namespace tensor;
+
+template <typename T>
+static int check(T value, T expected, const char *name)
+{
+  const T tol = 100 * std::numeric_limits<T>::epsilon() * std::max(T(1), std::abs(expected));
+  if (std::abs(value - expected) > tol)
+  {
+    std::cout << name << " = " << value << " != " << expected << std::endl;
+    return 1;
+  }
+  return 0;
+}
+
+int main()
+{
+  // odd sizes so that the tails of the vector kernels are exercised
+  const int n0 = 7, n1 = 13, n2 = 5;
+  Tensor<double, 3> x(n0, n1, n2), y(n0, n1, n2);
+  Tensor<float, 1> f(101);
+  for (index_t i = 0; i < x.size(); i++)
+  {
+    x[i] = static_cast<double>(rand()) / RAND_MAX - 0.5;
+    y[i] = static_cast<double>(rand()) / RAND_MAX - 0.5;
+  }
+  for (index_t i = 0; i < f.size(); i++)
+    f[i] = static_cast<float>(rand()) / RAND_MAX - 0.5f;
+
+  int fails = 0;
+
+  double s = 0, d = 0, ss = 0, m = 0, lo = x[0], hi = x[0];
+  for (index_t i = 0; i < x.size(); i++)
+  {
+    s += x[i];
+    d += x[i] * y[i];
+    ss += x[i] * x[i];
+    m = std::max(m, std::abs(x[i]));
+    lo = std::min(lo, x[i]);
+    hi = std::max(hi, x[i]);
+  }
+
+  fails += check(sum(x), s, "sum(x)");
+  fails += check(dot(x, y), d, "dot(x, y)");
+  fails += check(norm2(x), std::sqrt(ss), "norm2(x)");
+  fails += check(max_abs(x), m, "max_abs(x)");
+  fails += check(min(x), lo, "min(x)");
+  fails += check(max(x), hi, "max(x)");
+
+  float fs = 0;
+  for (index_t i = 0; i < f.size(); i++)
+    fs += f[i];
+  fails += check(sum(f), fs, "sum(f)");
+
+  // strided
+  auto xs = x.at(span(1, 7, 2), all{}, 3);
+  auto ys = y.at(span(1, 7, 2), all{}, 3);
+  s = 0, d = 0, m = 0;
+  for (int i = 0; i < 3; i++)
+  {
+    for (int j = 0; j < n1; j++)
+    {
+      s += xs(i, j);
+      d += xs(i, j) * ys(i, j);
+      m = std::max(m, std::abs(xs(i, j)));
+    }
+  }
+
+  fails += check(sum(xs), s, "sum(xs)");
+  fails += check(dot(xs, ys), d, "dot(xs, ys)");
+  fails += check(max_abs(xs), m, "max_abs(xs)");
+
+  // axis reductions
+  for (int dim = 0; dim < 3; dim++)
+  {
+    auto r = sum(x, dim);
+    auto a = max_abs(x, dim);
+    for (int i = 0; i < n0; i++)
+      for (int j = 0; j < n1; j++)
+        for (int k = 0; k < n2; k++)
+        {
+          const int idx[] = {i, j, k};
+          if (idx[dim] != 0)
+            continue;
+
+          double expected = 0, expected_abs = 0;
+          for (index_t l = 0; l < x.shape(dim); l++)
+          {
+            const double v = (dim == 0) ? x(l, j, k) : (dim == 1) ? x(i, l, k) : x(i, j, l);
+            expected += v;
+            expected_abs = std::max(expected_abs, std::abs(v));
+          }
+
+          const double value = (dim == 0) ? r(j, k) : (dim == 1) ? r(i, k) : r(i, j);
+          const double value_abs = (dim == 0) ? a(j, k) : (dim == 1) ? a(i, k) : a(i, j);
+          fails += check(value, expected, "sum(x, dim)");
+          fails += check(value_abs, expected_abs, "max_abs(x, dim)");
+        }
+  }
+
+  auto rs = sum(xs, 1);
+  for (int i = 0; i < 3; i++)
+  {
+    double expected = 0;
+    for (int j = 0; j < n1; j++)
+      expected += xs(i, j);
+    fails += check(rs(i), expected, "sum(xs, 1)");
+  }
+
+  // expressions are reduced without temporaries and match the reductions of
+  // the evaluated expression
+  Tensor<double, 3> z(n0, n1, n2), w(n0, n1, n2);
+  z = x * y;
+  w = abs(x - y);
+  fails += check(sum(x * y), sum(z), "sum(x * y)");
+  fails += check(dot(x - y, x + y), dot(x, x) - dot(y, y), "dot(x - y, x + y)");
+  fails += check(max(abs(x - y)), max(w), "max(abs(x - y))");
+  fails += check(max_abs(x - y), max(w), "max_abs(x - y)");
+  fails += check(min(abs(x - y)), min(w), "min(abs(x - y))");
+  fails += check(norm2(x - y), std::sqrt(sum(w * w)), "norm2(x - y)");
+  fails += check(sum(2.0 * xs + ys), 2.0 * sum(xs) + sum(ys), "sum(2 * xs + ys)");
+  for (int dim = 0; dim < 3; dim++)
+  {
+    auto r = sum(x * y, dim);
+    auto a = max_abs(x - y, dim);
+    auto er = sum(z, dim);
+    auto ea = max_abs(w, dim);
+    for (index_t i = 0; i < r.size(); i++)
+    {
+      fails += check(r[i], er[i], "sum(x * y, dim)");
+      fails += check(a[i], ea[i], "max_abs(x - y, dim)");
+    }
+  }
+  auto es = sum(xs * ys, 1);
+  for (int i = 0; i < 3; i++)
+  {
+    double expected = 0;
+    for (int j = 0; j < n1; j++)
+      expected += xs(i, j) * ys(i, j);
+    fails += check(es(i), expected, "sum(xs * ys, 1)");
+  }
+
+  // longer than one block, and mixed layouts
+  Tensor<double, 2> u(45, 31), v(45, 31);
+  Tensor<double, 2, std::allocator<double>, layout::right> ur(45, 31);
+  for (index_t i = 0; i < u.size(); i++)
+  {
+    u[i] = std::sin(0.1 * i);
+    v[i] = std::cos(0.1 * i);
+  }
+  copy(ur, u);
+  double uv = 0;
+  for (index_t i = 0; i < u.size(); i++)
+    uv += (u[i] + v[i]) * (u[i] - v[i]);
+  fails += check(dot(u + v, u - v), uv, "dot(u + v, u - v)");
+  fails += check(sum(ur * v), dot(u, v), "sum(ur * v)");
+  fails += check(max_abs(ur - u), 0.0, "max_abs(ur - u)");
+  auto ru = sum(ur * v, 0);
+  for (int j = 0; j < 31; j++)
+  {
+    double expected = 0;
+    for (int i = 0; i < 45; i++)
+      expected += u(i, j) * v(i, j);
+    fails += check(ru(j), expected, "sum(ur * v, 0)");
+  }
+
+  thread_pool pool(3);
+  fails += check(parallel_reduce(pool, u * v, 0.0, std::plus<>{}), dot(u, v), "parallel_reduce(u * v)");
+  fails += check(parallel_reduce(pool, abs(ur - v), 0.0, [](double a, double b)
+                                 { return std::max(a, b); }),
+                 max_abs(u - v), "parallel_reduce(abs(ur - v))");
+
+  if (fails)
+  {
+    std::cout << "Reductions test failed!" << std::endl;
+  }
+  else
+  {
+    std::cout << "Reductions test passed!" << std::endl;
+  }
+
+  return fails;
+}
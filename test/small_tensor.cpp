@@ -0,0 +1,140 @@
+#include "TensorView.hpp"
+
+#include <iostream>
+#include <cmath>
+
+using namespace tensor;
+
+// counts the allocations made through it.
+template <typename T>
+struct counting_allocator : std::allocator<T>
+{
+  static inline int allocations = 0;
+
+  template <typename U>
+  struct rebind
+  {
+    using other = counting_allocator<U>;
+  };
+
+  counting_allocator() = default;
+
+  template <typename U>
+  counting_allocator(const counting_allocator<U> &) {}
+
+  T *allocate(size_t n)
+  {
+    ++allocations;
+    return std::allocator<T>::allocate(n);
+  }
+};
+
+template <typename A>
+static bool inside(const A &a)
+{
+  auto p = reinterpret_cast<const char *>(a.data());
+  auto q = reinterpret_cast<const char *>(&a);
+  return p >= q && p < q + sizeof(A);
+}
+
+int main()
+{
+  int fails = 0;
+  using alloc = counting_allocator<double>;
+
+  // within the capacity nothing is allocated and the elements are zero
+  SmallTensor<double, 2, 36, alloc> A(5, 5);
+  fails += !A.is_inline() || !inside(A) || A.size() != 25 || A.shape(0) != 5 || A.shape(1) != 5;
+  for (auto x : A)
+    fails += x != 0.0;
+
+  for (index_t j = 0; j < 5; j++)
+    for (index_t i = 0; i < 5; i++)
+      A(i, j) = i + 10.0 * j;
+
+  // copies and moves of an inline tensor are inline
+  auto B = A;
+  fails += !inside(B) || B.data() == A.data();
+  auto C = std::move(B);
+  fails += !inside(C);
+  for (index_t i = 0; i < 25; i++)
+    fails += C[i] != A[i];
+
+  SmallTensor<double, 2, 36, alloc> D(uninitialized, 6, 6);
+  fails += !D.is_inline() || D.size() != 36;
+  fails += alloc::allocations != 0;
+
+  // the BaseTensor API: expressions, subviews and reductions
+  D.reshape_discard(5, 5);
+  D = 2.0 * A - 1.0;
+  auto col = D.at(all{}, 2);
+  for (index_t i = 0; i < 5; i++)
+    fails += col(i) != 2.0 * (i + 20.0) - 1.0;
+  fails += max_abs(D) != 2.0 * 44.0 - 1.0;
+
+  SmallMatrix<double, 25> P(5, 5);
+  matmul(P, A, D);
+  Matrix<double> R(5, 5), Ad(5, 5), Dd(5, 5);
+  copy(Ad, A);
+  copy(Dd, D);
+  matmul(R, Ad, Dd);
+  for (index_t i = 0; i < 25; i++)
+    fails += std::abs(P[i] - R[i]) > 1e-12;
+  fails += alloc::allocations != 0;
+
+  // beyond the capacity the elements spill to the heap, preserving their
+  // values in memory order
+  A.reshape(5, 10);
+  fails += A.is_inline() || inside(A) || alloc::allocations != 1;
+  for (index_t j = 0; j < 5; j++)
+    for (index_t i = 0; i < 5; i++)
+      fails += A(i, j) != i + 10.0 * j;
+  for (index_t j = 5; j < 10; j++)
+    for (index_t i = 0; i < 5; i++)
+      fails += A(i, j) != 0.0;
+
+  // copies allocate, moves take the array
+  auto E = A;
+  fails += E.is_inline() || alloc::allocations != 2 || E(4, 4) != 44.0;
+  const double *p = A.data();
+  auto F = std::move(A);
+  fails += F.data() != p || alloc::allocations != 2;
+
+  // the memory is reused when the tensor shrinks
+  F.reshape_discard(3, 3);
+  fails += F.data() != p || F.size() != 9;
+  F.reshape(7, 7);
+  fails += F.data() != p || alloc::allocations != 2;
+
+  // assigning an inline tensor reuses the memory
+  E = C;
+  fails += E.size() != 25 || E(3, 2) != 23.0 || alloc::allocations != 2;
+
+  // row major, rank 3 and reshaped views
+  SmallTensor<int, 3, 64, std::allocator<int>, layout::right> G(2, 3, 4);
+  for (index_t i = 0; i < G.size(); i++)
+    G[i] = i;
+  fails += G(1, 2, 3) != 23 || G(0, 1, 0) != 4;
+  auto g = reshape(G, 6, 4);
+  fails += g(5, 3) != 23;
+
+  SmallVector<float, 4> v;
+  fails += v.size() != 0 || !v.is_inline();
+  v.reshape(3);
+  v(2) = 1.5f;
+  v.reshape(6);
+  fails += v.is_inline() || v(2) != 1.5f || v(5) != 0.0f;
+
+  static_assert(SmallVector<float, 4>::inline_capacity() == 4, "inline_capacity");
+
+  if (fails)
+  {
+    std::cout << "SmallTensor test failed!" << std::endl;
+  }
+  else
+  {
+    std::cout << "SmallTensor test passed!" << std::endl;
+  }
+
+  return fails;
+}
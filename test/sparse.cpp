@@ -0,0 +1,162 @@
+#include "TensorView.hpp"
+
+#include <iostream>
+#include <cmath>
+
+using namespace tensor;
+
+static_assert(std::is_trivially_copyable_v<CsrView<double>>, "CsrView must be trivially copyable.");
+static_assert(std::is_trivially_copyable_v<BsrView<const float, 4, 2, int>>, "BsrView must be trivially copyable.");
+
+// a random n x m matrix with about one nonzero in `sparsity` elements, and a
+// few dense rows.
+static Matrix<double> random_sparse(index_t n, index_t m, int sparsity)
+{
+  Matrix<double> A(n, m);
+  for (index_t j = 0; j < m; j++)
+    for (index_t i = 0; i < n; i++)
+      if (rand() % sparsity == 0 || i == 3)
+        A(i, j) = static_cast<double>(rand()) / RAND_MAX - 0.5;
+  return A;
+}
+
+template <typename A, typename B>
+static int compare(const A &a, const B &b)
+{
+  int fails = 0;
+  for (index_t i = 0; i < a.size(); i++)
+    fails += std::abs(a[i] - b[i]) > 1e-12;
+  return fails;
+}
+
+template <typename Executor>
+static int test_executor(Executor &&exec)
+{
+  int fails = 0;
+
+  const index_t n = 300, m = 180, k = 7;
+  const auto D = random_sparse(n, m, 20);
+  const auto A = csr_from_dense(D);
+
+  Vector<double> x(m), y(n), ref(n), y0(n);
+  for (index_t j = 0; j < m; j++)
+    x(j) = std::sin(0.3 * j);
+  for (index_t i = 0; i < n; i++)
+    y0(i) = std::cos(0.7 * i);
+
+  // y = A * x, then y = 2 A x - y0
+  matmul(reshape(ref.data(), n, 1), D, reshape(x.data(), m, 1));
+  spmv(exec, y, A, x);
+  fails += compare(y, ref);
+
+  copy(y, y0);
+  spmv(exec, y, A.view(), x, 2.0, -1.0);
+  Vector<double> e(n);
+  e = 2.0 * ref - y0;
+  fails += compare(y, e);
+
+  // strided vectors
+  Matrix<double> X(2, m), Y(3, n);
+  for (index_t j = 0; j < m; j++)
+    X(1, j) = x(j);
+  spmv(exec, Y.at(2, all{}), A, X.at(1, all{}));
+  for (index_t i = 0; i < n; i++)
+    fails += std::abs(Y(2, i) - ref(i)) > 1e-12 || Y(0, i) != 0.0;
+
+  // C = A * B, column and row major
+  Matrix<double> B(m, k), C(n, k), R(n, k);
+  for (index_t i = 0; i < B.size(); i++)
+    B[i] = std::sin(0.1 * i);
+  matmul(R, D, B);
+  spmm(exec, C, A, B);
+  fails += compare(C, R);
+
+  Tensor<double, 2, std::allocator<double>, layout::right> Br(m, k), Cr(n, k);
+  copy(Br, B);
+  spmm(exec, Cr, A, Br);
+  for (index_t i = 0; i < n; i++)
+    for (index_t j = 0; j < k; j++)
+      fails += std::abs(Cr(i, j) - R(i, j)) > 1e-12;
+
+  // more columns than one accumulated block
+  Matrix<double> Bw(m, 150), Cw(n, 150), Rw(n, 150);
+  for (index_t i = 0; i < Bw.size(); i++)
+    Bw[i] = std::cos(0.01 * i);
+  matmul(Rw, D, Bw);
+  copy(Cw, Rw);
+  spmm(exec, Cw, A, Bw, 1.0, -1.0);
+  fails += max_abs(Cw) > 1e-12;
+
+  // block sparse
+  const auto Ab = bsr_from_csr<4, 3>(A);
+  fails += Ab.rows() != n || Ab.cols() != m;
+  Vector<double> yb(n);
+  spmv(exec, yb, Ab, x);
+  fails += compare(yb, ref);
+
+  return fails;
+}
+
+int main()
+{
+  int fails = 0;
+
+  fails += test_executor(sequential_executor{});
+  thread_pool pool(3);
+  fails += test_executor(pool);
+
+  // triplets in any order, with duplicates and empty rows
+  Vector<index_t> I(6), J(6);
+  Vector<double> V(6);
+  const index_t ti[] = {2, 0, 2, 0, 2, 4}, tj[] = {1, 3, 0, 3, 1, 4};
+  const double tv[] = {1.0, 2.0, 3.0, 4.0, 5.0, 6.0};
+  for (index_t p = 0; p < 6; p++)
+  {
+    I(p) = ti[p];
+    J(p) = tj[p];
+    V(p) = tv[p];
+  }
+  const auto T = csr_from_triplets<int>(5, 5, I, J, V);
+  fails += T.nnz() != 4;
+  fails += T(0, 3) != 6.0 || T(2, 0) != 3.0 || T(2, 1) != 6.0 || T(4, 4) != 6.0 || T(1, 1) != 0.0 || T(4, 0) != 0.0;
+  fails += T.row_offsets()[1] != 1 || T.row_offsets()[2] != 1 || T.row_offsets()[5] != 4 || T.columns()[1] != 0;
+
+  // the views of a block sparse matrix are fixed size
+  const auto Tb = bsr_from_csr<1, 5>(T);
+  fails += Tb.nnzb() != 3;
+  fixed_matrix_view<const double, 1, 5> b = Tb.block(1);
+  fails += b(0, 0) != 3.0 || b(0, 1) != 6.0 || b(0, 2) != 0.0;
+
+  // large enough to be split between the default executor's threads, with
+  // float values and int indices
+  const index_t n = 30000;
+  Vector<int> Li(3 * n - 2), Lj(3 * n - 2);
+  Vector<float> Lv(3 * n - 2);
+  index_t p = 0;
+  for (index_t i = 0; i < n; i++)
+    for (index_t j = (i > 0 ? i - 1 : 0); j < std::min(n, i + 2); j++, p++)
+    {
+      Li(p) = i;
+      Lj(p) = j;
+      Lv(p) = (i == j) ? 2.0f : -1.0f;
+    }
+  CsrMatrix<float, int> L = csr_from_triplets<int>(n, n, Li, Lj, Lv);
+  Vector<float> u(n), Lu(n);
+  for (index_t i = 0; i < n; i++)
+    u(i) = float(i % 5);
+  spmv(Lu, L, u);
+  for (index_t i = 1; i + 1 < n; i++)
+    fails += Lu(i) != 2.0f * u(i) - u(i - 1) - u(i + 1);
+  fails += Lu(0) != 2.0f * u(0) - u(1);
+
+  if (fails)
+  {
+    std::cout << "Sparse test failed!" << std::endl;
+  }
+  else
+  {
+    std::cout << "Sparse test passed!" << std::endl;
+  }
+
+  return fails;
+}
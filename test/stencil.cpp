@@ -0,0 +1,171 @@
+#include "TensorView.hpp"
+
+#include <iostream>
+#include <cmath>
+
+using namespace tensor;
+
+// in(i + off) with the boundary handling of b, or 0.
+template <typename T>
+static double fetch(const T &in, long i, long j, long k, boundary b)
+{
+  const long n[] = {(long)in.shape(0), (long)in.shape(1), (long)in.shape(2)};
+  long idx[] = {i, j, k};
+  for (int d = 0; d < 3; d++)
+  {
+    if (idx[d] >= 0 && idx[d] < n[d])
+      continue;
+    if (b == boundary::zero)
+      return 0.0;
+    if (b == boundary::clamp)
+      idx[d] = (idx[d] < 0) ? 0 : n[d] - 1;
+    else
+      idx[d] = ((idx[d] % n[d]) + n[d]) % n[d];
+  }
+  return in(idx[0], idx[1], idx[2]);
+}
+
+// the 27 point stencil written out with operator().
+template <typename Out, typename In>
+static void reference(Out &&out, const In &in, const double w[4], boundary b)
+{
+  const long n0 = in.shape(0), n1 = in.shape(1), n2 = in.shape(2);
+  for (long k = 0; k < n2; k++)
+    for (long j = 0; j < n1; j++)
+      for (long i = 0; i < n0; i++)
+      {
+        const bool interior = i > 0 && j > 0 && k > 0 && i + 1 < n0 && j + 1 < n1 && k + 1 < n2;
+        if (!interior && b == boundary::none)
+          continue;
+
+        double s = 0;
+        for (long c = -1; c <= 1; c++)
+          for (long bb = -1; bb <= 1; bb++)
+            for (long a = -1; a <= 1; a++)
+              s += w[(a != 0) + (bb != 0) + (c != 0)] * fetch(in, i + a, j + bb, k + c, b);
+        out(i, j, k) = s;
+      }
+}
+
+template <typename A, typename B>
+static int compare(const A &a, const B &b)
+{
+  int fails = 0;
+  for (index_t k = 0; k < a.shape(2); k++)
+    for (index_t j = 0; j < a.shape(1); j++)
+      for (index_t i = 0; i < a.shape(0); i++)
+        fails += std::abs(a(i, j, k) - b(i, j, k)) > 1e-12;
+  return fails;
+}
+
+template <typename Executor>
+static int test_executor(Executor &&exec)
+{
+  int fails = 0;
+
+  const index_t n0 = 13, n1 = 6, n2 = 9;
+  Tensor<double, 3> u(n0, n1, n2);
+  for (index_t i = 0; i < u.size(); i++)
+    u[i] = std::sin(0.37 * i);
+
+  // the seven point Laplacian matches the stencil written with operator()
+  Tensor<double, 3> lap(n0, n1, n2), ref(n0, n1, n2);
+  stencil_apply(exec, lap, u, seven_point_stencil(-6.0, 1.0));
+  for (index_t k = 1; k + 1 < n2; k++)
+    for (index_t j = 1; j + 1 < n1; j++)
+      for (index_t i = 1; i + 1 < n0; i++)
+        ref(i, j, k) = u(i - 1, j, k) + u(i + 1, j, k) + u(i, j - 1, k) + u(i, j + 1, k) + u(i, j, k - 1) + u(i, j, k + 1) - 6.0 * u(i, j, k);
+  fails += compare(lap, ref);
+
+  // the 27 point stencil with every boundary treatment
+  const double w[] = {-4.0, 0.5, 0.25, 0.125};
+  const auto st = twenty_seven_point_stencil(w[0], w[1], w[2], w[3]);
+  for (boundary b : {boundary::none, boundary::zero, boundary::clamp, boundary::periodic})
+  {
+    Tensor<double, 3> v(n0, n1, n2), r(n0, n1, n2);
+    stencil_apply(exec, v, u, st, b);
+    reference(r, u, w, b);
+    fails += compare(v, r);
+  }
+
+  // subviews (non unit stride) and row-major tensors
+  auto sub = u.at(span(0, n0, 2), all{}, span(1, n2));
+  Tensor<double, 3> vs(sub.shape(0), sub.shape(1), sub.shape(2)), rs(sub.shape(0), sub.shape(1), sub.shape(2));
+  stencil_apply(exec, vs, sub, st, boundary::clamp);
+  reference(rs, sub, w, boundary::clamp);
+  fails += compare(vs, rs);
+
+  Tensor<double, 3, std::allocator<double>, layout::right> ur(n0, n1, n2), vr(n0, n1, n2), rr(n0, n1, n2);
+  copy(ur, u);
+  stencil_apply(exec, vr, ur, st, boundary::periodic);
+  reference(rr, ur, w, boundary::periodic);
+  fails += compare(vr, rr);
+
+  // into a subview of a larger tensor
+  Tensor<double, 3> big(n0 + 2, n1 + 2, n2 + 2);
+  stencil_apply(exec, big.at(span(1, n0 + 1), span(1, n1 + 1), span(1, n2 + 1)), u, st, boundary::zero);
+  Tensor<double, 3> rz(n0, n1, n2);
+  reference(rz, u, w, boundary::zero);
+  fails += compare(big.at(span(1, n0 + 1), span(1, n1 + 1), span(1, n2 + 1)), rz);
+  fails += big(0, 0, 0) != 0.0;
+
+  return fails;
+}
+
+int main()
+{
+  int fails = 0;
+
+  fails += test_executor(sequential_executor{});
+  thread_pool pool(3);
+  fails += test_executor(pool);
+
+  // fixed size tensors and other ranks
+  FixedTensor<double, 8> x;
+  for (index_t i = 0; i < 8; i++)
+    x[i] = i * i;
+  FixedTensor<double, 8> d2;
+  stencil_apply(d2, x, stencil<double, point<-1>, point<0>, point<1>>{{1.0, -2.0, 1.0}}, boundary::zero);
+  for (index_t i = 1; i + 1 < 8; i++)
+    fails += d2(i) != 2.0;
+  fails += d2(0) != 1.0 || d2(7) != 36.0 - 98.0;
+
+  Tensor<float, 2> a(33, 20), g(33, 20);
+  for (index_t i = 0; i < a.size(); i++)
+    a[i] = float(i % 33);
+  stencil_apply(pool, g, a, stencil<float, point<1, 0>, point<-1, 0>>{{0.5f, -0.5f}});
+  for (index_t j = 0; j < 20; j++)
+    for (index_t i = 1; i + 1 < 33; i++)
+      fails += g(i, j) != 1.0f;
+  fails += g(0, 0) != 0.0f || g(32, 19) != 0.0f;
+
+  // long rows are visited in several cache blocks
+  Tensor<double, 3> p(2000, 12, 4), q(2000, 12, 4);
+  for (index_t i = 0; i < p.size(); i++)
+    p[i] = double(i % 7);
+  stencil_apply(pool, q, p, seven_point_stencil(-6.0, 1.0));
+  for (index_t k = 1; k + 1 < 4; k++)
+    for (index_t j = 1; j + 1 < 12; j++)
+      for (index_t i = 1; i + 1 < 2000; i++)
+        fails += q(i, j, k) != p(i - 1, j, k) + p(i + 1, j, k) + p(i, j - 1, k) + p(i, j + 1, k) + p(i, j, k - 1) + p(i, j, k + 1) - 6.0 * p(i, j, k);
+
+  // stencils wider than the tensor are all halo
+  Tensor<double, 3> tiny(2, 1, 3), out(2, 1, 3), rt(2, 1, 3);
+  for (index_t i = 0; i < tiny.size(); i++)
+    tiny[i] = i + 1.0;
+  const double w[] = {1.0, 2.0, 3.0, 4.0};
+  stencil_apply(pool, out, tiny, twenty_seven_point_stencil(w[0], w[1], w[2], w[3]), boundary::periodic);
+  reference(rt, tiny, w, boundary::periodic);
+  fails += compare(out, rt);
+
+  if (fails)
+  {
+    std::cout << "Stencil test failed!" << std::endl;
+  }
+  else
+  {
+    std::cout << "Stencil test passed!" << std::endl;
+  }
+
+  return fails;
+}
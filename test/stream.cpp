@@ -0,0 +1,191 @@
+#include "TensorView.hpp"
+
+#include <iostream>
+#include <cstdio>
+#include <cstdint>
+
+using namespace tensor;
+
+int main()
+{
+  int fails = 0;
+  const char *path = "stream_test.tv";
+  const char *npy_path = "stream_test.npy";
+
+  const index_t n0 = 5, n1 = 7, n2 = 3, n_frames = 10;
+  auto frame_value = [](index_t t, index_t i, index_t j, index_t k)
+  { return 1000.0f * t + 100.0f * i + 10.0f * j + k; };
+
+  // write frames with acquire/submit and with write, on two threads
+  for (const char *p : {path, npy_path})
+  {
+    {
+      stream_options options;
+      options.buffers = 3;
+      options.threads = 2;
+      StreamWriter<float, 3> w(p, {n0, n1, n2}, options);
+      Tensor<float, 3> x(n0, n1, n2);
+      for (index_t t = 0; t < n_frames; t++)
+      {
+        if (t % 2 == 0)
+        {
+          auto f = w.acquire();
+          fails += reinterpret_cast<std::uintptr_t>(f.data()) % direct_io_alignment != 0;
+          for (index_t k = 0; k < n2; k++)
+            for (index_t j = 0; j < n1; j++)
+              for (index_t i = 0; i < n0; i++)
+                f(i, j, k) = frame_value(t, i, j, k);
+          w.submit();
+        }
+        else
+        {
+          for (index_t k = 0; k < n2; k++)
+            for (index_t j = 0; j < n1; j++)
+              for (index_t i = 0; i < n0; i++)
+                x(i, j, k) = frame_value(t, i, j, k);
+          w.write(x);
+        }
+      }
+      fails += w.frames() != n_frames;
+      w.close();
+    }
+
+    // read them back, with more buffers than frames left at the end
+    {
+      stream_options options;
+      options.buffers = 4;
+      options.threads = 3;
+      StreamReader<float, 3> r(p, options);
+      fails += r.frames() != n_frames || r.shape(0) != n0 || r.shape(1) != n1 || r.shape(2) != n2;
+      index_t t = 0;
+      while (!r.done())
+      {
+        fails += r.position() != t;
+        auto f = r.next();
+        fails += reinterpret_cast<std::uintptr_t>(f.data()) % direct_io_alignment != 0;
+        for (index_t k = 0; k < n2; k++)
+          for (index_t j = 0; j < n1; j++)
+            for (index_t i = 0; i < n0; i++)
+              fails += f(i, j, k) != frame_value(t, i, j, k);
+        t++;
+      }
+      fails += t != n_frames;
+
+      int caught = 0;
+      try
+      {
+        r.next();
+      }
+      catch (const std::out_of_range &)
+      {
+        caught++;
+      }
+      fails += caught != 1;
+    }
+  }
+
+  // the file is a tensor of order 4 whose last dimension is the frame index
+  {
+    auto y = map_file<const float, 4>(path);
+    fails += y.shape(0) != n0 || y.shape(1) != n1 || y.shape(2) != n2 || y.shape(3) != n_frames;
+    fails += y(4, 6, 2, 9) != frame_value(9, 4, 6, 2);
+
+    auto z = load_npy<float, 4>(npy_path);
+    fails += z.shape(0) != n0 || z.shape(1) != n1 || z.shape(2) != n2 || z.shape(3) != n_frames;
+    fails += z(1, 2, 0, 3) != frame_value(3, 1, 2, 0);
+  }
+
+  // files written by save and save_npy, in row-major order, with O_DIRECT
+  // requested (it is used only if the frames are block aligned)
+  {
+    Tensor<double, 3, std::allocator<double>, layout::right> x(6, 4, 8);
+    for (index_t i = 0; i < x.size(); i++)
+      x[i] = i;
+    save_npy(npy_path, x);
+
+    stream_options options;
+    options.direct = true;
+    StreamReader<double, 2, layout::right> r(npy_path, options);
+    fails += r.frames() != 6 || r.shape(0) != 4 || r.shape(1) != 8;
+    fails += r.direct();
+    for (index_t t = 0; t < 6; t++)
+    {
+      auto f = r.next();
+      for (index_t i = 0; i < 4; i++)
+        for (index_t j = 0; j < 8; j++)
+          fails += f(i, j) != x(t, i, j);
+    }
+  }
+  {
+    Tensor<float, 2> x(1024, 3);
+    for (index_t i = 0; i < x.size(); i++)
+      x[i] = i;
+
+    stream_options options;
+    options.direct = true;
+    {
+      StreamWriter<float, 1> w(path, {1024}, options);
+      for (index_t t = 0; t < 3; t++)
+        w.write(x.at(all{}, t));
+    }
+
+    StreamReader<float, 1> r(path, options);
+    fails += r.frames() != 3 || r.shape(0) != 1024;
+    for (index_t t = 0; t < 3; t++)
+    {
+      auto f = r.next();
+      for (index_t i = 0; i < 1024; i++)
+        fails += f(i) != x(i, t);
+    }
+  }
+
+  // mismatched element type, order, or layout
+  int caught = 0;
+  try
+  {
+    StreamReader<double, 1> r(path);
+  }
+  catch (const std::runtime_error &)
+  {
+    caught++;
+  }
+  try
+  {
+    StreamReader<float, 2> r(path);
+  }
+  catch (const std::runtime_error &)
+  {
+    caught++;
+  }
+  try
+  {
+    StreamReader<float, 1, layout::right> r(path);
+  }
+  catch (const std::runtime_error &)
+  {
+    caught++;
+  }
+  try
+  {
+    StreamReader<float, 1> r("does_not_exist.tv");
+  }
+  catch (const std::runtime_error &)
+  {
+    caught++;
+  }
+  fails += caught != 4;
+
+  std::remove(path);
+  std::remove(npy_path);
+
+  if (fails)
+  {
+    std::cout << "Stream test failed!" << std::endl;
+  }
+  else
+  {
+    std::cout << "Stream test passed!" << std::endl;
+  }
+
+  return fails;
+}
@@ -0,0 +1,131 @@
+#include "TensorView.hpp"
+
+#include <iostream>
+#include <cmath>
+
+using namespace tensor;
+
+int main()
+{
+  const int n0 = 3, n1 = 4, n2 = 5;
+  Tensor<double, 3> x(n0, n1, n2);
+  for (double &v : x)
+    v = static_cast<double>(rand()) / RAND_MAX;
+
+  int fails = 0;
+
+  // permuted view
+  auto p = permute<1, 2, 0>(x);
+  fails += p.shape(0) != n1 || p.shape(1) != n2 || p.shape(2) != n0;
+  for (int i = 0; i < n0; i++)
+    for (int j = 0; j < n1; j++)
+      for (int k = 0; k < n2; k++)
+        fails += p(j, k, i) != x(i, j, k);
+
+  // iterating the permuted view visits p in its own first index fastest order
+  {
+    int j = 0, k = 0, i = 0;
+    for (double v : p)
+    {
+      fails += v != x(i, j, k);
+      if (++j == n1)
+      {
+        j = 0;
+        if (++k == n2)
+          k = 0, ++i;
+      }
+    }
+  }
+
+  // writing through a permuted view
+  Tensor<double, 3> y(n1, n2, n0);
+  y = 2.0 * p;
+  for (int i = 0; i < n0; i++)
+    for (int j = 0; j < n1; j++)
+      for (int k = 0; k < n2; k++)
+        fails += y(j, k, i) != 2.0 * x(i, j, k);
+
+  Tensor<double, 3> z(n0, n1, n2);
+  permute<1, 2, 0>(z) = 0.5 * y;
+  for (index_t i = 0; i < z.size(); i++)
+    fails += z[i] != x[i];
+
+  // subviews of permuted views
+  auto ps = p.at(span(1, 4), 2, all{});
+  for (int j = 0; j < 3; j++)
+    for (int i = 0; i < n0; i++)
+      fails += ps(j, i) != x(i, 1 + j, 2);
+
+  // transpose of a matrix and of a strided subview
+  Tensor<double, 2> A(n0, n1);
+  for (double &a : A)
+    a = static_cast<double>(rand()) / RAND_MAX;
+
+  auto At = transpose(A);
+  for (int i = 0; i < n0; i++)
+    for (int j = 0; j < n1; j++)
+      fails += At(j, i) != A(i, j);
+
+  auto xt = transpose(x.at(all{}, 1, all{}));
+  for (int i = 0; i < n0; i++)
+    for (int k = 0; k < n2; k++)
+      fails += xt(k, i) != x(i, 1, k);
+
+  const Tensor<double, 2> &cA = A;
+  auto cAt = transpose(cA);
+  static_assert(std::is_same_v<decltype(cAt), StridedView<const double, 2>>);
+
+  // negative strides
+  auto f = flip(x, 1);
+  for (int i = 0; i < n0; i++)
+    for (int j = 0; j < n1; j++)
+      for (int k = 0; k < n2; k++)
+        fails += f(i, j, k) != x(i, n1 - 1 - j, k);
+
+  auto fs = f.at(1, span(0, 4, 2), all{});
+  for (int j = 0; j < 2; j++)
+    for (int k = 0; k < n2; k++)
+      fails += fs(j, k) != x(1, n1 - 1 - 2 * j, k);
+
+  double rsum = 0;
+  for (index_t i = 0; i < x.size(); i++)
+    rsum += x[i];
+  fails += std::abs(sum(f) - rsum) > 1e-12;
+
+  Tensor<double, 1> v(10);
+  for (int i = 0; i < 10; i++)
+    v(i) = i;
+  auto rv = flip(v, 0);
+  int pos = 0;
+  for (double e : rv)
+    fails += e != 9 - pos++;
+
+  // broadcast (stride zero) dimension
+  StridedView<double, 2> b(v.data(), {10, 3}, {1, 0});
+  for (int i = 0; i < 10; i++)
+    for (int j = 0; j < 3; j++)
+      fails += b(i, j) != i;
+
+  Tensor<double, 2> c(10, 3);
+  c = b + 1.0;
+  for (int i = 0; i < 10; i++)
+    for (int j = 0; j < 3; j++)
+      fails += c(i, j) != i + 1;
+
+  auto bs = b.at(span(2, 5), all{});
+  fails += bs.shape(0) != 3 || bs.shape(1) != 3;
+  for (int i = 0; i < 3; i++)
+    for (int j = 0; j < 3; j++)
+      fails += bs(i, j) != i + 2;
+
+  if (fails)
+  {
+    std::cout << "Strided view test failed!" << std::endl;
+  }
+  else
+  {
+    std::cout << "Strided view test passed!" << std::endl;
+  }
+
+  return fails;
+}
@@ -37,6 +37,53 @@ int main()
     pos++;
   }
 
+  // multidimensional subviews
+  TensorView<double, 3> cube(data, 10, 10, 10);
+
+  auto slab = cube.at(all{}, all{}, 3);
+  pos = 0;
+  for (auto val : slab)
+  {
+    fails += val != slab(pos % 10, pos / 10);
+    pos++;
+  }
+  fails += pos != 100;
+
+  auto strided = cube.at(span(1, 9, 2), 5, span(2, 8));
+  pos = 0;
+  for (auto val : strided)
+  {
+    fails += val != strided(pos % 4, pos / 4);
+    fails += val != strided[pos];
+    pos++;
+  }
+  fails += pos != 24;
+
+  auto block = cube.at(span(2, 5), span(0, 10, 3), span(4, 6));
+  pos = 0;
+  for (auto it = block.begin(); it != block.end(); ++it)
+  {
+    const int i = pos % 3, j = (pos / 3) % 4, k = pos / 12;
+    fails += *it != block(i, j, k);
+    pos++;
+  }
+  fails += pos != 24;
+
+  pos = 24;
+  for (auto it = block.rbegin(); it != block.rend(); ++it)
+  {
+    pos--;
+    fails += *it != block[pos];
+  }
+
+  auto it = block.begin();
+  it += 13;
+  fails += *it != block[13];
+  it -= 7;
+  fails += *it != block[6];
+  fails += it[5] != block[11];
+  fails += (block.end() - block.begin()) != 24;
+
   if (fails)
   {
     std::cout << "Subview iterator test failed!" << std::endl;